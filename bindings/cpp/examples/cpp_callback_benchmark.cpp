@@ -0,0 +1,136 @@
+/**
+ * @file cpp_callback_benchmark.cpp
+ * @author Michal Vasko <mvasko@cesnet.cz>
+ * @brief Benchmark comparing the overhead of C, C++ Callback, and C++ typed callable subscriptions
+ *
+ * @copyright
+ * Copyright 2020 CESNET, z.s.p.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <stdlib.h>
+
+#include "Session.hpp"
+
+#define OP_COUNT 20000
+
+using namespace std;
+
+static const char *rpc_path = "/test-examples:activate-software-image";
+static size_t cb_count;
+
+static int
+c_rpc_cb(sr_session_ctx_t *session, const char *op_path, const sr_val_t *input, const size_t input_cnt, \
+        sr_event_t event, uint32_t request_id, sr_val_t **output, size_t *output_cnt, void *private_data)
+{
+    (void)session;
+    (void)op_path;
+    (void)event;
+    (void)request_id;
+    (void)output;
+    (void)output_cnt;
+    (void)private_data;
+
+    cb_count += input_cnt && input[0].xpath;
+    return SR_ERR_OK;
+}
+
+class My_Callback:public sysrepo::Callback {
+    int rpc(sysrepo::S_Session session, const char *op_path, const sysrepo::S_Vals input, sr_event_t event, \
+            uint32_t request_id, sysrepo::S_Vals_Holder output, void *private_data) override
+    {
+        cb_count += input->val_cnt() && input->val(0)->xpath();
+        return SR_ERR_OK;
+    }
+};
+
+static void
+measure(const char *name, sr_session_ctx_t *sess, const sr_val_t *input)
+{
+    sr_val_t *output;
+    size_t output_cnt;
+    int ret;
+
+    cb_count = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        ret = sr_rpc_send(sess, rpc_path, input, 1, 0, &output, &output_cnt);
+        if (ret != SR_ERR_OK) {
+            sysrepo::throw_exception(ret);
+        }
+        sr_free_values(output, output_cnt);
+    }
+    auto usec = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    if (cb_count != OP_COUNT) {
+        sysrepo::throw_exception(SR_ERR_INTERNAL);
+    }
+    cout << name << ": " << OP_COUNT << " RPCs in " << usec / 1000 << " ms, " << (double)usec / OP_COUNT << " us/op, " \
+        << (OP_COUNT * 1000000.0) / usec << " ops/sec" << endl;
+}
+
+int
+main(int argc, char **argv)
+{
+    sr_val_t input;
+
+    input.xpath = (char *)"/test-examples:activate-software-image/image-name";
+    input.type = SR_STRING_T;
+    input.dflt = false;
+    input.origin = nullptr;
+    input.data.string_val = (char *)"image";
+
+    try {
+        sysrepo::S_Connection conn(new sysrepo::Connection());
+        sysrepo::S_Session sess(new sysrepo::Session(conn));
+
+        /* plain C callback */
+        {
+            sysrepo::S_Subscribe subscribe(new sysrepo::Subscribe(sess));
+            sr_subscription_ctx_t **sub = subscribe->swig_sub();
+            int ret = sr_rpc_subscribe(subscribe->swig_sess(), rpc_path, c_rpc_cb, nullptr, 0, 0, sub);
+            if (ret != SR_ERR_OK) {
+                sysrepo::throw_exception(ret);
+            }
+            measure("C callback", subscribe->swig_sess(), &input);
+        }
+
+        /* C++ Callback object */
+        {
+            sysrepo::S_Subscribe subscribe(new sysrepo::Subscribe(sess));
+            sysrepo::S_Callback cb(new My_Callback());
+            subscribe->rpc_subscribe(rpc_path, cb);
+            measure("C++ Callback", subscribe->swig_sess(), &input);
+        }
+
+        /* C++ typed callable */
+        {
+            sysrepo::S_Subscribe subscribe(new sysrepo::Subscribe(sess));
+            subscribe->rpc_subscribe(rpc_path, [](sysrepo::Session &session, const char *op_path, \
+                    const sysrepo::Vals_View &input, sr_event_t event, uint32_t request_id, \
+                    sysrepo::Vals_Holder &output) {
+                cb_count += input.val_cnt() && input[0].xpath();
+                return SR_ERR_OK;
+            });
+            measure("C++ typed callable", subscribe->swig_sess(), &input);
+        }
+    } catch (const std::exception &e) {
+        cout << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include <memory>
 #include <iostream>
 #include <vector>
+#include <future>
 
 #include <libyang/Tree_Data.hpp>
 #include <libyang/Internal.hpp>
@@ -205,6 +206,19 @@ libyang::S_Data_Node Session::get_data(const char *xpath, uint32_t max_depth, ui
     throw_exception(ret);
 }
 
+S_Async_Request Session::get_data_async(const char *xpath, uint32_t max_depth, uint32_t timeout_ms, \
+        const sr_get_oper_options_t opts)
+{
+    sr_async_t *request;
+
+    int ret = sr_get_data_async(_sess, xpath, max_depth, timeout_ms, opts, &request);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+
+    return std::make_shared<Async_Request>(request, _deleter, _conn);
+}
+
 void Session::set_item(const char *path, S_Val value, const sr_edit_options_t opts)
 {
     sr_val_t *val = value ? value->_val : nullptr;
@@ -248,6 +262,14 @@ void Session::edit_batch(const libyang::S_Data_Node edit, const char *default_op
     }
 }
 
+void Session::edit_batch_data(const char *data, const char *data_path, LYD_FORMAT format, const char *default_operation)
+{
+    int ret = sr_edit_batch_data(_sess, data, data_path, format, default_operation);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
 void Session::validate(const char *module_name, uint32_t timeout_ms)
 {
     int ret = sr_validate(_sess, module_name, timeout_ms);
@@ -289,6 +311,15 @@ void Session::replace_config(const libyang::S_Data_Node src_config, const char *
     }
 }
 
+void Session::replace_config_data(const char *data, const char *data_path, LYD_FORMAT format, const char *module_name, \
+        uint32_t timeout_ms, int wait)
+{
+    int ret = sr_replace_config_data(_sess, module_name, data, data_path, format, timeout_ms, wait);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
 void Session::copy_config(sr_datastore_t src_datastore, const char *module_name, uint32_t timeout_ms, int wait)
 {
     int ret = sr_copy_config(_sess, module_name, src_datastore, timeout_ms, wait);
@@ -372,6 +403,68 @@ S_Tree_Change Session::get_change_tree_next(S_Iter_Change iter)
 
 Session::~Session() {}
 
+Async_Request::Async_Request(sr_async_t *request, S_Deleter sess_deleter, S_Connection conn)
+{
+    _req = request;
+    _sess_deleter = sess_deleter;
+    _conn = conn;
+}
+
+int Async_Request::fd()
+{
+    int fd;
+
+    int ret = sr_async_get_fd(_req, &fd);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+
+    return fd;
+}
+
+bool Async_Request::done()
+{
+    return !_req || sr_async_is_done(_req);
+}
+
+libyang::S_Data_Node Async_Request::get()
+{
+    struct lyd_node *data;
+
+    if (!_req) {
+        throw_exception(SR_ERR_INVAL_ARG);
+    }
+
+    int ret = sr_async_finish(_req, &data);
+    _req = nullptr;
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+
+    if (!data) {
+        return nullptr;
+    }
+    return std::make_shared<libyang::Data_Node>(data, std::make_shared<libyang::Deleter>(data));
+}
+
+std::future<libyang::S_Data_Node> Async_Request::get_future()
+{
+    if (!_req) {
+        throw_exception(SR_ERR_INVAL_ARG);
+    }
+
+    // the request is kept alive until the future is waited for
+    auto self = shared_from_this();
+    return std::async(std::launch::deferred, [self]() { return self->get(); });
+}
+
+Async_Request::~Async_Request()
+{
+    if (_req) {
+        sr_async_finish(_req, nullptr);
+    }
+}
+
 S_Vals Session::rpc_send(const char *path, S_Vals input, uint32_t timeout_ms)
 {
     S_Vals output(new Vals());
@@ -402,6 +495,63 @@ libyang::S_Data_Node Session::rpc_send(libyang::S_Data_Node input, uint32_t time
     return std::make_shared<libyang::Data_Node>(output, std::make_shared<libyang::Deleter>(output));
 }
 
+S_Async_Request Session::rpc_send_async(libyang::S_Data_Node input, uint32_t timeout_ms)
+{
+    sr_async_t *request;
+
+    int ret = sr_rpc_send_tree_async(_sess, input->swig_node(), timeout_ms, &request);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+
+    return std::make_shared<Async_Request>(request, _deleter, _conn);
+}
+
+static void rpc_future_cb(sr_session_ctx_t *session, int err_code, const struct lyd_node *output, void *private_data)
+{
+    auto promise = std::unique_ptr<std::promise<libyang::S_Data_Node>>(
+            static_cast<std::promise<libyang::S_Data_Node> *>(private_data));
+    struct lyd_node *dup;
+    (void)session;
+
+    if (err_code != SR_ERR_OK) {
+        promise->set_exception(std::make_exception_ptr(sysrepo_exception((sr_error_t)err_code)));
+        return;
+    }
+    if (!output) {
+        promise->set_value(nullptr);
+        return;
+    }
+
+    // output is freed once the callback returns, action output keeps its parents same as in rpc_send()
+    dup = lyd_dup(output, LYD_DUP_OPT_RECURSIVE | LYD_DUP_OPT_WITH_PARENTS);
+    if (!dup) {
+        promise->set_exception(std::make_exception_ptr(sysrepo_exception(SR_ERR_LY)));
+        return;
+    }
+
+    try {
+        promise->set_value(std::make_shared<libyang::Data_Node>(dup, std::make_shared<libyang::Deleter>(dup)));
+    } catch (...) {
+        promise->set_exception(std::current_exception());
+    }
+}
+
+std::future<libyang::S_Data_Node> Session::rpc_send_future(libyang::S_Data_Node input, uint32_t timeout_ms)
+{
+    auto promise = new std::promise<libyang::S_Data_Node>();
+    auto future = promise->get_future();
+
+    // the promise is fulfilled and freed by the callback called from a connection worker
+    int ret = sr_rpc_send_async(_sess, input->swig_node(), timeout_ms, rpc_future_cb, promise);
+    if (ret != SR_ERR_OK) {
+        delete promise;
+        throw_exception(ret);
+    }
+
+    return future;
+}
+
 void Session::event_notif_send(const char *path, S_Vals values)
 {
     int ret = sr_event_notif_send(_sess, path, values->_vals, values->val_cnt());
@@ -27,6 +27,9 @@
 #include <memory>
 #include <map>
 #include <vector>
+#include <utility>
+#include <type_traits>
+#include <future>
 
 #include <libyang/Tree_Data.hpp>
 
@@ -91,6 +94,9 @@ public:
     /** Wrapper for [sr_get_data](@ref sr_get_data) */
     libyang::S_Data_Node get_data(const char *xpath, uint32_t max_depth = 0, uint32_t timeout_ms = 0, \
             const sr_get_oper_options_t opts = OPER_DEFAULT);
+    /** Wrapper for [sr_get_data_async](@ref sr_get_data_async) */
+    S_Async_Request get_data_async(const char *xpath, uint32_t max_depth = 0, uint32_t timeout_ms = 0, \
+            const sr_get_oper_options_t opts = OPER_DEFAULT);
 
     /** Wrapper for [sr_set_item](@ref sr_set_item) */
     void set_item(const char *path, S_Val value = nullptr, const sr_edit_options_t opts = EDIT_DEFAULT);
@@ -104,6 +110,8 @@ public:
             const char *leaflist_value = nullptr, const char *origin = nullptr, const sr_edit_options_t opts = EDIT_DEFAULT);
     /** Wrapper for [sr_edit_batch](@ref sr_edit_batch) */
     void edit_batch(const libyang::S_Data_Node edit, const char *default_operation);
+    /** Wrapper for [sr_edit_batch_data](@ref sr_edit_batch_data) */
+    void edit_batch_data(const char *data, const char *data_path, LYD_FORMAT format, const char *default_operation);
     /** Wrapper for [sr_validate](@ref sr_validate) */
     void validate(const char *module_name = nullptr, uint32_t timeout_ms = 0);
     /** Wrapper for [sr_apply_changes](@ref sr_apply_changes) */
@@ -113,6 +121,9 @@ public:
     /** Wrapper for [sr_replace_config](@ref sr_replace_config) */
     void replace_config(const libyang::S_Data_Node src_config, const char *module_name = nullptr, uint32_t timeout_ms = 0, \
             int wait = 0);
+    /** Wrapper for [sr_replace_config_data](@ref sr_replace_config_data) */
+    void replace_config_data(const char *data, const char *data_path, LYD_FORMAT format, const char *module_name = nullptr, \
+            uint32_t timeout_ms = 0, int wait = 0);
     /** Wrapper for [sr_copy_config](@ref sr_copy_config) */
     void copy_config(sr_datastore_t src_datastore, const char *module_name = nullptr, uint32_t timeout_ms = 0, int wait = 0);
 
@@ -135,6 +146,13 @@ public:
     S_Vals rpc_send(const char *path, S_Vals input, uint32_t timeout_ms = 0);
     /** Wrapper for [sr_rpc_send_tree](@ref sr_rpc_send_tree) */
     libyang::S_Data_Node rpc_send(libyang::S_Data_Node input, uint32_t timeout_ms = 0);
+    /** Wrapper for [sr_rpc_send_tree_async](@ref sr_rpc_send_tree_async) */
+    S_Async_Request rpc_send_async(libyang::S_Data_Node input, uint32_t timeout_ms = 0);
+#ifndef SWIG
+    /** Wrapper for [sr_rpc_send_async](@ref sr_rpc_send_async), the future is ready once the output is received,
+     * the session must not be stopped before that */
+    std::future<libyang::S_Data_Node> rpc_send_future(libyang::S_Data_Node input, uint32_t timeout_ms = 0);
+#endif
 
     /** Wrapper for [sr_event_notif_send](@ref sr_event_notif_send) */
     void event_notif_send(const char *path, S_Vals values);
@@ -149,6 +167,34 @@ private:
     S_Deleter _deleter;
 };
 
+/**
+ * @brief Class for wrapping sr_async_t. Keeps the session it was created on alive.
+ * @class Async_Request
+ */
+class Async_Request : public std::enable_shared_from_this<Async_Request>
+{
+public:
+    /** Wrapper for [sr_async_t](@ref sr_async_t), for internal use only.*/
+    Async_Request(sr_async_t *request, S_Deleter sess_deleter, S_Connection conn);
+    /** Wrapper for [sr_async_get_fd](@ref sr_async_get_fd), to be polled for POLLIN */
+    int fd();
+    /** Wrapper for [sr_async_is_done](@ref sr_async_is_done) */
+    bool done();
+    /** Wrapper for [sr_async_finish](@ref sr_async_finish), waits for the result, can be called only once */
+    libyang::S_Data_Node get();
+#ifndef SWIG
+    /** Future of the result, waiting for it calls [sr_async_finish](@ref sr_async_finish) so poll fd() first
+     * to wait without blocking, can be called only once */
+    std::future<libyang::S_Data_Node> get_future();
+#endif
+    ~Async_Request();
+
+private:
+    sr_async_t *_req;
+    S_Deleter _sess_deleter;
+    S_Connection _conn;
+};
+
 /**
  * @brief Helper class for calling C callbacks, C++ only.
  * @class Callback
@@ -182,6 +228,58 @@ public:
     std::map<const char *, void *> private_data;
 };
 
+#ifndef SWIG
+/**
+ * @brief Base class of callables stored directly by a subscription, C++ only.
+ * @class Callable
+ */
+class Callable
+{
+public:
+    virtual ~Callable() {};
+};
+
+/**
+ * @brief Typed callable stored by a subscription, C++ only.
+ * @class Callable_Fn
+ */
+template<typename F>
+class Callable_Fn : public Callable
+{
+public:
+    template<typename G>
+    explicit Callable_Fn(G &&callable) : fn(std::forward<G>(callable)) {}
+
+    F fn;
+};
+
+/** Call a callback returning an error code, exceptions are converted to error codes. */
+template<typename F>
+int callable_ret(F &&call) noexcept
+{
+    try {
+        return call();
+    } catch (const sysrepo_exception &e) {
+        return e.error_code();
+    } catch (...) {
+        return SR_ERR_CALLBACK_FAILED;
+    }
+}
+
+/** Call a callback returning nothing, exceptions are ignored. */
+template<typename F>
+void callable_void(F &&call) noexcept
+{
+    try {
+        call();
+    } catch (...) {}
+}
+
+/** Whether a type can be used as a typed callable and not as S_Callback. */
+template<typename F>
+using enable_if_callable = typename std::enable_if<!std::is_convertible<F, S_Callback>::value>::type;
+#endif
+
 /**
  * @brief Class for wrapping sr_subscription_ctx_t.
  * @class Subscribe
@@ -213,6 +311,48 @@ public:
             void *private_data = nullptr, sr_subscr_options_t opts = SUBSCR_DEFAULT);
     std::vector<S_Callback > cb_list;
 
+#ifndef SWIG
+    /**
+     * Typed callables subscribe directly, without a Callback object, and they are called with non-owning
+     * Session and value views so there are no allocations per event. Any callable state should be captured,
+     * there is no private data.
+     */
+
+    /** Wrapper for [sr_module_change_subscribe](@ref sr_module_change_subscribe), callable signature
+     * int (Session &session, const char *module_name, const char *xpath, sr_event_t event, uint32_t request_id) */
+    template<typename F, typename = enable_if_callable<F>>
+    void module_change_subscribe(const char *module_name, F &&callback, const char *xpath = nullptr, \
+            uint32_t priority = 0, sr_subscr_options_t opts = SUBSCR_DEFAULT);
+    /** Wrapper for [sr_rpc_subscribe](@ref sr_rpc_subscribe), callable signature
+     * int (Session &session, const char *op_path, const Vals_View &input, sr_event_t event, uint32_t request_id,
+     * Vals_Holder &output) */
+    template<typename F, typename = enable_if_callable<F>>
+    void rpc_subscribe(const char *xpath, F &&callback, uint32_t priority = 0, sr_subscr_options_t opts = SUBSCR_DEFAULT);
+    /** Wrapper for [sr_rpc_subscribe_tree](@ref sr_rpc_subscribe_tree), callable signature
+     * int (Session &session, const char *op_path, const struct lyd_node *input, sr_event_t event, uint32_t request_id,
+     * struct lyd_node *output) */
+    template<typename F, typename = enable_if_callable<F>>
+    void rpc_subscribe_tree(const char *xpath, F &&callback, uint32_t priority = 0, \
+            sr_subscr_options_t opts = SUBSCR_DEFAULT);
+    /** Wrapper for [sr_event_notif_subscribe](@ref sr_event_notif_subscribe), callable signature
+     * void (Session &session, const sr_ev_notif_type_t notif_type, const char *path, const Vals_View &vals,
+     * time_t timestamp) */
+    template<typename F, typename = enable_if_callable<F>>
+    void event_notif_subscribe(const char *module_name, F &&callback, const char *xpath = nullptr, \
+            time_t start_time = 0, time_t stop_time = 0, sr_subscr_options_t opts = SUBSCR_DEFAULT);
+    /** Wrapper for [sr_event_notif_subscribe_tree](@ref sr_event_notif_subscribe_tree), callable signature
+     * void (Session &session, const sr_ev_notif_type_t notif_type, const struct lyd_node *notif, time_t timestamp) */
+    template<typename F, typename = enable_if_callable<F>>
+    void event_notif_subscribe_tree(const char *module_name, F &&callback, const char *xpath = nullptr, \
+            time_t start_time = 0, time_t stop_time = 0, sr_subscr_options_t opts = SUBSCR_DEFAULT);
+    /** Wrapper for [sr_oper_get_items_subscribe](@ref sr_oper_get_items_subscribe), callable signature
+     * int (Session &session, const char *module_name, const char *path, const char *request_xpath,
+     * uint32_t request_id, struct lyd_node **parent) */
+    template<typename F, typename = enable_if_callable<F>>
+    void oper_get_items_subscribe(const char *module_name, const char *path, F &&callback, \
+            sr_subscr_options_t opts = SUBSCR_DEFAULT);
+#endif
+
     /** Wrapper for [sr_get_event_pipe](@ref sr_get_event_pipe) */
     int get_event_pipe();
     /** Wrapper for [sr_process_event](@ref sr_process_events) */
@@ -231,11 +371,160 @@ public:
     void additional_cleanup(void *private_data) {return;};
 
 private:
+#ifndef SWIG
+    template<typename F>
+    Callable_Fn<typename std::decay<F>::type> *add_callable(F &&callback);
+
+    std::vector<std::unique_ptr<Callable>> _callables;
+#endif
     sr_subscription_ctx_t *_sub;
     S_Session _sess;
     S_Deleter sess_deleter;
 };
 
+#ifndef SWIG
+template<typename F>
+Callable_Fn<typename std::decay<F>::type> *Subscribe::add_callable(F &&callback)
+{
+    auto callable = new Callable_Fn<typename std::decay<F>::type>(std::forward<F>(callback));
+    _callables.emplace_back(callable);
+    return callable;
+}
+
+template<typename F, typename>
+void Subscribe::module_change_subscribe(const char *module_name, F &&callback, const char *xpath, uint32_t priority, \
+        sr_subscr_options_t opts)
+{
+    using C = Callable_Fn<typename std::decay<F>::type>;
+    C *callable = add_callable(std::forward<F>(callback));
+
+    sr_module_change_cb cb = [](sr_session_ctx_t *session, const char *module_name, const char *xpath, \
+            sr_event_t event, uint32_t request_id, void *private_data) -> int {
+        Session sess(session);
+        C *callable = static_cast<C *>(private_data);
+        return callable_ret([&]() {return callable->fn(sess, module_name, xpath, event, request_id);});
+    };
+
+    opts |= SR_SUBSCR_CTX_REUSE;
+    int ret = sr_module_change_subscribe(_sess->_sess, module_name, xpath, cb, callable, priority, opts, &_sub);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
+template<typename F, typename>
+void Subscribe::rpc_subscribe(const char *xpath, F &&callback, uint32_t priority, sr_subscr_options_t opts)
+{
+    using C = Callable_Fn<typename std::decay<F>::type>;
+    C *callable = add_callable(std::forward<F>(callback));
+
+    sr_rpc_cb cb = [](sr_session_ctx_t *session, const char *op_path, const sr_val_t *input, const size_t input_cnt, \
+            sr_event_t event, uint32_t request_id, sr_val_t **output, size_t *output_cnt, void *private_data) -> int {
+        Session sess(session);
+        C *callable = static_cast<C *>(private_data);
+        return callable_ret([&]() {
+            Vals_View in_vals(input, input_cnt);
+            Vals_Holder out_vals(output, output_cnt);
+            return callable->fn(sess, op_path, in_vals, event, request_id, out_vals);
+        });
+    };
+
+    opts |= SR_SUBSCR_CTX_REUSE;
+    int ret = sr_rpc_subscribe(_sess->_sess, xpath, cb, callable, priority, opts, &_sub);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
+template<typename F, typename>
+void Subscribe::rpc_subscribe_tree(const char *xpath, F &&callback, uint32_t priority, sr_subscr_options_t opts)
+{
+    using C = Callable_Fn<typename std::decay<F>::type>;
+    C *callable = add_callable(std::forward<F>(callback));
+
+    sr_rpc_tree_cb cb = [](sr_session_ctx_t *session, const char *op_path, const struct lyd_node *input, \
+            sr_event_t event, uint32_t request_id, struct lyd_node *output, void *private_data) -> int {
+        Session sess(session);
+        C *callable = static_cast<C *>(private_data);
+        return callable_ret([&]() {return callable->fn(sess, op_path, input, event, request_id, output);});
+    };
+
+    opts |= SR_SUBSCR_CTX_REUSE;
+    int ret = sr_rpc_subscribe_tree(_sess->_sess, xpath, cb, callable, priority, opts, &_sub);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
+template<typename F, typename>
+void Subscribe::event_notif_subscribe(const char *module_name, F &&callback, const char *xpath, time_t start_time, \
+        time_t stop_time, sr_subscr_options_t opts)
+{
+    using C = Callable_Fn<typename std::decay<F>::type>;
+    C *callable = add_callable(std::forward<F>(callback));
+
+    sr_event_notif_cb cb = [](sr_session_ctx_t *session, const sr_ev_notif_type_t notif_type, const char *path, \
+            const sr_val_t *values, const size_t values_cnt, time_t timestamp, void *private_data) {
+        Session sess(session);
+        C *callable = static_cast<C *>(private_data);
+        callable_void([&]() {
+            Vals_View vals(values, values_cnt);
+            callable->fn(sess, notif_type, path, vals, timestamp);
+        });
+    };
+
+    opts |= SR_SUBSCR_CTX_REUSE;
+    int ret = sr_event_notif_subscribe(_sess->_sess, module_name, xpath, start_time, stop_time, cb, callable, opts, \
+            &_sub);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
+template<typename F, typename>
+void Subscribe::event_notif_subscribe_tree(const char *module_name, F &&callback, const char *xpath, \
+        time_t start_time, time_t stop_time, sr_subscr_options_t opts)
+{
+    using C = Callable_Fn<typename std::decay<F>::type>;
+    C *callable = add_callable(std::forward<F>(callback));
+
+    sr_event_notif_tree_cb cb = [](sr_session_ctx_t *session, const sr_ev_notif_type_t notif_type, \
+            const struct lyd_node *notif, time_t timestamp, void *private_data) {
+        Session sess(session);
+        C *callable = static_cast<C *>(private_data);
+        callable_void([&]() {callable->fn(sess, notif_type, notif, timestamp);});
+    };
+
+    opts |= SR_SUBSCR_CTX_REUSE;
+    int ret = sr_event_notif_subscribe_tree(_sess->_sess, module_name, xpath, start_time, stop_time, cb, callable, \
+            opts, &_sub);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+
+template<typename F, typename>
+void Subscribe::oper_get_items_subscribe(const char *module_name, const char *path, F &&callback, \
+        sr_subscr_options_t opts)
+{
+    using C = Callable_Fn<typename std::decay<F>::type>;
+    C *callable = add_callable(std::forward<F>(callback));
+
+    sr_oper_get_items_cb cb = [](sr_session_ctx_t *session, const char *module_name, const char *path, \
+            const char *request_xpath, uint32_t request_id, struct lyd_node **parent, void *private_data) -> int {
+        Session sess(session);
+        C *callable = static_cast<C *>(private_data);
+        return callable_ret([&]() {return callable->fn(sess, module_name, path, request_xpath, request_id, parent);});
+    };
+
+    opts |= SR_SUBSCR_CTX_REUSE;
+    int ret = sr_oper_get_items_subscribe(_sess->_sess, module_name, path, cb, callable, opts, &_sub);
+    if (ret != SR_ERR_OK) {
+        throw_exception(ret);
+    }
+}
+#endif
+
 /** @} */
 }
 #endif
@@ -468,6 +468,26 @@ sr_val_t* Vals::reallocate(size_t n) {
     return _vals;
 }
 
+// Val_View
+std::string Val_View::val_to_string() const {
+    char *value = sr_val_to_str(_val);
+    if (value == nullptr) {
+        throw_exception(SR_ERR_OPERATION_FAILED);
+    }
+    std::string string_val = value;
+    free(value);
+
+    return string_val;
+}
+
+// Vals_View
+Val_View Vals_View::val(size_t n) const {
+    if (n >= _cnt)
+        throw std::out_of_range("Vals_View::val: index out of range");
+
+    return Val_View(&_vals[n]);
+}
+
 // Vals_Holder
 Vals_Holder::Vals_Holder(sr_val_t **vals, size_t *cnt) {
     if (!vals || !cnt || (!*vals && *cnt))
@@ -211,6 +211,73 @@ private:
     S_Deleter _deleter;
 };
 
+#ifndef SWIG
+/**
+ * @brief Non-owning view of a single sr_val_t, the value must outlive it, C++ only.
+ * @class Val_View
+ */
+class Val_View
+{
+public:
+    /** View of an existing [sr_val_t](@ref sr_val_t).*/
+    explicit Val_View(const sr_val_t *val) : _val(val) {};
+    /** Getter for xpath.*/
+    const char *xpath() const {return _val->xpath;};
+    /** Getter for type.*/
+    sr_type_t type() const {return _val->type;};
+    /** Getter for dflt.*/
+    bool dflt() const {return _val->dflt;};
+    /** Getter for origin.*/
+    const char *origin() const {return _val->origin;};
+    /** Getter for data, read it based on the type.*/
+    const sr_data_t &data() const {return _val->data;};
+    /** Getter for the viewed [sr_val_t](@ref sr_val_t).*/
+    const sr_val_t *get() const {return _val;};
+    /** Wrapper for [sr_val_to_str](@ref sr_val_to_str) */
+    std::string val_to_string() const;
+
+private:
+    const sr_val_t *_val;
+};
+
+/**
+ * @brief Non-owning view of an sr_val_t array, the array must outlive it, C++ only.
+ * @class Vals_View
+ */
+class Vals_View
+{
+public:
+    /** Iterator over the viewed values.*/
+    class iterator
+    {
+    public:
+        explicit iterator(const sr_val_t *val) : _val(val) {};
+        Val_View operator*() const {return Val_View(_val);};
+        iterator &operator++() {++_val; return *this;};
+        bool operator==(const iterator &other) const {return _val == other._val;};
+        bool operator!=(const iterator &other) const {return _val != other._val;};
+
+    private:
+        const sr_val_t *_val;
+    };
+
+    /** View of an existing [sr_val_t](@ref sr_val_t) array.*/
+    Vals_View(const sr_val_t *vals, size_t cnt) : _vals(vals), _cnt(cnt) {};
+    /** Getter for array size */
+    size_t val_cnt() const {return _cnt;};
+    /** Getter for the n-th value view, with index check.*/
+    Val_View val(size_t n) const;
+    /** Getter for the n-th value view, without index check.*/
+    Val_View operator[](size_t n) const {return Val_View(&_vals[n]);};
+    iterator begin() const {return iterator(_vals);};
+    iterator end() const {return iterator(_vals + _cnt);};
+
+private:
+    const sr_val_t *_vals;
+    size_t _cnt;
+};
+#endif
+
 /**
  * @brief Class for wrapping sr_val_t in callbacks.
  * @class Vals_Holder
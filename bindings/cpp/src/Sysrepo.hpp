@@ -54,6 +54,7 @@ class Change;
 class Tree_Change;
 class Callback;
 class Deleter;
+class Async_Request;
 
 using S_Iter_Change      = std::shared_ptr<Iter_Change>;
 using S_Session          = std::shared_ptr<Session>;
@@ -71,6 +72,7 @@ using S_Change           = std::shared_ptr<Change>;
 using S_Tree_Change      = std::shared_ptr<Tree_Change>;
 using S_Callback         = std::shared_ptr<Callback>;
 using S_Deleter          = std::shared_ptr<Deleter>;
+using S_Async_Request    = std::shared_ptr<Async_Request>;
 
 /* this is a workaround for python not recognizing
  * enum's in function default values */
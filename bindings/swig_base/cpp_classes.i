@@ -45,6 +45,9 @@
 %newobject Session::rpc_send;
 %newobject Session::action_send;
 
+%shared_ptr(sysrepo::Async_Request);
+%ignore Async_Request::Async_Request;
+
 %shared_ptr(sysrepo::Callback);
 %ignore Callback::private_data;
 
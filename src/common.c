@@ -32,6 +32,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/mman.h>
+#ifdef SR_HAVE_SENDFILE
+# include <sys/sendfile.h>
+#endif
 #include <signal.h>
 #include <pwd.h>
 #include <grp.h>
@@ -553,12 +556,12 @@ sr_sub_notif_del(const char *mod_name, const char *xpath, time_t start_time, tim
 
 sr_error_info_t *
 sr_sub_rpc_add(sr_session_ctx_t *sess, const char *op_path, const char *xpath, sr_rpc_cb rpc_cb,
-        sr_rpc_tree_cb rpc_tree_cb, void *private_data, uint32_t priority, sr_subscription_ctx_t *subs)
+        sr_rpc_tree_cb rpc_tree_cb, void *private_data, uint32_t priority, uint32_t slot, sr_subscription_ctx_t *subs)
 {
     sr_error_info_t *err_info = NULL;
     struct opsub_rpc_s *rpc_sub = NULL;
     uint32_t i;
-    char *mod_name;
+    char *mod_name, suffix[SR_RPC_SUB_SUFFIX_LEN];
     void *mem[4] = {NULL};
 
     assert(op_path && xpath && (rpc_cb || rpc_tree_cb) && (!rpc_cb || !rpc_tree_cb));
@@ -568,9 +571,9 @@ sr_sub_rpc_add(sr_session_ctx_t *sess, const char *op_path, const char *xpath, s
         return err_info;
     }
 
-    /* try to find this RPC/action subscriptions, they may already exist */
+    /* try to find this RPC/action subscriptions, they may already exist (concurrent ones each use their own SHM) */
     for (i = 0; i < subs->rpc_sub_count; ++i) {
-        if (!strcmp(op_path, subs->rpc_subs[i].op_path)) {
+        if (!strcmp(op_path, subs->rpc_subs[i].op_path) && (subs->rpc_subs[i].slot == slot)) {
             break;
         }
     }
@@ -588,12 +591,14 @@ sr_sub_rpc_add(sr_session_ctx_t *sess, const char *op_path, const char *xpath, s
         mem[1] = strdup(op_path);
         SR_CHECK_MEM_GOTO(!mem[1], err_info, error_unlock);
         rpc_sub->op_path = mem[1];
+        rpc_sub->slot = slot;
 
         /* get module name */
         mod_name = sr_get_first_ns(xpath);
 
         /* create specific SHM and map it */
-        err_info = sr_shmsub_open_map(mod_name, "rpc", sr_str_hash(op_path), &rpc_sub->sub_shm, sizeof(sr_multi_sub_shm_t));
+        err_info = sr_shmsub_open_map(mod_name, sr_path_sub_shm_rpc_suffix(slot, suffix), sr_str_hash(op_path),
+                &rpc_sub->sub_shm, sizeof(sr_multi_sub_shm_t));
         free(mod_name);
         if (err_info) {
             goto error_unlock;
@@ -769,11 +774,11 @@ sr_subs_session_del(sr_session_ctx_t *sess, sr_subscription_ctx_t *subs)
     struct modsub_oper_s *oper_sub;
     struct modsub_notif_s *notif_sub;
     struct opsub_rpc_s *rpc_sub;
+    sr_main_shm_t *main_shm;
     sr_mod_t *shm_mod;
     sr_rpc_t *shm_rpc;
-    sr_shm_t *ext_shm;
 
-    ext_shm = &sess->conn->ext_shm;
+    main_shm = (sr_main_shm_t *)sess->conn->main_shm.addr;
 
     /* remove ourselves from session subscriptions */
     if ((err_info = sr_ptr_del(&sess->ptr_lock, (void ***)&sess->subscriptions, &sess->subscription_count, subs))) {
@@ -786,7 +791,7 @@ change_subs_del:
         change_subs = &subs->change_subs[i];
 
         /* find module */
-        shm_mod = sr_shmmain_find_module(&sess->conn->main_shm, ext_shm->addr, change_subs->module_name, 0);
+        shm_mod = sr_shmmain_find_module(&sess->conn->main_shm, sess->conn->ext_shm.addr, change_subs->module_name, 0);
         SR_CHECK_INT_RET(!shm_mod, err_info);
         for (j = 0; j < change_subs->sub_count; ++j) {
             if (change_subs->subs[j].sess == sess) {
@@ -812,12 +817,12 @@ oper_subs_del:
         oper_sub = &subs->oper_subs[i];
 
         /* find module */
-        shm_mod = sr_shmmain_find_module(&sess->conn->main_shm, ext_shm->addr, oper_sub->module_name, 0);
+        shm_mod = sr_shmmain_find_module(&sess->conn->main_shm, sess->conn->ext_shm.addr, oper_sub->module_name, 0);
         SR_CHECK_INT_RET(!shm_mod, err_info);
         for (j = 0; j < oper_sub->sub_count; ++j) {
             if (oper_sub->subs[j].sess == sess) {
                 /* properly remove the subscriptions from the main SHM */
-                if ((err_info = sr_shmmod_oper_subscription_stop(ext_shm->addr, shm_mod, oper_sub->subs[j].xpath,
+                if ((err_info = sr_shmmod_oper_subscription_stop(sess->conn, shm_mod, oper_sub->subs[j].xpath,
                         subs->evpipe_num, 0))) {
                     return err_info;
                 }
@@ -837,12 +842,12 @@ notif_subs_del:
         notif_sub = &subs->notif_subs[i];
 
         /* find module */
-        shm_mod = sr_shmmain_find_module(&sess->conn->main_shm, ext_shm->addr, notif_sub->module_name, 0);
+        shm_mod = sr_shmmain_find_module(&sess->conn->main_shm, sess->conn->ext_shm.addr, notif_sub->module_name, 0);
         SR_CHECK_INT_RET(!shm_mod, err_info);
         for (j = 0; j < notif_sub->sub_count; ++j) {
             if (notif_sub->subs[j].sess == sess) {
                 /* properly remove the subscriptions from the main SHM */
-                if ((err_info = sr_shmmod_notif_subscription_stop(ext_shm->addr, shm_mod, subs->evpipe_num, 0))) {
+                if ((err_info = sr_shmmod_notif_subscription_stop(sess->conn, shm_mod, subs->evpipe_num, 0))) {
                     return err_info;
                 }
 
@@ -862,14 +867,26 @@ rpc_subs_del:
     for (i = 0; i < subs->rpc_sub_count; ++i) {
         rpc_sub = &subs->rpc_subs[i];
 
-        /* find RPC/action */
-        shm_rpc = sr_shmmain_find_rpc((sr_main_shm_t *)sess->conn->main_shm.addr, ext_shm->addr, rpc_sub->op_path, 0);
-        SR_CHECK_INT_RET(!shm_rpc, err_info);
         for (j = 0; j < rpc_sub->sub_count; ++j) {
             if (rpc_sub->subs[j].sess == sess) {
-                /* properly remove the subscription from the main SHM */
-                if ((err_info = sr_shmmain_rpc_subscription_stop(sess->conn, shm_rpc, rpc_sub->subs[j].xpath,
-                        rpc_sub->subs[j].priority, subs->evpipe_num, 0, NULL))) {
+                /* RPC SUBS WRITE LOCK */
+                if ((err_info = sr_shmmain_sub_lock_remap(sess->conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__))) {
+                    return err_info;
+                }
+
+                /* find RPC/action */
+                shm_rpc = sr_shmmain_find_rpc(main_shm, sess->conn->ext_shm.addr, rpc_sub->op_path, 0);
+                if (!shm_rpc) {
+                    SR_ERRINFO_INT(&err_info);
+                } else {
+                    /* properly remove the subscription from the main SHM */
+                    err_info = sr_shmmain_rpc_subscription_stop(sess->conn, shm_rpc, rpc_sub->subs[j].xpath,
+                            rpc_sub->subs[j].priority, subs->evpipe_num, 0, NULL);
+                }
+
+                /* RPC SUBS WRITE UNLOCK */
+                sr_shmmain_sub_unlock(sess->conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__);
+                if (err_info) {
                     return err_info;
                 }
 
@@ -954,12 +971,32 @@ sr_notif_find_subscriber(sr_conn_ctx_t *conn, const char *mod_name, sr_mod_notif
     sr_error_info_t *err_info = NULL;
     sr_mod_t *shm_mod;
 
+    *notif_subs = NULL;
+    *notif_sub_count = 0;
+
     shm_mod = sr_shmmain_find_module(&conn->main_shm, conn->ext_shm.addr, mod_name, 0);
     SR_CHECK_INT_RET(!shm_mod, err_info);
 
-    *notif_subs = (sr_mod_notif_sub_t *)(conn->ext_shm.addr + shm_mod->notif_subs);
-    *notif_sub_count = shm_mod->notif_sub_count;
-    return NULL;
+    /* MOD SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    if (shm_mod->notif_sub_count) {
+        /* copy the subscriptions, they can be changed once unlocked */
+        *notif_subs = malloc(shm_mod->notif_sub_count * sizeof **notif_subs);
+        if (!*notif_subs) {
+            SR_ERRINFO_MEM(&err_info);
+            goto cleanup;
+        }
+        memcpy(*notif_subs, conn->ext_shm.addr + shm_mod->notif_subs, shm_mod->notif_sub_count * sizeof **notif_subs);
+        *notif_sub_count = shm_mod->notif_sub_count;
+    }
+
+cleanup:
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_READ, __func__);
+    return err_info;
 }
 
 sr_error_info_t *
@@ -1282,6 +1319,14 @@ sr_remove_data_files(const char *mod_name)
     }
     free(path);
 
+    if ((err_info = sr_path_running_diff_shm(mod_name, 0, &path))) {
+        return err_info;
+    }
+    if ((shm_unlink(path) == -1) && (errno != ENOENT)) {
+        SR_LOG_WRN("Failed to unlink \"%s\" (%s).", path, strerror(errno));
+    }
+    free(path);
+
     if ((err_info = sr_path_ds_shm(mod_name, SR_DS_OPERATIONAL, 0, &path))) {
         return err_info;
     }
@@ -1472,6 +1517,18 @@ sr_path_ext_shm(char **path)
     return err_info;
 }
 
+const char *
+sr_path_sub_shm_rpc_suffix(uint32_t slot, char *suffix)
+{
+    if (slot) {
+        snprintf(suffix, SR_RPC_SUB_SUFFIX_LEN, "rpc%" PRIu32, slot);
+    } else {
+        strcpy(suffix, "rpc");
+    }
+
+    return suffix;
+}
+
 sr_error_info_t *
 sr_path_sub_shm(const char *mod_name, const char *suffix1, int64_t suffix2, int abs_path, char **path)
 {
@@ -1521,6 +1578,27 @@ sr_path_ds_shm(const char *mod_name, sr_datastore_t ds, int abs_path, char **pat
     return err_info;
 }
 
+sr_error_info_t *
+sr_path_running_diff_shm(const char *mod_name, int abs_path, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+    const char *prefix;
+    int ret;
+
+    err_info = sr_shm_prefix(&prefix);
+    if (err_info) {
+        return err_info;
+    }
+
+    ret = asprintf(path, "%s/%s_%s.%s.diff", abs_path ? SR_SHM_DIR : "",
+            prefix, mod_name, sr_ds2str(SR_DS_RUNNING));
+    if (ret == -1) {
+        *path = NULL;
+        SR_ERRINFO_MEM(&err_info);
+    }
+    return err_info;
+}
+
 sr_error_info_t *
 sr_path_evpipe(uint32_t evpipe_num, char **path)
 {
@@ -1533,6 +1611,30 @@ sr_path_evpipe(uint32_t evpipe_num, char **path)
     return err_info;
 }
 
+sr_error_info_t *
+sr_path_conn_dir(char **path)
+{
+    sr_error_info_t *err_info = NULL;
+
+    if (asprintf(path, "%s/conn", sr_get_repo_path()) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+
+    return err_info;
+}
+
+sr_error_info_t *
+sr_path_conn_file(pid_t pid, sr_conn_ctx_t *conn_ctx, char **path)
+{
+    sr_error_info_t *err_info = NULL;
+
+    if (asprintf(path, "%s/conn/%ld.%" PRIxPTR, sr_get_repo_path(), (long)pid, (uintptr_t)conn_ctx) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+
+    return err_info;
+}
+
 sr_error_info_t *
 sr_path_startup_dir(char **path)
 {
@@ -2004,16 +2106,38 @@ sr_file_exists(const char *path)
 int
 sr_process_exists(pid_t pid)
 {
-    if (!kill(pid, 0)) {
-        return 1;
+    char path[32], buf[128], *ptr;
+    ssize_t len;
+    int fd;
+
+    if (kill(pid, 0)) {
+        if (errno != ESRCH) {
+            SR_LOG_INF("Failed to check existence of process with PID %ld (%s).", (long)pid, strerror(errno));
+            return 1;
+        }
+        return 0;
     }
 
-    if (errno != ESRCH) {
-        SR_LOG_INF("Failed to check existence of process with PID %ld (%s).", (long)pid, strerror(errno));
+    /* a zombie process still exists but has already released all its resources */
+    sprintf(path, "/proc/%ld/stat", (long)pid);
+    if ((fd = open(path, O_RDONLY | O_CLOEXEC)) == -1) {
+        /* procfs not available, rely on kill() */
         return 1;
     }
+    len = read(fd, buf, sizeof buf - 1);
+    close(fd);
+    if (len < 1) {
+        return 1;
+    }
+    buf[len] = '\0';
 
-    return 0;
+    /* the state follows the executable name in parentheses */
+    ptr = strrchr(buf, ')');
+    if (ptr && (ptr[1] == ' ') && ((ptr[2] == 'Z') || (ptr[2] == 'X'))) {
+        return 0;
+    }
+
+    return 1;
 }
 
 void
@@ -2127,13 +2251,238 @@ sr_strshmlen(const char *str)
     return SR_SHM_SIZE(strlen(str) + 1);
 }
 
+/**
+ * @brief Get the size class of an ext SHM slab block.
+ *
+ * @param[in] size Requested memory size.
+ * @return Size class.
+ */
+static uint32_t
+sr_shmalloc_class(size_t size)
+{
+    uint32_t class = 0;
+
+    while (((size_t)SR_SHM_BLOCK_MIN_SIZE << class) < size) {
+        ++class;
+    }
+
+    return class;
+}
+
+size_t
+sr_shmalloc_size(size_t size)
+{
+    return (size_t)SR_SHM_BLOCK_MIN_SIZE << sr_shmalloc_class(size);
+}
+
+/**
+ * @brief Add a free ext SHM block into the free list of its size class. EXT lock is expected to be held.
+ *
+ * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] off Offset of the block.
+ * @param[in] class Size class of the block.
+ */
+static void
+sr_shmfree_list_add(char *ext_shm_addr, off_t off, uint32_t class)
+{
+    sr_ext_shm_t *ext_shm = (sr_ext_shm_t *)ext_shm_addr;
+
+    /* prepend the block to its free list */
+    *((off_t *)(ext_shm_addr + off)) = ext_shm->free_blocks[class];
+    ext_shm->free_blocks[class] = off;
+}
+
+/**
+ * @brief Remove a block from the free list of its size class. EXT lock is expected to be held.
+ *
+ * @param[in] shm_ext Ext SHM structure.
+ * @param[in] off Offset of the block.
+ * @param[in] class Size class of the block.
+ * @return Whether the block was free and was removed, 0 if it is in use or could not be found
+ * in the current mapping.
+ */
+static int
+sr_shmfree_list_del(sr_shm_t *shm_ext, off_t off, uint32_t class)
+{
+    sr_ext_shm_t *ext_shm = (sr_ext_shm_t *)shm_ext->addr;
+    off_t *next;
+
+    for (next = &ext_shm->free_blocks[class]; *next; next = (off_t *)(shm_ext->addr + *next)) {
+        if ((size_t)*next + sizeof *next > shm_ext->size) {
+            /* the block was added by another process and is not mapped yet */
+            return 0;
+        }
+        if (*next == off) {
+            *next = *((off_t *)(shm_ext->addr + off));
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Add unused ext SHM memory into the free lists divided into the largest blocks aligned to their size.
+ * EXT lock is expected to be held.
+ *
+ * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] start Start offset of the memory.
+ * @param[in] end End offset of the memory.
+ */
+static void
+sr_shmfree_range(char *ext_shm_addr, off_t start, off_t end)
+{
+    uint32_t class;
+
+    start = (start + SR_SHM_BLOCK_MIN_SIZE - 1) & ~((off_t)SR_SHM_BLOCK_MIN_SIZE - 1);
+    while (start + SR_SHM_BLOCK_MIN_SIZE <= end) {
+        class = 0;
+        while ((class + 1 < SR_SHM_BLOCK_CLASS_COUNT) && !(start & (((off_t)SR_SHM_BLOCK_MIN_SIZE << (class + 1)) - 1))
+                && (start + ((off_t)SR_SHM_BLOCK_MIN_SIZE << (class + 1)) <= end)) {
+            ++class;
+        }
+
+        sr_shmfree_list_add(ext_shm_addr, start, class);
+        start += (off_t)SR_SHM_BLOCK_MIN_SIZE << class;
+    }
+}
+
+sr_error_info_t *
+sr_shmalloc(sr_shm_t *shm_ext, size_t size, off_t *off)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_ext_shm_t *ext_shm;
+    size_t block_size, slab_size;
+    off_t gap_off, slab_off, block_off;
+    uint32_t class, split_class;
+
+    assert(size);
+
+    class = sr_shmalloc_class(size);
+    if (class >= SR_SHM_BLOCK_CLASS_COUNT) {
+        sr_errinfo_new(&err_info, SR_ERR_NOMEM, NULL, "Cannot allocate %lu B in ext SHM.", (unsigned long)size);
+        return err_info;
+    }
+    block_size = (size_t)SR_SHM_BLOCK_MIN_SIZE << class;
+
+    /* EXT LOCK */
+    if ((err_info = sr_mlock(&((sr_ext_shm_t *)shm_ext->addr)->lock, SR_EXT_LOCK_TIMEOUT, __func__))) {
+        return err_info;
+    }
+
+    /* other processes may have added slabs meanwhile, we need all of them mapped */
+    if ((err_info = sr_shm_remap(shm_ext, 0))) {
+        goto cleanup;
+    }
+
+    ext_shm = (sr_ext_shm_t *)shm_ext->addr;
+    if (!ext_shm->free_blocks[class]) {
+        /* no free block, split the smallest larger free block, if any */
+        for (split_class = class + 1; split_class < SR_SHM_BLOCK_CLASS_COUNT; ++split_class) {
+            if (ext_shm->free_blocks[split_class]) {
+                break;
+            }
+        }
+        if (split_class < SR_SHM_BLOCK_CLASS_COUNT) {
+            block_off = ext_shm->free_blocks[split_class];
+            ext_shm->free_blocks[split_class] = *((off_t *)(shm_ext->addr + block_off));
+
+            /* keep splitting the first half, the second halves are free */
+            do {
+                --split_class;
+                sr_shmfree_list_add(shm_ext->addr, block_off + ((off_t)SR_SHM_BLOCK_MIN_SIZE << split_class),
+                        split_class);
+            } while (split_class > class);
+            sr_shmfree_list_add(shm_ext->addr, block_off, class);
+        }
+    }
+    if (!ext_shm->free_blocks[class]) {
+        /* no free block at all, add a new slab at the end of ext SHM aligned to its size so that every block
+         * is aligned to its size as well and the buddy of a freed block can be found */
+        gap_off = shm_ext->size;
+        slab_size = (block_size > SR_SHM_SLAB_SIZE) ? block_size : SR_SHM_SLAB_SIZE;
+        slab_off = (gap_off + slab_size - 1) & ~((off_t)slab_size - 1);
+        if ((err_info = sr_shm_remap(shm_ext, slab_off + slab_size))) {
+            goto cleanup;
+        }
+        ext_shm = (sr_ext_shm_t *)shm_ext->addr;
+
+        /* the memory skipped because of the alignment can be used for smaller blocks */
+        sr_shmfree_range(shm_ext->addr, gap_off, slab_off);
+
+        /* link all its blocks into the free list */
+        for (block_off = slab_off; block_off < slab_off + (off_t)slab_size; block_off += block_size) {
+            *((off_t *)(shm_ext->addr + block_off)) = block_off + block_size;
+        }
+        *((off_t *)(shm_ext->addr + slab_off + slab_size - block_size)) = 0;
+        ext_shm->free_blocks[class] = slab_off;
+        ext_shm->wasted += (slab_off - gap_off) + slab_size;
+    }
+
+    /* take the first free block */
+    *off = ext_shm->free_blocks[class];
+    ext_shm->free_blocks[class] = *((off_t *)(shm_ext->addr + *off));
+    ext_shm->wasted -= block_size;
+
+cleanup:
+    /* EXT UNLOCK */
+    if (shm_ext->addr) {
+        sr_munlock(&((sr_ext_shm_t *)shm_ext->addr)->lock);
+    }
+    return err_info;
+}
+
+void
+sr_shmfree(sr_shm_t *shm_ext, off_t off, size_t size)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_ext_shm_t *ext_shm = (sr_ext_shm_t *)shm_ext->addr;
+    size_t block_size;
+    off_t buddy_off;
+    uint32_t class;
+
+    assert(off && size);
+
+    class = sr_shmalloc_class(size);
+    assert(class < SR_SHM_BLOCK_CLASS_COUNT);
+    block_size = (size_t)SR_SHM_BLOCK_MIN_SIZE << class;
+    assert(!(off & (block_size - 1)));
+
+    /* EXT LOCK (it is held only briefly and recovered if its owner terminates, the block must not be lost) */
+    if ((err_info = sr_mlock(&ext_shm->lock, -1, __func__))) {
+        sr_errinfo_free(&err_info);
+        return;
+    }
+
+    ext_shm->wasted += block_size;
+
+    /* merge the block with its free buddies so that split blocks are joined again */
+    while (class + 1 < SR_SHM_BLOCK_CLASS_COUNT) {
+        buddy_off = off ^ (off_t)block_size;
+        if (((size_t)buddy_off + block_size > shm_ext->size) || !sr_shmfree_list_del(shm_ext, buddy_off, class)) {
+            /* buddy not free (or not mapped) */
+            break;
+        }
+
+        if (buddy_off < off) {
+            off = buddy_off;
+        }
+        ++class;
+        block_size <<= 1;
+    }
+
+    sr_shmfree_list_add(shm_ext->addr, off, class);
+
+    /* EXT UNLOCK */
+    sr_munlock(&ext_shm->lock);
+}
+
 sr_error_info_t *
 sr_shmrealloc_add(sr_shm_t *shm_ext, off_t *shm_array, uint16_t *shm_count, int in_ext_shm, size_t item_size,
         int32_t add_idx, void **new_item, size_t dyn_attr_size, off_t *dyn_attr_off)
 {
     sr_error_info_t *err_info = NULL;
-    off_t old_array_off, new_array_off, old_count_off, attr_off;
-    size_t new_ext_size;
+    off_t old_array_off, old_count_off, new_array_off;
 
     assert((add_idx > -2) && (add_idx <= *shm_count));
     assert(!dyn_attr_size || dyn_attr_off);
@@ -2145,6 +2494,11 @@ sr_shmrealloc_add(sr_shm_t *shm_ext, off_t *shm_array, uint16_t *shm_count, int
         /* add at the end */
         add_idx = *shm_count;
     }
+    if (*shm_count == UINT16_MAX) {
+        sr_errinfo_new(&err_info, SR_ERR_NOMEM, NULL, "Too many items (%" PRIu32 ") in a SHM array.",
+                (uint32_t)*shm_count + 1);
+        return err_info;
+    }
 
     if (in_ext_shm) {
         /* remember current offsets in ext SHM */
@@ -2152,47 +2506,52 @@ sr_shmrealloc_add(sr_shm_t *shm_ext, off_t *shm_array, uint16_t *shm_count, int
         old_count_off = ((char *)shm_count) - shm_ext->addr;
     }
 
-    /* we may not even need to resize ext SHM because of the alignment */
-    if (SR_SHM_SIZE((*shm_count + 1) * item_size) + dyn_attr_size > SR_SHM_SIZE(*shm_count * item_size)) {
-        /* get new offsets and size */
-        new_array_off = shm_ext->size;
-        attr_off = new_array_off + SR_SHM_SIZE((*shm_count + 1) * item_size);
-        new_ext_size = attr_off + dyn_attr_size;
-
-        /* remap ext SHM */
-        if ((err_info = sr_shm_remap(shm_ext, new_ext_size))) {
+    /* allocate the dynamic attribute */
+    if (dyn_attr_size) {
+        if ((err_info = sr_shmalloc(shm_ext, dyn_attr_size, dyn_attr_off))) {
             return err_info;
         }
+        if (in_ext_shm) {
+            /* update our pointers */
+            shm_array = (off_t *)(shm_ext->addr + old_array_off);
+            shm_count = (uint16_t *)(shm_ext->addr + old_count_off);
+        }
+    }
 
+    if (!*shm_count || (sr_shmalloc_size((*shm_count + 1) * item_size) > sr_shmalloc_size(*shm_count * item_size))) {
+        /* the array block is full, move it into a larger one */
+        if ((err_info = sr_shmalloc(shm_ext, (*shm_count + 1) * item_size, &new_array_off))) {
+            if (dyn_attr_size) {
+                sr_shmfree(shm_ext, *dyn_attr_off, dyn_attr_size);
+                *dyn_attr_off = 0;
+            }
+            return err_info;
+        }
         if (in_ext_shm) {
             /* update our pointers */
             shm_array = (off_t *)(shm_ext->addr + old_array_off);
             shm_count = (uint16_t *)(shm_ext->addr + old_count_off);
         }
 
-        /* add wasted memory */
-        *((size_t *)shm_ext->addr) += SR_SHM_SIZE(*shm_count * item_size);
+        if (*shm_count) {
+            /* copy preceding items */
+            if (add_idx) {
+                memcpy(shm_ext->addr + new_array_off, shm_ext->addr + *shm_array, add_idx * item_size);
+            }
 
-        /* copy preceding items */
-        if (add_idx) {
-            memcpy(shm_ext->addr + new_array_off, shm_ext->addr + *shm_array, add_idx * item_size);
-        }
+            /* copy succeeding items */
+            if (add_idx < *shm_count) {
+                memcpy(shm_ext->addr + new_array_off + (add_idx + 1) * item_size,
+                        shm_ext->addr + *shm_array + add_idx * item_size, (*shm_count - add_idx) * item_size);
+            }
 
-        /* copy succeeding items */
-        if (add_idx < *shm_count) {
-            memcpy(shm_ext->addr + new_array_off + (add_idx + 1) * item_size,
-                    shm_ext->addr + *shm_array + add_idx * item_size, (*shm_count - add_idx) * item_size);
+            /* free the previous block */
+            sr_shmfree(shm_ext, *shm_array, *shm_count * item_size);
         }
 
-        /* update array and attribute offset */
+        /* update array offset */
         *shm_array = new_array_off;
-        if (dyn_attr_off && dyn_attr_size) {
-            *dyn_attr_off = attr_off;
-        }
-
     } else if (add_idx < *shm_count) {
-        assert(!dyn_attr_size);
-
         /* we only need to move succeeding items */
         memmove(shm_ext->addr + *shm_array + (add_idx + 1) * item_size,
                 shm_ext->addr + *shm_array + add_idx * item_size, (*shm_count - add_idx) * item_size);
@@ -2205,33 +2564,110 @@ sr_shmrealloc_add(sr_shm_t *shm_ext, off_t *shm_array, uint16_t *shm_count, int
     return NULL;
 }
 
+sr_error_info_t *
+sr_shmrealloc_add_items(sr_shm_t *shm_ext, off_t *shm_array, uint16_t *shm_count, int in_ext_shm, size_t item_size,
+        uint16_t add_count, void **new_items)
+{
+    sr_error_info_t *err_info = NULL;
+    off_t old_array_off, old_count_off, new_array_off;
+
+    assert(add_count);
+
+    if ((uint32_t)*shm_count + add_count > UINT16_MAX) {
+        sr_errinfo_new(&err_info, SR_ERR_NOMEM, NULL, "Too many items (%" PRIu32 ") in a SHM array.",
+                (uint32_t)*shm_count + add_count);
+        return err_info;
+    }
+
+    if (in_ext_shm) {
+        /* remember current offsets in ext SHM */
+        old_array_off = ((char *)shm_array) - shm_ext->addr;
+        old_count_off = ((char *)shm_count) - shm_ext->addr;
+    }
+
+    if (!*shm_count || (sr_shmalloc_size((*shm_count + add_count) * item_size) >
+            sr_shmalloc_size(*shm_count * item_size))) {
+        /* the array block is too small, move it into a larger one */
+        if ((err_info = sr_shmalloc(shm_ext, (*shm_count + add_count) * item_size, &new_array_off))) {
+            return err_info;
+        }
+        if (in_ext_shm) {
+            /* update our pointers */
+            shm_array = (off_t *)(shm_ext->addr + old_array_off);
+            shm_count = (uint16_t *)(shm_ext->addr + old_count_off);
+        }
+
+        if (*shm_count) {
+            /* copy all the current items and free the previous block */
+            memcpy(shm_ext->addr + new_array_off, shm_ext->addr + *shm_array, *shm_count * item_size);
+            sr_shmfree(shm_ext, *shm_array, *shm_count * item_size);
+        }
+
+        /* update array offset */
+        *shm_array = new_array_off;
+    }
+
+    /* return pointer to the first new item and update count */
+    *new_items = (shm_ext->addr + *shm_array) + (*shm_count * item_size);
+    *shm_count += add_count;
+
+    return NULL;
+}
+
 void
-sr_shmrealloc_del(char *ext_shm_addr, off_t *shm_array, uint16_t *shm_count, size_t item_size, uint16_t del_idx,
-        size_t dyn_shm_size)
+sr_shmrealloc_del(sr_shm_t *shm_ext, off_t *shm_array, uint16_t *shm_count, size_t item_size, uint16_t del_idx,
+        off_t dyn_attr_off, size_t dyn_attr_size)
 {
-    /* add wasted memory keeping alignment in mind */
-    *((size_t *)ext_shm_addr) += SR_SHM_SIZE(*shm_count * item_size) - SR_SHM_SIZE((*shm_count - 1) * item_size);
-    *((size_t *)ext_shm_addr) += dyn_shm_size;
+    size_t block_size, new_block_size;
+
+    /* free the dynamic attribute */
+    if (dyn_attr_size) {
+        sr_shmfree(shm_ext, dyn_attr_off, dyn_attr_size);
+    }
+
+    block_size = sr_shmalloc_size(*shm_count * item_size);
 
     --(*shm_count);
     if (!*shm_count) {
-        /* the only item removed */
+        /* the only item removed, free the whole block */
+        sr_shmfree(shm_ext, *shm_array, block_size);
         *shm_array = 0;
-    } else if (del_idx < *shm_count) {
+        return;
+    }
+
+    if (del_idx < *shm_count) {
         /* move all following items, we may need to keep the order intact */
-        memmove((ext_shm_addr + *shm_array) + (del_idx * item_size),
-                (ext_shm_addr + *shm_array) + ((del_idx + 1) * item_size),
+        memmove((shm_ext->addr + *shm_array) + (del_idx * item_size),
+                (shm_ext->addr + *shm_array) + ((del_idx + 1) * item_size),
                 (*shm_count - del_idx) * item_size);
     }
+
+    /* free the unused second halves of the block, the items are kept in place and the halves are merged
+     * back once the block is freed */
+    new_block_size = sr_shmalloc_size(*shm_count * item_size);
+    while (block_size > new_block_size) {
+        block_size >>= 1;
+        sr_shmfree(shm_ext, *shm_array + block_size, block_size);
+    }
 }
 
-sr_error_info_t *
-sr_mutex_init(pthread_mutex_t *lock, int shared)
+/**
+ * @brief Wrapper for pthread_mutex_init().
+ *
+ * @param[in,out] lock pthread mutex to initialize.
+ * @param[in] shared Whether the mutex will be shared between processes or not.
+ * @param[in] robust Whether the mutex should be robust, only if @p shared is set.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+_sr_mutex_init(pthread_mutex_t *lock, int shared, int robust)
 {
     sr_error_info_t *err_info = NULL;
     pthread_mutexattr_t attr;
     int ret;
 
+    assert(shared || !robust);
+
     /* check address alignment */
     if (SR_MUTEX_ALIGN_CHECK(lock)) {
         sr_errinfo_new(&err_info, SR_ERR_INTERNAL, NULL, "Mutex address not aligned.");
@@ -2249,6 +2685,11 @@ sr_mutex_init(pthread_mutex_t *lock, int shared)
             sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Changing pthread attr failed (%s).", strerror(ret));
             return err_info;
         }
+        if (robust && (ret = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST))) {
+            pthread_mutexattr_destroy(&attr);
+            sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Changing pthread attr failed (%s).", strerror(ret));
+            return err_info;
+        }
 
         if ((ret = pthread_mutex_init(lock, &attr))) {
             pthread_mutexattr_destroy(&attr);
@@ -2266,6 +2707,37 @@ sr_mutex_init(pthread_mutex_t *lock, int shared)
     return NULL;
 }
 
+sr_error_info_t *
+sr_mutex_init(pthread_mutex_t *lock, int shared)
+{
+    return _sr_mutex_init(lock, shared, 0);
+}
+
+sr_error_info_t *
+sr_mutex_init_robust(pthread_mutex_t *lock)
+{
+    return _sr_mutex_init(lock, 1, 1);
+}
+
+/**
+ * @brief Make a robust mutex consistent if its previous owner terminated while holding it.
+ *
+ * @param[in] lock Mutex that was just locked.
+ * @param[in] ret Return value of locking the mutex.
+ * @return Return value of locking the mutex, 0 if it was made consistent.
+ */
+static int
+sr_mutex_owner_dead(pthread_mutex_t *lock, int ret)
+{
+    if (ret == EOWNERDEAD) {
+        /* the mutex is locked now, anything it protects stays as the terminated owner left it */
+        SR_LOG_WRN("Recovering a lock held by a terminated process.");
+        ret = pthread_mutex_consistent(lock);
+    }
+
+    return ret;
+}
+
 sr_error_info_t *
 sr_mlock(pthread_mutex_t *lock, int timeout_ms, const char *func)
 {
@@ -2281,6 +2753,7 @@ sr_mlock(pthread_mutex_t *lock, int timeout_ms, const char *func)
         sr_time_get(&abs_ts, (uint32_t)timeout_ms);
         ret = pthread_mutex_timedlock(lock, &abs_ts);
     }
+    ret = sr_mutex_owner_dead(lock, ret);
     if (ret) {
         SR_ERRINFO_LOCK(&err_info, func, ret);
         return err_info;
@@ -2365,6 +2838,23 @@ sr_rwlock_init(sr_rwlock_t *rwlock, int shared)
     return NULL;
 }
 
+sr_error_info_t *
+sr_rwlock_init_robust(sr_rwlock_t *rwlock)
+{
+    sr_error_info_t *err_info = NULL;
+
+    if ((err_info = sr_mutex_init_robust(&rwlock->mutex))) {
+        return err_info;
+    }
+    rwlock->readers = 0;
+    if ((err_info = sr_cond_init(&rwlock->cond, 1))) {
+        pthread_mutex_destroy(&rwlock->mutex);
+        return err_info;
+    }
+
+    return NULL;
+}
+
 void
 sr_rwlock_destroy(sr_rwlock_t *rwlock)
 {
@@ -2385,6 +2875,7 @@ sr_rwlock(sr_rwlock_t *rwlock, int timeout_ms, sr_lock_mode_t mode, const char *
 
     /* MUTEX LOCK */
     ret = pthread_mutex_timedlock(&rwlock->mutex, &timeout_ts);
+    ret = sr_mutex_owner_dead(&rwlock->mutex, ret);
     if (ret) {
         SR_ERRINFO_LOCK(&err_info, func, ret);
         return err_info;
@@ -2430,6 +2921,7 @@ sr_rwunlock(sr_rwlock_t *rwlock, sr_lock_mode_t mode, const char *func)
 
         /* MUTEX LOCK */
         ret = pthread_mutex_timedlock(&rwlock->mutex, &timeout_ts);
+        ret = sr_mutex_owner_dead(&rwlock->mutex, ret);
         if (ret) {
             SR_ERRINFO_LOCK(&err_info, func, ret);
             sr_errinfo_free(&err_info);
@@ -2456,6 +2948,43 @@ sr_rwunlock(sr_rwlock_t *rwlock, sr_lock_mode_t mode, const char *func)
     pthread_mutex_unlock(&rwlock->mutex);
 }
 
+sr_error_info_t *
+sr_rwlock_recover(sr_rwlock_t *rwlock, uint32_t rcount, const char *func)
+{
+    sr_error_info_t *err_info = NULL;
+    struct timespec timeout_ts;
+    int ret;
+
+    assert(rcount);
+
+    sr_time_get(&timeout_ts, SR_MAIN_LOCK_TIMEOUT * 1000);
+
+    /* MUTEX LOCK */
+    ret = pthread_mutex_timedlock(&rwlock->mutex, &timeout_ts);
+    ret = sr_mutex_owner_dead(&rwlock->mutex, ret);
+    if (ret) {
+        SR_ERRINFO_LOCK(&err_info, func, ret);
+        return err_info;
+    }
+
+    /* remove all the read locks */
+    if (rwlock->readers < rcount) {
+        SR_ERRINFO_INT(&err_info);
+        rwlock->readers = 0;
+    } else {
+        rwlock->readers -= rcount;
+    }
+
+    if (!rwlock->readers) {
+        /* broadcast on condition */
+        pthread_cond_broadcast(&rwlock->cond);
+    }
+
+    /* MUTEX UNLOCK */
+    pthread_mutex_unlock(&rwlock->mutex);
+    return err_info;
+}
+
 void
 sr_shmlock_update(sr_conn_shm_lock_t *shmlock, sr_lock_mode_t mode, int lock)
 {
@@ -2509,6 +3038,66 @@ sr_realloc(void *ptr, size_t size)
     return new_mem;
 }
 
+#ifdef SR_HAVE_SENDFILE
+
+/**
+ * @brief Copy all the file contents in kernel.
+ *
+ * @param[in] fd_to Destination file descriptor.
+ * @param[in] fd_from Source file descriptor.
+ * @param[out] copied Set if the file was copied, otherwise nothing was written.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_cp_sendfile(int fd_to, int fd_from, int *copied)
+{
+    sr_error_info_t *err_info = NULL;
+    struct stat st;
+    off_t size, offset = 0;
+    ssize_t nsent;
+
+    *copied = 0;
+
+    if (fstat(fd_from, &st) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "fstat");
+        return err_info;
+    }
+    size = st.st_size;
+
+    /* allocate the whole SHM at once */
+    if (size && (ftruncate(fd_to, size) == -1)) {
+        SR_ERRINFO_SYSERRNO(&err_info, "ftruncate");
+        return err_info;
+    }
+
+    while (offset < size) {
+        nsent = sendfile(fd_to, fd_from, &offset, size - offset);
+        if (nsent == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (!offset && ((errno == EINVAL) || (errno == ENOSYS))) {
+                /* not supported for these files, nothing written */
+                return NULL;
+            }
+            SR_ERRINFO_SYSERRNO(&err_info, "sendfile");
+            return err_info;
+        } else if (!nsent) {
+            /* the file was truncated meanwhile */
+            break;
+        }
+    }
+
+    if ((offset < size) && (ftruncate(fd_to, offset) == -1)) {
+        SR_ERRINFO_SYSERRNO(&err_info, "ftruncate");
+        return err_info;
+    }
+
+    *copied = 1;
+    return NULL;
+}
+
+#endif
+
 sr_error_info_t *
 sr_cp_file2shm(const char *to, const char *from, mode_t perm)
 {
@@ -2517,6 +3106,9 @@ sr_cp_file2shm(const char *to, const char *from, mode_t perm)
     char *out_ptr, buf[4096];
     ssize_t nread, nwritten;
     mode_t um;
+#ifdef SR_HAVE_SENDFILE
+    int copied;
+#endif
 
     /* open "from" file */
     fd_from = open(from, O_RDONLY);
@@ -2536,6 +3128,13 @@ sr_cp_file2shm(const char *to, const char *from, mode_t perm)
         goto cleanup;
     }
 
+#ifdef SR_HAVE_SENDFILE
+    /* avoid copying the data through user space */
+    if ((err_info = sr_cp_sendfile(fd_to, fd_from, &copied)) || copied) {
+        goto cleanup;
+    }
+#endif
+
     while ((nread = read(fd_from, buf, sizeof buf)) > 0) {
         out_ptr = buf;
         do {
@@ -4140,6 +4739,142 @@ cleanup:
     return err_info;
 }
 
+sr_error_info_t *
+sr_module_file_diff_set(const char *mod_name, uint32_t ver, const struct lyd_node *mod_diff)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL, *running_path = NULL;
+    int fd = -1, running_fd;
+    struct stat st;
+    mode_t um;
+
+    if (!mod_diff) {
+        /* invalidate any previous diff */
+        ver = 0;
+    }
+
+    if ((err_info = sr_path_running_diff_shm(mod_name, 0, &path))) {
+        goto cleanup;
+    }
+
+    /* set umask so that the correct permissions are really set if the file is created */
+    um = umask(00000);
+    fd = shm_open(path, O_WRONLY | O_TRUNC | O_CREAT | O_EXCL, SR_FILE_PERM);
+    umask(um);
+    if ((fd == -1) && (errno == EEXIST)) {
+        /* just overwrite the existing diff */
+        fd = shm_open(path, O_WRONLY | O_TRUNC, 0);
+    } else if (fd > -1) {
+        /* new diff, it may be read by the same users as the running data */
+        if ((err_info = sr_path_ds_shm(mod_name, SR_DS_RUNNING, 0, &running_path))) {
+            goto cleanup;
+        }
+        running_fd = shm_open(running_path, O_RDONLY, 0);
+        if ((running_fd > -1) && !fstat(running_fd, &st) && !fchown(fd, st.st_uid, st.st_gid)) {
+            fchmod(fd, st.st_mode & 00666);
+        }
+        if (running_fd > -1) {
+            close(running_fd);
+        }
+    }
+    if (fd == -1) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Failed to open \"%s\" (%s).", path, strerror(errno));
+        goto cleanup;
+    }
+
+    /* write the version of the data created by this diff */
+    if (write(fd, &ver, sizeof ver) != sizeof ver) {
+        SR_ERRINFO_SYSERRNO(&err_info, "write");
+        goto cleanup;
+    }
+
+    /* print the diff */
+    if (mod_diff && lyd_print_fd(fd, mod_diff, LYD_LYB, LYP_WITHSIBLINGS)) {
+        sr_errinfo_new_ly(&err_info, lyd_node_module(mod_diff)->ctx);
+        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, NULL, "Failed to store diff into \"%s\".", path);
+        goto cleanup;
+    }
+
+cleanup:
+    if (err_info && (fd > -1)) {
+        /* make sure no invalid diff is used */
+        ver = 0;
+        if (ftruncate(fd, 0) || (pwrite(fd, &ver, sizeof ver, 0) != sizeof ver)) {
+            shm_unlink(path);
+        }
+    }
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+    free(running_path);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_module_file_diff_get(const struct lys_module *ly_mod, uint32_t ver, struct lyd_node **mod_diff, int *found)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path = NULL;
+    int fd = -1;
+    struct stat st;
+    void *addr = MAP_FAILED;
+
+    *mod_diff = NULL;
+    *found = 0;
+
+    if ((err_info = sr_path_running_diff_shm(ly_mod->name, 0, &path))) {
+        goto cleanup;
+    }
+
+    fd = shm_open(path, O_RDONLY, 0);
+    if (fd == -1) {
+        /* no diff stored or not accessible, no error */
+        goto cleanup;
+    }
+
+    if (fstat(fd, &st) == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "fstat");
+        goto cleanup;
+    }
+    if ((size_t)st.st_size < sizeof ver) {
+        /* no diff stored */
+        goto cleanup;
+    }
+
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        SR_ERRINFO_SYSERRNO(&err_info, "mmap");
+        goto cleanup;
+    }
+
+    if (*(uint32_t *)addr != ver) {
+        /* the stored diff created a different version */
+        goto cleanup;
+    }
+
+    /* parse the diff */
+    if ((size_t)st.st_size > sizeof ver) {
+        ly_errno = 0;
+        *mod_diff = lyd_parse_mem(ly_mod->ctx, (char *)addr + sizeof ver, LYD_LYB, LYD_OPT_EDIT | LYD_OPT_STRICT);
+        if (ly_errno) {
+            sr_errinfo_new_ly(&err_info, ly_mod->ctx);
+            goto cleanup;
+        }
+    }
+    *found = 1;
+
+cleanup:
+    if (addr != MAP_FAILED) {
+        munmap(addr, st.st_size);
+    }
+    if (fd > -1) {
+        close(fd);
+    }
+    free(path);
+    return err_info;
+}
+
 sr_error_info_t *
 sr_module_update_oper_diff(sr_conn_ctx_t *conn, const char *mod_name)
 {
@@ -4175,7 +4910,7 @@ sr_module_update_oper_diff(sr_conn_ctx_t *conn, const char *mod_name)
     }
 
     /* load the module enabled running data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, NULL, NULL, 0,
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, NULL, NULL, 0, 0, 0,
             SR_OPER_NO_STORED | SR_OPER_NO_SUBS, NULL))) {
         goto cleanup;
     }
@@ -5,7 +5,7 @@
  *
  * @copyright
  * Copyright 2018 Deutsche Telekom AG.
- * Copyright 2018 - 2019 CESNET, z.s.p.o.
+ * Copyright 2018 - 2020 CESNET, z.s.p.o.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -29,7 +29,10 @@
 #include <string.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <signal.h>
+#include <time.h>
 #include <getopt.h>
 #include <pthread.h>
 #include <sys/types.h>
@@ -48,11 +51,36 @@ int loop_finish;
 pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
 
+/** protected plugin states for parallel plugin initialization */
+pthread_mutex_t init_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t init_cond = PTHREAD_COND_INITIALIZER;
+
+typedef enum {
+    SRPD_PLUGIN_PENDING = 0,    /**< plugin not yet initialized */
+    SRPD_PLUGIN_INITIALIZED,    /**< plugin successfully initialized */
+    SRPD_PLUGIN_FAILED          /**< plugin initialization failed or was not attempted */
+} srpd_plugin_state_t;
+
 struct srpd_plugin_s {
+    char *name;
     void *handle;
     srp_init_cb_t init_cb;
     srp_cleanup_cb_t cleanup_cb;
+    const char **deps;
+    struct srpd_plugin_s **dep_plugins;
+    int dep_count;
     void *private_data;
+
+    sr_session_ctx_t *sess;
+    srpd_plugin_state_t state;
+    uint64_t init_usec;
+    pthread_t tid;
+    int has_thread;
+};
+
+struct srpd_plugins_s {
+    struct srpd_plugin_s *plugins;
+    int count;
 };
 
 static void
@@ -70,7 +98,7 @@ help_print(void)
 {
     printf(
         "Usage:\n"
-        "  sysrepo-plugind [-h] [-v <level>] [-d]\n"
+        "  sysrepo-plugind [-h] [-v <level>] [-d] [-p]\n"
         "\n"
         "Options:\n"
         "  -h, --help           Prints usage help.\n"
@@ -78,6 +106,8 @@ help_print(void)
         "  -v, --verbosity <level>\n"
         "                       Change verbosity to a level (none, error, warning, info, debug) or number (0, 1, 2, 3, 4).\n"
         "  -d, --debug          Debug mode - is not daemonized and logs to stderr instead of syslog.\n"
+        "  -p, --parallel       Initialize plugins in parallel, each in its own thread, once all their\n"
+        "                       dependencies are initialized.\n"
         "\n"
         "Environment variable $SRPD_PLUGINS_PATH overwrites the default plugins path.\n"
         "\n"
@@ -243,7 +273,8 @@ load_plugins(struct srpd_plugin_s **plugins, int *plugin_count)
     DIR *dir;
     struct dirent *ent;
     const char *plugins_dir;
-    char *path;
+    char *path, *name;
+    size_t len;
     int rc = 0;
 
     *plugins = NULL;
@@ -320,9 +351,32 @@ load_plugins(struct srpd_plugin_s **plugins, int *plugin_count)
             break;
         }
 
+        /* optional dependencies */
+        (*plugins)[*plugin_count].deps = dlsym(handle, SRP_DEPS);
+
+        /* plugin name is the file name without the suffix */
+        name = strdup(ent->d_name);
+        if (!name) {
+            error_print(0, "strdup() failed (%s).", strerror(errno));
+            dlclose(handle);
+            rc = -1;
+            break;
+        }
+        len = strlen(name);
+        if ((len > 3) && !strcmp(name + len - 3, ".so")) {
+            name[len - 3] = '\0';
+        }
+
         /* finally store the plugin */
+        (*plugins)[*plugin_count].name = name;
         (*plugins)[*plugin_count].handle = handle;
+        (*plugins)[*plugin_count].dep_plugins = NULL;
+        (*plugins)[*plugin_count].dep_count = 0;
         (*plugins)[*plugin_count].private_data = NULL;
+        (*plugins)[*plugin_count].sess = NULL;
+        (*plugins)[*plugin_count].state = SRPD_PLUGIN_PENDING;
+        (*plugins)[*plugin_count].init_usec = 0;
+        (*plugins)[*plugin_count].has_thread = 0;
         ++(*plugin_count);
     }
 
@@ -330,25 +384,284 @@ load_plugins(struct srpd_plugin_s **plugins, int *plugin_count)
     return rc;
 }
 
+static struct srpd_plugin_s *
+find_plugin(struct srpd_plugin_s *plugins, int plugin_count, const char *name)
+{
+    int i;
+
+    for (i = 0; i < plugin_count; ++i) {
+        if (!strcmp(plugins[i].name, name)) {
+            return &plugins[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int
+resolve_plugin_deps(struct srpd_plugin_s *plugins, int plugin_count)
+{
+    struct srpd_plugin_s *plugin, *dep;
+    int i, j;
+
+    for (i = 0; i < plugin_count; ++i) {
+        plugin = &plugins[i];
+        if (find_plugin(plugins, i, plugin->name)) {
+            error_print(0, "Duplicate plugin \"%s\".", plugin->name);
+            return -1;
+        }
+
+        if (!plugin->deps) {
+            continue;
+        }
+        for (j = 0; plugin->deps[j]; ++j) {}
+        if (!j) {
+            continue;
+        }
+
+        plugin->dep_plugins = malloc(j * sizeof *plugin->dep_plugins);
+        if (!plugin->dep_plugins) {
+            error_print(0, "malloc() failed (%s).", strerror(errno));
+            return -1;
+        }
+        for (j = 0; plugin->deps[j]; ++j) {
+            dep = find_plugin(plugins, plugin_count, plugin->deps[j]);
+            if (!dep) {
+                error_print(0, "Plugin \"%s\" depends on unknown plugin \"%s\".", plugin->name, plugin->deps[j]);
+                return -1;
+            }
+            plugin->dep_plugins[plugin->dep_count++] = dep;
+        }
+    }
+
+    return 0;
+}
+
+static int
+sort_plugins_visit(struct srpd_plugin_s *plugins, int idx, char *marks, int *order, int *order_count)
+{
+    struct srpd_plugin_s *plugin = &plugins[idx];
+    int i;
+
+    if (marks[idx] == 2) {
+        /* already sorted */
+        return 0;
+    } else if (marks[idx] == 1) {
+        error_print(0, "Plugin \"%s\" has cyclic dependencies.", plugin->name);
+        return -1;
+    }
+
+    /* all dependencies first */
+    marks[idx] = 1;
+    for (i = 0; i < plugin->dep_count; ++i) {
+        if (sort_plugins_visit(plugins, plugin->dep_plugins[i] - plugins, marks, order, order_count)) {
+            return -1;
+        }
+    }
+    marks[idx] = 2;
+
+    order[(*order_count)++] = idx;
+    return 0;
+}
+
+static int
+sort_plugins(struct srpd_plugin_s *plugins, int plugin_count, int **order)
+{
+    char *marks;
+    int i, order_count = 0, rc = 0;
+
+    *order = NULL;
+    if (!plugin_count) {
+        return 0;
+    }
+
+    *order = malloc(plugin_count * sizeof **order);
+    marks = calloc(plugin_count, sizeof *marks);
+    if (!*order || !marks) {
+        error_print(0, "malloc() failed (%s).", strerror(errno));
+        rc = -1;
+        goto cleanup;
+    }
+
+    /* plugins are ordered so that every plugin follows all its dependencies */
+    for (i = 0; i < plugin_count; ++i) {
+        if ((rc = sort_plugins_visit(plugins, i, marks, *order, &order_count))) {
+            break;
+        }
+    }
+
+cleanup:
+    if (rc) {
+        /* the order is incomplete, it must not be used */
+        free(*order);
+        *order = NULL;
+    }
+    free(marks);
+    return rc;
+}
+
+static int
+init_plugin(struct srpd_plugin_s *plugin)
+{
+    struct timespec start, end;
+    int r;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    r = plugin->init_cb(plugin->sess, &plugin->private_data);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    plugin->init_usec = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000;
+
+    if (r != SR_ERR_OK) {
+        SRP_LOG_ERR("Plugin \"%s\" initialization failed (%s).", plugin->name, sr_strerror(r));
+        return -1;
+    }
+
+    SRP_LOG_INF("Plugin \"%s\" initialized in %" PRIu64 " us.", plugin->name, plugin->init_usec);
+    return 0;
+}
+
+static void
+set_plugin_state(struct srpd_plugin_s *plugin, srpd_plugin_state_t state)
+{
+    pthread_mutex_lock(&init_lock);
+    plugin->state = state;
+    pthread_cond_broadcast(&init_cond);
+    pthread_mutex_unlock(&init_lock);
+}
+
+static void *
+init_plugin_thread(void *arg)
+{
+    struct srpd_plugin_s *plugin = arg;
+    int i, dep_failed = 0;
+
+    /* wait for all the dependencies */
+    pthread_mutex_lock(&init_lock);
+    for (i = 0; i < plugin->dep_count; ++i) {
+        while (plugin->dep_plugins[i]->state == SRPD_PLUGIN_PENDING) {
+            pthread_cond_wait(&init_cond, &init_lock);
+        }
+        if (plugin->dep_plugins[i]->state == SRPD_PLUGIN_FAILED) {
+            dep_failed = 1;
+        }
+    }
+    pthread_mutex_unlock(&init_lock);
+
+    if (dep_failed) {
+        SRP_LOG_ERR("Plugin \"%s\" not initialized because of a failed dependency.", plugin->name);
+        set_plugin_state(plugin, SRPD_PLUGIN_FAILED);
+    } else {
+        set_plugin_state(plugin, init_plugin(plugin) ? SRPD_PLUGIN_FAILED : SRPD_PLUGIN_INITIALIZED);
+    }
+
+    return NULL;
+}
+
+static int
+init_plugins_parallel(struct srpd_plugin_s *plugins, int plugin_count)
+{
+    int i, r, rc = 0;
+
+    /* every plugin in its own thread, they wait for their dependencies */
+    for (i = 0; i < plugin_count; ++i) {
+        if ((r = pthread_create(&plugins[i].tid, NULL, init_plugin_thread, &plugins[i]))) {
+            SRP_LOG_ERR("Creating plugin \"%s\" thread failed (%s).", plugins[i].name, strerror(r));
+            set_plugin_state(&plugins[i], SRPD_PLUGIN_FAILED);
+        } else {
+            plugins[i].has_thread = 1;
+        }
+    }
+
+    for (i = 0; i < plugin_count; ++i) {
+        if (plugins[i].has_thread) {
+            pthread_join(plugins[i].tid, NULL);
+        }
+    }
+
+    for (i = 0; i < plugin_count; ++i) {
+        if (plugins[i].state != SRPD_PLUGIN_INITIALIZED) {
+            rc = -1;
+        }
+    }
+
+    return rc;
+}
+
+static int
+srpd_oper_plugin_cb(sr_session_ctx_t *session, const char *module_name, const char *path, const char *request_xpath,
+        uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    struct srpd_plugins_s *srpd_plugins = private_data;
+    struct srpd_plugin_s *plugin;
+    struct ly_ctx *ly_ctx;
+    struct lyd_node *node;
+    uint64_t values[4];
+    char *xpath, buf[24];
+    int i, j, r;
+    const char *leaves[] = {"pid", "init-time", "callbacks", "callback-time"};
+
+    (void)module_name;
+    (void)path;
+    (void)request_xpath;
+    (void)request_id;
+
+    ly_ctx = (struct ly_ctx *)sr_get_context(sr_session_get_connection(session));
+
+    for (i = 0; i < srpd_plugins->count; ++i) {
+        plugin = &srpd_plugins->plugins[i];
+        if (plugin->state != SRPD_PLUGIN_INITIALIZED) {
+            continue;
+        }
+
+        values[0] = getpid();
+        values[1] = plugin->init_usec;
+        if ((r = sr_session_get_cb_stats(plugin->sess, &values[2], &values[3]))) {
+            return r;
+        }
+
+        for (j = 0; j < 4; ++j) {
+            if (asprintf(&xpath, "/sysrepo-monitoring:sysrepo-state/plugin[name='%s']/%s", plugin->name,
+                    leaves[j]) == -1) {
+                return SR_ERR_NOMEM;
+            }
+            sprintf(buf, "%" PRIu64, values[j]);
+
+            node = lyd_new_path(*parent, ly_ctx, xpath, buf, 0, 0);
+            free(xpath);
+            if (!node) {
+                return SR_ERR_LY;
+            }
+            if (!*parent) {
+                *parent = node;
+            }
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
 int
 main(int argc, char** argv)
 {
     struct srpd_plugin_s *plugins = NULL;
+    struct srpd_plugins_s srpd_plugins;
     sr_conn_ctx_t *conn = NULL;
     sr_session_ctx_t *sess = NULL;
+    sr_subscription_ctx_t *subscr = NULL;
     sr_log_level_t log_level = SR_LL_ERR;
-    int plugin_count = 0, i, r, rc = EXIT_FAILURE, opt, debug = 0;
+    int *order = NULL, plugin_count = 0, i, r, rc = EXIT_FAILURE, opt, debug = 0, parallel = 0;
     struct option options[] = {
         {"help",      no_argument,       NULL, 'h'},
         {"version",   no_argument,       NULL, 'V'},
         {"verbosity", required_argument, NULL, 'v'},
         {"debug",     no_argument,       NULL, 'd'},
+        {"parallel",  no_argument,       NULL, 'p'},
         {NULL,        0,                 NULL, 0},
     };
 
     /* process options */
     opterr = 0;
-    while ((opt = getopt_long(argc, argv, "hVv:d", options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hVv:dp", options, NULL)) != -1) {
         switch (opt) {
         case 'h':
             version_print();
@@ -380,6 +693,9 @@ main(int argc, char** argv)
         case 'd':
             debug = 1;
             break;
+        case 'p':
+            parallel = 1;
+            break;
         default:
             error_print(0, "Invalid option or missing argument: -%c", optopt);
             goto cleanup;
@@ -392,10 +708,13 @@ main(int argc, char** argv)
         goto cleanup;
     }
 
-    /* load plugins */
+    /* load plugins and learn their initialization order */
     if (load_plugins(&plugins, &plugin_count)) {
         goto cleanup;
     }
+    if (resolve_plugin_deps(plugins, plugin_count) || sort_plugins(plugins, plugin_count, &order)) {
+        goto cleanup;
+    }
 
     /* daemonize, sysrepo-plugind no longer directly logs to stderr */
     daemon_init(debug, log_level);
@@ -412,15 +731,38 @@ main(int argc, char** argv)
         goto cleanup;
     }
 
-    /* init plugins */
+    /* every plugin has its own session */
     for (i = 0; i < plugin_count; ++i) {
-        r = plugins[i].init_cb(sess, &plugins[i].private_data);
-        if (r != SR_ERR_OK) {
-            SRP_LOG_ERR("Plugin initialization failed (%s).", sr_strerror(r));
+        if ((r = sr_session_start(conn, SR_DS_RUNNING, &plugins[i].sess)) != SR_ERR_OK) {
+            error_print(r, "Failed to start new session");
             goto cleanup;
         }
     }
 
+    /* init plugins */
+    if (parallel) {
+        if (init_plugins_parallel(plugins, plugin_count)) {
+            goto cleanup;
+        }
+    } else {
+        for (i = 0; i < plugin_count; ++i) {
+            if (init_plugin(&plugins[order[i]])) {
+                plugins[order[i]].state = SRPD_PLUGIN_FAILED;
+                goto cleanup;
+            }
+            plugins[order[i]].state = SRPD_PLUGIN_INITIALIZED;
+        }
+    }
+
+    /* provide plugin information in sysrepo-monitoring */
+    srpd_plugins.plugins = plugins;
+    srpd_plugins.count = plugin_count;
+    if ((r = sr_oper_get_items_subscribe(sess, "sysrepo-monitoring", "/sysrepo-monitoring:sysrepo-state/plugin",
+            srpd_oper_plugin_cb, &srpd_plugins, 0, &subscr)) != SR_ERR_OK) {
+        error_print(r, "Failed to subscribe for sysrepo-monitoring plugin data");
+        goto cleanup;
+    }
+
     /* wait for a terminating signal */
     pthread_mutex_lock(&lock);
     while (!loop_finish) {
@@ -428,19 +770,26 @@ main(int argc, char** argv)
     }
     pthread_mutex_unlock(&lock);
 
-    /* cleanup plugins */
-    for (i = 0; i < plugin_count; ++i) {
-        plugins[i].cleanup_cb(sess, plugins[i].private_data);
-    }
-
     /* success */
     rc = EXIT_SUCCESS;
 
 cleanup:
+    sr_unsubscribe(subscr);
+
+    /* cleanup initialized plugins, dependent plugins first */
+    for (i = plugin_count - 1; order && (i >= 0); --i) {
+        if (plugins[order[i]].state == SRPD_PLUGIN_INITIALIZED) {
+            plugins[order[i]].cleanup_cb(plugins[order[i]].sess, plugins[order[i]].private_data);
+        }
+    }
+
     for (i = 0; i < plugin_count; ++i) {
         dlclose(plugins[i].handle);
+        free(plugins[i].name);
+        free(plugins[i].dep_plugins);
     }
     free(plugins);
+    free(order);
 
     sr_disconnect(conn);
     return rc;
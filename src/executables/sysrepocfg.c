@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <errno.h>
+#include <time.h>
 
 #include <libyang/libyang.h>
 
@@ -93,6 +94,10 @@ help_print(void)
         "  -t, --timeout <seconds>      Set the timeout for the operation, otherwise the default one is used.\n"
         "  -w, --wait                   Wait for all the callbacks to be called on a data change including DONE or ABORT.\n"
         "  -v, --verbosity <level>      Change verbosity to a level (none, error, warning, info, debug) or number (0, 1, 2, 3, 4).\n"
+        "  -s, --stream                 Process the full datastore one module at a time. Import still reads and parses\n"
+        "                               the whole input at once, only stores it per module and is then not atomic. Export\n"
+        "                               holds data of a single module at a time, except LYB, which is exported at once.\n"
+        "                               Throughput is printed with \"info\" verbosity (import, export op).\n"
         "\n"
     );
 }
@@ -170,7 +175,7 @@ step_edit_input(const char *editor, const char *path)
 }
 
 static int
-step_read_file(FILE *file, char **mem)
+step_read_file(FILE *file, char **mem, size_t *size)
 {
     size_t mem_size, mem_used;
 
@@ -180,7 +185,7 @@ step_read_file(FILE *file, char **mem)
 
     do {
         if (mem_used == mem_size) {
-            mem_size >>= 1;
+            mem_size <<= 1;
             *mem = realloc(*mem, mem_size);
         }
 
@@ -197,6 +202,41 @@ step_read_file(FILE *file, char **mem)
         return EXIT_FAILURE;
     }
 
+    /* there is always space left */
+    (*mem)[mem_used] = '\0';
+    if (size) {
+        *size = mem_used;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int
+step_data_format(const char *file_path, LYD_FORMAT *format)
+{
+    const char *ptr;
+
+    if (*format != LYD_UNKNOWN) {
+        /* explicitly set */
+        return EXIT_SUCCESS;
+    }
+
+    if (!file_path) {
+        error_print(0, "When reading data from STDIN, format must be specified");
+        return EXIT_FAILURE;
+    }
+
+    ptr = strrchr(file_path, '.');
+    if (ptr && !strcmp(ptr, ".xml")) {
+        *format = LYD_XML;
+    } else if (ptr && !strcmp(ptr, ".json")) {
+        *format = LYD_JSON;
+    } else if (ptr && !strcmp(ptr, ".lyb")) {
+        *format = LYD_LYB;
+    } else {
+        error_print(0, "Failed to detect format of \"%s\"", file_path);
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -209,23 +249,8 @@ step_load_data(sr_session_ctx_t *sess, const char *file_path, LYD_FORMAT format,
     ly_ctx = (struct ly_ctx *)sr_get_context(sr_session_get_connection(sess));
 
     /* learn format */
-    if (format == LYD_UNKNOWN) {
-        if (!file_path) {
-            error_print(0, "When reading data from STDIN, format must be specified");
-            return EXIT_FAILURE;
-        }
-
-        ptr = strrchr(file_path, '.');
-        if (ptr && !strcmp(ptr, ".xml")) {
-            format = LYD_XML;
-        } else if (ptr && !strcmp(ptr, ".json")) {
-            format = LYD_JSON;
-        } else if (ptr && !strcmp(ptr, ".lyb")) {
-            format = LYD_LYB;
-        } else {
-            error_print(0, "Failed to detect format of \"%s\"", file_path);
-            return EXIT_FAILURE;
-        }
+    if (step_data_format(file_path, &format)) {
+        return EXIT_FAILURE;
     }
 
     /* parse import data */
@@ -233,7 +258,7 @@ step_load_data(sr_session_ctx_t *sess, const char *file_path, LYD_FORMAT format,
         *data = lyd_parse_path(ly_ctx, file_path, format, flags, NULL);
     } else {
         /* we need to load the data into memory first */
-        if (step_read_file(stdin, &ptr)) {
+        if (step_read_file(stdin, &ptr, NULL)) {
             return EXIT_FAILURE;
         }
         *data = lyd_parse_mem(ly_ctx, ptr, format, flags);
@@ -286,6 +311,224 @@ step_create_input_file(LYD_FORMAT format, char *tmp_file)
     return EXIT_SUCCESS;
 }
 
+static int
+step_module_has_data(const struct lys_module *ly_mod, int config_only)
+{
+    const struct lys_node *snode = NULL;
+
+    if (!ly_mod->implemented) {
+        return 0;
+    }
+
+    while ((snode = lys_getnext(snode, NULL, ly_mod, 0))) {
+        if ((snode->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))
+                && (!config_only || (snode->flags & LYS_CONFIG_W))) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void
+step_print_throughput(const char *op_str, size_t size, const struct timespec *start)
+{
+    struct timespec end;
+    double mb, seconds;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mb = (double)size / (1024 * 1024);
+    seconds = (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1000000000.0;
+
+    fprintf(stderr, "sysrepocfg: %s %.2f MB in %.2f s (%.2f MB/s)\n", op_str, mb, seconds,
+            (seconds > 0) ? mb / seconds : 0);
+}
+
+struct step_output {
+    FILE *file;
+    size_t size;
+};
+
+static ssize_t
+step_print_clb(void *arg, const void *buf, size_t count)
+{
+    struct step_output *out = arg;
+
+    if (fwrite(buf, 1, count, out->file) < count) {
+        return -1;
+    }
+    out->size += count;
+    return count;
+}
+
+static int
+op_import_stream(sr_session_ctx_t *sess, const char *file_path, LYD_FORMAT format, int not_strict, int timeout_s,
+        int wait, int report)
+{
+    struct ly_ctx *ly_ctx;
+    const struct lys_module *ly_mod;
+    struct lyd_node *data, *mod_data, *root, *next;
+    struct timespec start;
+    FILE *file;
+    char *mem;
+    size_t size;
+    uint32_t idx = 0;
+    int r, rc = EXIT_FAILURE;
+
+    ly_ctx = (struct ly_ctx *)sr_get_context(sr_session_get_connection(sess));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (step_data_format(file_path, &format)) {
+        return EXIT_FAILURE;
+    }
+
+    /* read the whole input, libyang is able to parse only complete data */
+    if (file_path) {
+        file = fopen(file_path, "r");
+        if (!file) {
+            error_print(0, "Failed to open \"%s\" for reading (%s)", file_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+    } else {
+        file = stdin;
+    }
+    r = step_read_file(file, &mem, &size);
+    if (file_path) {
+        fclose(file);
+    }
+    if (r) {
+        return EXIT_FAILURE;
+    }
+
+    /* parse and validate all the data together, they will be stored separately */
+    data = lyd_parse_mem(ly_ctx, mem, format, LYD_OPT_CONFIG | (not_strict ? 0 : LYD_OPT_STRICT));
+    free(mem);
+    if (ly_errno) {
+        error_ly_print(ly_ctx);
+        error_print(0, "Data parsing failed");
+        return EXIT_FAILURE;
+    }
+
+    /* replace data of every module separately, they are freed right after they are stored */
+    while ((ly_mod = ly_ctx_get_module_iter(ly_ctx, &idx))) {
+        if (!step_module_has_data(ly_mod, 1)) {
+            continue;
+        }
+
+        /* unlink all the module data */
+        mod_data = NULL;
+        LY_TREE_FOR_SAFE(data, next, root) {
+            if (lyd_node_module(root) != ly_mod) {
+                continue;
+            }
+
+            if (root == data) {
+                data = next;
+            }
+            lyd_unlink(root);
+            if (mod_data) {
+                lyd_insert_sibling(&mod_data, root);
+            } else {
+                mod_data = root;
+            }
+        }
+
+        /* replace config (always spends data) */
+        r = sr_replace_config(sess, ly_mod->name, mod_data, timeout_s * 1000, wait);
+        if ((r == SR_ERR_NOT_FOUND) && !mod_data) {
+            /* not a sysrepo module */
+            continue;
+        } else if (r) {
+            error_print(r, "Replace config of module \"%s\" failed", ly_mod->name);
+            goto cleanup;
+        }
+    }
+
+    if (report) {
+        step_print_throughput("imported", size, &start);
+    }
+    rc = EXIT_SUCCESS;
+
+cleanup:
+    lyd_free_withsiblings(data);
+    return rc;
+}
+
+static int
+op_export_stream(sr_session_ctx_t *sess, FILE *file, LYD_FORMAT format, uint32_t max_depth, int timeout_s, int report)
+{
+    struct ly_ctx *ly_ctx;
+    const struct lys_module *ly_mod;
+    struct lyd_node *data;
+    struct step_output out = {file, 0};
+    struct timespec start;
+    char *str, *inner, *end;
+    uint32_t idx = 0;
+    int r, config_only, first = 1;
+
+    ly_ctx = (struct ly_ctx *)sr_get_context(sr_session_get_connection(sess));
+    config_only = (sr_session_get_ds(sess) != SR_DS_OPERATIONAL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* get and print data of every module separately */
+    while ((ly_mod = ly_ctx_get_module_iter(ly_ctx, &idx))) {
+        if (!step_module_has_data(ly_mod, config_only)) {
+            continue;
+        }
+
+        asprintf(&str, "/%s:*", ly_mod->name);
+        r = sr_get_data(sess, str, max_depth, timeout_s * 1000, 0, &data);
+        free(str);
+        if (r != SR_ERR_OK) {
+            error_print(r, "Getting data of module \"%s\" failed", ly_mod->name);
+            return EXIT_FAILURE;
+        }
+        if (!data) {
+            continue;
+        }
+
+        if (format == LYD_JSON) {
+            /* all the top-level nodes must be members of a single JSON object */
+            r = lyd_print_mem(&str, data, LYD_JSON, LYP_FORMAT | LYP_WITHSIBLINGS);
+            lyd_free_withsiblings(data);
+            if (r || !(inner = strchr(str, '{')) || !(end = strrchr(str, '}'))) {
+                free(str);
+                error_ly_print(ly_ctx);
+                error_print(0, "Printing data of module \"%s\" failed", ly_mod->name);
+                return EXIT_FAILURE;
+            }
+            for (++inner; (end > inner) && ((end[-1] == '\n') || (end[-1] == ' ')); --end);
+
+            step_print_clb(&out, first ? "{" : ",", 1);
+            step_print_clb(&out, inner, end - inner);
+            free(str);
+        } else {
+            r = lyd_print_clb(step_print_clb, &out, data, format, LYP_FORMAT | LYP_WITHSIBLINGS);
+            lyd_free_withsiblings(data);
+            if (r) {
+                error_ly_print(ly_ctx);
+                error_print(0, "Printing data of module \"%s\" failed", ly_mod->name);
+                return EXIT_FAILURE;
+            }
+        }
+        first = 0;
+    }
+
+    if (format == LYD_JSON) {
+        /* finish the JSON object */
+        if (first) {
+            step_print_clb(&out, "{", 1);
+        }
+        step_print_clb(&out, "\n}\n", 3);
+    }
+    fflush(file);
+
+    if (report) {
+        step_print_throughput("exported", out.size, &start);
+    }
+    return EXIT_SUCCESS;
+}
+
 static int
 op_import(sr_session_ctx_t *sess, const char *file_path, const char *module_name, LYD_FORMAT format, int not_strict,
         int timeout_s, int wait)
@@ -310,9 +553,11 @@ op_import(sr_session_ctx_t *sess, const char *file_path, const char *module_name
 
 static int
 op_export(sr_session_ctx_t *sess, const char *file_path, const char *module_name, const char *xpath, LYD_FORMAT format,
-        uint32_t max_depth, int timeout_s)
+        uint32_t max_depth, int timeout_s, int stream, int report)
 {
     struct lyd_node *data;
+    struct step_output out = {NULL, 0};
+    struct timespec start;
     FILE *file = NULL;
     char *str;
     int r;
@@ -320,6 +565,7 @@ op_export(sr_session_ctx_t *sess, const char *file_path, const char *module_name
     if (format == LYD_UNKNOWN) {
         format = LYD_XML;
     }
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
     if (file_path) {
         file = fopen(file_path, "w");
@@ -329,6 +575,15 @@ op_export(sr_session_ctx_t *sess, const char *file_path, const char *module_name
         }
     }
 
+    if (stream && !module_name && !xpath && (format != LYD_LYB)) {
+        /* LYB data of separate modules cannot be concatenated */
+        r = op_export_stream(sess, file ? file : stdout, format, max_depth, timeout_s, report);
+        if (file) {
+            fclose(file);
+        }
+        return r;
+    }
+
     /* get subtrees */
     if (module_name) {
         asprintf(&str, "/%s:*", module_name);
@@ -348,7 +603,15 @@ op_export(sr_session_ctx_t *sess, const char *file_path, const char *module_name
     }
 
     /* print exported data */
-    lyd_print_file(file ? file : stdout, data, format, LYP_FORMAT | LYP_WITHSIBLINGS);
+    if (stream && report) {
+        /* count the printed bytes for the throughput */
+        out.file = file ? file : stdout;
+        lyd_print_clb(step_print_clb, &out, data, format, LYP_FORMAT | LYP_WITHSIBLINGS);
+        fflush(out.file);
+        step_print_throughput("exported", out.size, &start);
+    } else {
+        lyd_print_file(file ? file : stdout, data, format, LYP_FORMAT | LYP_WITHSIBLINGS);
+    }
     lyd_free_withsiblings(data);
 
     /* cleanup */
@@ -368,13 +631,22 @@ op_edit(sr_session_ctx_t *sess, const char *file_path, const char *editor, const
 
     if (file_path) {
         /* just apply an edit from a file */
-        flags = LYD_OPT_EDIT | LYD_OPT_TRUSTED | (not_strict ? 0 : LYD_OPT_STRICT);
-        if (step_load_data(sess, file_path, format, flags, &data)) {
-            return EXIT_FAILURE;
-        }
+        if (not_strict) {
+            flags = LYD_OPT_EDIT | LYD_OPT_TRUSTED;
+            if (step_load_data(sess, file_path, format, flags, &data)) {
+                return EXIT_FAILURE;
+            }
+
+            r = sr_edit_batch(sess, data, "merge");
+            lyd_free_withsiblings(data);
+        } else {
+            /* let sysrepo parse the edit itself, spares duplicating it */
+            if (step_data_format(file_path, &format)) {
+                return EXIT_FAILURE;
+            }
 
-        r = sr_edit_batch(sess, data, "merge");
-        lyd_free_withsiblings(data);
+            r = sr_edit_batch_data(sess, NULL, file_path, format, "merge");
+        }
         if (r != SR_ERR_OK) {
             error_print(r, "Failed to prepare edit");
             return EXIT_FAILURE;
@@ -401,7 +673,7 @@ op_edit(sr_session_ctx_t *sess, const char *file_path, const char *editor, const
     }
 
     /* use export operation to get data to edit */
-    if (op_export(sess, tmp_file, module_name, NULL, format, 0, timeout_s)) {
+    if (op_export(sess, tmp_file, module_name, NULL, format, 0, timeout_s, 0, 0)) {
         goto cleanup_unlock;
     }
 
@@ -594,7 +866,7 @@ main(int argc, char** argv)
     const char *module_name = NULL, *editor = NULL, *file_path = NULL, *xpath = NULL, *op_str;
     char *ptr;
     sr_log_level_t log_level = SR_LL_ERR;
-    int r, rc = EXIT_FAILURE, opt, operation = 0, lock = 0, not_strict = 0, timeout = 0, wait = 0;
+    int r, rc = EXIT_FAILURE, opt, operation = 0, lock = 0, not_strict = 0, timeout = 0, wait = 0, stream = 0;
     uint32_t max_depth = 0;
     struct option options[] = {
         {"help",            no_argument,       NULL, 'h'},
@@ -616,6 +888,7 @@ main(int argc, char** argv)
         {"timeout",         required_argument, NULL, 't'},
         {"wait",            no_argument,       NULL, 'w'},
         {"verbosity",       required_argument, NULL, 'v'},
+        {"stream",          no_argument,       NULL, 's'},
         {NULL,              0,                 NULL, 0},
     };
 
@@ -626,7 +899,7 @@ main(int argc, char** argv)
 
     /* process options */
     opterr = 0;
-    while ((opt = getopt_long(argc, argv, "hVI::X::E::R::N::C:W:d:m:x:f:lnp:t:wv:", options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hVI::X::E::R::N::C:W:d:m:x:f:lnp:t:wv:s", options, NULL)) != -1) {
         switch (opt) {
         case 'h':
             version_print();
@@ -799,6 +1072,9 @@ main(int argc, char** argv)
                 goto cleanup;
             }
             break;
+        case 's':
+            stream = 1;
+            break;
         default:
             error_print(0, "Invalid option or missing argument: -%c", optopt);
             goto cleanup;
@@ -852,10 +1128,15 @@ main(int argc, char** argv)
     /* perform the operation */
     switch (operation) {
     case 'I':
-        rc = op_import(sess, file_path, module_name, format, not_strict, timeout, wait);
+        if (stream && !module_name) {
+            rc = op_import_stream(sess, file_path, format, not_strict, timeout, wait, log_level >= SR_LL_INF);
+        } else {
+            rc = op_import(sess, file_path, module_name, format, not_strict, timeout, wait);
+        }
         break;
     case 'X':
-        rc = op_export(sess, file_path, module_name, xpath, format, max_depth, timeout);
+        rc = op_export(sess, file_path, module_name, xpath, format, max_depth, timeout, stream,
+                log_level >= SR_LL_INF);
         break;
     case 'E':
         rc = op_edit(sess, file_path, editor, module_name, format, lock, not_strict, timeout, wait);
@@ -80,6 +80,7 @@ help_print(void)
         "  -V, --version        Print only information about sysrepo version.\n"
         "  -l, --list           List YANG modules in sysrepo.\n"
         "  -i, --install <path> Install the specified schema into sysrepo. Can be in either YANG or YIN format.\n"
+        "                       Can be specified multiple times to install all the schemas in a single batch.\n"
         "  -u, --uninstall <module>[,<module2>,<module3> ...]\n"
         "                       Uninstall the specified module(s) from sysrepo.\n"
         "  -c, --change <module>\n"
@@ -95,6 +96,7 @@ help_print(void)
         "                       modules is always searched (install, update op).\n"
         "  -e, --enable-feature <feature-name>\n"
         "                       Enabled specific feature. Can be specified multiple times (install, change op).\n"
+        "                       When installing more schemas, it applies to the last previously specified one.\n"
         "  -d, --disable-feature <feature-name>\n"
         "                       Disable specific feature. Can be specified multiple times (change op).\n"
         "  -r, --replay <state> Change replay support (storing notifications) for this module to on/off or 1/0 (change op).\n"
@@ -412,6 +414,8 @@ cleanup:
 
 /* can be changed by log_cb */
 char *inst_module_name;
+char **sched_module_names;
+int sched_module_count;
 
 static void
 log_cb(sr_log_level_t level, const char *message)
@@ -428,6 +432,12 @@ log_cb(sr_log_level_t level, const char *message)
     if (!end) {
         return;
     }
+    if (!strncmp(end, "\" scheduled for installation", 28)) {
+        /* store the name of the module scheduled to be installed */
+        sched_module_names = realloc(sched_module_names, (sched_module_count + 1) * sizeof *sched_module_names);
+        sched_module_names[sched_module_count++] = strndup(message + 8, end - (message + 8));
+        return;
+    }
     if (strncmp(end, "\" was installed", 15) && strncmp(end, "\" was updated", 13)) {
         return;
     }
@@ -437,15 +447,40 @@ log_cb(sr_log_level_t level, const char *message)
     inst_module_name = strndup(message + 8, end - (message + 8));
 }
 
+/* add a string into a NULL-terminated array */
+static int
+str_array_add(const char ***array, const char *str)
+{
+    void *mem;
+    int count = 0;
+
+    if (*array) {
+        for (count = 0; (*array)[count]; ++count) {}
+    }
+
+    mem = realloc(*array, (count + 2) * sizeof **array);
+    if (!mem) {
+        error_print(0, "Memory allocation failed");
+        return -1;
+    }
+    *array = mem;
+    (*array)[count] = str;
+    (*array)[count + 1] = NULL;
+    return 0;
+}
+
 int
 main(int argc, char** argv)
 {
     sr_conn_ctx_t *conn = NULL;
     const char *file_path = NULL, *search_dirs = NULL, *module_name = NULL, *owner = NULL, *group = NULL;
+    const char **file_paths = NULL, ***file_features = NULL;
     char **features = NULL, **dis_features = NULL, *ptr;
+    void *mem;
     mode_t perms = -1;
     sr_log_level_t log_level = SR_LL_ERR;
     int r, i, rc = EXIT_FAILURE, opt, operation = 0, feat_count = 0, dis_feat_count = 0, replay = -1, apply = 0;
+    int file_count = 0;
     uint32_t conn_count;
     struct option options[] = {
         {"help",            no_argument,       NULL, 'h'},
@@ -494,12 +529,33 @@ main(int argc, char** argv)
             operation = 'l';
             break;
         case 'i':
-            if (operation) {
+            if (operation && (operation != 'i')) {
                 error_print(0, "Operation already specified");
                 goto cleanup;
             }
             operation = 'i';
-            file_path = optarg;
+
+            /* add another schema to install */
+            if (str_array_add(&file_paths, optarg)) {
+                goto cleanup;
+            }
+            mem = realloc(file_features, (file_count + 1) * sizeof *file_features);
+            if (!mem) {
+                error_print(0, "Memory allocation failed");
+                goto cleanup;
+            }
+            file_features = mem;
+            file_features[file_count] = NULL;
+
+            /* features specified before the first schema belong to it */
+            for (i = 0; i < feat_count; ++i) {
+                if (str_array_add(&file_features[file_count], features[i])) {
+                    ++file_count;
+                    goto cleanup;
+                }
+            }
+            feat_count = 0;
+            ++file_count;
             break;
         case 'u':
             if (operation) {
@@ -544,6 +600,13 @@ main(int argc, char** argv)
                 error_print(0, "Invalid parameter -%c for the operation", opt);
                 goto cleanup;
             }
+            if (operation == 'i') {
+                /* feature of the last schema to install */
+                if (str_array_add(&file_features[file_count - 1], optarg)) {
+                    goto cleanup;
+                }
+                break;
+            }
             features = realloc(features, (feat_count + 1) * sizeof *features);
             features[feat_count++] = optarg;
             break;
@@ -664,10 +727,14 @@ main(int argc, char** argv)
         break;
     case 'i':
         /* install */
-        if ((r = sr_install_module(conn, file_path, search_dirs, (const char **)features, feat_count)) != SR_ERR_OK) {
-            /* succeed if the module is already installed */
+        if ((r = sr_install_modules(conn, file_paths, search_dirs, file_features)) != SR_ERR_OK) {
+            /* succeed if all the modules are already installed */
             if (r != SR_ERR_EXISTS) {
-                error_print(r, "Failed to install module \"%s\"", file_path);
+                if (file_count == 1) {
+                    error_print(r, "Failed to install module \"%s\"", file_paths[0]);
+                } else {
+                    error_print(r, "Failed to install modules");
+                }
                 goto cleanup;
             }
         }
@@ -773,8 +840,18 @@ main(int argc, char** argv)
         break;
     }
 
-    /* change permissions for a newly installed/updated module */
-    if (((operation == 'i') || (operation == 'U')) && (owner || group || ((int)perms != -1))) {
+    /* change permissions for newly installed modules */
+    if ((operation == 'i') && (owner || group || ((int)perms != -1))) {
+        for (i = 0; i < sched_module_count; ++i) {
+            if ((r = sr_set_module_access(conn, sched_module_names[i], owner, group, perms)) != SR_ERR_OK) {
+                error_print(r, "Failed to change module \"%s\" access", sched_module_names[i]);
+                goto cleanup;
+            }
+        }
+    }
+
+    /* change permissions for a newly updated module */
+    if ((operation == 'U') && (owner || group || ((int)perms != -1))) {
         if ((r = sr_set_module_access(conn, inst_module_name, owner, group, perms)) != SR_ERR_OK) {
             error_print(r, "Failed to change module \"%s\" access", inst_module_name);
             goto cleanup;
@@ -785,7 +862,16 @@ main(int argc, char** argv)
 
 cleanup:
     free(inst_module_name);
+    for (i = 0; i < sched_module_count; ++i) {
+        free(sched_module_names[i]);
+    }
+    free(sched_module_names);
     sr_disconnect(conn);
+    for (i = 0; i < file_count; ++i) {
+        free(file_features[i]);
+    }
+    free(file_features);
+    free(file_paths);
     free(features);
     free(dis_features);
     return rc;
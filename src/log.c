@@ -23,15 +23,58 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdarg.h>
+#include <string.h>
 #include <assert.h>
+#include <errno.h>
 #include <syslog.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <sys/types.h>
 
 sr_log_level_t stderr_ll = SR_LL_NONE;  /**< stderr log level */
 sr_log_level_t syslog_ll = SR_LL_NONE;  /**< syslog log level */
+sr_log_level_t log_max_ll = SR_LL_NONE; /**< Maximum level of a message that is printed anywhere */
 int syslog_open;                        /**< Whether syslog was opened */
 sr_log_cb log_cb;                       /**< Logging callback */
 
+#define SR_LOG_RING_SIZE 1024           /**< Number of records in the log ring, must be a power of 2 */
+#define SR_LOG_RECORD_SIZE 512          /**< Size of the message (arguments) buffer of a log record */
+#define SR_LOG_MSG_SIZE 1024            /**< Size of a message formatted from binary log record arguments */
+
+/**
+ * @brief Log ring record.
+ */
+struct sr_log_record_s {
+    ATOMIC_T seq;                       /**< Sequence number, learn whether the record is free or filled */
+    sr_log_level_t ll;                  /**< Log level */
+    int plugin;                         /**< Whether the message was generated by a plugin */
+    const char *format;                 /**< Static message format with its binary arguments in buf,
+                                             NULL if buf holds the formatted message */
+    uint16_t path_off;                  /**< Offset of the path in the buffer, 0 if there is none */
+    char buf[SR_LOG_RECORD_SIZE];       /**< Message and optional path or binary format arguments */
+};
+
+/**
+ * @brief Lock-free multi-producer single-consumer ring of log records printed by a background thread.
+ */
+static struct {
+    struct sr_log_record_s *records;    /**< Records of the ring */
+    ATOMIC_T enq_pos;                   /**< Position of the next record to be filled */
+    uint_fast32_t deq_pos;              /**< Position of the next record to be printed, only for the thread */
+    ATOMIC_T running;                   /**< Whether the thread should keep running */
+    sem_t sem;                          /**< Semaphore posted for every filled record */
+    pthread_t tid;                      /**< Printing thread ID */
+} log_ring;
+
+#define SR_LOG_ASYNC_ON 0x1             /**< log_async flag of enabled asynchronous logging */
+#define SR_LOG_ASYNC_PRODUCER 0x2       /**< log_async increment for every thread currently using the log ring */
+static ATOMIC_T log_async;              /**< Asynchronous logging flag and number of threads using the log ring */
+static pthread_mutex_t log_async_lock = PTHREAD_MUTEX_INITIALIZER; /**< Lock for enabling/disabling asynchronous logging */
+
 /**
  * @brief String error list.
  */
@@ -97,8 +140,30 @@ sr_api_ret(sr_session_ctx_t *session, sr_error_info_t *err_info)
     return err_code;
 }
 
-void
-sr_log_msg(int plugin, sr_log_level_t ll, const char *msg, const char *path)
+/**
+ * @brief Update maximum log level of a printed message.
+ */
+static void
+sr_log_max_ll_update(void)
+{
+    if (log_cb) {
+        /* callback is called for all the messages */
+        log_max_ll = SR_LL_DBG;
+    } else {
+        log_max_ll = (stderr_ll > syslog_ll) ? stderr_ll : syslog_ll;
+    }
+}
+
+/**
+ * @brief Print a message into all the log outputs.
+ *
+ * @param[in] plugin Whether the message was generated by a plugin.
+ * @param[in] ll Log level (severity).
+ * @param[in] msg Message.
+ * @param[in] path Optional XPath of the concerned node.
+ */
+static void
+sr_log_msg_print(int plugin, sr_log_level_t ll, const char *msg, const char *path)
 {
     int priority;
     const char *severity;
@@ -145,6 +210,569 @@ sr_log_msg(int plugin, sr_log_level_t ll, const char *msg, const char *path)
     }
 }
 
+/**
+ * @brief Start using the log ring, if asynchronous logging is enabled.
+ *
+ * @return 0 if it is disabled, non-zero if the log ring can be used until ::sr_log_ring_leave() is called.
+ */
+static int
+sr_log_ring_enter(void)
+{
+    if (!(ATOMIC_LOAD_ACQUIRE(log_async) & SR_LOG_ASYNC_ON)) {
+        return 0;
+    }
+
+    /* announce using the ring, it is not freed until we leave */
+    if (!(ATOMIC_ADD_ACQ_REL(log_async, SR_LOG_ASYNC_PRODUCER) & SR_LOG_ASYNC_ON)) {
+        /* disabled in the meantime */
+        ATOMIC_SUB_ACQ_REL(log_async, SR_LOG_ASYNC_PRODUCER);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Stop using the log ring.
+ */
+static void
+sr_log_ring_leave(void)
+{
+    ATOMIC_SUB_ACQ_REL(log_async, SR_LOG_ASYNC_PRODUCER);
+}
+
+/**
+ * @brief Parse a conversion specification of a format.
+ *
+ * @param[in] spec Specification right after '%'.
+ * @param[out] len_mod Length modifier, 'H' for "hh", 'q' for "ll", 0 if there is none.
+ * @param[out] len_off Offset of the length modifier (or conversion if there is none) in @p spec.
+ * @param[out] stars Number of '*' width and precision arguments.
+ * @return Length of the whole specification, 0 if it is not supported.
+ */
+static size_t
+sr_log_spec_parse(const char *spec, char *len_mod, size_t *len_off, int *stars)
+{
+    const char *ptr = spec;
+
+    *stars = 0;
+
+    /* flags, width, and precision */
+    ptr += strspn(ptr, "-+ #0");
+    if (*ptr == '*') {
+        ++(*stars);
+        ++ptr;
+    } else {
+        ptr += strspn(ptr, "0123456789");
+    }
+    if (*ptr == '.') {
+        ++ptr;
+        if (*ptr == '*') {
+            ++(*stars);
+            ++ptr;
+        } else {
+            ptr += strspn(ptr, "0123456789");
+        }
+    }
+    *len_off = ptr - spec;
+    if (*len_off > 32) {
+        return 0;
+    }
+
+    /* length modifier */
+    *len_mod = 0;
+    switch (*ptr) {
+    case 'h':
+    case 'l':
+        *len_mod = *ptr;
+        ++ptr;
+        if (*ptr == *len_mod) {
+            *len_mod = (*len_mod == 'h') ? 'H' : 'q';
+            ++ptr;
+        }
+        break;
+    case 'j':
+    case 'z':
+    case 't':
+    case 'L':
+        *len_mod = *ptr;
+        ++ptr;
+        break;
+    }
+
+    /* conversion */
+    if (!*ptr || !strchr("diouxXcspfFeEgGaA%", *ptr)) {
+        return 0;
+    }
+    return ptr - spec + 1;
+}
+
+/**
+ * @brief Store a value into binary log record arguments.
+ */
+#define SR_LOG_ARG_PUT(buf, off, val) \
+    if ((off) + sizeof (val) > SR_LOG_RECORD_SIZE) { goto error; } \
+    memcpy((buf) + (off), &(val), sizeof (val)); \
+    (off) += sizeof (val)
+
+/**
+ * @brief Load a value from binary log record arguments.
+ */
+#define SR_LOG_ARG_GET(buf, off, val) \
+    memcpy(&(val), (buf) + (off), sizeof (val)); \
+    (off) += sizeof (val)
+
+/**
+ * @brief Store format arguments into a binary log record buffer without formatting them.
+ *
+ * @param[in] buf Record buffer of ::SR_LOG_RECORD_SIZE.
+ * @param[in] format Message format.
+ * @param[in] ap Format arguments.
+ * @return 0 on success, non-zero if they cannot be stored.
+ */
+static int
+sr_log_args_encode(char *buf, const char *format, va_list ap)
+{
+    va_list args;
+    const char *ptr, *str;
+    size_t off = 0, spec_len, len_off, str_len;
+    char len_mod;
+    int i, stars, int_arg;
+    intmax_t im;
+    uintmax_t um;
+    double d;
+    long double ld;
+    void *p;
+
+    va_copy(args, ap);
+    for (ptr = strchr(format, '%'); ptr; ptr = strchr(ptr + spec_len, '%')) {
+        ++ptr;
+        if (!(spec_len = sr_log_spec_parse(ptr, &len_mod, &len_off, &stars))) {
+            goto error;
+        }
+
+        for (i = 0; i < stars; ++i) {
+            int_arg = va_arg(args, int);
+            SR_LOG_ARG_PUT(buf, off, int_arg);
+        }
+
+        switch (ptr[spec_len - 1]) {
+        case 'd':
+        case 'i':
+            switch (len_mod) {
+            case 'H':
+                im = (signed char)va_arg(args, int);
+                break;
+            case 'h':
+                im = (short)va_arg(args, int);
+                break;
+            case 'l':
+                im = va_arg(args, long);
+                break;
+            case 'q':
+                im = va_arg(args, long long);
+                break;
+            case 'j':
+                im = va_arg(args, intmax_t);
+                break;
+            case 'z':
+                im = va_arg(args, ssize_t);
+                break;
+            case 't':
+                im = va_arg(args, ptrdiff_t);
+                break;
+            default:
+                im = va_arg(args, int);
+                break;
+            }
+            SR_LOG_ARG_PUT(buf, off, im);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            switch (len_mod) {
+            case 'H':
+                um = (unsigned char)va_arg(args, unsigned);
+                break;
+            case 'h':
+                um = (unsigned short)va_arg(args, unsigned);
+                break;
+            case 'l':
+                um = va_arg(args, unsigned long);
+                break;
+            case 'q':
+                um = va_arg(args, unsigned long long);
+                break;
+            case 'j':
+                um = va_arg(args, uintmax_t);
+                break;
+            case 'z':
+                um = va_arg(args, size_t);
+                break;
+            case 't':
+                um = (size_t)va_arg(args, ptrdiff_t);
+                break;
+            default:
+                um = va_arg(args, unsigned);
+                break;
+            }
+            SR_LOG_ARG_PUT(buf, off, um);
+            break;
+        case 'c':
+            if (len_mod) {
+                goto error;
+            }
+            int_arg = va_arg(args, int);
+            SR_LOG_ARG_PUT(buf, off, int_arg);
+            break;
+        case 's':
+            if (len_mod) {
+                goto error;
+            }
+
+            /* the string itself must be copied */
+            str = va_arg(args, const char *);
+            if (!str) {
+                str = "(null)";
+            }
+            str_len = strlen(str) + 1;
+            if (off + str_len > SR_LOG_RECORD_SIZE) {
+                goto error;
+            }
+            memcpy(buf + off, str, str_len);
+            off += str_len;
+            break;
+        case 'p':
+            p = va_arg(args, void *);
+            SR_LOG_ARG_PUT(buf, off, p);
+            break;
+        case '%':
+            break;
+        default:
+            /* floating point */
+            if (len_mod == 'L') {
+                ld = va_arg(args, long double);
+                SR_LOG_ARG_PUT(buf, off, ld);
+            } else {
+                d = va_arg(args, double);
+                SR_LOG_ARG_PUT(buf, off, d);
+            }
+            break;
+        }
+    }
+
+    va_end(args);
+    return 0;
+
+error:
+    va_end(args);
+    return 1;
+}
+
+/**
+ * @brief Format a message from its format and binary log record arguments.
+ *
+ * @param[in] format Message format.
+ * @param[in] buf Record buffer with the arguments.
+ * @param[in,out] msg Buffer for the message.
+ * @param[in] msg_size Size of @p msg.
+ */
+static void
+sr_log_args_render(const char *format, const char *buf, char *msg, size_t msg_size)
+{
+    const char *ptr;
+    size_t off = 0, len = 0, spec_len, len_off, i;
+    char spec[64], len_mod, conv;
+    int n, r, s, c, stars, star[2];
+    intmax_t im;
+    uintmax_t um;
+    double d;
+    long double ld;
+    void *p;
+
+    for (ptr = format; *ptr && (len < msg_size - 1); ptr += spec_len) {
+        if (*ptr != '%') {
+            msg[len++] = *ptr;
+            spec_len = 1;
+            continue;
+        }
+
+        /* specification was checked when the arguments were stored */
+        ++ptr;
+        spec_len = sr_log_spec_parse(ptr, &len_mod, &len_off, &stars);
+        conv = ptr[spec_len - 1];
+        if (conv == '%') {
+            msg[len++] = '%';
+            continue;
+        }
+        for (s = 0; s < stars; ++s) {
+            SR_LOG_ARG_GET(buf, off, star[s]);
+        }
+
+        /* rebuild the specification with the width and precision arguments written in */
+        n = 0;
+        s = 0;
+        spec[n++] = '%';
+        for (i = 0; i < len_off; ++i) {
+            if (ptr[i] != '*') {
+                spec[n++] = ptr[i];
+            } else if (i && (ptr[i - 1] == '.') && (star[s] < 0)) {
+                /* negative precision is as if it was omitted */
+                --n;
+                ++s;
+            } else {
+                n += sprintf(spec + n, "%d", star[s++]);
+            }
+        }
+
+        switch (conv) {
+        case 'd':
+        case 'i':
+            sprintf(spec + n, "j%c", conv);
+            SR_LOG_ARG_GET(buf, off, im);
+            r = snprintf(msg + len, msg_size - len, spec, im);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            sprintf(spec + n, "j%c", conv);
+            SR_LOG_ARG_GET(buf, off, um);
+            r = snprintf(msg + len, msg_size - len, spec, um);
+            break;
+        case 'c':
+            sprintf(spec + n, "%c", conv);
+            SR_LOG_ARG_GET(buf, off, c);
+            r = snprintf(msg + len, msg_size - len, spec, c);
+            break;
+        case 's':
+            sprintf(spec + n, "%c", conv);
+            r = snprintf(msg + len, msg_size - len, spec, buf + off);
+            off += strlen(buf + off) + 1;
+            break;
+        case 'p':
+            sprintf(spec + n, "%c", conv);
+            SR_LOG_ARG_GET(buf, off, p);
+            r = snprintf(msg + len, msg_size - len, spec, p);
+            break;
+        default:
+            if (len_mod == 'L') {
+                sprintf(spec + n, "L%c", conv);
+                SR_LOG_ARG_GET(buf, off, ld);
+                r = snprintf(msg + len, msg_size - len, spec, ld);
+            } else {
+                sprintf(spec + n, "%c", conv);
+                SR_LOG_ARG_GET(buf, off, d);
+                r = snprintf(msg + len, msg_size - len, spec, d);
+            }
+            break;
+        }
+
+        if (r > 0) {
+            len = ((size_t)r < msg_size - len) ? len + r : msg_size - 1;
+        }
+    }
+
+    if (*ptr) {
+        /* message truncated */
+        strcpy(msg + msg_size - 4, "...");
+    } else {
+        msg[len] = '\0';
+    }
+}
+
+/**
+ * @brief Reserve a free record in the log ring.
+ *
+ * @param[out] pos Position of the reserved record.
+ * @return Reserved record, NULL if the ring is full.
+ */
+static struct sr_log_record_s *
+sr_log_ring_reserve(uint_fast32_t *pos)
+{
+    struct sr_log_record_s *rec;
+    uint_fast32_t cur_pos, seq;
+    int32_t dif;
+
+    cur_pos = ATOMIC_LOAD_RELAXED(log_ring.enq_pos);
+    while (1) {
+        rec = &log_ring.records[cur_pos & (SR_LOG_RING_SIZE - 1)];
+        seq = ATOMIC_LOAD_ACQUIRE(rec->seq);
+        dif = (int32_t)(uint32_t)(seq - cur_pos);
+        if (!dif) {
+            /* free record, try to take it */
+            if (ATOMIC_CAS_RELAXED(log_ring.enq_pos, cur_pos, cur_pos + 1)) {
+                *pos = cur_pos;
+                return rec;
+            }
+        } else if (dif < 0) {
+            /* record not yet printed from the previous round, the ring is full */
+            return NULL;
+        }
+
+        /* record taken by someone else, try again */
+        cur_pos = ATOMIC_LOAD_RELAXED(log_ring.enq_pos);
+    }
+}
+
+/**
+ * @brief Mark a record as filled and wake up the printing thread.
+ *
+ * @param[in] rec Filled record.
+ * @param[in] pos Position of the record.
+ * @param[in] len Length of the message that was written into the record.
+ */
+static void
+sr_log_ring_publish(struct sr_log_record_s *rec, uint_fast32_t pos, int len)
+{
+    if (len >= SR_LOG_RECORD_SIZE) {
+        /* message truncated */
+        strcpy(rec->buf + SR_LOG_RECORD_SIZE - 4, "...");
+    }
+
+    ATOMIC_STORE_RELEASE(rec->seq, pos + 1);
+    sem_post(&log_ring.sem);
+}
+
+/**
+ * @brief Store a message into the log ring.
+ *
+ * @param[in] plugin Whether the message was generated by a plugin.
+ * @param[in] ll Log level (severity).
+ * @param[in] msg Message.
+ * @param[in] path Optional XPath of the concerned node.
+ * @return 0 on success, non-zero if the ring is full.
+ */
+static int
+sr_log_ring_push(int plugin, sr_log_level_t ll, const char *msg, const char *path)
+{
+    struct sr_log_record_s *rec;
+    uint_fast32_t pos;
+    int len;
+
+    if (!(rec = sr_log_ring_reserve(&pos))) {
+        return 1;
+    }
+
+    rec->ll = ll;
+    rec->plugin = plugin;
+    rec->format = NULL;
+    len = snprintf(rec->buf, SR_LOG_RECORD_SIZE, "%s", msg);
+    rec->path_off = 0;
+    if (path && (len < SR_LOG_RECORD_SIZE - 1)) {
+        rec->path_off = len + 1;
+        snprintf(rec->buf + rec->path_off, SR_LOG_RECORD_SIZE - rec->path_off, "%s", path);
+    }
+
+    sr_log_ring_publish(rec, pos, len);
+    return 0;
+}
+
+/**
+ * @brief Store a message into the log ring, as binary format arguments if possible.
+ *
+ * @param[in] plugin Whether the message was generated by a plugin, its format is then not static and
+ * the message is formatted directly into the log ring.
+ * @param[in] ll Log level (severity).
+ * @param[in] format Message format.
+ * @param[in] ap Format arguments.
+ * @return 0 on success, non-zero if the ring is full.
+ */
+static int
+sr_log_ring_vprintf(int plugin, sr_log_level_t ll, const char *format, va_list ap)
+{
+    struct sr_log_record_s *rec;
+    uint_fast32_t pos;
+    int len = 0;
+
+    if (!(rec = sr_log_ring_reserve(&pos))) {
+        return 1;
+    }
+
+    rec->ll = ll;
+    rec->plugin = plugin;
+    rec->path_off = 0;
+    if (!plugin && !sr_log_args_encode(rec->buf, format, ap)) {
+        /* formatted by the printing thread */
+        rec->format = format;
+    } else {
+        /* too long or unsupported arguments, format it now */
+        rec->format = NULL;
+        len = vsnprintf(rec->buf, SR_LOG_RECORD_SIZE, format, ap);
+        if (len < 0) {
+            rec->buf[0] = '\0';
+            len = 0;
+        }
+    }
+
+    sr_log_ring_publish(rec, pos, len);
+    return 0;
+}
+
+/**
+ * @brief Thread printing all the log ring records.
+ *
+ * @param[in] arg Unused.
+ * @return Always NULL.
+ */
+static void *
+sr_log_ring_thread(void *arg)
+{
+    struct sr_log_record_s *rec;
+    char msg[SR_LOG_MSG_SIZE];
+    int running;
+
+    (void)arg;
+
+    do {
+        /* wait for a record */
+        while ((sem_wait(&log_ring.sem) == -1) && (errno == EINTR)) {}
+        running = ATOMIC_LOAD_RELAXED(log_ring.running);
+
+        /* print all the filled records in order */
+        while (1) {
+            rec = &log_ring.records[log_ring.deq_pos & (SR_LOG_RING_SIZE - 1)];
+            if ((uint32_t)ATOMIC_LOAD_ACQUIRE(rec->seq) != (uint32_t)(log_ring.deq_pos + 1)) {
+                break;
+            }
+
+            if (rec->format) {
+                sr_log_args_render(rec->format, rec->buf, msg, sizeof msg);
+                sr_log_msg_print(rec->plugin, rec->ll, msg, NULL);
+            } else {
+                sr_log_msg_print(rec->plugin, rec->ll, rec->buf, rec->path_off ? rec->buf + rec->path_off : NULL);
+            }
+
+            /* free the record for the next round */
+            ATOMIC_STORE_RELEASE(rec->seq, log_ring.deq_pos + SR_LOG_RING_SIZE);
+            ++log_ring.deq_pos;
+        }
+    } while (running);
+
+    return NULL;
+}
+
+void
+sr_log_msg(int plugin, sr_log_level_t ll, const char *msg, const char *path)
+{
+    if ((ll > log_max_ll) || (ll == SR_LL_NONE)) {
+        /* would not be printed anywhere */
+        return;
+    }
+
+    if (sr_log_ring_enter()) {
+        if (!sr_log_ring_push(plugin, ll, msg, path)) {
+            /* will be printed by the log ring thread */
+            sr_log_ring_leave();
+            return;
+        }
+        sr_log_ring_leave();
+    }
+
+    sr_log_msg_print(plugin, ll, msg, path);
+}
+
 void
 sr_errinfo_add(sr_error_info_t **err_info, sr_error_t err_code, const char *xpath, const char *format, va_list *vargs)
 {
@@ -318,34 +946,63 @@ sr_errinfo_merge(sr_error_info_t **err_info, sr_error_info_t *err_info2)
     free(err_info2);
 }
 
+/**
+ * @brief Log a message with variable arguments.
+ *
+ * @param[in] plugin Whether the message was generated by a plugin.
+ * @param[in] ll Log level (severity).
+ * @param[in] format Message format.
+ * @param[in] ap Format arguments.
+ */
+static void
+sr_log_va(int plugin, sr_log_level_t ll, const char *format, va_list ap)
+{
+    va_list ap2;
+    char *msg = NULL;
+    int msg_len = 0, r;
+
+    if (ll > log_max_ll) {
+        /* would not be printed anywhere, do not even format it */
+        return;
+    }
+
+    if (sr_log_ring_enter()) {
+        /* store it into the log ring, without any allocation */
+        va_copy(ap2, ap);
+        r = sr_log_ring_vprintf(plugin, ll, format, ap2);
+        va_end(ap2);
+        sr_log_ring_leave();
+        if (!r) {
+            return;
+        }
+    }
+
+    if (sr_vsprintf(&msg, &msg_len, 0, format, ap) == -1) {
+        return;
+    }
+
+    sr_log_msg_print(plugin, ll, msg, NULL);
+    free(msg);
+}
+
 void
 sr_log(sr_log_level_t ll, const char *format, ...)
 {
     va_list ap;
-    char *msg;
-    int msg_len = 0;
 
     va_start(ap, format);
-    sr_vsprintf(&msg, &msg_len, 0, format, ap);
+    sr_log_va(0, ll, format, ap);
     va_end(ap);
-
-    sr_log_msg(0, ll, msg, NULL);
-    free(msg);
 }
 
 API void
 srp_log(sr_log_level_t ll, const char *format, ...)
 {
     va_list ap;
-    char *msg;
-    int msg_len = 0;
 
     va_start(ap, format);
-    sr_vsprintf(&msg, &msg_len, 0, format, ap);
+    sr_log_va(1, ll, format, ap);
     va_end(ap);
-
-    sr_log_msg(1, ll, msg, NULL);
-    free(msg);
 }
 
 API const char *
@@ -365,6 +1022,7 @@ sr_log_stderr(sr_log_level_t log_level)
     ly_log_options(LY_LOSTORE);
 
     stderr_ll = log_level;
+    sr_log_max_ll_update();
 }
 
 API sr_log_level_t
@@ -380,6 +1038,7 @@ sr_log_syslog(const char *app_name, sr_log_level_t log_level)
     ly_log_options(LY_LOSTORE);
 
     syslog_ll = log_level;
+    sr_log_max_ll_update();
 
     if ((log_level > SR_LL_NONE) && !syslog_open) {
         openlog(app_name ? app_name : "sysrepo", LOG_CONS | LOG_PID | LOG_NDELAY, LOG_USER);
@@ -402,4 +1061,67 @@ API void
 sr_log_set_cb(sr_log_cb log_callback)
 {
     log_cb = log_callback;
+    sr_log_max_ll_update();
+}
+
+API int
+sr_log_async(int enable)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+    int ret;
+
+    /* LOCK */
+    pthread_mutex_lock(&log_async_lock);
+
+    if (enable && !(ATOMIC_LOAD_ACQUIRE(log_async) & SR_LOG_ASYNC_ON)) {
+        log_ring.records = malloc(SR_LOG_RING_SIZE * sizeof *log_ring.records);
+        SR_CHECK_MEM_GOTO(!log_ring.records, err_info, cleanup);
+        for (i = 0; i < SR_LOG_RING_SIZE; ++i) {
+            ATOMIC_STORE_RELAXED(log_ring.records[i].seq, i);
+        }
+        ATOMIC_STORE_RELAXED(log_ring.enq_pos, 0);
+        log_ring.deq_pos = 0;
+
+        if (sem_init(&log_ring.sem, 0, 0) == -1) {
+            SR_ERRINFO_SYSERRNO(&err_info, "sem_init");
+            free(log_ring.records);
+            log_ring.records = NULL;
+            goto cleanup;
+        }
+
+        /* start the printing thread */
+        ATOMIC_STORE_RELAXED(log_ring.running, 1);
+        if ((ret = pthread_create(&log_ring.tid, NULL, sr_log_ring_thread, NULL))) {
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, NULL, "Creating a new thread failed (%s).", strerror(ret));
+            sem_destroy(&log_ring.sem);
+            free(log_ring.records);
+            log_ring.records = NULL;
+            goto cleanup;
+        }
+
+        /* publish the prepared ring */
+        ATOMIC_ADD_ACQ_REL(log_async, SR_LOG_ASYNC_ON);
+    } else if (!enable && (ATOMIC_LOAD_ACQUIRE(log_async) & SR_LOG_ASYNC_ON)) {
+        /* no new threads start using the ring, wait for the ones that are using it */
+        ATOMIC_SUB_ACQ_REL(log_async, SR_LOG_ASYNC_ON);
+        while (ATOMIC_LOAD_ACQUIRE(log_async)) {
+            sched_yield();
+        }
+
+        /* stop the thread, it prints all the remaining records */
+        ATOMIC_STORE_RELAXED(log_ring.running, 0);
+        sem_post(&log_ring.sem);
+        pthread_join(log_ring.tid, NULL);
+
+        sem_destroy(&log_ring.sem);
+        free(log_ring.records);
+        log_ring.records = NULL;
+    }
+
+cleanup:
+    /* UNLOCK */
+    pthread_mutex_unlock(&log_async_lock);
+
+    return sr_api_ret(NULL, err_info);
 }
@@ -33,13 +33,14 @@
 #define SR_ERRINFO_SYSERRNO(err_info, func) sr_errinfo_new(err_info, SR_ERR_SYS, NULL, "%s() failed (%s).", func, strerror(errno))
 #define SR_ERRINFO_VALID(err_info) sr_errinfo_new(err_info, SR_ERR_VALIDATION_FAILED, NULL, "Validation failed.")
 
-#define SR_LOG_WRN(format, ...) sr_log(SR_LL_WRN, format, __VA_ARGS__)
-#define SR_LOG_INF(format, ...) sr_log(SR_LL_INF, format, __VA_ARGS__)
-#define SR_LOG_DBG(format, ...) sr_log(SR_LL_DBG, format, __VA_ARGS__)
+/* the level is checked before even evaluating the arguments */
+#define SR_LOG_WRN(format, ...) if (log_max_ll >= SR_LL_WRN) { sr_log(SR_LL_WRN, format, __VA_ARGS__); }
+#define SR_LOG_INF(format, ...) if (log_max_ll >= SR_LL_INF) { sr_log(SR_LL_INF, format, __VA_ARGS__); }
+#define SR_LOG_DBG(format, ...) if (log_max_ll >= SR_LL_DBG) { sr_log(SR_LL_DBG, format, __VA_ARGS__); }
 
-#define SR_LOG_WRNMSG(msg) sr_log(SR_LL_WRN, msg)
-#define SR_LOG_INFMSG(msg) sr_log(SR_LL_INF, msg)
-#define SR_LOG_DBGMSG(msg) sr_log(SR_LL_DBG, msg)
+#define SR_LOG_WRNMSG(msg) if (log_max_ll >= SR_LL_WRN) { sr_log(SR_LL_WRN, msg); }
+#define SR_LOG_INFMSG(msg) if (log_max_ll >= SR_LL_INF) { sr_log(SR_LL_INF, msg); }
+#define SR_LOG_DBGMSG(msg) if (log_max_ll >= SR_LL_DBG) { sr_log(SR_LL_DBG, msg); }
 
 #define SR_CHECK_MEM_GOTO(cond, err_info, go) if (cond) { SR_ERRINFO_MEM(&(err_info)); goto go; }
 #define SR_CHECK_MEM_RET(cond, err_info) if (cond) { SR_ERRINFO_MEM(&(err_info)); return err_info; }
@@ -54,6 +55,7 @@
 extern sr_log_level_t stderr_ll;  /**< stderr log level */
 extern sr_log_level_t syslog_ll;  /**< syslog log level */
 extern sr_log_cb log_cb;          /**< logging callback */
+extern sr_log_level_t log_max_ll; /**< maximum level of a printed message */
 
 /**
  * @brief Set error info to a session and return corresponding error code, if any.
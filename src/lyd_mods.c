@@ -49,6 +49,7 @@
 #include "../modules/ietf_origin_yang.h"
 
 static sr_error_info_t *sr_lydmods_add_data_deps_r(struct lyd_node *sr_mod, struct lys_node *data_root, struct lyd_node *sr_deps);
+static sr_error_info_t *sr_lydmods_unsched_del_module_r(struct lyd_node *sr_mods, const struct lys_module *ly_mod, int first);
 
 sr_error_info_t *
 sr_lydmods_exists(int *exists)
@@ -1607,9 +1608,403 @@ sr_lydmods_ctx_load_modules(const struct lyd_node *sr_mods, struct ly_ctx *ly_ct
     return NULL;
 }
 
+/**
+ * @brief Add a module name into a set, if not already there.
+ *
+ * @param[in] set Set of module names.
+ * @param[in] name Module name to add.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_name_set_add(struct ly_set *set, const char *name)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+
+    for (i = 0; i < set->number; ++i) {
+        if (!strcmp(set->set.g[i], name)) {
+            return NULL;
+        }
+    }
+
+    if (ly_set_add(set, (void *)name, LY_SET_OPT_USEASLIST) == -1) {
+        SR_ERRINFO_MEM(&err_info);
+    }
+    return err_info;
+}
+
+/**
+ * @brief Find sysrepo module data of a module.
+ *
+ * @param[in] sr_mods Sysrepo module data.
+ * @param[in] name Module name.
+ * @return Found sysrepo module, NULL if not found.
+ */
+static struct lyd_node *
+sr_lydmods_find_module(const struct lyd_node *sr_mods, const char *name)
+{
+    struct lyd_node *sr_mod;
+
+    LY_TREE_FOR(sr_mods->child, sr_mod) {
+        if (!strcmp(sr_mod->schema->name, "module") && !strcmp(sr_ly_leaf_value_str(sr_mod->child), name)) {
+            return sr_mod;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Add all implemented modules importing a module into a set.
+ *
+ * @param[in] ly_ctx Context to search in.
+ * @param[in] name Imported module name.
+ * @param[in] set Set of module names to add to.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_sched_add_importers(const struct ly_ctx *ly_ctx, const char *name, struct ly_set *set)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module *ly_mod;
+    uint32_t idx;
+    uint8_t i;
+
+    idx = 0;
+    while ((ly_mod = ly_ctx_get_module_iter(ly_ctx, &idx))) {
+        if (!ly_mod->implemented) {
+            continue;
+        }
+        for (i = 0; i < ly_mod->imp_size; ++i) {
+            if (!strcmp(ly_mod->imp[i].module->name, name)) {
+                if ((err_info = sr_lydmods_name_set_add(set, ly_mod->name))) {
+                    return err_info;
+                }
+                break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Add all implemented modules whose data may be changed by a module into a set.
+ * These are the targets of its augments and deviations.
+ *
+ * @param[in] ly_mod Module that may be augmenting or deviating other modules.
+ * @param[in] set Set of module names to add to.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_sched_add_targets(const struct lys_module *ly_mod, struct ly_set *set)
+{
+    sr_error_info_t *err_info = NULL;
+    uint8_t i;
+
+    for (i = 0; i < ly_mod->augment_size; ++i) {
+        if (ly_mod->augment[i].target
+                && (err_info = sr_lydmods_name_set_add(set, lys_node_module(ly_mod->augment[i].target)->name))) {
+            return err_info;
+        }
+    }
+
+    if (ly_mod->deviation_size) {
+        /* any implemented import may be deviated */
+        for (i = 0; i < ly_mod->imp_size; ++i) {
+            if (ly_mod->imp[i].module->implemented
+                    && (err_info = sr_lydmods_name_set_add(set, ly_mod->imp[i].module->name))) {
+                return err_info;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Learn all the modules whose data are affected by the scheduled changes. These are the modules
+ * being installed, updated, removed, or with changed features, all the implemented modules importing them
+ * (recursively), the targets of their augments and deviations, all their inverse data dependencies (recursively),
+ * and all the modules with instance-identifier data dependencies.
+ *
+ * @param[in] sr_mods Sysrepo module data.
+ * @param[in] old_ctx Context without any scheduled changes.
+ * @param[in] new_ctx Context with all scheduled module changes.
+ * @param[out] mod_set Set of names of all the affected modules.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_sched_affected_modules(const struct lyd_node *sr_mods, const struct ly_ctx *old_ctx,
+        const struct ly_ctx *new_ctx, struct ly_set **mod_set)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *sr_mod, *node, *dep;
+    const struct lys_module *ly_mod;
+    const char *name;
+    uint32_t i, changed_count;
+
+    *mod_set = ly_set_new();
+    SR_CHECK_MEM_RET(!*mod_set, err_info);
+
+    /* modules directly changed */
+    LY_TREE_FOR(sr_mods->child, sr_mod) {
+        name = sr_ly_leaf_value_str(sr_mod->child);
+        if (!strcmp(sr_mod->schema->name, "installed-module")) {
+            if ((err_info = sr_lydmods_name_set_add(*mod_set, name))) {
+                return err_info;
+            }
+            continue;
+        }
+
+        LY_TREE_FOR(sr_mod->child->next, node) {
+            if (!strcmp(node->schema->name, "removed") || !strcmp(node->schema->name, "updated-yang")
+                    || !strcmp(node->schema->name, "changed-feature")) {
+                if ((err_info = sr_lydmods_name_set_add(*mod_set, name))) {
+                    return err_info;
+                }
+                break;
+            }
+        }
+    }
+
+    /* modules importing them can use any of their definitions so their schema may have changed, too */
+    for (i = 0; i < (*mod_set)->number; ++i) {
+        name = (*mod_set)->set.g[i];
+        if ((err_info = sr_lydmods_sched_add_importers(old_ctx, name, *mod_set))) {
+            return err_info;
+        }
+        if ((err_info = sr_lydmods_sched_add_importers(new_ctx, name, *mod_set))) {
+            return err_info;
+        }
+    }
+
+    /* data of augmented and deviated modules change, too */
+    changed_count = (*mod_set)->number;
+    for (i = 0; i < changed_count; ++i) {
+        name = (*mod_set)->set.g[i];
+        ly_mod = ly_ctx_get_module(old_ctx, name, NULL, 1);
+        if (ly_mod && (err_info = sr_lydmods_sched_add_targets(ly_mod, *mod_set))) {
+            return err_info;
+        }
+        ly_mod = ly_ctx_get_module(new_ctx, name, NULL, 1);
+        if (ly_mod && (err_info = sr_lydmods_sched_add_targets(ly_mod, *mod_set))) {
+            return err_info;
+        }
+    }
+
+    /* finally, data of modules depending on any changed data need to be revalidated */
+    for (i = 0; i < (*mod_set)->number; ++i) {
+        sr_mod = sr_lydmods_find_module(sr_mods, (*mod_set)->set.g[i]);
+        if (!sr_mod) {
+            /* module being installed */
+            continue;
+        }
+
+        LY_TREE_FOR(sr_mod->child->next, node) {
+            if (!strcmp(node->schema->name, "inverse-data-deps")
+                    && (err_info = sr_lydmods_name_set_add(*mod_set, sr_ly_leaf_value_str(node)))) {
+                return err_info;
+            }
+        }
+    }
+
+    if (!(*mod_set)->number) {
+        /* nothing changed */
+        return NULL;
+    }
+
+    /* instance-identifiers are not among inverse data dependencies because they may reference any data,
+     * so data of all the modules with them need to be revalidated as well */
+    LY_TREE_FOR(sr_mods->child, sr_mod) {
+        if (strcmp(sr_mod->schema->name, "module")) {
+            continue;
+        }
+
+        LY_TREE_FOR(sr_mod->child->next, node) {
+            if (strcmp(node->schema->name, "data-deps")) {
+                continue;
+            }
+            LY_TREE_FOR(node->child, dep) {
+                if (!strcmp(dep->schema->name, "inst-id")) {
+                    break;
+                }
+            }
+            if (dep && (err_info = sr_lydmods_name_set_add(*mod_set, sr_ly_leaf_value_str(sr_mod->child)))) {
+                return err_info;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Learn all the modules whose data are needed for validating data of the affected modules.
+ *
+ * @param[in] sr_mods Sysrepo module data.
+ * @param[in] new_ctx Context with all scheduled module changes.
+ * @param[in] mod_set Set of names of all the affected modules.
+ * @param[out] dep_set Set of names of the modules depended on, that are not affected.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_sched_dep_modules(const struct lyd_node *sr_mods, const struct ly_ctx *new_ctx,
+        const struct ly_set *mod_set, struct ly_set **dep_set)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *sr_mod, *node, *dep;
+    const struct lys_module *ly_mod;
+    struct ly_set *set;
+    uint32_t i, j, idx;
+    int all = 0;
+
+    set = ly_set_new();
+    SR_CHECK_MEM_RET(!set, err_info);
+
+    for (i = 0; !all && (i < mod_set->number); ++i) {
+        /* stored data dependencies */
+        if ((sr_mod = sr_lydmods_find_module(sr_mods, mod_set->set.g[i]))) {
+            LY_TREE_FOR(sr_mod->child->next, node) {
+                if (strcmp(node->schema->name, "data-deps")) {
+                    continue;
+                }
+                LY_TREE_FOR(node->child, dep) {
+                    if (!strcmp(dep->schema->name, "inst-id")) {
+                        /* instance-identifiers may reference any data */
+                        all = 1;
+                        break;
+                    } else if ((err_info = sr_lydmods_name_set_add(set, sr_ly_leaf_value_str(dep)))) {
+                        goto cleanup;
+                    }
+                }
+            }
+        }
+
+        /* any other module referenced in the new schema must be imported */
+        ly_mod = ly_ctx_get_module(new_ctx, mod_set->set.g[i], NULL, 1);
+        for (j = 0; ly_mod && (j < ly_mod->imp_size); ++j) {
+            if (ly_mod->imp[j].module->implemented
+                    && (err_info = sr_lydmods_name_set_add(set, ly_mod->imp[j].module->name))) {
+                goto cleanup;
+            }
+        }
+    }
+
+    if (all) {
+        /* we need data of all the modules */
+        ly_set_clean(set);
+        idx = 0;
+        while ((ly_mod = ly_ctx_get_module_iter(new_ctx, &idx))) {
+            if (ly_mod->implemented && (err_info = sr_lydmods_name_set_add(set, ly_mod->name))) {
+                goto cleanup;
+            }
+        }
+    }
+
+    /* skip the affected modules themselves */
+    *dep_set = ly_set_new();
+    SR_CHECK_MEM_GOTO(!*dep_set, err_info, cleanup);
+    for (i = 0; i < set->number; ++i) {
+        for (j = 0; j < mod_set->number; ++j) {
+            if (!strcmp(set->set.g[i], mod_set->set.g[j])) {
+                break;
+            }
+        }
+        if ((j == mod_set->number) && (err_info = sr_lydmods_name_set_add(*dep_set, set->set.g[i]))) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    ly_set_free(set);
+    return err_info;
+}
+
+/**
+ * @brief Convert data of a module from the old context into the new updated context, skipping any unknown nodes.
+ *
+ * @param[in] old_data Module data in the old context.
+ * @param[in] new_ctx Context with all scheduled module changes.
+ * @param[out] new_data Module data in the new context.
+ * @return 0 on success, non-zero if the data could not be converted.
+ */
+static int
+sr_lydmods_sched_convert_data(const struct lyd_node *old_data, const struct ly_ctx *new_ctx, struct lyd_node **new_data)
+{
+    char *data_str = NULL;
+    int ret = 0;
+
+    *new_data = NULL;
+    if (!old_data) {
+        return 0;
+    }
+
+    /* LYB first, it is considerably faster */
+    if (lyd_print_mem(&data_str, old_data, LYD_LYB, LYP_WITHSIBLINGS)) {
+        return 1;
+    }
+    ly_errno = 0;
+    *new_data = lyd_parse_mem((struct ly_ctx *)new_ctx, data_str, LYD_LYB,
+            LYD_OPT_CONFIG | LYD_OPT_TRUSTED | LYD_OPT_LYB_MOD_UPDATE);
+    free(data_str);
+    data_str = NULL;
+    if (!ly_errno) {
+        return 0;
+    }
+    lyd_free_withsiblings(*new_data);
+    *new_data = NULL;
+
+    /* LYB data referencing a removed module cannot be parsed, use JSON instead */
+    if (lyd_print_mem(&data_str, old_data, LYD_JSON, LYP_WITHSIBLINGS)) {
+        return 1;
+    }
+    ly_errno = 0;
+    *new_data = lyd_parse_mem((struct ly_ctx *)new_ctx, data_str, LYD_JSON, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+    if (ly_errno) {
+        lyd_free_withsiblings(*new_data);
+        *new_data = NULL;
+        ret = 1;
+    }
+
+    free(data_str);
+    return ret;
+}
+
+/**
+ * @brief Load data of a module for a datastore, if they exist.
+ *
+ * @param[in] ly_mod Module to load the data of.
+ * @param[in] ds Datastore, startup or running.
+ * @param[in,out] data Data to append to.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_sched_load_data(const struct lys_module *ly_mod, sr_datastore_t ds, struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path;
+    int exists;
+
+    if (ds == SR_DS_RUNNING) {
+        /* check that running data file exists */
+        if ((err_info = sr_path_ds_shm(ly_mod->name, SR_DS_RUNNING, 1, &path))) {
+            return err_info;
+        }
+        exists = sr_file_exists(path);
+        free(path);
+        if (!exists) {
+            return NULL;
+        }
+    }
+
+    return sr_module_file_data_append(ly_mod, ds, data);
+}
+
 /**
  * @brief Check that persistent (startup) module data can be loaded into updated context.
- * On success print the new updated LYB data.
+ * On success print the new updated LYB data. Only the data of modules affected by the scheduled
+ * changes are migrated, files of all the other modules are left untouched.
  *
  * @param[in] sr_mods Sysrepo module data.
  * @param[in] new_ctx Context with all scheduled module changes.
@@ -1620,13 +2015,12 @@ static sr_error_info_t *
 sr_lydmods_sched_update_data(const struct lyd_node *sr_mods, const struct ly_ctx *new_ctx, int *fail)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *old_start_data = NULL, *new_start_data = NULL, *old_run_data = NULL, *new_run_data = NULL, *mod_data;
+    struct lyd_node *new_start_data = NULL, *new_run_data = NULL, *old_data = NULL, *mod_data, **data_p;
     struct ly_ctx *old_ctx = NULL;
-    struct ly_set *set = NULL, *startup_set = NULL;
-    const struct lys_module *ly_mod;
-    char *start_data_json = NULL, *run_data_json = NULL, *path;
+    struct ly_set *set = NULL, *startup_set = NULL, *mod_set = NULL, *dep_set = NULL;
+    const struct lys_module *ly_mod, **valid_mods = NULL;
+    sr_datastore_t ds;
     uint32_t idx;
-    int exists;
 
     set = ly_set_new();
     SR_CHECK_MEM_GOTO(!set, err_info, cleanup);
@@ -1639,31 +2033,43 @@ sr_lydmods_sched_update_data(const struct lyd_node *sr_mods, const struct ly_ctx
         goto cleanup;
     }
 
-    /* parse all the startup/running data using the old context (that must succeed) */
-    idx = 0;
-    while ((ly_mod = ly_ctx_get_module_iter(old_ctx, &idx))) {
-        if (!ly_mod->implemented) {
-            /* we need data of only implemented modules */
-            continue;
-        }
+    /* learn what module data need to be migrated and what are needed for their validation */
+    if ((err_info = sr_lydmods_sched_affected_modules(sr_mods, old_ctx, new_ctx, &mod_set))) {
+        goto cleanup;
+    }
+    if ((err_info = sr_lydmods_sched_dep_modules(sr_mods, new_ctx, mod_set, &dep_set))) {
+        goto cleanup;
+    }
 
-        /* append startup data */
-        if ((err_info = sr_module_file_data_append(ly_mod, SR_DS_STARTUP, &old_start_data))) {
-            goto cleanup;
+    /* parse the affected startup/running data using the old context (that must succeed) and convert them */
+    for (idx = 0; idx < mod_set->number; ++idx) {
+        ly_mod = ly_ctx_get_module(old_ctx, mod_set->set.g[idx], NULL, 1);
+        if (!ly_mod) {
+            /* module being installed */
+            continue;
         }
 
-        /* check that running data file exists */
-        if ((err_info = sr_path_ds_shm(ly_mod->name, SR_DS_RUNNING, 1, &path))) {
-            goto cleanup;
-        }
-        exists = sr_file_exists(path);
-        free(path);
+        for (ds = SR_DS_STARTUP; ds <= SR_DS_RUNNING; ++ds) {
+            if ((err_info = sr_lydmods_sched_load_data(ly_mod, ds, &old_data))) {
+                goto cleanup;
+            }
 
-        if (exists) {
-            /* append running data */
-            if ((err_info = sr_module_file_data_append(ly_mod, SR_DS_RUNNING, &old_run_data))) {
+            /* try to load it into the new updated context skipping any unknown nodes */
+            if (sr_lydmods_sched_convert_data(old_data, new_ctx, &mod_data)) {
+                /* it failed, some of the scheduled changes are not compatible with the stored data, abort them all */
+                sr_log_wrn_ly((struct ly_ctx *)new_ctx);
+                *fail = 1;
                 goto cleanup;
             }
+            lyd_free_withsiblings(old_data);
+            old_data = NULL;
+
+            data_p = (ds == SR_DS_STARTUP) ? &new_start_data : &new_run_data;
+            if (*data_p && mod_data) {
+                sr_ly_link(*data_p, mod_data);
+            } else if (mod_data) {
+                *data_p = mod_data;
+            }
         }
 
         /* remember this module from the new context */
@@ -1674,31 +2080,6 @@ sr_lydmods_sched_update_data(const struct lyd_node *sr_mods, const struct ly_ctx
         } /* else the module was removed */
     }
 
-    /* print the data of all the modules into JSON */
-    if (lyd_print_mem(&start_data_json, old_start_data, LYD_JSON, LYP_WITHSIBLINGS)) {
-        sr_errinfo_new_ly(&err_info, old_ctx);
-        goto cleanup;
-    }
-    if (lyd_print_mem(&run_data_json, old_run_data, LYD_JSON, LYP_WITHSIBLINGS)) {
-        sr_errinfo_new_ly(&err_info, old_ctx);
-        goto cleanup;
-    }
-
-    /* try to load it into the new updated context skipping any unknown nodes */
-    ly_errno = 0;
-    new_start_data = lyd_parse_mem((struct ly_ctx *)new_ctx, start_data_json, LYD_JSON,
-            LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
-    if (!ly_errno) {
-        new_run_data = lyd_parse_mem((struct ly_ctx *)new_ctx, run_data_json, LYD_JSON,
-            LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
-    }
-    if (ly_errno) {
-        /* it failed, some of the scheduled changes are not compatible with the stored data, abort them all */
-        sr_log_wrn_ly((struct ly_ctx *)new_ctx);
-        *fail = 1;
-        goto cleanup;
-    }
-
     /* check that any startup data can be loaded and are valid */
     startup_set = lyd_find_path(sr_mods, "installed-module/data");
     if (!startup_set) {
@@ -1734,15 +2115,36 @@ sr_lydmods_sched_update_data(const struct lyd_node *sr_mods, const struct ly_ctx
         }
     }
 
-    /* fully validate complete startup and running datastore */
-    if (lyd_validate(&new_start_data, LYD_OPT_CONFIG, (void *)new_ctx) ||
-            lyd_validate(&new_run_data, LYD_OPT_CONFIG, (void *)new_ctx)) {
-        sr_log_wrn_ly((struct ly_ctx *)new_ctx);
-        *fail = 1;
-        goto cleanup;
+    if (set->number) {
+        /* add data of the unaffected modules the migrated data depend on, their schema did not change */
+        for (idx = 0; idx < dep_set->number; ++idx) {
+            ly_mod = ly_ctx_get_module(new_ctx, dep_set->set.g[idx], NULL, 1);
+            if (!ly_mod) {
+                continue;
+            }
+            if ((err_info = sr_lydmods_sched_load_data(ly_mod, SR_DS_STARTUP, &new_start_data))) {
+                goto cleanup;
+            }
+            if ((err_info = sr_lydmods_sched_load_data(ly_mod, SR_DS_RUNNING, &new_run_data))) {
+                goto cleanup;
+            }
+        }
+
+        /* fully validate the migrated startup and running data */
+        valid_mods = malloc(set->number * sizeof *valid_mods);
+        SR_CHECK_MEM_GOTO(!valid_mods, err_info, cleanup);
+        for (idx = 0; idx < set->number; ++idx) {
+            valid_mods[idx] = set->set.g[idx];
+        }
+        if (lyd_validate_modules(&new_start_data, valid_mods, set->number, LYD_OPT_CONFIG) ||
+                lyd_validate_modules(&new_run_data, valid_mods, set->number, LYD_OPT_CONFIG)) {
+            sr_log_wrn_ly((struct ly_ctx *)new_ctx);
+            *fail = 1;
+            goto cleanup;
+        }
     }
 
-    /* print all modules data with the updated module context and free them, no longer needed */
+    /* print migrated modules data with the updated module context, others are kept as they are */
     for (idx = 0; idx < set->number; ++idx) {
         ly_mod = (struct lys_module *)set->set.g[idx];
 
@@ -1766,14 +2168,14 @@ sr_lydmods_sched_update_data(const struct lyd_node *sr_mods, const struct ly_ctx
     /* success */
 
 cleanup:
+    free(valid_mods);
     ly_set_free(set);
     ly_set_free(startup_set);
-    lyd_free_withsiblings(old_start_data);
+    ly_set_free(mod_set);
+    ly_set_free(dep_set);
+    lyd_free_withsiblings(old_data);
     lyd_free_withsiblings(new_start_data);
-    lyd_free_withsiblings(old_run_data);
     lyd_free_withsiblings(new_run_data);
-    free(start_data_json);
-    free(run_data_json);
     ly_ctx_destroy(old_ctx, NULL);
     if (err_info) {
         sr_errinfo_new(&err_info, SR_ERR_OPERATION_FAILED, NULL, "Failed to update data for the new context.");
@@ -2106,20 +2508,26 @@ cleanup:
     return err_info;
 }
 
-sr_error_info_t *
-sr_lydmods_deferred_add_module(struct ly_ctx *ly_ctx, const struct lys_module *ly_mod, const char **features, int feat_count)
+/**
+ * @brief Schedule module installation to sysrepo module data.
+ *
+ * @param[in] sr_mods Sysrepo module data to modify.
+ * @param[in] ly_mod Module that is scheduled to be installed.
+ * @param[in] features Array of enabled features.
+ * @param[in] feat_count Number of enabled features.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_lydmods_deferred_add_module_info(struct lyd_node *sr_mods, const struct lys_module *ly_mod, const char **features,
+        int feat_count)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *sr_mods = NULL, *inst_mod;
+    struct ly_ctx *ly_ctx = lyd_node_module(sr_mods)->ctx;
+    struct lyd_node *inst_mod;
     struct ly_set *set = NULL;
     char *path = NULL, *yang_str = NULL;
     int i;
 
-    /* parse current module information */
-    if ((err_info = sr_lydmods_parse(ly_ctx, &sr_mods))) {
-        goto cleanup;
-    }
-
     /* check that the module is not already marked for installation */
     if (asprintf(&path, "installed-module[name=\"%s\"]", ly_mod->name) == -1) {
         SR_ERRINFO_MEM(&err_info);
@@ -2161,17 +2569,64 @@ sr_lydmods_deferred_add_module(struct ly_ctx *ly_ctx, const struct lys_module *l
         goto cleanup;
     }
 
+cleanup:
+    free(path);
+    free(yang_str);
+    ly_set_free(set);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_lydmods_deferred_add_modules(struct ly_ctx *ly_ctx, const struct lys_module **ly_mods, uint32_t mod_count,
+        const char ***features, const int *feat_counts, const struct lys_module **inst_mods, uint32_t inst_count,
+        uint32_t *skip_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *sr_mods = NULL;
+    uint32_t i;
+
+    *skip_count = 0;
+
+    /* parse current module information */
+    if ((err_info = sr_lydmods_parse(ly_ctx, &sr_mods))) {
+        goto cleanup;
+    }
+
+    /* unschedule deletion of the installed modules, if scheduled */
+    for (i = 0; i < inst_count; ++i) {
+        err_info = sr_lydmods_unsched_del_module_r(sr_mods, inst_mods[i], 1);
+        if (err_info && (err_info->err_code == SR_ERR_NOT_FOUND)) {
+            /* the module is installed and staying, nothing to do */
+            sr_errinfo_free(&err_info);
+            SR_LOG_INF("Module \"%s\" is already in sysrepo.", inst_mods[i]->name);
+            ++(*skip_count);
+        } else if (err_info) {
+            goto cleanup;
+        }
+    }
+
+    if (*skip_count == mod_count + inst_count) {
+        /* nothing changed */
+        goto cleanup;
+    }
+
+    /* add all the modules */
+    for (i = 0; i < mod_count; ++i) {
+        if ((err_info = sr_lydmods_deferred_add_module_info(sr_mods, ly_mods[i], features[i], feat_counts[i]))) {
+            goto cleanup;
+        }
+    }
+
     /* store the updated persistent data tree */
     if ((err_info = sr_lydmods_print(&sr_mods))) {
         goto cleanup;
     }
 
-    SR_LOG_INF("Module \"%s\" scheduled for installation.", ly_mod->name);
+    for (i = 0; i < mod_count; ++i) {
+        SR_LOG_INF("Module \"%s\" scheduled for installation.", ly_mods[i]->name);
+    }
 
 cleanup:
-    free(path);
-    free(yang_str);
-    ly_set_free(set);
     lyd_free_withsiblings(sr_mods);
     return err_info;
 }
@@ -2409,30 +2864,6 @@ cleanup:
     return err_info;
 }
 
-sr_error_info_t *
-sr_lydmods_unsched_del_module_with_imps(struct ly_ctx *ly_ctx, const struct lys_module *ly_mod)
-{
-    sr_error_info_t *err_info = NULL;
-    struct lyd_node *sr_mods = NULL;
-
-    /* parse current module information */
-    if ((err_info = sr_lydmods_parse(ly_ctx, &sr_mods))) {
-        goto cleanup;
-    }
-
-    /* try to unschedule deletion */
-    if ((err_info = sr_lydmods_unsched_del_module_r(sr_mods, ly_mod, 1))) {
-        goto cleanup;
-    }
-
-    /* store the updated persistent data tree */
-    err_info = sr_lydmods_print(&sr_mods);
-
-cleanup:
-    lyd_free_withsiblings(sr_mods);
-    return err_info;
-}
-
 sr_error_info_t *
 sr_lydmods_deferred_upd_module(struct ly_ctx *ly_ctx, const struct lys_module *ly_upd_mod)
 {
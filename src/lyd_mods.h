@@ -88,16 +88,22 @@ sr_error_info_t *sr_lydmods_ctx_load_modules(const struct lyd_node *sr_mods, str
 sr_error_info_t *sr_lydmods_sched_apply(struct lyd_node *sr_mods, struct ly_ctx *new_ctx, int *change, int *fail);
 
 /**
- * @brief Schedule module installation to sysrepo module data.
+ * @brief Schedule installation of modules to sysrepo module data and unschedule deletion of already
+ * installed modules, all at once. Nothing is changed on error.
  *
  * @param[in] ly_ctx Context to use for parsing the data.
- * @param[in] ly_mod Module that is scheduled to be installed.
- * @param[in] features Array of enabled features.
- * @param[in] feat_count Number of enabled features.
+ * @param[in] ly_mods Modules that are scheduled to be installed.
+ * @param[in] mod_count Count of @p ly_mods.
+ * @param[in] features Array of enabled features for every module.
+ * @param[in] feat_counts Number of enabled features for every module.
+ * @param[in] inst_mods Already installed modules whose deletion to unschedule (with any implemented dependencies).
+ * @param[in] inst_count Count of @p inst_mods.
+ * @param[out] skip_count Number of @p inst_mods not scheduled for deletion, which were skipped.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_lydmods_deferred_add_module(struct ly_ctx *ly_ctx, const struct lys_module *ly_mod, const char **features,
-        int feat_count);
+sr_error_info_t *sr_lydmods_deferred_add_modules(struct ly_ctx *ly_ctx, const struct lys_module **ly_mods, uint32_t mod_count,
+        const char ***features, const int *feat_counts, const struct lys_module **inst_mods, uint32_t inst_count,
+        uint32_t *skip_count);
 
 /**
  * @brief Unschedule module installation from sysrepo module data.
@@ -140,15 +146,6 @@ sr_error_info_t *sr_lydmods_deferred_add_module_data(struct lyd_node *sr_mods, c
  */
 sr_error_info_t *sr_lydmods_deferred_del_module(struct ly_ctx *ly_ctx, const char *mod_name);
 
-/**
- * @brief Unschedule module deletion from sysrepo module data.
- *
- * @param[in] ly_ctx Context to use for parsing the data.
- * @param[in] ly_mod Module that is scheduled to be deleted.
- * @return err_info, NULL on success.
- */
-sr_error_info_t *sr_lydmods_unsched_del_module_with_imps(struct ly_ctx *ly_ctx, const struct lys_module *ly_mod);
-
 /**
  * @brief Schedule module update to sysrepo module data.
  *
@@ -23,24 +23,77 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <assert.h>
 #include <unistd.h>
 #include <inttypes.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <libyang/libyang.h>
 
+/**
+ * @brief Comparator function for qsort of mod info modules.
+ *
+ * @param[in] ptr1 First value pointer.
+ * @param[in] ptr2 Second value pointer.
+ * @return Less than, equal to, or greater than 0 if the first value is found
+ * to be less than, equal to, or greater to the second value.
+ */
+static int
+sr_modinfo_qsort_cmp(const void *ptr1, const void *ptr2)
+{
+    struct sr_mod_info_mod_s *mod1, *mod2;
+
+    mod1 = (struct sr_mod_info_mod_s *)ptr1;
+    mod2 = (struct sr_mod_info_mod_s *)ptr2;
+
+    if (mod1->shm_mod > mod2->shm_mod) {
+        return 1;
+    }
+    if (mod1->shm_mod < mod2->shm_mod) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Learn the mod info type of a module from a dependency closure.
+ *
+ * @param[in] flags Closure flags of the module.
+ * @param[in] need_dep Whether data dependencies are needed.
+ * @param[in] need_inv_dep Whether inverse data dependencies (and their data dependencies) are needed.
+ * @return Mod info module type, 0 if the module is not needed.
+ */
+static int
+sr_modinfo_closure_type(uint32_t flags, int need_dep, int need_inv_dep)
+{
+    if (need_inv_dep && (flags & SR_MOD_CLOSURE_INV_DEP)) {
+        return MOD_INFO_INV_DEP;
+    }
+    if (need_dep && (flags & SR_MOD_CLOSURE_DEP)) {
+        return MOD_INFO_DEP;
+    }
+    if (need_inv_dep && (flags & SR_MOD_CLOSURE_INV_DEP_DEP)) {
+        return MOD_INFO_DEP;
+    }
+    return 0;
+}
+
 sr_error_info_t *
 sr_modinfo_add_mod(sr_mod_t *shm_mod, const struct lys_module *ly_mod, int mod_type, int mod_req_deps,
         struct sr_mod_info_s *mod_info)
 {
-    sr_mod_t *dep_mod;
-    sr_mod_data_dep_t *shm_deps;
-    off_t *shm_inv_deps;
-    uint16_t i, cur_i;
-    int prev_mod_type = 0;
     sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = mod_info->conn;
+    struct sr_mod_info_mod_s *mods;
+    sr_mod_t *first_shm_mod, *dep_mod;
+    sr_mod_closure_t *shm_closure;
+    const struct lys_module *dep_ly_mod;
+    uint32_t i, new_count;
+    uint16_t c;
+    int prev_mod_type = 0, dep_type, need_dep, need_inv_dep, self_done;
 
     assert((mod_type == MOD_INFO_REQ) || (mod_type == MOD_INFO_DEP) || (mod_type == MOD_INFO_INV_DEP));
     assert(!mod_req_deps || (mod_req_deps == MOD_INFO_DEP) || (mod_req_deps == (MOD_INFO_DEP | MOD_INFO_INV_DEP)));
@@ -50,82 +103,111 @@ sr_modinfo_add_mod(sr_mod_t *shm_mod, const struct lys_module *ly_mod, int mod_t
         if (mod_info->mods[i].shm_mod == shm_mod) {
             /* already there */
             if ((mod_info->mods[i].state & MOD_INFO_TYPE_MASK) < mod_type) {
-                /* update module type and remember the previous one, add whatever new dependencies are necessary */
+                /* update module type, add whatever new dependencies are necessary */
                 prev_mod_type = mod_info->mods[i].state;
-                mod_info->mods[i].state = mod_type;
                 break;
             }
             return NULL;
         }
     }
-    cur_i = i;
 
-    if (prev_mod_type < MOD_INFO_DEP) {
-        /* add it */
-        ++mod_info->mod_count;
-        mod_info->mods = sr_realloc(mod_info->mods, mod_info->mod_count * sizeof *mod_info->mods);
+    if (!mod_req_deps) {
+        if (prev_mod_type) {
+            /* just update its type */
+            mod_info->mods[i].state = mod_type;
+            return NULL;
+        }
+
+        /* just add it at the end */
+        mod_info->mods = sr_realloc(mod_info->mods, (mod_info->mod_count + 1) * sizeof *mod_info->mods);
         SR_CHECK_MEM_RET(!mod_info->mods, err_info);
-        memset(&mod_info->mods[cur_i], 0, sizeof *mod_info->mods);
 
-        /* fill basic attributes */
-        mod_info->mods[cur_i].shm_mod = shm_mod;
-        mod_info->mods[cur_i].state = mod_type;
-        mod_info->mods[cur_i].ly_mod = ly_mod;
+        memset(&mod_info->mods[mod_info->mod_count], 0, sizeof *mod_info->mods);
+        mod_info->mods[mod_info->mod_count].shm_mod = shm_mod;
+        mod_info->mods[mod_info->mod_count].state = mod_type;
+        mod_info->mods[mod_info->mod_count].ly_mod = ly_mod;
+        ++mod_info->mod_count;
+        return NULL;
     }
 
-    if (!(mod_req_deps & MOD_INFO_DEP) || (mod_info->mods[cur_i].state < MOD_INFO_INV_DEP)) {
-        /* we do not need recursive dependencies of this module */
-        return NULL;
+    /* learn which parts of its precomputed dependency closure are needed */
+    need_dep = (mod_type >= MOD_INFO_INV_DEP) && (prev_mod_type < MOD_INFO_INV_DEP);
+    need_inv_dep = (mod_req_deps & MOD_INFO_INV_DEP) && (mod_type == MOD_INFO_REQ) && (prev_mod_type < MOD_INFO_REQ);
+
+    /* modules are kept sorted by their SHM offsets for a uniform locking order, merging requires it */
+    for (i = 1; i < mod_info->mod_count; ++i) {
+        if (mod_info->mods[i - 1].shm_mod > mod_info->mods[i].shm_mod) {
+            qsort(mod_info->mods, mod_info->mod_count, sizeof *mod_info->mods, sr_modinfo_qsort_cmp);
+            break;
+        }
     }
 
-    if (prev_mod_type < MOD_INFO_INV_DEP) {
-        /* add all its dependencies, recursively */
-        shm_deps = (sr_mod_data_dep_t *)(mod_info->conn->ext_shm.addr + shm_mod->data_deps);
-        for (i = 0; i < shm_mod->data_dep_count; ++i) {
-            if (shm_deps[i].type == SR_DEP_INSTID) {
-                /* we will handle those once we have the final data tree */
+    mods = malloc((mod_info->mod_count + shm_mod->dep_closure_count + 1) * sizeof *mods);
+    SR_CHECK_MEM_RET(!mods, err_info);
+
+    /* merge the module and its closure, which is sorted as well, into the modules */
+    first_shm_mod = SR_FIRST_SHM_MOD(conn->main_shm.addr);
+    shm_closure = (sr_mod_closure_t *)(conn->ext_shm.addr + shm_mod->dep_closure);
+    i = 0;
+    new_count = 0;
+    c = 0;
+    self_done = 0;
+    while (!self_done || (c < shm_mod->dep_closure_count)) {
+        /* next module to merge */
+        if (!self_done && ((c == shm_mod->dep_closure_count) || (shm_mod < first_shm_mod + shm_closure[c].mod_idx))) {
+            dep_mod = shm_mod;
+            dep_type = mod_type;
+            dep_ly_mod = ly_mod;
+            self_done = 1;
+        } else {
+            dep_mod = first_shm_mod + shm_closure[c].mod_idx;
+            dep_type = sr_modinfo_closure_type(shm_closure[c].flags, need_dep, need_inv_dep);
+            dep_ly_mod = NULL;
+            ++c;
+            if (!dep_type) {
                 continue;
             }
+        }
 
-            /* find the dependency */
-            dep_mod = sr_shmmain_find_module(&mod_info->conn->main_shm, NULL, NULL, shm_deps[i].module);
-            SR_CHECK_INT_RET(!dep_mod, err_info);
+        /* copy all the preceding modules */
+        while ((i < mod_info->mod_count) && (mod_info->mods[i].shm_mod < dep_mod)) {
+            mods[new_count++] = mod_info->mods[i++];
+        }
 
+        if ((i < mod_info->mod_count) && (mod_info->mods[i].shm_mod == dep_mod)) {
+            /* already there, update its type */
+            mods[new_count] = mod_info->mods[i++];
+            if ((mods[new_count].state & MOD_INFO_TYPE_MASK) < dep_type) {
+                mods[new_count].state = dep_type;
+            }
+        } else {
             /* find ly module */
-            ly_mod = ly_ctx_get_module(ly_mod->ctx, mod_info->conn->ext_shm.addr + dep_mod->name, NULL, 1);
-            SR_CHECK_INT_RET(!ly_mod, err_info);
-
-            /* add dependency */
-            if ((err_info = sr_modinfo_add_mod(dep_mod, ly_mod, MOD_INFO_DEP, mod_req_deps, mod_info))) {
-                return err_info;
+            if (!dep_ly_mod) {
+                dep_ly_mod = sr_shmmain_ly_mod(conn, ly_mod->ctx, dep_mod);
+                if (!dep_ly_mod) {
+                    free(mods);
+                    SR_ERRINFO_INT(&err_info);
+                    return err_info;
+                }
             }
+
+            /* add it */
+            memset(&mods[new_count], 0, sizeof *mods);
+            mods[new_count].shm_mod = dep_mod;
+            mods[new_count].state = dep_type;
+            mods[new_count].ly_mod = dep_ly_mod;
         }
+        ++new_count;
     }
 
-    if (!(mod_req_deps & MOD_INFO_INV_DEP) || (mod_info->mods[cur_i].state < MOD_INFO_REQ)) {
-        /* we do not need inverse dependencies of this module, its data will not be changed */
-        return NULL;
+    /* copy the rest */
+    while (i < mod_info->mod_count) {
+        mods[new_count++] = mod_info->mods[i++];
     }
 
-     if (prev_mod_type < MOD_INFO_REQ) {
-         /* add all inverse dependencies (modules dependening on this module) */
-         shm_inv_deps = (off_t *)(mod_info->conn->ext_shm.addr + shm_mod->inv_data_deps);
-         for (i = 0; i < shm_mod->inv_data_dep_count; ++i) {
-            /* find ly module */
-            ly_mod = ly_ctx_get_module(ly_mod->ctx, mod_info->conn->ext_shm.addr + shm_inv_deps[i], NULL, 1);
-            SR_CHECK_INT_RET(!ly_mod, err_info);
-
-            /* find SHM module */
-            dep_mod = sr_shmmain_find_module(&mod_info->conn->main_shm, NULL, NULL, shm_inv_deps[i]);
-            SR_CHECK_INT_RET(!dep_mod, err_info);
-
-            /* add inverse dependency */
-            if ((err_info = sr_modinfo_add_mod(dep_mod, ly_mod, MOD_INFO_INV_DEP, mod_req_deps, mod_info))) {
-                return err_info;
-            }
-         }
-     }
-
+    free(mod_info->mods);
+    mod_info->mods = mods;
+    mod_info->mod_count = new_count;
     return NULL;
 }
 
@@ -291,11 +373,14 @@ sr_modinfo_diff_merge(struct sr_mod_info_s *mod_info, const struct lyd_node *new
  *
  * @param[in] data Data tree.
  * @param[in] ly_mod libyang module of interest.
+ * @param[in] name Optional name of the only top-level node to duplicate.
+ * @param[in] len Length of @p name.
  * @param[out] mod_data Duplicated module data.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_module_data_dup(const struct lyd_node *data, const struct lys_module *ly_mod, struct lyd_node **mod_data)
+sr_module_data_dup(const struct lyd_node *data, const struct lys_module *ly_mod, const char *name, int len,
+        struct lyd_node **mod_data)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *dup;
@@ -305,7 +390,8 @@ sr_module_data_dup(const struct lyd_node *data, const struct lys_module *ly_mod,
     *mod_data = NULL;
 
     LY_TREE_FOR(data, node) {
-        if (lyd_node_module(node) == ly_mod) {
+        if ((lyd_node_module(node) == ly_mod) && (!name || (!strncmp(node->schema->name, name, len)
+                && !node->schema->name[len]))) {
             /* duplicate node */
             dup = lyd_dup(node, LYD_DUP_OPT_RECURSIVE | LYD_DUP_OPT_WITH_WHEN);
             if (!dup) {
@@ -487,6 +573,68 @@ sr_xpath_oper_data_predicate_required(const char *pred1, int len1, const char *p
     return 0;
 }
 
+/**
+ * @brief Learn the depth of a simple absolute XPath, which is a path of node names with optional
+ * predicates that do not reference any other nodes.
+ *
+ * @param[in] xpath XPath to examine.
+ * @return Number of nodes in the XPath, 0 if it is not a simple XPath.
+ */
+static uint32_t
+sr_xpath_simple_depth(const char *xpath)
+{
+    const char *mod, *name, *pred, *ptr;
+    int mlen, len, plen, dslash, has_pred;
+    uint32_t depth = 0;
+    char quote;
+
+    if (!xpath || (xpath[0] != '/')) {
+        return 0;
+    }
+
+    while (xpath[0]) {
+        if (xpath[0] != '/') {
+            /* some other expression follows */
+            return 0;
+        }
+
+        xpath = sr_xpath_next_name(xpath, &mod, &mlen, &name, &len, &dslash, &has_pred);
+        if (dslash || !len) {
+            return 0;
+        }
+
+        /* only plain node names, no wildcards, abbreviated steps, or operators */
+        for (ptr = (mod ? mod : name); ptr < name + len; ++ptr) {
+            if (!isalnum(ptr[0]) && (ptr[0] != '_') && (ptr[0] != '-') && (ptr[0] != ':')
+                    && ((ptr[0] != '.') || (ptr == name))) {
+                return 0;
+            }
+        }
+        ++depth;
+
+        while (xpath[0] == '[') {
+            xpath = sr_xpath_next_predicate(xpath, &pred, &plen, NULL);
+            if (!xpath) {
+                return 0;
+            }
+
+            /* predicates must not reference other nodes */
+            quote = 0;
+            for (ptr = pred; ptr < pred + plen; ++ptr) {
+                if (quote && (ptr[0] == quote)) {
+                    quote = 0;
+                } else if (!quote && ((ptr[0] == '\'') || (ptr[0] == '\"'))) {
+                    quote = ptr[0];
+                } else if (!quote && ((ptr[0] == '/') || (ptr[0] == '('))) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    return depth;
+}
+
 /**
  * @brief Check whether operational data are required.
  *
@@ -584,17 +732,18 @@ sr_xpath_oper_data_required(const char *request_xpath, const char *sub_xpath)
  * @param[in] xpath XPath of the provided data.
  * @param[in] request_xpath XPath of the data request.
  * @param[in] sid Sysrepo session ID.
- * @param[in] evpipe_num Subscriber event pipe number.
+ * @param[in] shm_msub SHM subscription.
  * @param[in] parent Data parent required for the subscription, NULL if top-level.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] stats Module operational statistics to update.
  * @param[out] data Data tree with appended operational data.
  * @param[out] cb_error_info Callback error info returned by the client, if any.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_xpath_oper_data_get(const struct lys_module *ly_mod, const char *xpath, const char *request_xpath, sr_sid_t sid,
-        uint32_t evpipe_num, const struct lyd_node *parent, uint32_t timeout_ms, struct lyd_node **oper_data,
-        sr_error_info_t **cb_error_info)
+        sr_mod_oper_sub_t *shm_msub, const struct lyd_node *parent, uint32_t timeout_ms, sr_stats_event_t *stats,
+        struct lyd_node **oper_data, sr_error_info_t **cb_error_info)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *parent_dup = NULL, *last_parent;
@@ -625,10 +774,11 @@ sr_xpath_oper_data_get(const struct lys_module *ly_mod, const char *xpath, const
     }
 
     /* get data from client */
-    if ((err_info = sr_shmsub_oper_notify(ly_mod, xpath, request_xpath, parent_dup, sid, evpipe_num, timeout_ms,
-            oper_data, cb_error_info))) {
+    if ((err_info = sr_shmsub_oper_notify(ly_mod, xpath, request_xpath, parent_dup, sid, shm_msub->evpipe_num,
+            timeout_ms, stats, oper_data, cb_error_info))) {
         goto cleanup;
     }
+    ATOMIC_INC_RELAXED(shm_msub->events);
 
     /* add default state data so that parents exist and we ask for descendants
      * that can exist (it should not fail with TRUSTED flag, we do not care even if it does) */
@@ -650,6 +800,7 @@ cleanup:
  * @param[in] oper_parent Operational parent of the data to retrieve. NULL for top-level.
  * @param[in] sid Sysrepo session ID.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] stats Module operational statistics to update.
  * @param[in,out] data Operational data tree.
  * @param[out] cb_error_info Callback error info returned by the client, if any.
  * @return err_info, NULL on success.
@@ -657,14 +808,14 @@ cleanup:
 static sr_error_info_t *
 sr_xpath_oper_data_append(sr_mod_oper_sub_t *shm_msub, const struct lys_module *ly_mod, const char *sub_xpath,
         const char *request_xpath, struct lyd_node *oper_parent, sr_sid_t sid, uint32_t timeout_ms,
-        struct lyd_node **data, sr_error_info_t **cb_error_info)
+        sr_stats_event_t *stats, struct lyd_node **data, sr_error_info_t **cb_error_info)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *oper_data;
 
     /* get oper data from the client */
-    if ((err_info = sr_xpath_oper_data_get(ly_mod, sub_xpath, request_xpath, sid, shm_msub->evpipe_num,
-            oper_parent, timeout_ms, &oper_data, cb_error_info))) {
+    if ((err_info = sr_xpath_oper_data_get(ly_mod, sub_xpath, request_xpath, sid, shm_msub, oper_parent,
+            timeout_ms, stats, &oper_data, cb_error_info))) {
         return err_info;
     }
 
@@ -681,12 +832,50 @@ sr_xpath_oper_data_append(sr_mod_oper_sub_t *shm_msub, const struct lys_module *
 }
 
 /**
- * @brief Update (replace or append) operational data for a specific module.
+ * @brief Apply stored operational data (diff) of a specific module.
+ *
+ * @param[in] mod Mod info module to process.
+ * @param[in] opts Get oper data options.
+ * @param[in,out] data Operational data tree.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_module_oper_data_load_stored(struct sr_mod_info_mod_s *mod, sr_get_oper_options_t opts, struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *diff = NULL;
+
+    if (opts & SR_OPER_NO_STORED) {
+        /* nothing to do */
+        return NULL;
+    }
+
+    /* apply stored operational diff */
+    if ((err_info = sr_module_file_data_append(mod->ly_mod, SR_DS_OPERATIONAL, &diff))) {
+        return err_info;
+    }
+    err_info = sr_diff_mod_apply(diff, mod->ly_mod, opts & SR_OPER_WITH_ORIGIN, data);
+    lyd_free_withsiblings(diff);
+    if (err_info) {
+        return err_info;
+    }
+
+    if (!*data) {
+        /* add possible default state data nodes */
+        lyd_validate_modules(data, &mod->ly_mod, 1, LYD_OPT_DATA | LYD_OPT_TRUSTED);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Update (replace or append) operational data for a specific module with data from subscribers.
  *
  * @param[in] mod Mod info module to process.
  * @param[in] sid Sysrepo session ID.
  * @param[in] request_xpath XPath of the data request.
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] max_depth Maximum depth of the requested data, 0 for unlimited.
+ * @param[in] conn Connection to use.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
  * @param[in] opts Get oper data options.
  * @param[in,out] data Operational data tree.
@@ -694,33 +883,17 @@ sr_xpath_oper_data_append(sr_mod_oper_sub_t *shm_msub, const struct lys_module *
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, sr_sid_t *sid, const char *request_xpath, char *ext_shm_addr,
-        uint32_t timeout_ms, sr_get_oper_options_t opts, struct lyd_node **data, sr_error_info_t **cb_error_info)
+sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, sr_sid_t *sid, const char *request_xpath,
+        uint32_t max_depth, sr_conn_ctx_t *conn, uint32_t timeout_ms, sr_get_oper_options_t opts, struct lyd_node **data,
+        sr_error_info_t **cb_error_info)
 {
     sr_error_info_t *err_info = NULL;
     sr_mod_oper_sub_t *shm_msub;
     const char *sub_xpath;
-    char *parent_xpath = NULL;
+    char *parent_xpath = NULL, *ext_shm_addr;
     uint16_t i, j;
+    uint32_t req_depth, sub_depth;
     struct ly_set *set = NULL;
-    struct lyd_node *diff = NULL;
-
-    if (!(opts & SR_OPER_NO_STORED)) {
-        /* apply stored operational diff */
-        if ((err_info = sr_module_file_data_append(mod->ly_mod, SR_DS_OPERATIONAL, &diff))) {
-            return err_info;
-        }
-        err_info = sr_diff_mod_apply(diff, mod->ly_mod, opts & SR_OPER_WITH_ORIGIN, data);
-        lyd_free_withsiblings(diff);
-        if (err_info) {
-            return err_info;
-        }
-
-        if (!*data) {
-            /* add possible default state data nodes */
-            lyd_validate_modules(data, &mod->ly_mod, 1, LYD_OPT_DATA | LYD_OPT_TRUSTED);
-        }
-    }
 
     if (opts & SR_OPER_NO_SUBS) {
         /* do not get data from subscribers */
@@ -729,6 +902,15 @@ sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, sr_sid_t *sid, const c
 
     assert(sid && timeout_ms && cb_error_info);
 
+    /* learn the deepest node that can be returned, if known */
+    req_depth = max_depth ? sr_xpath_simple_depth(request_xpath) : 0;
+
+    /* MOD SUBS READ LOCK (held while the subscribers are being asked, they must not change) */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+    ext_shm_addr = conn->ext_shm.addr;
+
     /* XPaths are ordered based on depth */
     for (i = 0; i < mod->shm_mod->oper_sub_count; ++i) {
         shm_msub = &((sr_mod_oper_sub_t *)(ext_shm_addr + mod->shm_mod->oper_subs))[i];
@@ -743,16 +925,20 @@ sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, sr_sid_t *sid, const c
         } else if (!sr_xpath_oper_data_required(request_xpath, sub_xpath)) {
             /* useless to retrieve this data because they would be filtered out anyway */
             continue;
+        } else if (req_depth && (sub_depth = sr_xpath_simple_depth(sub_xpath))
+                && (sub_depth > req_depth + max_depth - 1)) {
+            /* useless to retrieve this data because they are deeper than the requested depth */
+            continue;
         }
 
         /* remove any present data */
         if (!(shm_msub->opts & SR_SUBSCR_OPER_MERGE) && (err_info = sr_lyd_xpath_complement(data, sub_xpath))) {
-            return err_info;
+            goto error;
         }
 
         /* trim the last node to get the parent */
         if ((err_info = sr_xpath_trim_last_node(sub_xpath, &parent_xpath))) {
-            return err_info;
+            goto error;
         }
 
         if (parent_xpath) {
@@ -775,7 +961,7 @@ sr_module_oper_data_update(struct sr_mod_info_mod_s *mod, sr_sid_t *sid, const c
             /* nested data */
             for (j = 0; j < set->number; ++j) {
                 if ((err_info = sr_xpath_oper_data_append(shm_msub, mod->ly_mod, sub_xpath, request_xpath, set->set.d[j],
-                        *sid, timeout_ms, data, cb_error_info))) {
+                        *sid, timeout_ms, &mod->shm_mod->stats.oper, data, cb_error_info))) {
                     goto error;
                 }
             }
@@ -788,15 +974,20 @@ next_iter:
         } else {
             /* top-level data */
             if ((err_info = sr_xpath_oper_data_append(shm_msub, mod->ly_mod, sub_xpath, request_xpath, NULL, *sid,
-                    timeout_ms, data, cb_error_info))) {
+                    timeout_ms, &mod->shm_mod->stats.oper, data, cb_error_info))) {
                 goto error;
             }
         }
     }
 
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__);
     return NULL;
 
 error:
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__);
+
     free(parent_xpath);
     ly_set_free(set);
     return err_info;
@@ -859,14 +1050,14 @@ sr_module_oper_data_add_state_default(struct lyd_node **data, const struct lys_m
  * @brief Duplicate operational (enabled) data from configuration data tree.
  *
  * @param[in] data Configuration data.
- * @param[in] ext_shm_addr Main SHM address.
+ * @param[in] conn Connection to use.
  * @param[in] mod Mod info module to process.
  * @param[in] opts Get oper data options.
  * @param[out] enabled_mod_data Enabled operational data of the module.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_module_oper_data_dup_enabled(const struct lyd_node *data, char *ext_shm_addr, struct sr_mod_info_mod_s *mod,
+sr_module_oper_data_dup_enabled(const struct lyd_node *data, sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod,
         sr_get_oper_options_t opts, struct lyd_node **enabled_mod_data)
 {
     sr_error_info_t *err_info = NULL;
@@ -874,52 +1065,62 @@ sr_module_oper_data_dup_enabled(const struct lyd_node *data, char *ext_shm_addr,
     struct lyd_node *root, *elem, *next;
     uint16_t i, xp_i;
     int data_duplicated = 0;
-    char **xpaths;
+    char **xpaths = NULL;
     const char *origin;
 
     *enabled_mod_data = NULL;
 
     if (!data) {
         /* no enabled data to duplicate */
-        data_duplicated = 1;
+        goto add_state;
     }
 
-    if (!data_duplicated) {
-        /* try to find a subscription for the whole module */
-        shm_changesubs = (sr_mod_change_sub_t *)(ext_shm_addr + mod->shm_mod->change_sub[SR_DS_RUNNING].subs);
-        for (i = 0; i < mod->shm_mod->change_sub[SR_DS_RUNNING].sub_count; ++i) {
-            if (!shm_changesubs[i].xpath && !(shm_changesubs[i].opts & SR_SUBSCR_PASSIVE)) {
-                /* the whole module is enabled */
-                if ((err_info = sr_module_data_dup(data, mod->ly_mod, enabled_mod_data))) {
-                    return err_info;
-                }
-                data_duplicated = 1;
-                break;
-            }
+    /* MOD SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    /* try to find a subscription for the whole module */
+    shm_changesubs = (sr_mod_change_sub_t *)(conn->ext_shm.addr + mod->shm_mod->change_sub[SR_DS_RUNNING].subs);
+    for (i = 0; i < mod->shm_mod->change_sub[SR_DS_RUNNING].sub_count; ++i) {
+        if (!shm_changesubs[i].xpath && !(shm_changesubs[i].opts & SR_SUBSCR_PASSIVE)) {
+            /* the whole module is enabled */
+            err_info = sr_module_data_dup(data, mod->ly_mod, NULL, 0, enabled_mod_data);
+            data_duplicated = 1;
+            break;
         }
     }
 
     if (!data_duplicated) {
         /* collect all enabled subtress in the form of xpaths */
-        xpaths = NULL;
         for (i = 0, xp_i = 0; i < mod->shm_mod->change_sub[SR_DS_RUNNING].sub_count; ++i) {
             if (shm_changesubs[i].xpath && !(shm_changesubs[i].opts & SR_SUBSCR_PASSIVE)) {
                 xpaths = sr_realloc(xpaths, (xp_i + 1) * sizeof *xpaths);
-                SR_CHECK_MEM_RET(!xpaths, err_info);
+                if (!xpaths) {
+                    SR_ERRINFO_MEM(&err_info);
+                    break;
+                }
 
-                xpaths[xp_i] = ext_shm_addr + shm_changesubs[i].xpath;
+                xpaths[xp_i] = conn->ext_shm.addr + shm_changesubs[i].xpath;
                 ++xp_i;
             }
         }
 
         /* duplicate only enabled subtrees */
-        err_info = sr_lyd_xpath_dup(data, xpaths, xp_i, mod->ly_mod, enabled_mod_data);
-        free(xpaths);
-        if (err_info) {
-            return err_info;
+        if (!err_info) {
+            err_info = sr_lyd_xpath_dup(data, xpaths, xp_i, mod->ly_mod, enabled_mod_data);
         }
+        free(xpaths);
+    }
+
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__);
+
+    if (err_info) {
+        return err_info;
     }
 
+add_state:
     /* add existing (valid) state NP containers and default values */
     if ((err_info = sr_module_oper_data_add_state_default(enabled_mod_data, mod->ly_mod))) {
         return err_info;
@@ -948,63 +1149,180 @@ sr_module_oper_data_dup_enabled(const struct lyd_node *data, char *ext_shm_addr,
     return NULL;
 }
 
+/**
+ * @brief Find a module in the module cache.
+ *
+ * @param[in] mod_cache Module cache.
+ * @param[in] ly_mod Module to find.
+ * @return Index of the module in the cache, mod_count if not found.
+ */
+static uint32_t
+sr_modcache_module_find(struct sr_mod_cache_s *mod_cache, const struct lys_module *ly_mod)
+{
+    uint32_t i;
+
+    for (i = 0; i < mod_cache->mod_count; ++i) {
+        if (ly_mod == mod_cache->mods[i].ly_mod) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief Update cached running module data of the directly previous version by applying the diff
+ * that created the current version.
+ *
+ * @param[in] mod_cache Module cache.
+ * @param[in] mod Mod info module to process.
+ * @param[in] upd_diff Optional diff that created the current module data, is loaded from its SHM otherwise.
+ * @param[in] read_locked Whether the cache is READ locked.
+ * @param[out] updated Whether the cached data were updated to the current version.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modcache_module_running_diff_apply(struct sr_mod_cache_s *mod_cache, struct sr_mod_info_mod_s *mod,
+        const struct lyd_node *upd_diff, int read_locked, int *updated)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err_info;
+    struct lyd_node *mod_diff = NULL;
+    uint32_t i;
+    int found;
+
+    *updated = 0;
+
+    if (!upd_diff) {
+        /* load the stored diff, it cannot change because the module is locked */
+        if ((err_info = sr_module_file_diff_get(mod->ly_mod, mod->ver, &mod_diff, &found))) {
+            return err_info;
+        }
+        if (!found) {
+            /* the diff is not available, full reload is required */
+            return NULL;
+        }
+        upd_diff = mod_diff;
+    }
+
+    if (read_locked) {
+        /* CACHE READ UNLOCK */
+        sr_rwunlock(&mod_cache->lock, SR_LOCK_READ, __func__);
+    }
+
+    /* CACHE WRITE LOCK */
+    if ((err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_WRITE, __func__))) {
+        goto cleanup_rlock;
+    }
+
+    /* find the module again, the cache could have been updated in the meantime */
+    i = sr_modcache_module_find(mod_cache, mod->ly_mod);
+    if (i == mod_cache->mod_count) {
+        /* module was not cached, full reload is required */
+        goto cleanup_wrunlock;
+    }
+
+    if (mod_cache->mods[i].ver == mod->ver - 1) {
+        /* apply the diff */
+        if ((tmp_err_info = sr_diff_mod_apply(upd_diff, mod->ly_mod, 0, &mod_cache->data))) {
+            /* cached data may be partially updated, throw them away and perform full reload */
+            SR_LOG_WRN("Failed to apply the diff to cached \"%s\" data, reloading them.", mod->ly_mod->name);
+            sr_errinfo_free(&tmp_err_info);
+            lyd_free_withsiblings(sr_module_data_unlink(&mod_cache->data, mod->ly_mod));
+            mod_cache->mods[i].ver = 0;
+            goto cleanup_wrunlock;
+        }
+        mod_cache->mods[i].ver = mod->ver;
+    }
+    *updated = (mod_cache->mods[i].ver >= mod->ver);
+
+cleanup_wrunlock:
+    /* CACHE WRITE UNLOCK */
+    sr_rwunlock(&mod_cache->lock, SR_LOCK_WRITE, __func__);
+
+cleanup_rlock:
+    if (read_locked) {
+        /* CACHE READ LOCK */
+        if ((tmp_err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_READ, __func__))) {
+            sr_errinfo_merge(&err_info, tmp_err_info);
+        }
+    }
+    lyd_free_withsiblings(mod_diff);
+    return err_info;
+}
+
 /**
  * @brief Update cached running module data (if required).
  *
+ * If the cached data are of the directly previous version, the diff that created the current version
+ * is applied to them. Otherwise, the new module data are prepared before the cache is WRITE-locked
+ * so that other cache readers are blocked only while the data trees are being swapped.
+ *
  * @param[in] mod_cache Module cache.
  * @param[in] mod Mod info module to process.
  * @param[in] upd_mod_data Optional current (updated) module data to store in cache.
+ * @param[in] upd_diff Optional diff that created @p upd_mod_data.
  * @param[in] read_locked Whether the cache is READ locked.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_modcache_module_running_update(struct sr_mod_cache_s *mod_cache, struct sr_mod_info_mod_s *mod,
-        const struct lyd_node *upd_mod_data, int read_locked)
+        const struct lyd_node *upd_mod_data, const struct lyd_node *upd_diff, int read_locked)
 {
-    sr_error_info_t *err_info = NULL;
-    struct lyd_node *mod_data;
+    sr_error_info_t *err_info = NULL, *tmp_err_info;
+    struct lyd_node *mod_data = NULL;
     uint32_t i;
+    int updated;
     void *mem;
 
     /* find the module in the cache */
-    for (i = 0; i < mod_cache->mod_count; ++i) {
-        if (mod->ly_mod == mod_cache->mods[i].ly_mod) {
-            break;
-        }
+    i = sr_modcache_module_find(mod_cache, mod->ly_mod);
+    if ((i < mod_cache->mod_count) && (mod_cache->mods[i].ver >= mod->ver)) {
+        /* cached data are current */
+        assert(mod_cache->mods[i].ver == mod->ver);
+        return NULL;
     }
 
-    if (i < mod_cache->mod_count) {
-        /* this module data are already in the cache */
-        assert(mod->shm_mod->ver >= mod_cache->mods[i].ver);
-        if (mod->shm_mod->ver > mod_cache->mods[i].ver) {
-            if (read_locked) {
-                /* CACHE READ UNLOCK */
-                sr_rwunlock(&mod_cache->lock, SR_LOCK_READ, __func__);
-            }
-
-            /* CACHE WRITE LOCK */
-            if ((err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_WRITE, __func__))) {
-                goto error_rlock;
-            }
+    if ((i < mod_cache->mod_count) && (mod_cache->mods[i].ver == mod->ver - 1)) {
+        /* cached data are only one version behind, try to update them incrementally */
+        if ((err_info = sr_modcache_module_running_diff_apply(mod_cache, mod, upd_diff, read_locked, &updated))) {
+            return err_info;
+        }
+        if (updated) {
+            return NULL;
+        }
+    }
 
-            /* data needs to be updated, remove old data */
-            lyd_free_withsiblings(sr_module_data_unlink(&mod_cache->data, mod->ly_mod));
-            mod_cache->mods[i].ver = 0;
+    /* prepare current data */
+    if (upd_mod_data) {
+        /* current data were provided, use them */
+        mod_data = lyd_dup_withsiblings(upd_mod_data, LYD_DUP_OPT_RECURSIVE | LYD_DUP_OPT_WITH_WHEN);
+        if (!mod_data) {
+            sr_errinfo_new_ly(&err_info, mod->ly_mod->ctx);
+            return err_info;
         }
     } else {
-        if (read_locked) {
-            /* CACHE READ UNLOCK */
-            sr_rwunlock(&mod_cache->lock, SR_LOCK_READ, __func__);
+        /* we need to load current data from persistent storage, it cannot change because the module is locked */
+        if ((err_info = sr_module_file_data_append(mod->ly_mod, SR_DS_RUNNING, &mod_data))) {
+            return err_info;
         }
+    }
 
-        /* CACHE WRITE LOCK */
-        if ((err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_WRITE, __func__))) {
-            goto error_rlock;
-        }
+    if (read_locked) {
+        /* CACHE READ UNLOCK */
+        sr_rwunlock(&mod_cache->lock, SR_LOCK_READ, __func__);
+    }
 
+    /* CACHE WRITE LOCK */
+    if ((err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_WRITE, __func__))) {
+        goto cleanup_rlock;
+    }
+
+    /* find the module again, the cache could have been updated in the meantime */
+    i = sr_modcache_module_find(mod_cache, mod->ly_mod);
+    if (i == mod_cache->mod_count) {
         /* module is not in cache yet, add an item */
         mem = realloc(mod_cache->mods, (i + 1) * sizeof *mod_cache->mods);
-        SR_CHECK_MEM_RET(!mem, err_info);
+        SR_CHECK_MEM_GOTO(!mem, err_info, cleanup_wrunlock);
         mod_cache->mods = mem;
         ++mod_cache->mod_count;
 
@@ -1012,41 +1330,30 @@ sr_modcache_module_running_update(struct sr_mod_cache_s *mod_cache, struct sr_mo
         mod_cache->mods[i].ver = 0;
     }
 
-    /* append current data */
-    if (!mod_cache->mods[i].ver) {
-        if (upd_mod_data) {
-            /* current data were provided, use them */
-            mod_data = lyd_dup_withsiblings(upd_mod_data, LYD_DUP_OPT_RECURSIVE | LYD_DUP_OPT_WITH_WHEN);
-            if (!mod_data) {
-                sr_errinfo_new_ly(&err_info, mod->ly_mod->ctx);
-                goto error_wrunlock;
-            }
-            if (mod_cache->data) {
-                sr_ly_link(mod_cache->data, mod_data);
-            } else {
-                mod_cache->data = mod_data;
-            }
-        } else {
-            /* we need to load current data from persistent storage */
-            if ((err_info = sr_module_file_data_append(mod->ly_mod, SR_DS_RUNNING, &mod_cache->data))) {
-                goto error_wrunlock;
-            }
+    if (mod_cache->mods[i].ver < mod->ver) {
+        /* replace old data */
+        lyd_free_withsiblings(sr_module_data_unlink(&mod_cache->data, mod->ly_mod));
+        if (mod_cache->data && mod_data) {
+            sr_ly_link(mod_cache->data, mod_data);
+        } else if (mod_data) {
+            mod_cache->data = mod_data;
         }
-        mod_cache->mods[i].ver = mod->shm_mod->ver;
+        mod_data = NULL;
+        mod_cache->mods[i].ver = mod->ver;
+    }
 
-error_wrunlock:
-        /* CACHE WRITE UNLOCK */
-        sr_rwunlock(&mod_cache->lock, SR_LOCK_WRITE, __func__);
+cleanup_wrunlock:
+    /* CACHE WRITE UNLOCK */
+    sr_rwunlock(&mod_cache->lock, SR_LOCK_WRITE, __func__);
 
-error_rlock:
-        if (read_locked) {
-            /* CACHE READ LOCK */
-            if ((err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_READ, __func__))) {
-                return err_info;
-            }
+cleanup_rlock:
+    if (read_locked) {
+        /* CACHE READ LOCK */
+        if ((tmp_err_info = sr_rwlock(&mod_cache->lock, SR_MOD_CACHE_LOCK_TIMEOUT * 1000, SR_LOCK_READ, __func__))) {
+            sr_errinfo_merge(&err_info, tmp_err_info);
         }
     }
-
+    lyd_free_withsiblings(mod_data);
     return err_info;
 }
 
@@ -1112,23 +1419,23 @@ sr_oper_data_trim_r(struct lyd_node **data, struct lyd_node *sibling, sr_get_ope
 }
 
 /**
- * @brief Load module data of the ietf-yang-library module. They are actually generated.
+ * @brief Generate data of the ietf-yang-library module.
  *
- * @param[in] mod_info Mod info to use.
- * @param[in] mod Mod info module to use.
+ * @param[in] ly_mod ietf-yang-library module.
+ * @param[out] data Generated data.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod)
+sr_modinfo_yanglib_generate(const struct lys_module *ly_mod, struct lyd_node **data)
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *mod_data;
 
     /* get the data from libyang */
-    mod_data = ly_ctx_info(mod_info->conn->ly_ctx);
-    SR_CHECK_LY_RET(!mod_data, mod_info->conn->ly_ctx, err_info);
+    mod_data = ly_ctx_info(ly_mod->ctx);
+    SR_CHECK_LY_RET(!mod_data, ly_mod->ctx, err_info);
 
-    if (!strcmp(mod->ly_mod->rev[0].date, "2019-01-04")) {
+    if (!strcmp(ly_mod->rev[0].date, "2019-01-04")) {
         assert(!strcmp(mod_data->schema->name, "yang-library"));
 
         /* add supported datastores */
@@ -1136,19 +1443,92 @@ sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mo
                 || !lyd_new_path(mod_data, NULL, "datastore[name='ietf-datastores:candidate']/schema", "complete", 0, 0)
                 || !lyd_new_path(mod_data, NULL, "datastore[name='ietf-datastores:startup']/schema", "complete", 0, 0)
                 || !lyd_new_path(mod_data, NULL, "datastore[name='ietf-datastores:operational']/schema", "complete", 0, 0)) {
-            sr_errinfo_new_ly(&err_info, mod_info->conn->ly_ctx);
+            sr_errinfo_new_ly(&err_info, ly_mod->ctx);
+            lyd_free_withsiblings(mod_data);
             return err_info;
         }
-    } else if (!strcmp(mod->ly_mod->rev[0].date, "2016-06-21")) {
+    } else if (!strcmp(ly_mod->rev[0].date, "2016-06-21")) {
         assert(!strcmp(mod_data->schema->name, "modules-state"));
 
         /* all data should already be there */
     } else {
         /* no other revision is supported */
         SR_ERRINFO_INT(&err_info);
+        lyd_free_withsiblings(mod_data);
         return err_info;
     }
 
+    *data = mod_data;
+    return NULL;
+}
+
+/**
+ * @brief Load module data of the ietf-yang-library module. They are actually generated, but only once
+ * for every context module set, then they are duplicated from the connection cache. If the cache
+ * cannot be locked in time, the data are generated without it.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_data_load_yanglib(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *mod_data = NULL;
+    uint16_t module_set_id;
+    int cache_locked;
+    struct sr_yanglib_cache_s *cache = &mod_info->conn->yanglib_cache;
+
+    module_set_id = ly_ctx_get_module_set_id(mod_info->conn->ly_ctx);
+
+    /* CACHE READ LOCK */
+    if ((err_info = sr_rwlock(&cache->lock, SR_YANGLIB_CACHE_LOCK_TIMEOUT, SR_LOCK_READ, __func__))) {
+        /* the cache is only an optimization, generate the data without it */
+        sr_errinfo_free(&err_info);
+        cache_locked = 0;
+    } else {
+        cache_locked = 1;
+    }
+
+    if (cache_locked) {
+        if (cache->data && (cache->module_set_id == module_set_id)) {
+            /* cached data are current */
+            mod_data = lyd_dup_withsiblings(cache->data, LYD_DUP_OPT_RECURSIVE);
+            if (!mod_data) {
+                sr_errinfo_new_ly(&err_info, mod_info->conn->ly_ctx);
+            }
+        }
+
+        /* CACHE READ UNLOCK */
+        sr_rwunlock(&cache->lock, SR_LOCK_READ, __func__);
+
+        if (err_info) {
+            return err_info;
+        }
+    }
+
+    if (!mod_data) {
+        /* generate the data */
+        if ((err_info = sr_modinfo_yanglib_generate(mod->ly_mod, &mod_data))) {
+            return err_info;
+        }
+
+        /* CACHE WRITE LOCK */
+        if ((err_info = sr_rwlock(&cache->lock, SR_YANGLIB_CACHE_LOCK_TIMEOUT, SR_LOCK_WRITE, __func__))) {
+            /* the cache is only an optimization, do not store the data */
+            sr_errinfo_free(&err_info);
+        } else {
+            /* store a copy in the cache, it is only an optimization so any failure is ignored */
+            lyd_free_withsiblings(cache->data);
+            cache->data = lyd_dup_withsiblings(mod_data, LYD_DUP_OPT_RECURSIVE);
+            cache->module_set_id = module_set_id;
+
+            /* CACHE WRITE UNLOCK */
+            sr_rwunlock(&cache->lock, SR_LOCK_WRITE, __func__);
+        }
+    }
+
     /* connect to the rest of data */
     if (!mod_info->data) {
         mod_info->data = mod_data;
@@ -1184,8 +1564,85 @@ sr_modinfo_module_srmon_evpipe2pid(sr_main_shm_t *main_shm, char *ext_shm_addr,
     return err_info;
 }
 
+/**
+ * @brief Append non-empty buckets of a duration histogram to sysrepo-monitoring data.
+ *
+ * @param[in] hist SHM histogram to read from.
+ * @param[in,out] parent Parent node of the buckets.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_hist(sr_stats_hist_t *hist, struct lyd_node *parent)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *sr_bucket;
+    uint32_t i;
+    uint64_t count;
+    char buf[22];
+    struct ly_ctx *ly_ctx;
+
+    ly_ctx = lyd_node_module(parent)->ctx;
+
+    for (i = 0; i < SR_STATS_HIST_BUCKETS; ++i) {
+        count = ATOMIC_LOAD_RELAXED(hist->buckets[i]);
+        if (!count) {
+            continue;
+        }
+
+        /* bucket */
+        sr_bucket = lyd_new(parent, NULL, "bucket");
+        SR_CHECK_LY_RET(!sr_bucket, ly_ctx, err_info);
+
+        /* upper-bound */
+        if (i < SR_STATS_HIST_BUCKETS - 1) {
+            sprintf(buf, "%"PRIu32, (uint32_t)1 << i);
+        } else {
+            sprintf(buf, "infinity");
+        }
+        SR_CHECK_LY_RET(!lyd_new_leaf(sr_bucket, NULL, "upper-bound", buf), ly_ctx, err_info);
+
+        /* count */
+        sprintf(buf, "%"PRIu64, count);
+        SR_CHECK_LY_RET(!lyd_new_leaf(sr_bucket, NULL, "count", buf), ly_ctx, err_info);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Append event statistics to sysrepo-monitoring data.
+ *
+ * @param[in] stats SHM event statistics to read from.
+ * @param[in,out] parent Parent node of the statistics.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_event_stats(sr_stats_event_t *stats, struct lyd_node *parent)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *sr_dur;
+    char buf[22];
+    struct ly_ctx *ly_ctx;
+
+    ly_ctx = lyd_node_module(parent)->ctx;
+
+    /* published */
+    sprintf(buf, "%"PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(stats->published));
+    SR_CHECK_LY_RET(!lyd_new_leaf(parent, NULL, "published", buf), ly_ctx, err_info);
+
+    /* timeouts */
+    sprintf(buf, "%"PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(stats->timeouts));
+    SR_CHECK_LY_RET(!lyd_new_leaf(parent, NULL, "timeouts", buf), ly_ctx, err_info);
+
+    /* duration */
+    sr_dur = lyd_new(parent, NULL, "duration");
+    SR_CHECK_LY_RET(!sr_dur, ly_ctx, err_info);
+    return sr_modinfo_module_srmon_hist(&stats->duration, sr_dur);
+}
+
 /**
  * @brief Append a "module" data node with its subscriptions to sysrepo-monitoring data.
+ * Expects CONN READ and MOD SUBS READ lock held.
  *
  * @param[in] main_shm Main SHM structure.
  * @param[in] ext_shm_addr Ext SHM address.
@@ -1197,7 +1654,7 @@ static sr_error_info_t *
 sr_modinfo_module_srmon_module(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_mod_t *shm_mod, struct lyd_node *sr_state)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *sr_mod, *sr_subs, *sr_sub;
+    struct lyd_node *sr_mod, *sr_subs, *sr_sub, *sr_stats, *sr_stat;
     sr_datastore_t ds;
     sr_mod_change_sub_t *change_sub;
     sr_mod_oper_sub_t *oper_sub;
@@ -1247,6 +1704,10 @@ sr_modinfo_module_srmon_module(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_m
             }
             sprintf(buf, "%"PRIu32, pid);
             SR_CHECK_LY_RET(!lyd_new_leaf(sr_sub, NULL, "pid", buf), ly_ctx, err_info);
+
+            /* events */
+            sprintf(buf, "%"PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(change_sub[i].events));
+            SR_CHECK_LY_RET(!lyd_new_leaf(sr_sub, NULL, "events", buf), ly_ctx, err_info);
         }
     }
 
@@ -1266,6 +1727,10 @@ sr_modinfo_module_srmon_module(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_m
         }
         sprintf(buf, "%"PRIu32, pid);
         SR_CHECK_LY_RET(!lyd_new_leaf(sr_sub, NULL, "pid", buf), ly_ctx, err_info);
+
+        /* events */
+        sprintf(buf, "%"PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(oper_sub[i].events));
+        SR_CHECK_LY_RET(!lyd_new_leaf(sr_sub, NULL, "events", buf), ly_ctx, err_info);
     }
 
     notif_sub = (sr_mod_notif_sub_t *)(ext_shm_addr + shm_mod->notif_subs);
@@ -1278,11 +1743,96 @@ sr_modinfo_module_srmon_module(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_m
         SR_CHECK_LY_RET(!lyd_new_leaf(sr_subs, NULL, "notification-sub", buf), ly_ctx, err_info);
     }
 
+    /* statistics */
+    sr_stats = lyd_new(sr_mod, NULL, "statistics");
+    SR_CHECK_LY_RET(!sr_stats, ly_ctx, err_info);
+
+    for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+        /* change */
+        sr_stat = lyd_new(sr_stats, NULL, "change");
+        SR_CHECK_LY_RET(!sr_stat, ly_ctx, err_info);
+        SR_CHECK_LY_RET(!lyd_new_leaf(sr_stat, NULL, "datastore", sr_ds2ident(ds)), ly_ctx, err_info);
+        if ((err_info = sr_modinfo_module_srmon_event_stats(&shm_mod->stats.change[ds], sr_stat))) {
+            return err_info;
+        }
+    }
+
+    /* operational */
+    sr_stat = lyd_new(sr_stats, NULL, "operational");
+    SR_CHECK_LY_RET(!sr_stat, ly_ctx, err_info);
+    if ((err_info = sr_modinfo_module_srmon_event_stats(&shm_mod->stats.oper, sr_stat))) {
+        return err_info;
+    }
+
+    /* notifications */
+    sprintf(buf, "%"PRIu64, (uint64_t)ATOMIC_LOAD_RELAXED(shm_mod->stats.notifs));
+    SR_CHECK_LY_RET(!lyd_new_leaf(sr_stats, NULL, "notifications", buf), ly_ctx, err_info);
+
+    for (ds = 0; ds < SR_DS_COUNT; ++ds) {
+        /* data-lock-wait */
+        sr_stat = lyd_new(sr_stats, NULL, "data-lock-wait");
+        SR_CHECK_LY_RET(!sr_stat, ly_ctx, err_info);
+        SR_CHECK_LY_RET(!lyd_new_leaf(sr_stat, NULL, "datastore", sr_ds2ident(ds)), ly_ctx, err_info);
+        if ((err_info = sr_modinfo_module_srmon_hist(&shm_mod->data_lock_info[ds].wait, sr_stat))) {
+            return err_info;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Append global "statistics" to sysrepo-monitoring data.
+ *
+ * @param[in] main_shm Main SHM structure.
+ * @param[in,out] sr_state Main container node of sysrepo-monitoring.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_module_srmon_stats(sr_main_shm_t *main_shm, struct lyd_node *sr_state)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *sr_stats, *sr_stat;
+    const char *phases[SR_STATS_COMMIT_PHASE_COUNT] = {"validate", "update", "change", "store", "done"};
+    uint32_t i;
+    struct ly_ctx *ly_ctx;
+
+    ly_ctx = lyd_node_module(sr_state)->ctx;
+
+    /* statistics */
+    sr_stats = lyd_new(sr_state, NULL, "statistics");
+    SR_CHECK_LY_RET(!sr_stats, ly_ctx, err_info);
+
+    /* main-lock-wait */
+    sr_stat = lyd_new(sr_stats, NULL, "main-lock-wait");
+    SR_CHECK_LY_RET(!sr_stat, ly_ctx, err_info);
+    if ((err_info = sr_modinfo_module_srmon_hist(&main_shm->stats.lock_wait, sr_stat))) {
+        return err_info;
+    }
+
+    /* rpc */
+    sr_stat = lyd_new(sr_stats, NULL, "rpc");
+    SR_CHECK_LY_RET(!sr_stat, ly_ctx, err_info);
+    if ((err_info = sr_modinfo_module_srmon_event_stats(&main_shm->stats.rpc, sr_stat))) {
+        return err_info;
+    }
+
+    for (i = 0; i < SR_STATS_COMMIT_PHASE_COUNT; ++i) {
+        /* commit-phase */
+        sr_stat = lyd_new(sr_stats, NULL, "commit-phase");
+        SR_CHECK_LY_RET(!sr_stat, ly_ctx, err_info);
+        SR_CHECK_LY_RET(!lyd_new_leaf(sr_stat, NULL, "name", phases[i]), ly_ctx, err_info);
+        if ((err_info = sr_modinfo_module_srmon_hist(&main_shm->stats.commit[i], sr_stat))) {
+            return err_info;
+        }
+    }
+
     return NULL;
 }
 
 /**
  * @brief Append an "rpc" data node with its subscriptions to sysrepo-monitoring data.
+ * Expects CONN READ and RPC SUBS READ lock held.
  *
  * @param[in] main_shm Main SHM structure.
  * @param[in] ext_shm_addr Ext SHM address.
@@ -1437,21 +1987,52 @@ sr_modinfo_module_data_load_srmon(struct sr_mod_info_s *mod_info)
     mod_data = lyd_new(NULL, ly_mod, "sysrepo-state");
     SR_CHECK_LY_GOTO(!mod_data, mod_info->conn->ly_ctx, err_info, cleanup);
 
+    /* CONN READ LOCK (subscription PIDs are learned from connection evpipes) */
+    if ((err_info = sr_shmmain_sub_lock_remap(mod_info->conn, &main_shm->conn_lock, SR_LOCK_READ, __func__))) {
+        goto cleanup;
+    }
+
     /* modules */
     SR_SHM_MOD_FOR(mod_info->conn->main_shm.addr, mod_info->conn->main_shm.size, shm_mod) {
-        if ((err_info = sr_modinfo_module_srmon_module(main_shm, mod_info->conn->ext_shm.addr, shm_mod, mod_data))) {
-            goto cleanup;
+        /* MOD SUBS READ LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(mod_info->conn, &shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+            goto cleanup_conn_unlock;
+        }
+
+        err_info = sr_modinfo_module_srmon_module(main_shm, mod_info->conn->ext_shm.addr, shm_mod, mod_data);
+
+        /* MOD SUBS READ UNLOCK */
+        sr_shmmain_sub_unlock(mod_info->conn, &shm_mod->sub_lock, SR_LOCK_READ, __func__);
+
+        if (err_info) {
+            goto cleanup_conn_unlock;
         }
     }
 
+    /* RPC SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(mod_info->conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__))) {
+        goto cleanup_conn_unlock;
+    }
+
     /* RPCs */
     shm_rpc = (sr_rpc_t *)(mod_info->conn->ext_shm.addr + main_shm->rpc_subs);
     for (i = 0; i < main_shm->rpc_sub_count; ++i) {
         if ((err_info = sr_modinfo_module_srmon_rpc(main_shm, mod_info->conn->ext_shm.addr, &shm_rpc[i], mod_data))) {
-            goto cleanup;
+            break;
         }
     }
 
+    /* RPC SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(mod_info->conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__);
+
+cleanup_conn_unlock:
+    /* CONN READ UNLOCK */
+    sr_shmmain_sub_unlock(mod_info->conn, &main_shm->conn_lock, SR_LOCK_READ, __func__);
+
+    if (err_info) {
+        goto cleanup;
+    }
+
     /* connections */
     shm_conn = (sr_conn_shm_t *)(mod_info->conn->ext_shm.addr + main_shm->conns);
     for (i = 0; i < main_shm->conn_count; ++i) {
@@ -1460,6 +2041,11 @@ sr_modinfo_module_data_load_srmon(struct sr_mod_info_s *mod_info)
         }
     }
 
+    /* statistics */
+    if ((err_info = sr_modinfo_module_srmon_stats(main_shm, mod_data))) {
+        goto cleanup;
+    }
+
     /* connect to the rest of data */
     if (!mod_info->data) {
         mod_info->data = mod_data;
@@ -1475,32 +2061,102 @@ cleanup:
 }
 
 /**
- * @brief Load module data of a specific module.
+ * @brief Learn whether top-level data of a module can be pruned based on a data request.
+ *
+ * @param[in] mod Mod info module.
+ * @param[in] request_xpath XPath of the data request.
+ * @param[out] name Name of the only top-level node that can be selected by the request.
+ * @param[out] len Length of @p name.
+ * @return 0 if the data cannot be pruned, non-zero if they can.
+ */
+static int
+sr_modinfo_module_data_prunable(struct sr_mod_info_mod_s *mod, const char *request_xpath, const char **name, int *len)
+{
+    const char *mod_name;
+    int mod_len, dslash, has_pred;
+
+    if (!sr_xpath_simple_depth(request_xpath)) {
+        /* we cannot say which data will be selected */
+        return 0;
+    }
+
+    /* only the module of the first node can be pruned */
+    sr_xpath_next_name(request_xpath, &mod_name, &mod_len, name, len, &dslash, &has_pred);
+    if (!mod_name || strncmp(mod_name, mod->ly_mod->name, mod_len) || mod->ly_mod->name[mod_len]) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Free all top-level data of a module except the selected ones.
+ *
+ * @param[in,out] data Data tree to prune.
+ * @param[in] ly_mod Module of the data to prune.
+ * @param[in] name Name of the only top-level node to keep.
+ * @param[in] len Length of @p name.
+ */
+static void
+sr_modinfo_module_data_prune(struct lyd_node **data, const struct lys_module *ly_mod, const char *name, int len)
+{
+    struct lyd_node *next, *elem;
+
+    LY_TREE_FOR_SAFE(*data, next, elem) {
+        if ((lyd_node_module(elem) == ly_mod) && (strncmp(elem->schema->name, name, len) || elem->schema->name[len])) {
+            if (*data == elem) {
+                *data = next;
+            }
+            lyd_free(elem);
+        }
+    }
+}
+
+/**
+ * @brief Module data file parsing of a single module performed by a separate thread.
+ */
+struct sr_file_load_mod_s {
+    const struct lys_module *ly_mod;    /**< Module whose data to parse, NULL if not parsed. */
+    struct lyd_node *data;          /**< Parsed module data. */
+    sr_error_info_t *err_info;      /**< Error info of the parsing. */
+};
+
+/**
+ * @brief Load base module data of a specific module. These are all the data except
+ * those retrieved from operational subscribers. Module must be locked.
  *
  * @param[in] mod_info Mod info to use.
  * @param[in] mod Mod info module to process.
- * @param[in] load_diff Whether to load stored operational diff of the module.
- * @param[in] sid Sysrepo session ID.
  * @param[in] request_xpath XPath of the data request.
- * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] prune Whether top-level data that cannot be selected by @p request_xpath can be omitted.
  * @param[in] opts Get oper data options.
- * @param[out] cb_error_info Callback error info returned by operational subscribers, if any.
+ * @param[in,out] file_mod Already parsed module file data to use instead of parsing the file, if set. They are
+ * spent (or their error is returned) by this function.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod, sr_sid_t *sid,
-        const char *request_xpath, uint32_t timeout_ms, sr_get_oper_options_t opts, sr_error_info_t **cb_error_info)
+sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod, const char *request_xpath,
+        int prune, sr_get_oper_options_t opts, struct sr_file_load_mod_s *file_mod)
 {
     sr_error_info_t *err_info = NULL;
     sr_conn_ctx_t *conn = mod_info->conn;
     struct sr_mod_cache_s *mod_cache = NULL;
     struct lyd_node *mod_data;
     sr_datastore_t conf_ds;
+    const char *name = NULL;
+    int len = 0;
+
+    if (prune && (!(mod->state & MOD_INFO_REQ) || !sr_modinfo_module_data_prunable(mod, request_xpath, &name, &len))) {
+        prune = 0;
+    }
+
+    /* pin the data version, it cannot change while the module is locked */
+    mod->ver = mod->shm_mod->ver;
 
     if (((mod_info->ds == SR_DS_RUNNING) || (mod_info->ds2 == SR_DS_RUNNING)) && (conn->opts & SR_CONN_CACHE_RUNNING)) {
         /* we are caching running data we will use, so in all cases load the module into cache if not yet there */
         mod_cache = &conn->mod_cache;
-        if ((err_info = sr_modcache_module_running_update(mod_cache, mod, NULL, mod_info->data_cached))) {
+        if ((err_info = sr_modcache_module_running_update(mod_cache, mod, NULL, NULL, mod_info->data_cached))) {
             return err_info;
         }
     }
@@ -1517,10 +2173,10 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
 
             if (mod_info->ds == SR_DS_OPERATIONAL) {
                 /* copy only enabled module data */
-                err_info = sr_module_oper_data_dup_enabled(mod_cache->data, conn->ext_shm.addr, mod, opts, &mod_data);
+                err_info = sr_module_oper_data_dup_enabled(mod_cache->data, conn, mod, opts, &mod_data);
             } else {
-                /* copy all module data */
-                err_info = sr_module_data_dup(mod_cache->data, mod->ly_mod, &mod_data);
+                /* copy all module data that can be selected */
+                err_info = sr_module_data_dup(mod_cache->data, mod->ly_mod, prune ? name : NULL, len, &mod_data);
             }
 
             /* CACHE READ UNLOCK */
@@ -1542,13 +2198,32 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
                 conf_ds = mod_info->ds;
             }
             /* get current persistent data */
-            if ((err_info = sr_module_file_data_append(mod->ly_mod, conf_ds, &mod_info->data))) {
+            if (file_mod && file_mod->ly_mod) {
+                /* already parsed */
+                assert(file_mod->ly_mod == mod->ly_mod);
+                if (file_mod->err_info) {
+                    err_info = file_mod->err_info;
+                    file_mod->err_info = NULL;
+                    return err_info;
+                }
+                if (mod_info->data && file_mod->data) {
+                    sr_ly_link(mod_info->data, file_mod->data);
+                } else if (file_mod->data) {
+                    mod_info->data = file_mod->data;
+                }
+                file_mod->data = NULL;
+            } else if ((err_info = sr_module_file_data_append(mod->ly_mod, conf_ds, &mod_info->data))) {
                 return err_info;
             }
 
+            if (prune && (mod_info->ds != SR_DS_OPERATIONAL)) {
+                /* drop all the data that cannot be selected right away */
+                sr_modinfo_module_data_prune(&mod_info->data, mod->ly_mod, name, len);
+            }
+
             if (mod_info->ds == SR_DS_OPERATIONAL) {
                 /* keep only enabled module data */
-                if ((err_info = sr_module_oper_data_dup_enabled(mod_info->data, conn->ext_shm.addr, mod, opts,
+                if ((err_info = sr_module_oper_data_dup_enabled(mod_info->data, conn, mod, opts,
                             &mod_data))) {
                     return err_info;
                 }
@@ -1574,14 +2249,16 @@ sr_modinfo_module_data_load(struct sr_mod_info_s *mod_info, struct sr_mod_info_m
                 }
             }
 
-            /* append any operational data provided by clients */
-            if ((err_info = sr_module_oper_data_update(mod, sid, request_xpath, conn->ext_shm.addr,
-                        timeout_ms, opts, &mod_info->data, cb_error_info))) {
+            /* apply any stored operational data */
+            if ((err_info = sr_module_oper_data_load_stored(mod, opts, &mod_info->data))) {
                 return err_info;
             }
 
-            /* trim any data according to options (they could not be trimmed before oper subscriptions) */
-            sr_oper_data_trim_r(&mod_info->data, mod_info->data, opts);
+            if (prune) {
+                /* drop all the data that cannot be selected, there is no point in processing them further,
+                 * not sooner because the stored diff may reference any of them */
+                sr_modinfo_module_data_prune(&mod_info->data, mod->ly_mod, name, len);
+            }
         }
     } else {
         /* we can use cached data and hence they must be cached */
@@ -1684,13 +2361,26 @@ sr_modinfo_add_instid_deps_data(struct sr_mod_info_s *mod_info, sr_mod_data_dep_
             goto cleanup;
         }
 
-        /* add this module data if not already there */
-        if ((j < mod_info->mod_count) && (err_info = sr_modinfo_module_data_load(mod_info, &mod_info->mods[j], sid,
-                    NULL, timeout_ms, 0, cb_error_info))) {
+        if (j == mod_info->mod_count) {
+            /* module data already there */
+            continue;
+        }
+
+        /* add this module data */
+        if ((err_info = sr_modinfo_module_data_load(mod_info, &mod_info->mods[j], NULL, 0, 0, NULL))) {
+            goto cleanup;
+        }
+        if ((mod_info->ds == SR_DS_OPERATIONAL) && (err_info = sr_module_oper_data_update(&mod_info->mods[j], sid,
+                NULL, 0, conn, timeout_ms, 0, &mod_info->data, cb_error_info))) {
             goto cleanup;
         }
     }
 
+    if (mod_info->ds == SR_DS_OPERATIONAL) {
+        /* trim any origin from the data */
+        sr_oper_data_trim_r(&mod_info->data, mod_info->data, 0);
+    }
+
     /* success */
 
 cleanup:
@@ -1739,6 +2429,68 @@ sr_modinfo_ly_val_diff_merge(struct sr_mod_info_s *mod_info, struct lyd_difflist
     return NULL;
 }
 
+/**
+ * @brief Learn whether data of a module in mod info must be validated.
+ *
+ * Stored startup and running data are always valid so only the modules that were changed and the modules that
+ * can reference the changed data need to be validated. Data of the other datastores are all validated.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod Mod info module to check.
+ * @return 0 if not, non-zero if it must be validated.
+ */
+static int
+sr_modinfo_module_validate_required(struct sr_mod_info_s *mod_info, struct sr_mod_info_mod_s *mod)
+{
+    char *ext_shm_addr = mod_info->conn->ext_shm.addr;
+    struct sr_mod_info_mod_s *mod2;
+    sr_mod_data_dep_t *shm_deps;
+    off_t *shm_inv_deps;
+    uint32_t i;
+    uint16_t j;
+
+    if ((mod_info->ds != SR_DS_STARTUP) && (mod_info->ds != SR_DS_RUNNING)) {
+        /* previous data may not be valid, full validation */
+        return 1;
+    }
+
+    if (mod->state & MOD_INFO_CHANGED) {
+        /* changed data */
+        return 1;
+    }
+
+    shm_deps = (sr_mod_data_dep_t *)(ext_shm_addr + mod->shm_mod->data_deps);
+    for (j = 0; j < mod->shm_mod->data_dep_count; ++j) {
+        if (shm_deps[j].type == SR_DEP_INSTID) {
+            /* instance-identifiers can reference any data, we cannot tell whether they were changed */
+            for (i = 0; i < mod_info->mod_count; ++i) {
+                if (mod_info->mods[i].state & MOD_INFO_CHANGED) {
+                    return 1;
+                }
+            }
+            return 0;
+        }
+    }
+
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod2 = &mod_info->mods[i];
+        if (!(mod2->state & MOD_INFO_CHANGED)) {
+            continue;
+        }
+
+        /* is this module referencing the changed module data? */
+        shm_inv_deps = (off_t *)(ext_shm_addr + mod2->shm_mod->inv_data_deps);
+        for (j = 0; j < mod2->shm_mod->inv_data_dep_count; ++j) {
+            if (shm_inv_deps[j] == mod->shm_mod->name) {
+                return 1;
+            }
+        }
+    }
+
+    /* neither the data nor any referenced data were changed */
+    return 0;
+}
+
 sr_error_info_t *
 sr_modinfo_validate(struct sr_mod_info_s *mod_info, int finish_diff, sr_sid_t *sid, sr_error_info_t **cb_error_info)
 {
@@ -1746,17 +2498,27 @@ sr_modinfo_validate(struct sr_mod_info_s *mod_info, int finish_diff, sr_sid_t *s
     struct sr_mod_info_mod_s *mod;
     struct lyd_difflist *diff = NULL;
     const struct lys_module **valid_mods = NULL;
+    char *valid = NULL;
     uint32_t i, j, valid_mod_count = 0;
     int flags;
 
     assert(SR_IS_CONVENTIONAL_DS(mod_info->ds) || (sid && cb_error_info));
     assert(!mod_info->data_cached);
 
+    valid = calloc(mod_info->mod_count, sizeof *valid);
+    SR_CHECK_MEM_GOTO(!valid, err_info, cleanup);
+
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
         switch (mod->state & MOD_INFO_TYPE_MASK) {
         case MOD_INFO_REQ:
+            if (!sr_modinfo_module_validate_required(mod_info, mod)) {
+                /* no need to validate this module */
+                break;
+            }
+
             /* this module will be validated */
+            valid[i] = 1;
             ++valid_mod_count;
 
             if (mod->state & MOD_INFO_CHANGED) {
@@ -1770,8 +2532,11 @@ sr_modinfo_validate(struct sr_mod_info_s *mod_info, int finish_diff, sr_sid_t *s
             break;
         case MOD_INFO_INV_DEP:
             /* this module reference targets could have been changed, needs to be validated */
-            ++valid_mod_count;
-            /* fallthrough */
+            if (sr_modinfo_module_validate_required(mod_info, mod)) {
+                valid[i] = 1;
+                ++valid_mod_count;
+            }
+            break;
         case MOD_INFO_DEP:
             /* this module will not be validated */
             break;
@@ -1780,20 +2545,18 @@ sr_modinfo_validate(struct sr_mod_info_s *mod_info, int finish_diff, sr_sid_t *s
         }
     }
 
+    if (!valid_mod_count) {
+        /* nothing to validate */
+        goto cleanup;
+    }
+
     /* create an array of all the modules that will be validated */
     valid_mods = malloc(valid_mod_count * sizeof *valid_mods);
     SR_CHECK_MEM_GOTO(!valid_mods, err_info, cleanup);
     for (i = 0, j = 0; i < mod_info->mod_count; ++i) {
-        mod = &mod_info->mods[i];
-        switch (mod->state & MOD_INFO_TYPE_MASK) {
-        case MOD_INFO_REQ:
-        case MOD_INFO_INV_DEP:
-            valid_mods[j] = mod->ly_mod;
+        if (valid[i]) {
+            valid_mods[j] = mod_info->mods[i].ly_mod;
             ++j;
-            break;
-        case MOD_INFO_DEP:
-            /* is not validated */
-            break;
         }
     }
     assert(j == valid_mod_count);
@@ -1822,6 +2585,7 @@ sr_modinfo_validate(struct sr_mod_info_s *mod_info, int finish_diff, sr_sid_t *s
 cleanup:
     lyd_free_val_diff(diff);
     free(valid_mods);
+    free(valid);
     return err_info;
 }
 
@@ -1955,12 +2719,174 @@ cleanup:
     return err_info;
 }
 
-sr_error_info_t *
-sr_modinfo_data_load(struct sr_mod_info_s *mod_info, uint8_t mod_type, int cache, sr_sid_t *sid,
-        const char *request_xpath, uint32_t timeout_ms, sr_get_oper_options_t opts, sr_error_info_t **cb_error_info)
+/**
+ * @brief Module data file parsing of several modules shared by all the threads.
+ */
+struct sr_file_load_s {
+    struct sr_file_load_mod_s **mods;   /**< Modules to parse. */
+    uint32_t mod_count;             /**< Count of modules. */
+    ATOMIC_T next_mod;              /**< Index of the next module to parse. */
+    sr_datastore_t ds;              /**< Datastore of the data files. */
+};
+
+/**
+ * @brief Thread parsing data files of the next modules until there are none left.
+ *
+ * @param[in] arg Shared module data file parsing structure.
+ * @return Always NULL.
+ */
+static void *
+sr_file_load_thread(void *arg)
+{
+    struct sr_file_load_s *load = (struct sr_file_load_s *)arg;
+    struct sr_file_load_mod_s *fmod;
+    uint32_t idx;
+
+    while ((idx = ATOMIC_INC_RELAXED(load->next_mod)) < load->mod_count) {
+        fmod = load->mods[idx];
+        fmod->err_info = sr_module_file_data_append(fmod->ly_mod, load->ds, &fmod->data);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Parse data files of all the modules whose data will be loaded from them using several threads.
+ * Modules must be locked.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod_type Types of modules whose data should only be loaded.
+ * @param[out] file_mods Array of parsed data for every mod info module, NULL if the files were not parsed.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_data_load_files_parallel(struct sr_mod_info_s *mod_info, uint8_t mod_type,
+        struct sr_file_load_mod_s **file_mods)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_file_load_s load = {0};
+    pthread_t *tids = NULL;
+    uint32_t i, thread_max, thread_count = 0;
+    long cpu_count;
+    int ret;
+
+    *file_mods = NULL;
+
+    if (mod_info->data_cached || (((mod_info->ds == SR_DS_RUNNING) || (mod_info->ds2 == SR_DS_RUNNING)) &&
+            (mod_info->conn->opts & SR_CONN_CACHE_RUNNING))) {
+        /* data are loaded from the cache */
+        return NULL;
+    }
+
+    /* learn how many files to parse */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        if (mod_info->mods[i].state & mod_type) {
+            ++load.mod_count;
+        }
+    }
+    if (load.mod_count < SR_DATA_LOAD_PARALLEL_MIN_MODS) {
+        /* not worth the threads */
+        return NULL;
+    }
+
+    cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_max = (cpu_count > 0) ? (uint32_t)cpu_count : 1;
+    if (thread_max > SR_DATA_LOAD_THREAD_COUNT) {
+        thread_max = SR_DATA_LOAD_THREAD_COUNT;
+    }
+    if (thread_max > load.mod_count) {
+        thread_max = load.mod_count;
+    }
+    if (thread_max < 2) {
+        /* nothing to parallelize */
+        return NULL;
+    }
+
+    *file_mods = calloc(mod_info->mod_count, sizeof **file_mods);
+    load.mods = malloc(load.mod_count * sizeof *load.mods);
+    tids = malloc((thread_max - 1) * sizeof *tids);
+    if (!*file_mods || !load.mods || !tids) {
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+    load.ds = (mod_info->ds == SR_DS_OPERATIONAL) ? SR_DS_RUNNING : mod_info->ds;
+
+    /* collect the modules, their data will be linked in the mod info order */
+    load.mod_count = 0;
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        if (mod_info->mods[i].state & mod_type) {
+            (*file_mods)[i].ly_mod = mod_info->mods[i].ly_mod;
+            load.mods[load.mod_count] = &(*file_mods)[i];
+            ++load.mod_count;
+        }
+    }
+
+    /* dispatch the modules to the threads, this thread is also one of them */
+    while (thread_count + 1 < thread_max) {
+        if ((ret = pthread_create(&tids[thread_count], NULL, sr_file_load_thread, &load))) {
+            /* continue with the threads we have */
+            SR_LOG_WRN("Failed to create a thread (%s).", strerror(ret));
+            break;
+        }
+        ++thread_count;
+    }
+    sr_file_load_thread(&load);
+
+    /* wait for all the files to be parsed */
+    for (i = 0; i < thread_count; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+
+cleanup:
+    if (err_info) {
+        free(*file_mods);
+        *file_mods = NULL;
+    }
+    free(tids);
+    free(load.mods);
+    return err_info;
+}
+
+/**
+ * @brief Free parsed module data files that were not used.
+ *
+ * @param[in] file_mods Array of parsed data for every mod info module.
+ * @param[in] mod_count Count of mod info modules.
+ */
+static void
+sr_modinfo_data_load_files_free(struct sr_file_load_mod_s *file_mods, uint32_t mod_count)
+{
+    uint32_t i;
+
+    if (!file_mods) {
+        return;
+    }
+
+    for (i = 0; i < mod_count; ++i) {
+        lyd_free_withsiblings(file_mods[i].data);
+        sr_errinfo_free(&file_mods[i].err_info);
+    }
+    free(file_mods);
+}
+
+/**
+ * @brief Load base data for modules in mod info, without any data from operational subscribers.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod_type Types of modules whose data should only be loaded.
+ * @param[in] cache Whether it makes sense to use cached data, if available.
+ * @param[in] request_xpath XPath of the data request.
+ * @param[in] prune Whether top-level data that cannot be selected by @p request_xpath can be omitted.
+ * @param[in] opts Get oper data options.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_data_load_base(struct sr_mod_info_s *mod_info, uint8_t mod_type, int cache, const char *request_xpath,
+        int prune, sr_get_oper_options_t opts)
 {
     sr_error_info_t *err_info = NULL;
     struct sr_mod_info_mod_s *mod;
+    struct sr_file_load_mod_s *file_mods = NULL;
     uint32_t i;
 
     assert(!mod_info->data);
@@ -1976,20 +2902,354 @@ sr_modinfo_data_load(struct sr_mod_info_s *mod_info, uint8_t mod_type, int cache
         mod_info->data_cached = 1;
     }
 
+    /* parse all the data files first, if there are many */
+    if ((err_info = sr_modinfo_data_load_files_parallel(mod_info, mod_type, &file_mods))) {
+        return err_info;
+    }
+
     /* load data for each module */
     for (i = 0; i < mod_info->mod_count; ++i) {
         mod = &mod_info->mods[i];
         if (mod->state & mod_type) {
-            if ((err_info = sr_modinfo_module_data_load(mod_info, mod, sid, request_xpath, timeout_ms, opts, cb_error_info))) {
+            if ((err_info = sr_modinfo_module_data_load(mod_info, mod, request_xpath, prune, opts,
+                    file_mods ? &file_mods[i] : NULL))) {
                 /* if cached, we keep both cache lock and flag, so it is fine */
-                return err_info;
+                break;
+            }
+        }
+    }
+
+    sr_modinfo_data_load_files_free(file_mods, mod_info->mod_count);
+    return err_info;
+}
+
+/**
+ * @brief Check whether an XPath selects only data of a specific module top-level nodes.
+ *
+ * @param[in] xpath XPath to check.
+ * @param[in] ly_mod Module of the top-level nodes.
+ * @return 0 if not, non-zero if it does.
+ */
+static int
+sr_xpath_first_node_module_match(const char *xpath, const struct lys_module *ly_mod)
+{
+    size_t len;
+
+    if ((xpath[0] != '/') || (xpath[1] == '/')) {
+        return 0;
+    }
+
+    len = strlen(ly_mod->name);
+    return !strncmp(xpath + 1, ly_mod->name, len) && (xpath[1 + len] == ':');
+}
+
+/**
+ * @brief Check whether operational subscribers of a module can provide its data independently
+ * of all the other modules (neither this module subscribers change data of other modules nor the other way around).
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod_type Types of modules whose data should only be loaded.
+ * @param[in] mod Mod info module to check.
+ * @return 0 if not, non-zero if it does.
+ */
+static int
+sr_modinfo_module_oper_subs_independent(struct sr_mod_info_s *mod_info, uint8_t mod_type,
+        struct sr_mod_info_mod_s *mod)
+{
+    sr_error_info_t *err_info;
+    struct sr_mod_info_mod_s *mod2;
+    sr_mod_oper_sub_t *shm_msubs;
+    uint32_t i;
+    uint16_t j;
+    int match, independent = 1;
+
+    if (!mod->shm_mod->oper_sub_count) {
+        /* nothing to do */
+        return 0;
+    }
+
+    for (i = 0; (i < mod_info->mod_count) && independent; ++i) {
+        mod2 = &mod_info->mods[i];
+        if (!(mod2->state & mod_type)) {
+            continue;
+        }
+
+        /* MOD SUBS READ LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(mod_info->conn, &mod2->shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+            /* cannot tell, the data will be loaded the standard way */
+            sr_errinfo_free(&err_info);
+            return 0;
+        }
+
+        shm_msubs = (sr_mod_oper_sub_t *)(mod_info->conn->ext_shm.addr + mod2->shm_mod->oper_subs);
+        for (j = 0; j < mod2->shm_mod->oper_sub_count; ++j) {
+            match = sr_xpath_first_node_module_match(mod_info->conn->ext_shm.addr + shm_msubs[j].xpath, mod->ly_mod);
+            if ((mod2 == mod) && !match) {
+                /* our subscriber provides data of another module (or we cannot tell) */
+                independent = 0;
+                break;
+            } else if ((mod2 != mod) && match) {
+                /* another module subscriber provides data into our data */
+                independent = 0;
+                break;
             }
         }
+
+        /* MOD SUBS READ UNLOCK */
+        sr_shmmain_sub_unlock(mod_info->conn, &mod2->shm_mod->sub_lock, SR_LOCK_READ, __func__);
+    }
+
+    return independent;
+}
+
+/**
+ * @brief Operational data load of a single module performed by a separate thread.
+ */
+struct sr_oper_load_mod_s {
+    struct sr_mod_info_mod_s *mod;  /**< Mod info module to load. */
+    struct lyd_node *data;          /**< Module data updated by the subscribers. */
+    sr_error_info_t *err_info;      /**< Error info of the load. */
+    sr_error_info_t *cb_err_info;   /**< Callback error info of the load. */
+};
+
+/**
+ * @brief Operational data load of several modules shared by all the threads.
+ */
+struct sr_oper_load_s {
+    struct sr_oper_load_mod_s *mods;    /**< Modules to load. */
+    uint32_t mod_count;             /**< Count of modules. */
+    ATOMIC_T next_mod;              /**< Index of the next module to load. */
+
+    sr_sid_t *sid;                  /**< Sysrepo session ID. */
+    const char *request_xpath;      /**< XPath of the data request. */
+    uint32_t max_depth;             /**< Maximum depth of the requested data. */
+    sr_conn_ctx_t *conn;            /**< Connection to use. */
+    uint32_t timeout_ms;            /**< Operational callback timeout in milliseconds. */
+    sr_get_oper_options_t opts;     /**< Get oper data options. */
+};
+
+/**
+ * @brief Thread loading operational data of the next modules until there are none left.
+ *
+ * @param[in] arg Shared operational data load structure.
+ * @return Always NULL.
+ */
+static void *
+sr_oper_load_thread(void *arg)
+{
+    struct sr_oper_load_s *load = (struct sr_oper_load_s *)arg;
+    struct sr_oper_load_mod_s *lmod;
+    uint32_t idx;
+
+    while ((idx = ATOMIC_INC_RELAXED(load->next_mod)) < load->mod_count) {
+        lmod = &load->mods[idx];
+
+        /* subscriptions of one module are still processed in order, parents before nested data */
+        lmod->err_info = sr_module_oper_data_update(lmod->mod, load->sid, load->request_xpath, load->max_depth,
+                load->conn, load->timeout_ms, load->opts, &lmod->data, &lmod->cb_err_info);
     }
 
     return NULL;
 }
 
+/**
+ * @brief Load data from operational subscribers of modules that can be processed independently
+ * using several threads, so that the subscribers can provide the data concurrently.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod_type Types of modules whose data should only be loaded.
+ * @param[in] sid Sysrepo session ID.
+ * @param[in] request_xpath XPath of the data request.
+ * @param[in] max_depth Maximum depth of the requested data, 0 for unlimited.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] opts Get oper data options.
+ * @param[in,out] loaded Array of flags for every mod info module, set for modules whose data were loaded.
+ * @param[out] cb_error_info Callback error info in case an operational subscriber of required data failed.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_data_load_subs_parallel(struct sr_mod_info_s *mod_info, uint8_t mod_type, sr_sid_t *sid,
+        const char *request_xpath, uint32_t max_depth, uint32_t timeout_ms, sr_get_oper_options_t opts, char *loaded,
+        sr_error_info_t **cb_error_info)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_oper_load_s load = {0};
+    struct sr_mod_info_mod_s *mod;
+    pthread_t *tids = NULL;
+    uint32_t i, thread_count = 0;
+    int ret;
+
+    load.mods = calloc(mod_info->mod_count, sizeof *load.mods);
+    SR_CHECK_MEM_RET(!load.mods, err_info);
+    load.sid = sid;
+    load.request_xpath = request_xpath;
+    load.max_depth = max_depth;
+    load.conn = mod_info->conn;
+    load.timeout_ms = timeout_ms;
+    load.opts = opts;
+
+    /* collect all the independent modules */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod = &mod_info->mods[i];
+        if ((mod->state & mod_type) && sr_modinfo_module_oper_subs_independent(mod_info, mod_type, mod)) {
+            load.mods[load.mod_count].mod = mod;
+            ++load.mod_count;
+        }
+    }
+    if (load.mod_count < 2) {
+        /* nothing to parallelize */
+        goto cleanup;
+    }
+
+    /* every module data are processed separately */
+    for (i = 0; i < load.mod_count; ++i) {
+        load.mods[i].data = sr_module_data_unlink(&mod_info->data, load.mods[i].mod->ly_mod);
+    }
+
+    /* dispatch the modules to the threads, this thread is also one of them */
+    tids = malloc(((mod_info->conn->oper_parallel_limit < load.mod_count) ? mod_info->conn->oper_parallel_limit :
+            load.mod_count) * sizeof *tids);
+    SR_CHECK_MEM_GOTO(!tids, err_info, cleanup_link);
+    while ((thread_count + 1 < mod_info->conn->oper_parallel_limit) && (thread_count + 1 < load.mod_count)) {
+        if ((ret = pthread_create(&tids[thread_count], NULL, sr_oper_load_thread, &load))) {
+            /* continue with the threads we have */
+            SR_LOG_WRN("Failed to create a thread (%s).", strerror(ret));
+            break;
+        }
+        ++thread_count;
+    }
+    sr_oper_load_thread(&load);
+
+    /* wait for all the replies */
+    for (i = 0; i < thread_count; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+
+    /* collect the results, in the order of the modules */
+    for (i = 0; i < load.mod_count; ++i) {
+        if (load.mods[i].err_info) {
+            sr_errinfo_merge(&err_info, load.mods[i].err_info);
+            load.mods[i].err_info = NULL;
+        }
+        if (load.mods[i].cb_err_info) {
+            sr_errinfo_merge(cb_error_info, load.mods[i].cb_err_info);
+            load.mods[i].cb_err_info = NULL;
+        }
+        loaded[load.mods[i].mod - mod_info->mods] = 1;
+    }
+
+cleanup_link:
+    /* link all module data back */
+    for (i = 0; i < load.mod_count; ++i) {
+        if (mod_info->data && load.mods[i].data) {
+            sr_ly_link(mod_info->data, load.mods[i].data);
+        } else if (load.mods[i].data) {
+            mod_info->data = load.mods[i].data;
+        }
+    }
+
+cleanup:
+    free(tids);
+    free(load.mods);
+    return err_info;
+}
+
+/**
+ * @brief Load data from operational subscribers for modules in mod info, base data must already be loaded.
+ * Modules do not need to be locked.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] mod_type Types of modules whose data should only be loaded.
+ * @param[in] sid Sysrepo session ID.
+ * @param[in] request_xpath XPath of the data request.
+ * @param[in] max_depth Maximum depth of the requested data, 0 for unlimited.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] opts Get oper data options.
+ * @param[out] cb_error_info Callback error info in case an operational subscriber of required data failed.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_modinfo_data_load_subs(struct sr_mod_info_s *mod_info, uint8_t mod_type, sr_sid_t *sid, const char *request_xpath,
+        uint32_t max_depth, uint32_t timeout_ms, sr_get_oper_options_t opts, sr_error_info_t **cb_error_info)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_mod_info_mod_s *mod;
+    char *loaded = NULL;
+    uint32_t i;
+
+    if (mod_info->ds != SR_DS_OPERATIONAL) {
+        /* no subscribers */
+        return NULL;
+    }
+
+    if (!(opts & SR_OPER_NO_SUBS) && (mod_info->conn->oper_parallel_limit > 1)) {
+        loaded = calloc(mod_info->mod_count, sizeof *loaded);
+        SR_CHECK_MEM_RET(!loaded, err_info);
+
+        /* first query the subscribers of all the independent modules at once */
+        if ((err_info = sr_modinfo_data_load_subs_parallel(mod_info, mod_type, sid, request_xpath, max_depth,
+                timeout_ms, opts, loaded, cb_error_info))) {
+            goto cleanup;
+        }
+    }
+
+    /* append any operational data provided by clients for each remaining module */
+    for (i = 0; i < mod_info->mod_count; ++i) {
+        mod = &mod_info->mods[i];
+        if ((mod->state & mod_type) && (!loaded || !loaded[i])) {
+            if ((err_info = sr_module_oper_data_update(mod, sid, request_xpath, max_depth, mod_info->conn, timeout_ms,
+                    opts, &mod_info->data, cb_error_info))) {
+                goto cleanup;
+            }
+        }
+    }
+
+    /* trim any data according to options (they could not be trimmed before oper subscriptions) */
+    sr_oper_data_trim_r(&mod_info->data, mod_info->data, opts);
+
+cleanup:
+    free(loaded);
+    return err_info;
+}
+
+sr_error_info_t *
+sr_modinfo_data_load(struct sr_mod_info_s *mod_info, uint8_t mod_type, int cache, sr_sid_t *sid,
+        const char *request_xpath, uint32_t max_depth, int prune, uint32_t timeout_ms, sr_get_oper_options_t opts,
+        sr_error_info_t **cb_error_info)
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* load base data */
+    if ((err_info = sr_modinfo_data_load_base(mod_info, mod_type, cache, request_xpath, prune, opts))) {
+        return err_info;
+    }
+
+    /* load subscribers data */
+    return sr_modinfo_data_load_subs(mod_info, mod_type, sid, request_xpath, max_depth, timeout_ms, opts, cb_error_info);
+}
+
+sr_error_info_t *
+sr_modinfo_data_load_snapshot(struct sr_mod_info_s *mod_info, sr_sid_t *sid, const char *request_xpath,
+        uint32_t max_depth, int prune, uint32_t timeout_ms, sr_get_oper_options_t opts, sr_error_info_t **cb_error_info)
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* load base data of the pinned module versions */
+    if ((err_info = sr_modinfo_data_load_base(mod_info, MOD_INFO_REQ, 1, request_xpath, prune, opts))) {
+        return err_info;
+    }
+
+    /* the data are either our own copy or protected by the cache lock, we do not need the modules anymore
+     * so do not block any writers while the (possibly slow) subscribers are providing their data */
+
+    /* MODULES UNLOCK */
+    sr_shmmod_modinfo_unlock(mod_info, 0);
+
+    /* load subscribers data */
+    return sr_modinfo_data_load_subs(mod_info, MOD_INFO_REQ, sid, request_xpath, max_depth, timeout_ms, opts,
+            cb_error_info);
+}
+
 sr_error_info_t *
 sr_modinfo_get_filter(struct sr_mod_info_s *mod_info, const char *xpath, sr_session_ctx_t *session, struct ly_set **result)
 {
@@ -2080,7 +3340,7 @@ sr_modinfo_generate_config_change_notif(struct sr_mod_info_s *mod_info, sr_sessi
     struct ly_set *set;
     sr_mod_t *shm_mod;
     time_t notif_ts;
-    sr_mod_notif_sub_t *notif_subs;
+    sr_mod_notif_sub_t *notif_subs = NULL;
     uint32_t idx = 0, notif_sub_count;
     char *xpath, nc_str[11];
     const char *op_enum;
@@ -2123,10 +3383,10 @@ sr_modinfo_generate_config_change_notif(struct sr_mod_info_s *mod_info, sr_sessi
 
     /* get this module and check replay support */
     shm_mod = sr_shmmain_find_module(&mod_info->conn->main_shm, mod_info->conn->ext_shm.addr, "ietf-netconf-notifications", 0);
-    SR_CHECK_INT_RET(!shm_mod, err_info);
+    SR_CHECK_INT_GOTO(!shm_mod, err_info, cleanup);
     if (!(shm_mod->flags & SR_MOD_REPLAY_SUPPORT) && !notif_sub_count) {
         /* nothing to do */
-        return NULL;
+        goto cleanup;
     }
 
     set = ly_set_new();
@@ -2231,6 +3491,7 @@ sr_modinfo_generate_config_change_notif(struct sr_mod_info_s *mod_info, sr_sessi
     tmp_err_info = sr_replay_store(session, notif, notif_ts);
 
     /* send the notification (non-validated, if everything works correctly it must be valid) */
+    ATOMIC_INC_RELAXED(shm_mod->stats.notifs);
     if (notif_sub_count && (err_info = sr_shmsub_notif_notify(notif, notif_ts, session->sid, (uint32_t *)notif_subs,
             notif_sub_count))) {
         goto cleanup;
@@ -2239,6 +3500,7 @@ sr_modinfo_generate_config_change_notif(struct sr_mod_info_s *mod_info, sr_sessi
     /* success */
 
 cleanup:
+    free(notif_subs);
     ly_set_free(set);
     lyd_free_withsiblings(notif);
     if (err_info) {
@@ -2256,8 +3518,9 @@ sr_error_info_t *
 sr_modinfo_data_store(struct sr_mod_info_s *mod_info)
 {
     sr_error_info_t *err_info = NULL, *tmp_err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)mod_info->conn->main_shm.addr;
     struct sr_mod_info_mod_s *mod;
-    struct lyd_node *mod_data, *diff = NULL;
+    struct lyd_node *mod_data, *mod_diff, *diff = NULL;
     uint32_t i;
     int change, create_flags;
 
@@ -2299,17 +3562,37 @@ sr_modinfo_data_store(struct sr_mod_info_s *mod_info)
 
                 if (mod_info->ds == SR_DS_RUNNING) {
                     /* update module running data version */
-                    ++mod->shm_mod->ver;
+                    mod->ver = ++mod->shm_mod->ver;
+
+                    /* store the diff creating this version for connections caching the previous one, if any */
+                    mod_diff = sr_module_data_unlink(&mod_info->diff, mod->ly_mod);
+                    tmp_err_info = NULL;
+                    if (main_shm->cache_running_conn_count) {
+                        tmp_err_info = sr_module_file_diff_set(mod->ly_mod->name, mod->ver, mod_diff);
+                    }
+                    if (tmp_err_info) {
+                        /* caching connections will reload the data instead */
+                        sr_errinfo_free(&tmp_err_info);
+                        SR_LOG_WRN("Failed to store the diff of module \"%s\".", mod->ly_mod->name);
+                    }
 
                     if (mod_info->conn->opts & SR_CONN_CACHE_RUNNING) {
                         /* we are caching so update cache with these data */
-                        tmp_err_info = sr_modcache_module_running_update(&mod_info->conn->mod_cache, mod, mod_data, 0);
+                        tmp_err_info = sr_modcache_module_running_update(&mod_info->conn->mod_cache, mod, mod_data,
+                                mod_diff, 0);
                         if (tmp_err_info) {
                             /* always store all changed modules, if possible */
                             sr_errinfo_merge(&err_info, tmp_err_info);
                             tmp_err_info = NULL;
                         }
                     }
+
+                    /* connect the diff back */
+                    if (mod_info->diff && mod_diff) {
+                        sr_ly_link(mod_info->diff, mod_diff);
+                    } else if (mod_diff) {
+                        mod_info->diff = mod_diff;
+                    }
                 }
 
                 /* connect them back */
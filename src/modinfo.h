@@ -51,6 +51,7 @@ struct sr_mod_info_s {
         sr_mod_t *shm_mod;      /**< Module SHM structure. */
         uint8_t state;          /**< Module state (flags). */
         const struct lys_module *ly_mod;    /**< Module libyang structure. */
+        uint32_t ver;           /**< Module data version of the loaded data, pinned while the module was locked. */
 
         uint32_t request_id;    /**< Request ID of the published event. */
     } *mods;                    /**< Relevant modules. */
@@ -60,6 +61,9 @@ struct sr_mod_info_s {
 /**
  * @brief Add a module into mod info.
  *
+ * If any dependencies are required, they are merged from the precomputed module dependency closure
+ * and all the modules are kept sorted by their main SHM position (locking order).
+ *
  * @param[in] shm_mod Module SHM structure.
  * @param[in] ly_mod Module libyang structure.
  * @param[in] mod_type Module type.
@@ -121,7 +125,8 @@ sr_error_info_t *sr_modinfo_diff_merge(struct sr_mod_info_s *mod_info, const str
 sr_error_info_t *sr_modinfo_replace(struct sr_mod_info_s *mod_info, struct lyd_node **src_data);
 
 /**
- * @brief Validate data for modules in mod info.
+ * @brief Validate data for modules in mod info. For startup and running datastores, only the data
+ * of changed modules and the modules referencing them are validated.
  *
  * @param[in] mod_info Mod info to use.
  * @param[in] finish_diff Whether to update diff with possible changes caused by validation.
@@ -166,14 +171,37 @@ sr_error_info_t *sr_modinfo_op_validate(struct sr_mod_info_s *mod_info, struct l
  * @param[in] mod_type Types of modules whose data should only be loaded.
  * @param[in] cache Whether it makes sense to use cached data, if available.
  * @param[in] sid Sysrepo session ID.
- * @param[in] request_id XPath of the data request.
+ * @param[in] request_xpath XPath of the data request.
+ * @param[in] max_depth Maximum depth of the requested data, 0 for unlimited. Operational subscriptions providing
+ * only deeper data are not called.
+ * @param[in] prune Whether top-level subtrees of required modules that cannot be selected by @p request_xpath
+ * can be omitted from the loaded data. Must not be set if any changes are to be applied on the data.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
  * @param[in] opts Get oper data options.
  * @param[out] cb_error_info Callback error info in case an operational subscriber of required data failed.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_modinfo_data_load(struct sr_mod_info_s *mod_info, uint8_t mod_type, int cache, sr_sid_t *sid,
-        const char *request_id, uint32_t timeout_ms, sr_get_oper_options_t opts, sr_error_info_t **cb_error_info);
+        const char *request_xpath, uint32_t max_depth, int prune, uint32_t timeout_ms, sr_get_oper_options_t opts,
+        sr_error_info_t **cb_error_info);
+
+/**
+ * @brief Load data for required modules in mod info as a snapshot. First, the base data (configuration,
+ * stored operational, internal) of the pinned module data versions are loaded, then the module locks are released
+ * and only afterwards are the data retrieved from operational subscribers. Modules must be READ-locked.
+ *
+ * @param[in] mod_info Mod info to use.
+ * @param[in] sid Sysrepo session ID.
+ * @param[in] request_xpath XPath of the data request.
+ * @param[in] max_depth Maximum depth of the requested data, 0 for unlimited.
+ * @param[in] prune Whether top-level subtrees that cannot be selected by @p request_xpath can be omitted.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] opts Get oper data options.
+ * @param[out] cb_error_info Callback error info in case an operational subscriber of required data failed.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_modinfo_data_load_snapshot(struct sr_mod_info_s *mod_info, sr_sid_t *sid, const char *request_xpath,
+        uint32_t max_depth, int prune, uint32_t timeout_ms, sr_get_oper_options_t opts, sr_error_info_t **cb_error_info);
 
 /**
  * @brief Filter data from mod info.
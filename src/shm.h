@@ -31,7 +31,7 @@
 #include "common.h"
 
 #define SR_MAIN_SHM_LOCK "sr_main_lock"     /**< Main SHM file lock name. */
-#define SR_SHM_VER 2                        /**< Main and ext SHM version of their expected content structures. */
+#define SR_SHM_VER 9                        /**< Main and ext SHM version of their expected content structures. */
 
 /**
  * Main SHM organization
@@ -45,13 +45,33 @@
  * modules, each with a ::sr_mod_t structure until the end of main SHM. All `off_t`
  * types in these structures are offset pointers to ext SHM.
  *
- * Ext shm starts with a `size_t` value representing the number of wasted
- * bytes in this SHM segment. It is followed by arrays and strings pointed to
- * by main SHM `off_t` pointers. First, there is the sysrepo connections state ::sr_conn_shm_t
- * meaning all currently running connections. Then, there is information from ::sr_mod_t
- * which includes names, dependencies, and subscriptions. Lastly, there are RPCs ::sr_rpc_t.
+ * Ext shm starts with ::sr_ext_shm_t header. It is followed by arrays and strings pointed to
+ * by main SHM `off_t` pointers. First, there is the information from ::sr_mod_t that does not change
+ * while the main SHM exists, which includes names, features, and dependencies. It is allocated
+ * sequentially when the modules are added. Then, there are slabs with all the items that
+ * are added and removed at runtime, meaning the sysrepo connections state ::sr_conn_shm_t, module
+ * subscriptions, and RPCs ::sr_rpc_t with their subscriptions. Every such item is a block of one of
+ * the size classes and the free blocks of each class are linked into a list so that they can be reused.
+ * Every block is aligned to its size so that a freed block is merged with its free buddy (the other half
+ * of the block twice its size) and a larger free block is split if there is no free block of a class.
  * Also, any pointers in all the previous structures point, again, into ext SHM.
+ *
+ * Main SHM lock protects the modules and connections. The subscriptions of every module, RPC subscriptions, and
+ * connection event pipes are protected by their own locks, which are always locked after the main SHM lock and
+ * allow changing these items while holding only main SHM READ lock. Items can then be allocated in ext SHM
+ * while other processes are using it so any reader must make sure it has all of it mapped after locking
+ * the specific lock (::sr_shmmain_sub_lock_remap()).
+ */
+
+/**
+ * @brief Ext SHM header.
  */
+typedef struct sr_ext_shm_s {
+    pthread_mutex_t lock;       /**< Process-shared robust lock for allocating and freeing ext SHM items. */
+    size_t wasted;              /**< Number of ext SHM bytes not in use, includes all the free slab blocks. */
+    off_t free_blocks[SR_SHM_BLOCK_CLASS_COUNT];    /**< First free block of every size class, 0 if there is none.
+                                                         Every free block starts with the offset of the next one. */
+} sr_ext_shm_t;
 
 /**
  * @brief Ext SHM module dependency type.
@@ -82,6 +102,55 @@ typedef struct sr_mod_op_dep_s {
     uint16_t out_dep_count;     /**< Output dependency count. */
 } sr_mod_op_dep_t;
 
+/**
+ * @brief Ext SHM module dependency closure flags.
+ */
+#define SR_MOD_CLOSURE_DEP          0x01    /**< Data dependency of the module. */
+#define SR_MOD_CLOSURE_INV_DEP      0x02    /**< Inverse data dependency of the module. */
+#define SR_MOD_CLOSURE_INV_DEP_DEP  0x04    /**< Data dependency of an inverse data dependency of the module. */
+
+/**
+ * @brief Ext SHM module dependency closure item, all the modules needed for working with the data of a module.
+ * (typedef sr_mod_closure_t)
+ */
+typedef struct sr_mod_closure_s {
+    uint32_t mod_idx;           /**< Main SHM index of the module. */
+    uint32_t flags;             /**< Closure flags of the module (SR_MOD_CLOSURE_*). */
+} sr_mod_closure_t;
+
+#define SR_STATS_HIST_BUCKETS 24    /**< Number of buckets of a duration histogram. */
+
+/**
+ * @brief SHM duration histogram, bucket i counts durations in the interval [2^(i-1), 2^i) microseconds,
+ * the first bucket durations under 1 microsecond, and the last bucket all the longer durations.
+ * (typedef sr_stats_hist_t)
+ */
+typedef struct sr_stats_hist_s {
+    ATOMIC64_T buckets[SR_STATS_HIST_BUCKETS];  /**< Duration counts. */
+} sr_stats_hist_t;
+
+/**
+ * @brief SHM event statistics of a publisher.
+ * (typedef sr_stats_event_t)
+ */
+typedef struct sr_stats_event_s {
+    ATOMIC64_T published;       /**< Number of published events. */
+    ATOMIC64_T timeouts;        /**< Number of events not processed by the subscribers in time. */
+    sr_stats_hist_t duration;   /**< Durations of processing the events by the subscribers. */
+} sr_stats_event_t;
+
+/**
+ * @brief Commit phases with measured durations.
+ */
+typedef enum sr_stats_commit_phase_e {
+    SR_STATS_COMMIT_VALIDATE = 0,   /**< Validation of the new data. */
+    SR_STATS_COMMIT_UPDATE,         /**< Publishing "update" event. */
+    SR_STATS_COMMIT_CHANGE,         /**< Publishing "change" event. */
+    SR_STATS_COMMIT_STORE,          /**< Storing the new data. */
+    SR_STATS_COMMIT_DONE,           /**< Publishing "done" event. */
+    SR_STATS_COMMIT_PHASE_COUNT     /**< Number of commit phases. */
+} sr_stats_commit_phase_t;
+
 /**
  * @brief Ext SHM module change subscriptions.
  */
@@ -90,6 +159,7 @@ typedef struct sr_mod_change_sub_s {
     uint32_t priority;          /**< Subscription priority. */
     int opts;                   /**< Subscription options. */
     uint32_t evpipe_num;        /**< Event pipe number. */
+    ATOMIC64_T events;          /**< Number of events the subscription was notified about. */
 } sr_mod_change_sub_t;
 
 /**
@@ -110,6 +180,7 @@ typedef struct sr_mod_oper_sub_s {
     sr_mod_oper_sub_type_t sub_type;  /**< Type of the subscription. */
     int opts;                   /**< Subscription options. */
     uint32_t evpipe_num;        /** Event pipe number. */
+    ATOMIC64_T events;          /**< Number of events the subscription was notified about. */
 } sr_mod_oper_sub_t;
 
 /**
@@ -133,8 +204,11 @@ struct sr_mod_s {
         uint8_t ds_locked;      /**< Whether module data are datastore locked (NETCONF locks). */
         sr_sid_t sid;           /**< Session ID of the locking session (user is always NULL). */
         time_t ds_ts;           /**< Timestamp of the datastore lock. */
+        sr_stats_hist_t wait;   /**< Durations of waiting for the lock. */
     } data_lock_info[SR_DS_COUNT]; /**< Module data lock information for each datastore. */
     sr_rwlock_t replay_lock;    /**< Process-shared lock for accessing stored notifications for replay. */
+    sr_rwlock_t sub_lock;       /**< Process-shared lock for accessing module change, operational, and notification
+                                     subscriptions. */
     uint32_t ver;               /**< Module data version (non-zero). */
 
     off_t name;                 /**< Module name. */
@@ -149,6 +223,9 @@ struct sr_mod_s {
     uint16_t inv_data_dep_count;    /**< Number of inverse data dependencies. */
     off_t op_deps;              /**< Array of operation dependencies. */
     uint16_t op_dep_count;      /**< Number of operation dependencies. */
+    off_t dep_closure;          /**< Array of all (inverse) data dependencies sorted by module index
+                                     (sr_mod_closure_t *). */
+    uint16_t dep_closure_count; /**< Number of modules in the dependency closure. */
 
     struct {
         off_t subs;             /**< Array of change subscriptions. */
@@ -160,6 +237,12 @@ struct sr_mod_s {
 
     off_t notif_subs;           /**< Array of notification subscriptions. */
     uint16_t notif_sub_count;   /**< Number of notification subscriptions. */
+
+    struct {
+        sr_stats_event_t change[SR_DS_COUNT];   /**< Change events for each datastore. */
+        sr_stats_event_t oper;  /**< Operational data requests. */
+        ATOMIC64_T notifs;      /**< Number of sent notifications. */
+    } stats;                    /**< Module statistics, updated without any locks. */
 };
 
 /**
@@ -170,6 +253,7 @@ typedef struct sr_rpc_sub_s {
     uint32_t priority;          /**< Subscription priority. */
     int opts;                   /**< Subscription options. */
     uint32_t evpipe_num;        /**< Event pipe number. */
+    uint32_t slot;              /**< Sub SHM slot of a concurrent subscription, 0 for standard subscriptions. */
 } sr_rpc_sub_t;
 
 /**
@@ -207,11 +291,22 @@ typedef struct sr_conn_shm_s {
 
     sr_conn_shm_lock_t main_lock; /**< Held main SHM lock. */
     off_t mod_locks;            /**< Held SHM module locks, points to (sr_conn_state_lock_t (*)[SR_DS_COUNT]). */
+    off_t sub_locks;            /**< Held SHM subscription locks, points to (sr_conn_shm_lock_t *), allocated together
+                                     with mod_locks. Module subscription locks are followed by RPC/action subscription
+                                     lock and connection event pipe lock (::SR_CONN_SHM_SUB_LOCK_RPC_IDX). */
 
     off_t evpipes;              /**< Array of event pipe numbers (uint32_t) of subscriptions on this connection. */
     uint16_t evpipe_count;      /**< Event pipe count. */
+    int cache_running;          /**< Whether the connection caches running data. */
 } sr_conn_shm_t;
 
+/** index of the held RPC/action subscription lock in connection sub_locks, connection event pipe lock follows */
+#define SR_CONN_SHM_SUB_LOCK_RPC_IDX(mod_count) (mod_count)
+
+/** size of the ext SHM module and subscription locks of a connection */
+#define SR_CONN_SHM_MOD_LOCKS_SIZE(mod_count) ((mod_count) * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT]) \
+        + ((mod_count) + 2) * sizeof(sr_conn_shm_lock_t))
+
 /**
  * @brief Main SHM.
  */
@@ -219,7 +314,10 @@ typedef struct sr_main_shm_s {
     uint32_t shm_ver;           /**< Main and ext SHM version of all expected data stored in them. Is increased with
                                      every change of their structure content (ABI change). */
     sr_rwlock_t lock;           /**< Process-shared lock for accessing main and ext SHM. It is required only when
-                                     accessing attributes that can be changed (subscriptions, replay support). */
+                                     accessing attributes that can be changed (subscriptions, replay support), WRITE
+                                     lock only when changing modules or connections. */
+    sr_rwlock_t rpc_lock;       /**< Process-shared lock for accessing RPC/action subscriptions. */
+    sr_rwlock_t conn_lock;      /**< Process-shared lock for accessing event pipes of connections. */
     pthread_mutex_t lydmods_lock; /**< Process-shared lock for accessing sysrepo module data. */
     uint32_t mod_count;         /**< Number of installed modules stored after this structure. */
 
@@ -231,6 +329,14 @@ typedef struct sr_main_shm_s {
 
     off_t conns;                /**< Array of existing connections (connection state). */
     uint16_t conn_count;        /**< Number of existing connections. */
+    uint16_t cache_running_conn_count;  /**< Number of connections caching running data, running diffs are stored
+                                             only if there are some. */
+
+    struct {
+        sr_stats_hist_t lock_wait;  /**< Durations of waiting for the main SHM lock. */
+        sr_stats_event_t rpc;   /**< RPC/action events. */
+        sr_stats_hist_t commit[SR_STATS_COMMIT_PHASE_COUNT];    /**< Durations of all the commit phases. */
+    } stats;                    /**< Global statistics, updated without any locks. */
 } sr_main_shm_t;
 
 /**
@@ -366,9 +472,21 @@ sr_error_info_t *sr_shmmain_createlock(int shm_lock);
  */
 void sr_shmmain_createunlock(int shm_lock);
 
+/**
+ * @brief Start using the process-wide watch of connection files being closed, it is created
+ * by the first connection of the process.
+ */
+void sr_shmmain_alive_ntf_acquire(void);
+
+/**
+ * @brief Stop using the process-wide watch of connection files being closed, it is closed
+ * with the last connection of the process.
+ */
+void sr_shmmain_alive_ntf_release(void);
+
 /**
  * @brief Add connection into main SHM.
- * Main SHM lock is expected to be held.
+ * Main SHM WRITE lock is expected to be held.
  *
  * @param[in] conn Connection to add.
  * @return err_info, NULL on success.
@@ -377,14 +495,14 @@ sr_error_info_t *sr_shmmain_conn_add(sr_conn_ctx_t *conn);
 
 /**
  * @brief Remove a connection from main SHM state.
- * Main SHM lock is expected to be held.
+ * Main SHM WRITE lock is expected to be held.
  *
  * @param[in] main_shm Main SHM structure.
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_ext Ext SHM structure.
  * @param[in] conn Connection context to delete.
  * @param[in] pid Connection PID to delete.
  */
-void sr_shmmain_conn_del(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_conn_ctx_t *conn, pid_t pid);
+void sr_shmmain_conn_del(sr_main_shm_t *main_shm, sr_shm_t *shm_ext, sr_conn_ctx_t *conn, pid_t pid);
 
 /**
  * @brief Find a connection in main SHM.
@@ -400,7 +518,7 @@ sr_conn_shm_t *sr_shmmain_conn_find(char *main_shm_addr, char *ext_shm_addr, sr_
 
 /**
  * @brief Add an event pipe into a connection in main SHM.
- * Main SHM lock is expected to be held.
+ * Main SHM lock is expected to be held, connection lock is locked by the function.
  *
  * @param[in] conn Connection of the subscription.
  * @param[in] evpipe_num Event pipe number.
@@ -410,7 +528,7 @@ sr_error_info_t *sr_shmmain_conn_add_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe
 
 /**
  * @brief Remove and event pipe from a connection in main SHM.
- * Main SHM lock is expected to be held.
+ * Main SHM lock is expected to be held, connection lock is locked by the function.
  *
  * @param[in] conn Connection of the subscription.
  * @param[in] evpipe_num Event pipe number.
@@ -426,7 +544,7 @@ void sr_shmmain_conn_del_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe_num);
 sr_error_info_t *sr_shmmain_ly_ctx_init(struct ly_ctx **ly_ctx);
 
 /**
- * @brief Copy startup files into running files.
+ * @brief Copy startup files into running files. Files of different modules are copied by several threads.
  *
  * @param[in] conn Connection to use.
  * @param[in] replace Whether replace any existing running data (standard copy-config) or copy data
@@ -462,6 +580,33 @@ sr_error_info_t *sr_shmmain_main_open(sr_shm_t *shm, int *created);
  */
 sr_error_info_t *sr_shmmain_ext_open(sr_shm_t *shm, int zero);
 
+/*
+ * Statistics functions
+ */
+
+/**
+ * @brief Get the start time of a measured duration.
+ *
+ * @param[out] start Start timestamp.
+ */
+void sr_stats_start(struct timespec *start);
+
+/**
+ * @brief Add a measured duration into a histogram.
+ *
+ * @param[in] hist Histogram to update.
+ * @param[in] start Start timestamp of the duration, it ends now.
+ */
+void sr_stats_hist_add(sr_stats_hist_t *hist, const struct timespec *start);
+
+/**
+ * @brief Add a measured subscription callback duration into the callback statistics of a session.
+ *
+ * @param[in] sess Session the subscription was created on.
+ * @param[in] start Start timestamp of the callback, it ends now.
+ */
+void sr_stats_sess_cb_add(sr_session_ctx_t *sess, const struct timespec *start);
+
 /*
  * Main SHM common functions
  */
@@ -480,7 +625,26 @@ sr_error_info_t *sr_shmmain_ext_open(sr_shm_t *shm, int zero);
 sr_mod_t *sr_shmmain_find_module(sr_shm_t *shm_main, char *ext_shm_addr, const char *name, off_t name_off);
 
 /**
- * @brief Find a specific main SHM RPC.
+ * @brief Create the connection index of libyang modules of all main SHM modules.
+ * Main SHM modules must not change afterwards for the connection.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmmain_ly_mods_index(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Get the libyang module of a main SHM module.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] ly_ctx Context to get the module from.
+ * @param[in] shm_mod Main SHM module.
+ * @return Libyang module, NULL if not found.
+ */
+const struct lys_module *sr_shmmain_ly_mod(sr_conn_ctx_t *conn, const struct ly_ctx *ly_ctx, sr_mod_t *shm_mod);
+
+/**
+ * @brief Find a specific main SHM RPC. RPC subscription lock is expected to be held.
  *
  * Either op_path or op_path_off must be set.
  *
@@ -494,7 +658,8 @@ sr_rpc_t *sr_shmmain_find_rpc(sr_main_shm_t *main_shm, char *ext_shm_addr, const
 
 /**
  * @brief Lock main/ext SHM and its mapping and remap it if needed (it was changed). Also, store information
- * about held locks into SHM (a few function names are exceptions).
+ * about held locks into SHM (a few function names are exceptions). When WRITE locking, READ locks held
+ * by terminated connections are removed and the connections recovered.
  *
  * !! Every API function that accesses ext SHM must call this function !!
  *
@@ -507,8 +672,8 @@ sr_rpc_t *sr_shmmain_find_rpc(sr_main_shm_t *main_shm, char *ext_shm_addr, const
 sr_error_info_t *sr_shmmain_lock_remap(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, const char *func);
 
 /**
- * @brief Unlock main SHM and update information about held locks in SHM. If remap was WRITE locked,
- * also defragment ext SHM as needed.
+ * @brief Unlock main SHM and update information about held locks in SHM. If remap was WRITE locked
+ * with main SHM WRITE lock, also print ext SHM items.
  *
  * @param[in] conn Connection to use.
  * @param[in] mode Whether to WRITE, READ or not unlock main (actually ext) SHM.
@@ -517,9 +682,42 @@ sr_error_info_t *sr_shmmain_lock_remap(sr_conn_ctx_t *conn, sr_lock_mode_t mode,
  */
 void sr_shmmain_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, const char *func);
 
+/**
+ * @brief Lock a main SHM subscription lock (::sr_mod_t sub_lock, ::sr_main_shm_t rpc_lock or conn_lock) and map
+ * any ext SHM items allocated meanwhile by other processes. Main SHM lock is expected to be held, unless
+ * only reading subscriptions. The held lock is stored in the connection state so that it can be recovered.
+ *
+ * Ext SHM may be mapped at a new address so all the pointers into it must be learned only after this call.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] sub_lock Subscription lock to lock.
+ * @param[in] mode Lock mode.
+ * @param[in] func Caller function name.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmmain_sub_lock_remap(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, sr_lock_mode_t mode,
+        const char *func);
+
+/**
+ * @brief Unlock a main SHM subscription lock locked by ::sr_shmmain_sub_lock_remap().
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] sub_lock Subscription lock to unlock.
+ * @param[in] mode Lock mode.
+ * @param[in] func Caller function name.
+ */
+void sr_shmmain_sub_unlock(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, sr_lock_mode_t mode, const char *func);
+
+/**
+ * @brief Unmap all previous ext SHM mappings of a connection. No ext SHM REMAP lock can be held.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_shmmain_ext_prev_clear(sr_conn_ctx_t *conn);
+
 /**
  * @brief Add main SHM RPC/action subscription.
- * May remap ext SHM!
+ * RPC subscription WRITE lock is expected to be held. May remap ext SHM!
  *
  * @param[in] shm_ext Ext SHM.
  * @param[in] shm_rpc_off SHM RPC offset.
@@ -527,29 +725,33 @@ void sr_shmmain_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, cons
  * @param[in] priority Subscription priority.
  * @param[in] sub_opts Subscriptions options.
  * @param[in] evpipe_num Subscription event pipe number.
+ * @param[out] slot Sub SHM slot assigned to the subscription.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_shmmain_rpc_subscription_add(sr_shm_t *shm_ext, off_t shm_rpc_off, const char *xpath,
-        uint32_t priority, int sub_opts, uint32_t evpipe_num);
+        uint32_t priority, int sub_opts, uint32_t evpipe_num, uint32_t *slot);
 
 /**
  * @brief Remove main SHM RPC/action subscription.
+ * RPC subscription WRITE lock is expected to be held.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_ext Ext SHM structure.
  * @param[in] shm_rpc SHM RPC.
  * @param[in] xpath Subscription XPath.
  * @param[in] priority Subscription priority.
  * @param[in] evpipe_num Subscription event pipe number.
  * @param[in] only_evpipe Whether to match only on \p evpipe_num.
+ * @param[out] slot Optional sub SHM slot of the removed subscription.
  * @param[out] last_removed Whether this is the last RPC subscription that was removed.
  * @return 0 if removed, 1 if no matching found.
  */
-int sr_shmmain_rpc_subscription_del(char *ext_shm_addr, sr_rpc_t *shm_rpc, const char *xpath, uint32_t priority,
-        uint32_t evpipe_num, int only_evpipe, int *last_removed);
+int sr_shmmain_rpc_subscription_del(sr_shm_t *shm_ext, sr_rpc_t *shm_rpc, const char *xpath, uint32_t priority,
+        uint32_t evpipe_num, int only_evpipe, uint32_t *slot, int *last_removed);
 
 /**
  * @brief Remove main SHM module RPC/action subscription and do a proper cleanup.
- * Calls ::sr_shmmain_rpc_subscription_del(), is a higher level wrapper.
+ * Calls ::sr_shmmain_rpc_subscription_del(), is a higher level wrapper. RPC subscription WRITE lock
+ * is expected to be held.
  *
  * @param[in] conn Connection to use.
  * @param[in] shm_rpc SHM RPC.
@@ -565,7 +767,7 @@ sr_error_info_t *sr_shmmain_rpc_subscription_stop(sr_conn_ctx_t *conn, sr_rpc_t
 
 /**
  * @brief Add an RPC/action into main SHM.
- * May remap ext SHM!
+ * RPC subscription WRITE lock is expected to be held. May remap ext SHM!
  *
  * @param[in] conn Connection to use.
  * @param[in] op_path Simple RPC/action path.
@@ -575,17 +777,17 @@ sr_error_info_t *sr_shmmain_rpc_subscription_stop(sr_conn_ctx_t *conn, sr_rpc_t
 sr_error_info_t *sr_shmmain_add_rpc(sr_conn_ctx_t *conn, const char *op_path, sr_rpc_t **shm_rpc_p);
 
 /**
- * @brief Remove an RPC/action from main SHM.
+ * @brief Remove an RPC/action from main SHM. RPC subscription WRITE lock is expected to be held.
  *
  * Either op_path or op_path_off must be set.
  *
  * @param[in] main_shm Main SHM structure.
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_ext Ext SHM structure.
  * @param[in] op_path RPC/action path.
  * @param[in] op_path_off RPC/action path offset.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmmain_del_rpc(sr_main_shm_t *main_shm, char *ext_shm_addr, const char *op_path, off_t op_path_off);
+sr_error_info_t *sr_shmmain_del_rpc(sr_main_shm_t *main_shm, sr_shm_t *shm_ext, const char *op_path, off_t op_path_off);
 
 /**
  * @brief Change replay support of a module in main SHM.
@@ -713,7 +915,7 @@ void sr_shmmod_release_locks(sr_conn_ctx_t *conn, sr_sid_t sid);
 
 /**
  * @brief Add main SHM module change subscription.
- * May remap ext SHM!
+ * Module subscription WRITE lock is expected to be held. May remap ext SHM!
  *
  * @param[in] shm_ext Ext SHM.
  * @param[in] shm_mod SHM module.
@@ -727,10 +929,28 @@ void sr_shmmod_release_locks(sr_conn_ctx_t *conn, sr_sid_t sid);
 sr_error_info_t *sr_shmmod_change_subscription_add(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const char *xpath,
         sr_datastore_t ds, uint32_t priority, int sub_opts, uint32_t evpipe_num);
 
+/**
+ * @brief Add several main SHM module change subscriptions of a single module at once.
+ * May remap ext SHM!
+ *
+ * @param[in] shm_ext Ext SHM.
+ * @param[in] shm_mod SHM module.
+ * @param[in] subscrs Subscriptions to add, only their XPaths and priorities are used.
+ * @param[in] subscr_count Count of @p subscrs.
+ * @param[in] ds Datastore.
+ * @param[in] sub_opts Subscription options of all the subscriptions.
+ * @param[in] evpipe_num Subscription event pipe number of all the subscriptions.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmmod_change_subscriptions_add(sr_shm_t *shm_ext, sr_mod_t *shm_mod,
+        const sr_module_change_subscr_t *subscrs, uint16_t subscr_count, sr_datastore_t ds, int sub_opts,
+        uint32_t evpipe_num);
+
 /**
  * @brief Remove main SHM module change subscription.
+ * Module subscription WRITE lock is expected to be held.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_ext Ext SHM structure.
  * @param[in] shm_mod SHM module.
  * @param[in] xpath Subscription XPath.
  * @param[in] ds Datastore.
@@ -741,12 +961,12 @@ sr_error_info_t *sr_shmmod_change_subscription_add(sr_shm_t *shm_ext, sr_mod_t *
  * @param[out] last_removed Whether this is the last module change subscription that was removed.
  * @return 0 if removed, 1 if no matching found.
  */
-int sr_shmmod_change_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const char *xpath, sr_datastore_t ds,
+int sr_shmmod_change_subscription_del(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const char *xpath, sr_datastore_t ds,
         uint32_t priority, int sub_opts, uint32_t evpipe_num, int only_evpipe, int *last_removed);
 
 /**
  * @brief Remove main SHM module change subscription and do a proper cleanup.
- * Calls ::sr_shmmod_change_subscription_del(), is a higher level wrapper.
+ * Calls ::sr_shmmod_change_subscription_del(), is a higher level wrapper, and locks module subscriptions.
  *
  * @param[in] conn Connection to use.
  * @param[in] shm_mod SHM module.
@@ -763,7 +983,7 @@ sr_error_info_t *sr_shmmod_change_subscription_stop(sr_conn_ctx_t *conn, sr_mod_
 
 /**
  * @brief Add main SHM module operational subscription.
- * May remap ext SHM!
+ * Module subscription WRITE lock is expected to be held. May remap ext SHM!
  *
  * @param[in] shm_ext Ext SHM.
  * @param[in] shm_mod SHM module.
@@ -778,35 +998,36 @@ sr_error_info_t *sr_shmmod_oper_subscription_add(sr_shm_t *shm_ext, sr_mod_t *sh
 
 /**
  * @brief Remove main SHM module operational subscription.
+ * Module subscription WRITE lock is expected to be held.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_ext Ext SHM structure.
  * @param[in] shm_mod SHM module.
  * @param[in] xpath Subscription XPath.
  * @param[in] evpipe_num Subscription event pipe number.
  * @param[in] only_evpipe Whether to match only on \p evpipe_num.
- * @param[out] xpath_p Optionally return the xpath of the removed subscription.
+ * @param[out] xpath_hash_p Optionally return the hash of the xpath of the removed subscription.
  * @return 0 if removed, 1 if no matching found.
  */
-int sr_shmmod_oper_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const char *xpath, uint32_t evpipe_num,
-        int only_evpipe, const char **xpath_p);
+int sr_shmmod_oper_subscription_del(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const char *xpath, uint32_t evpipe_num,
+        int only_evpipe, uint32_t *xpath_hash_p);
 
 /**
  * @brief Remove main SHM module operational subscription and do a proper cleanup.
- * Calls ::sr_shmmod_oper_subscription_del(), is a higher level wrapper.
+ * Calls ::sr_shmmod_oper_subscription_del(), is a higher level wrapper, and locks module subscriptions.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] conn Connection to use.
  * @param[in] shm_mod SHM module.
  * @param[in] xpath Subscription XPath.
  * @param[in] evpipe_num Subscription event pipe number.
  * @param[in] all_evpipe Whether to remove all subscriptions matching \p evpipe_num.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmmod_oper_subscription_stop(char *ext_shm_addr, sr_mod_t *shm_mod, const char *xpath,
+sr_error_info_t *sr_shmmod_oper_subscription_stop(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, const char *xpath,
         uint32_t evpipe_num, int all_evpipe);
 
 /**
  * @brief Add main SHM module notification subscription.
- * May remap ext SHM!
+ * Module subscription WRITE lock is expected to be held. May remap ext SHM!
  *
  * @param[in] shm_ext Ext SHM.
  * @param[in] shm_mod SHM module.
@@ -817,26 +1038,27 @@ sr_error_info_t *sr_shmmod_notif_subscription_add(sr_shm_t *shm_ext, sr_mod_t *s
 
 /**
  * @brief Remove main SHM module notification subscription.
+ * Module subscription WRITE lock is expected to be held.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_ext Ext SHM structure.
  * @param[in] shm_mod SHM module.
  * @param[in] evpipe_num Subscription event pipe number.
  * @param[out] last_removed Whether this is the last module notification subscription that was removed.
  * @return 0 if removed, 1 if no matching found.
  */
-int sr_shmmod_notif_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t evpipe_num, int *last_removed);
+int sr_shmmod_notif_subscription_del(sr_shm_t *shm_ext, sr_mod_t *shm_mod, uint32_t evpipe_num, int *last_removed);
 
 /**
  * @brief Remove main SHM module notification subscription and do a proper cleanup.
- * Calls ::sr_shmmod_notif_subscription_del(), is a higher level wrapper.
+ * Calls ::sr_shmmod_notif_subscription_del(), is a higher level wrapper, and locks module subscriptions.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] conn Connection to use.
  * @param[in] shm_mod SHM module.
  * @param[in] evpipe_num Subscription event pipe number.
  * @param[in] all_evpipe Whether to remove all subscriptions matching \p evpipe_num.
  * @return err_info, NULL on success.
  */
-sr_error_info_t *sr_shmmod_notif_subscription_stop(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t evpipe_num,
+sr_error_info_t *sr_shmmod_notif_subscription_stop(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, uint32_t evpipe_num,
         int all_evpipe);
 
 /**
@@ -939,13 +1161,14 @@ sr_error_info_t *sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_
  * @param[in] sid Originator sysrepo session ID.
  * @param[in] evpipe_num Subscriber event pipe number.
  * @param[in] timeout_ms Operational callback timeout in milliseconds.
+ * @param[in] stats Event statistics to update.
  * @param[out] data Data provided by the subscriber.
  * @param[out] cb_err_info Callback error information generated by a subscriber, if any.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_shmsub_oper_notify(const struct lys_module *ly_mod, const char *xpath, const char *request_xpath,
-        const struct lyd_node *parent, sr_sid_t sid, uint32_t evpipe_num, uint32_t timeout_ms, struct lyd_node **data,
-        sr_error_info_t **cb_err_info);
+        const struct lyd_node *parent, sr_sid_t sid, uint32_t evpipe_num, uint32_t timeout_ms, sr_stats_event_t *stats,
+        struct lyd_node **data, sr_error_info_t **cb_err_info);
 
 /**
  * @brief Notify about (generate) an RPC/action event.
@@ -957,12 +1180,14 @@ sr_error_info_t *sr_shmsub_oper_notify(const struct lys_module *ly_mod, const ch
  * @param[in] sid Originator sysrepo session ID.
  * @param[in] timeout_ms RPC/action callback timeout in milliseconds.
  * @param[in,out] request_id Generated request ID, set to 0 when passing.
+ * @param[out] slot Sub SHM slot used for the event, non-zero only if it was handled by a concurrent subscriber.
  * @param[out] output Operation output returned by the last subscriber on success.
  * @param[out] cb_err_info Callback error information generated by a subscriber, if any.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_node *input,
-        sr_sid_t sid, uint32_t timeout_ms, uint32_t *request_id, struct lyd_node **output, sr_error_info_t **cb_err_info);
+        sr_sid_t sid, uint32_t timeout_ms, uint32_t *request_id, uint32_t *slot, struct lyd_node **output,
+        sr_error_info_t **cb_err_info);
 
 /**
  * @brief Notify about (generate) an RPC/action abort event.
@@ -972,10 +1197,11 @@ sr_error_info_t *sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, const char *op_path,
  * @param[in] input Operation input tree.
  * @param[in] sid Originator sysrepo session ID.
  * @param[in] request_id Generated request ID from previous event.
+ * @param[in] slot Sub SHM slot used for the previous event.
  * @return err_info, NULL on success.
  */
 sr_error_info_t *sr_shmsub_rpc_notify_abort(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_node *input,
-        sr_sid_t sid, uint32_t request_id);
+        sr_sid_t sid, uint32_t request_id, uint32_t slot);
 
 /**
  * @brief Notify about (generate) a notification event.
@@ -1071,4 +1297,36 @@ sr_error_info_t *sr_shmsub_notif_listen_module_replay(struct modsub_notif_s *not
  */
 void *sr_shmsub_listen_thread(void *arg);
 
+/**
+ * @brief Create and start a connection handler pool.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] worker_count Number of worker threads.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_hpool_start(sr_conn_ctx_t *conn, uint32_t worker_count);
+
+/**
+ * @brief Stop and free a connection handler pool. No subscriptions can be handled by it anymore.
+ *
+ * @param[in] conn Connection to use.
+ */
+void sr_shmsub_hpool_stop(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Add a subscription to be handled by the connection handler pool.
+ *
+ * @param[in] subs Subscription structure.
+ * @return err_info, NULL on success.
+ */
+sr_error_info_t *sr_shmsub_hpool_add(sr_subscription_ctx_t *subs);
+
+/**
+ * @brief Remove a subscription from the connection handler pool and wait until none of the workers
+ * processes its events.
+ *
+ * @param[in] subs Subscription structure.
+ */
+void sr_shmsub_hpool_del(sr_subscription_ctx_t *subs);
+
 #endif
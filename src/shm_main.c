@@ -24,15 +24,18 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <sys/inotify.h>
 #include <ctype.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <assert.h>
+#include <time.h>
 
 /**
  * @brief Item holding information about a SHM object for debug printing.
@@ -133,17 +136,17 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
     int msg_len = 0;
     char *msg;
 
-    if ((stderr_ll < SR_LL_DBG) && (syslog_ll < SR_LL_DBG) && !log_cb) {
+    if (log_max_ll < SR_LL_DBG) {
         /* nothing to print */
         return;
     }
 
-    /* add wasted */
+    /* add header */
     item_count = 0;
     items = malloc(sizeof *items);
     items[item_count].start = 0;
-    items[item_count].size = sizeof(size_t);
-    asprintf(&(items[item_count].name), "ext wasted %lu", *((size_t *)ext_shm_addr));
+    items[item_count].size = sizeof(sr_ext_shm_t);
+    asprintf(&(items[item_count].name), "ext header (wasted %lu)", ((sr_ext_shm_t *)ext_shm_addr)->wasted);
     ++item_count;
 
     main_shm = (sr_main_shm_t *)shm_main->addr;
@@ -152,25 +155,28 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
         /* add connection state */
         items = sr_realloc(items, (item_count + 1) * sizeof *items);
         items[item_count].start = main_shm->conns;
-        items[item_count].size = main_shm->conn_count * sizeof *shm_conn;
+        items[item_count].size = sr_shmalloc_size(main_shm->conn_count * sizeof *shm_conn);
         asprintf(&(items[item_count].name), "connections (%u)", main_shm->conn_count);
         ++item_count;
     }
 
     shm_conn = (sr_conn_shm_t *)(ext_shm_addr + main_shm->conns);
     for (i = 0; i < main_shm->conn_count; ++i) {
-        /* add connection mod locks */
-        items = sr_realloc(items, (item_count + 1) * sizeof *items);
-        items[item_count].start = shm_conn[i].mod_locks;
-        items[item_count].size = SR_SHM_SIZE(main_shm->mod_count * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT]));
-        asprintf(&(items[item_count].name), "conn mods lock (%u, conn %p)", main_shm->mod_count, (void *)shm_conn[i].conn_ctx);
-        ++item_count;
+        if (shm_conn[i].mod_locks) {
+            /* add connection mod locks */
+            items = sr_realloc(items, (item_count + 1) * sizeof *items);
+            items[item_count].start = shm_conn[i].mod_locks;
+            items[item_count].size = sr_shmalloc_size(SR_CONN_SHM_MOD_LOCKS_SIZE(main_shm->mod_count));
+            asprintf(&(items[item_count].name), "conn mods lock (%u, conn %p)", main_shm->mod_count,
+                    (void *)shm_conn[i].conn_ctx);
+            ++item_count;
+        }
 
         if (shm_conn[i].evpipes) {
             /* add connection evpipes */
             items = sr_realloc(items, (item_count + 1) * sizeof *items);
             items[item_count].start = shm_conn[i].evpipes;
-            items[item_count].size = SR_SHM_SIZE(shm_conn[i].evpipe_count * sizeof(uint32_t));
+            items[item_count].size = sr_shmalloc_size(shm_conn[i].evpipe_count * sizeof(uint32_t));
             asprintf(&(items[item_count].name), "evpipes (%u, conn %p)", shm_conn[i].evpipe_count, (void *)shm_conn[i].conn_ctx);
             ++item_count;
         }
@@ -180,7 +186,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
         /* add RPCs */
         items = sr_realloc(items, (item_count + 1) * sizeof *items);
         items[item_count].start = main_shm->rpc_subs;
-        items[item_count].size = main_shm->rpc_sub_count * sizeof *shm_rpc;
+        items[item_count].size = sr_shmalloc_size(main_shm->rpc_sub_count * sizeof *shm_rpc);
         asprintf(&(items[item_count].name), "rpcs (%u)", main_shm->rpc_sub_count);
         ++item_count;
 
@@ -189,7 +195,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
             /* add op_path */
             items = sr_realloc(items, (item_count + 1) * sizeof *items);
             items[item_count].start = shm_rpc[i].op_path;
-            items[item_count].size = sr_strshmlen(ext_shm_addr + shm_rpc[i].op_path);
+            items[item_count].size = sr_shmalloc_size(sr_strshmlen(ext_shm_addr + shm_rpc[i].op_path));
             asprintf(&(items[item_count].name), "rpc op_path (\"%s\")", ext_shm_addr + shm_rpc[i].op_path);
             ++item_count;
 
@@ -197,7 +203,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
                 /* add RPC subscriptions */
                 items = sr_realloc(items, (item_count + 1) * sizeof *items);
                 items[item_count].start = shm_rpc[i].subs;
-                items[item_count].size = shm_rpc[i].sub_count * sizeof *rpc_subs;
+                items[item_count].size = sr_shmalloc_size(shm_rpc[i].sub_count * sizeof *rpc_subs);
                 asprintf(&(items[item_count].name), "rpc subs (%u, op_path \"%s\")", shm_rpc[i].sub_count,
                         ext_shm_addr + shm_rpc[i].op_path);
                 ++item_count;
@@ -207,7 +213,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
                     /* add RPC subscription XPath */
                     items = sr_realloc(items, (item_count + 1) * sizeof *items);
                     items[item_count].start = rpc_subs[j].xpath;
-                    items[item_count].size = sr_strshmlen(ext_shm_addr + rpc_subs[j].xpath);
+                    items[item_count].size = sr_shmalloc_size(sr_strshmlen(ext_shm_addr + rpc_subs[j].xpath));
                     asprintf(&(items[item_count].name), "rpc sub xpath (\"%s\", op_path \"%s\")",
                             ext_shm_addr + rpc_subs[j].xpath, ext_shm_addr + shm_rpc[i].op_path);
                     ++item_count;
@@ -259,6 +265,16 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
             ++item_count;
         }
 
+        if (shm_mod->dep_closure_count) {
+            /* add dependency closure */
+            items = sr_realloc(items, (item_count + 1) * sizeof *items);
+            items[item_count].start = shm_mod->dep_closure;
+            items[item_count].size = shm_mod->dep_closure_count * sizeof(sr_mod_closure_t);
+            asprintf(&(items[item_count].name), "dep closure (%u, mod \"%s\")", shm_mod->dep_closure_count,
+                    ext_shm_addr + shm_mod->name);
+            ++item_count;
+        }
+
         if (shm_mod->op_dep_count) {
             /* add op deps array */
             items = sr_realloc(items, (item_count + 1) * sizeof *items);
@@ -294,7 +310,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
                 /* add change subscriptions */
                 items = sr_realloc(items, (item_count + 1) * sizeof *items);
                 items[item_count].start = shm_mod->change_sub[ds].subs;
-                items[item_count].size = shm_mod->change_sub[ds].sub_count * sizeof *change_subs;
+                items[item_count].size = sr_shmalloc_size(shm_mod->change_sub[ds].sub_count * sizeof *change_subs);
                 asprintf(&(items[item_count].name), "%s change subs (%u, mod \"%s\")", sr_ds2str(ds),
                         shm_mod->change_sub[ds].sub_count, ext_shm_addr + shm_mod->name);
                 ++item_count;
@@ -305,7 +321,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
                     if (change_subs[i].xpath) {
                         items = sr_realloc(items, (item_count + 1) * sizeof *items);
                         items[item_count].start = change_subs[i].xpath;
-                        items[item_count].size = sr_strshmlen(ext_shm_addr + change_subs[i].xpath);
+                        items[item_count].size = sr_shmalloc_size(sr_strshmlen(ext_shm_addr + change_subs[i].xpath));
                         asprintf(&(items[item_count].name), "%s change sub xpath (\"%s\", mod \"%s\")", sr_ds2str(ds),
                                 ext_shm_addr + change_subs[i].xpath, ext_shm_addr + shm_mod->name);
                         ++item_count;
@@ -318,7 +334,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
             /* add DP subscriptions */
             items = sr_realloc(items, (item_count + 1) * sizeof *items);
             items[item_count].start = shm_mod->oper_subs;
-            items[item_count].size = shm_mod->oper_sub_count * sizeof *oper_subs;
+            items[item_count].size = sr_shmalloc_size(shm_mod->oper_sub_count * sizeof *oper_subs);
             asprintf(&(items[item_count].name), "oper subs (%u, mod \"%s\")", shm_mod->oper_sub_count,
                     ext_shm_addr + shm_mod->name);
             ++item_count;
@@ -328,7 +344,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
             for (i = 0; i < shm_mod->oper_sub_count; ++i) {
                 items = sr_realloc(items, (item_count + 1) * sizeof *items);
                 items[item_count].start = oper_subs[i].xpath;
-                items[item_count].size = sr_strshmlen(ext_shm_addr + oper_subs[i].xpath);
+                items[item_count].size = sr_shmalloc_size(sr_strshmlen(ext_shm_addr + oper_subs[i].xpath));
                 asprintf(&(items[item_count].name), "oper sub xpath (\"%s\", mod \"%s\")",
                         ext_shm_addr + oper_subs[i].xpath, ext_shm_addr + shm_mod->name);
                 ++item_count;
@@ -339,7 +355,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
             /* add notif subscriptions */
             items = sr_realloc(items, (item_count + 1) * sizeof *items);
             items[item_count].start = shm_mod->notif_subs;
-            items[item_count].size = SR_SHM_SIZE(shm_mod->notif_sub_count * sizeof(sr_mod_notif_sub_t));
+            items[item_count].size = sr_shmalloc_size(shm_mod->notif_sub_count * sizeof(sr_mod_notif_sub_t));
             asprintf(&(items[item_count].name), "notif subs (%u, mod \"%s\")", shm_mod->notif_sub_count,
                     ext_shm_addr + shm_mod->name);
             ++item_count;
@@ -359,7 +375,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
         assert((unsigned)items[i].start == SR_SHM_SIZE(items[i].start));
 
         if (items[i].start > cur_off) {
-            printed += sr_sprintf(&msg, &msg_len, printed, "%06ld-%06ld [%6ld]: (wasted %ld)\n",
+            printed += sr_sprintf(&msg, &msg_len, printed, "%06ld-%06ld [%6ld]: (free %ld)\n",
                     cur_off, items[i].start, items[i].start - cur_off, items[i].start - cur_off);
             wasted += items[i].start - cur_off;
             cur_off = items[i].start;
@@ -372,7 +388,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
     }
 
     if ((unsigned)cur_off < ext_shm_size) {
-        printed += sr_sprintf(&msg, &msg_len, printed, "%06ld-%06ld [%6lu]: (wasted %ld)\n",
+        printed += sr_sprintf(&msg, &msg_len, printed, "%06ld-%06ld [%6lu]: (free %ld)\n",
                 cur_off, ext_shm_size, ext_shm_size - cur_off, ext_shm_size - cur_off);
         wasted += ext_shm_size - cur_off;
     }
@@ -385,272 +401,7 @@ sr_shmmain_ext_print(sr_shm_t *shm_main, char *ext_shm_addr, size_t ext_shm_size
     /* check that no item exists after the mapped segment */
     assert((unsigned)cur_off <= ext_shm_size);
     /* check that wasted memory is correct */
-    assert(*((size_t *)ext_shm_addr) == wasted);
-}
-
-/**
- * @brief Copy data deps array from ext SHM to buffer to defragment it.
- *
- * @param[in] shm_main Main SHM.
- * @param[in] ext_shm_addr Ext SHM mapping address.
- * @param[in] data_deps SHM ext offset of data deps.
- * @param[in] data_dep_count Data dep count.
- * @param[in] ext_buf SHM ext buffer.
- * @param[in,out] ext_buf_cur Current ext SHM buffer position.
- * @return Memory offset of the copy.
- */
-static off_t
-sr_shmmain_defrag_copy_data_deps(sr_shm_t *shm_main, char *ext_shm_addr, off_t data_deps, uint16_t data_dep_count,
-        char *ext_buf, char **ext_buf_cur)
-{
-    sr_mod_data_dep_t *new_data_deps, *old_data_deps;
-    sr_mod_t *ref_mod;
-    char *str;
-    uint16_t i;
-    off_t ret;
-
-    if (!data_deps && !data_dep_count) {
-        /* no data dependencies */
-        return 0;
-    }
-    assert(data_deps && data_dep_count);
-
-    old_data_deps = (sr_mod_data_dep_t *)(ext_shm_addr + data_deps);
-
-    /* current offset */
-    ret = *ext_buf_cur - ext_buf;
-
-    /* allocate array */
-    new_data_deps = (sr_mod_data_dep_t *)(ext_buf + sr_shmcpy(ext_buf, ext_shm_addr + data_deps,
-            data_dep_count * sizeof *new_data_deps, ext_buf_cur));
-
-    /* copy all items */
-    for (i = 0; i < data_dep_count; ++i) {
-        /* assign module */
-        if (old_data_deps[i].module) {
-            ref_mod = sr_shmmain_find_module(shm_main, ext_buf, ext_shm_addr + old_data_deps[i].module, 0);
-            new_data_deps[i].module = ref_mod->name;
-        }
-
-        /* copy xpath */
-        if (old_data_deps[i].xpath) {
-            str = ext_shm_addr + old_data_deps[i].xpath;
-            new_data_deps[i].xpath = sr_shmstrcpy(ext_buf, str, ext_buf_cur);
-        }
-    }
-
-    return ret;
-}
-
-/**
- * @brief Copy inverse data deps array from main SHM to memory to defragment it.
- *
- * @param[in] shm_main Main SHM.
- * @param[in] ext_shm_addr Ext SHM address.
- * @param[in] inv_data_deps SHM offset of inverse data deps.
- * @param[in] inv_data_dep_count Inverse data dep count.
- * @param[in] ext_buf SHM memory copy.
- * @param[in,out] ext_buf_cur Current SHM memory position.
- * @return Memory offset of the copy.
- */
-static off_t
-sr_shmmain_defrag_copy_inv_data_deps(sr_shm_t *shm_main, char *ext_shm_addr, off_t inv_data_deps,
-        uint16_t inv_data_dep_count, char *ext_buf, char **ext_buf_cur)
-{
-    off_t *new_inv_data_deps, *old_inv_data_deps;
-    sr_mod_t *ref_mod;
-    uint16_t i;
-    off_t ret;
-
-    if (!inv_data_deps && !inv_data_dep_count) {
-        /* no inverse data dependencies */
-        return 0;
-    }
-    assert(inv_data_deps && inv_data_dep_count);
-
-    old_inv_data_deps = (off_t *)(ext_shm_addr + inv_data_deps);
-
-    /* current offset */
-    ret = *ext_buf_cur - ext_buf;
-
-    /* allocate array */
-    new_inv_data_deps = (off_t *)(ext_buf + sr_shmcpy(ext_buf, ext_shm_addr + inv_data_deps,
-            inv_data_dep_count * sizeof *new_inv_data_deps, ext_buf_cur));
-
-    /* copy all items */
-    for (i = 0; i < inv_data_dep_count; ++i) {
-        /* assign module */
-        ref_mod = sr_shmmain_find_module(shm_main, ext_buf, ext_shm_addr + old_inv_data_deps[i], 0);
-        new_inv_data_deps[i] = ref_mod->name;
-    }
-
-    return ret;
-}
-
-/**
- * @brief Copy an array from ext SHM to buffer to defragment it.
- *
- * @param[in] ext_shm_addr Ext SHM mapping address.
- * @param[in] array SHM offset of the array.
- * @param[in] size Array item size.
- * @param[in] count Array item count.
- * @param[in] ext_buf SHM ext buffer.
- * @param[in,out] ext_buf_cur Current SHM ext buffer position.
- * @return Buffer offset of the copy.
- */
-static off_t
-sr_shmmain_defrag_copy_array_with_string(char *ext_shm_addr, off_t array, size_t size, uint16_t count, char *ext_buf,
-        char **ext_buf_cur)
-{
-    off_t ret, *item;
-    uint16_t i;
-
-    if (!array && !count) {
-        /* empty array */
-        return 0;
-    }
-    assert(array && count);
-
-    /* current offset */
-    ret = *ext_buf_cur - ext_buf;
-
-    /* copy whole array */
-    item = (off_t *)(ext_buf + sr_shmcpy(ext_buf, ext_shm_addr + array, count * size, ext_buf_cur));
-
-    /* copy string for each item */
-    for (i = 0; i < count; ++i) {
-        if (*item) {
-            *item = sr_shmcpy(ext_buf, ext_shm_addr + *item, sr_strshmlen(ext_shm_addr + *item), ext_buf_cur);
-        }
-
-        /* next item */
-        item = (off_t *)(((uintptr_t)item) + size);
-    }
-
-    return ret;
-}
-
-/**
- * @brief Defragment Ext SHM.
- *
- * @param[in] shm_main Main SHM.
- * @param[in] shm_ext Ext SHM.
- * @param[out] defrag_ext_buf Defragmented Ext SHM memory copy.
- * @return err_info, NULL on success.
- */
-static sr_error_info_t *
-sr_shmmain_ext_defrag(sr_shm_t *shm_main, sr_shm_t *shm_ext, char **defrag_ext_buf)
-{
-    sr_error_info_t *err_info = NULL;
-    sr_mod_t *shm_mod;
-    sr_rpc_t *shm_rpc;
-    sr_mod_op_dep_t *old_op_deps, *new_op_deps;
-    char *ext_buf, *ext_buf_cur, *mod_name;
-    sr_conn_shm_t *shm_conn;
-    sr_main_shm_t *main_shm;
-    sr_mod_notif_sub_t *notif_subs;
-    sr_conn_shm_lock_t (*mod_locks)[SR_DS_COUNT];
-    uint32_t *evpipes;
-    uint16_t i;
-
-    *defrag_ext_buf = NULL;
-
-    /* resulting defragmented size is known */
-    ext_buf_cur = ext_buf = malloc(shm_ext->size - *((size_t *)shm_ext->addr));
-    SR_CHECK_MEM_RET(!ext_buf, err_info);
-
-    /* wasted ext number */
-    *((size_t *)ext_buf_cur) = 0;
-    ext_buf_cur += sizeof(size_t);
-
-    /* 1) copy all module names so that dependencies can reference them */
-    SR_SHM_MOD_FOR(shm_main->addr, shm_main->size, shm_mod) {
-        /* copy module name and update offset */
-        mod_name = shm_ext->addr + shm_mod->name;
-        shm_mod->name = sr_shmstrcpy(ext_buf, mod_name, &ext_buf_cur);
-    }
-
-    /* 2) copy the rest of arrays */
-    SR_SHM_MOD_FOR(shm_main->addr, shm_main->size, shm_mod) {
-        /* copy and update features */
-        shm_mod->features = sr_shmmain_defrag_copy_array_with_string(shm_ext->addr, shm_mod->features, sizeof(off_t),
-                shm_mod->feat_count, ext_buf, &ext_buf_cur);
-
-        /* copy and update data deps */
-        shm_mod->data_deps = sr_shmmain_defrag_copy_data_deps(shm_main, shm_ext->addr, shm_mod->data_deps,
-                shm_mod->data_dep_count, ext_buf, &ext_buf_cur);
-
-        /* allocate and copy inverse data deps */
-        shm_mod->inv_data_deps = sr_shmmain_defrag_copy_inv_data_deps(shm_main, shm_ext->addr, shm_mod->inv_data_deps,
-                shm_mod->inv_data_dep_count, ext_buf, &ext_buf_cur);
-
-        /* allocate and copy op deps, first only with their xpath ... */
-        old_op_deps = (sr_mod_op_dep_t *)(shm_ext->addr + shm_mod->op_deps);
-        shm_mod->op_deps = sr_shmmain_defrag_copy_array_with_string(shm_ext->addr, shm_mod->op_deps, sizeof(sr_mod_op_dep_t),
-                shm_mod->op_dep_count, ext_buf, &ext_buf_cur);
-
-        /* ... then copy both arrays as well */
-        new_op_deps = (sr_mod_op_dep_t *)(ext_buf + shm_mod->op_deps);
-        for (i = 0; i < shm_mod->op_dep_count; ++i) {
-            new_op_deps[i].in_deps = sr_shmmain_defrag_copy_data_deps(shm_main, shm_ext->addr, old_op_deps[i].in_deps,
-                    old_op_deps[i].in_dep_count, ext_buf, &ext_buf_cur);
-            new_op_deps[i].out_deps = sr_shmmain_defrag_copy_data_deps(shm_main, shm_ext->addr, old_op_deps[i].out_deps,
-                    old_op_deps[i].out_dep_count, ext_buf, &ext_buf_cur);
-        }
-
-        /* copy change subscriptions */
-        for (i = 0; i < SR_DS_COUNT; ++i) {
-            shm_mod->change_sub[i].subs = sr_shmmain_defrag_copy_array_with_string(shm_ext->addr, shm_mod->change_sub[i].subs,
-                    sizeof(sr_mod_change_sub_t), shm_mod->change_sub[i].sub_count, ext_buf, &ext_buf_cur);
-        }
-
-        /* copy operational subscriptions */
-        shm_mod->oper_subs = sr_shmmain_defrag_copy_array_with_string(shm_ext->addr, shm_mod->oper_subs,
-                sizeof(sr_mod_oper_sub_t), shm_mod->oper_sub_count, ext_buf, &ext_buf_cur);
-
-        /* copy notification subscriptions */
-        notif_subs = (sr_mod_notif_sub_t *)(shm_ext->addr + shm_mod->notif_subs);
-        shm_mod->notif_subs = sr_shmcpy(ext_buf, notif_subs, SR_SHM_SIZE(shm_mod->notif_sub_count * sizeof *notif_subs), &ext_buf_cur);
-    }
-
-    main_shm = (sr_main_shm_t *)shm_main->addr;
-
-    /* 3) copy connection state */
-    shm_conn = (sr_conn_shm_t *)(shm_ext->addr + main_shm->conns);
-    /* copy connections */
-    main_shm->conns = sr_shmcpy(ext_buf, shm_conn, main_shm->conn_count * sizeof *shm_conn, &ext_buf_cur);
-
-    shm_conn = (sr_conn_shm_t *)(ext_buf + main_shm->conns);
-    for (i = 0; i < main_shm->conn_count; ++i) {
-        /* copy mods lock */
-        mod_locks = (sr_conn_shm_lock_t (*)[SR_DS_COUNT])(shm_ext->addr + shm_conn[i].mod_locks);
-        shm_conn[i].mod_locks = sr_shmcpy(ext_buf, mod_locks, SR_SHM_SIZE(main_shm->mod_count * sizeof *mod_locks), &ext_buf_cur);
-
-        /* copy evpipes */
-        evpipes = (uint32_t *)(shm_ext->addr + shm_conn[i].evpipes);
-        shm_conn[i].evpipes = sr_shmcpy(ext_buf, evpipes, SR_SHM_SIZE(shm_conn[i].evpipe_count * sizeof *evpipes), &ext_buf_cur);
-    }
-
-    /* 4) copy RPCs and their subscriptions */
-    main_shm->rpc_subs = sr_shmmain_defrag_copy_array_with_string(shm_ext->addr, main_shm->rpc_subs,
-                sizeof(sr_rpc_t), main_shm->rpc_sub_count, ext_buf, &ext_buf_cur);
-
-    /* copy RPC subscriptions */
-    shm_rpc = (sr_rpc_t *)(ext_buf + main_shm->rpc_subs);
-    for (i = 0; i < main_shm->rpc_sub_count; ++i) {
-        shm_rpc[i].subs = sr_shmmain_defrag_copy_array_with_string(shm_ext->addr, shm_rpc[i].subs,
-                sizeof(sr_rpc_sub_t), shm_rpc[i].sub_count, ext_buf, &ext_buf_cur);
-    }
-
-    /* check size */
-    if ((unsigned)(ext_buf_cur - ext_buf) != shm_ext->size - *((size_t *)shm_ext->addr)) {
-        SR_ERRINFO_INT(&err_info);
-        free(ext_buf);
-        return err_info;
-    }
-
-    *defrag_ext_buf = ext_buf;
-    return NULL;
+    assert(((sr_ext_shm_t *)ext_shm_addr)->wasted == wasted);
 }
 
 sr_error_info_t *
@@ -705,6 +456,21 @@ sr_shmmain_check_dirs(void)
     }
     free(dir_path);
 
+    /* connection files dir */
+    if ((err_info = sr_path_conn_dir(&dir_path))) {
+        return err_info;
+    }
+    if (((ret = access(dir_path, F_OK)) == -1) && (errno != ENOENT)) {
+        free(dir_path);
+        SR_ERRINFO_SYSERRNO(&err_info, "access");
+        return err_info;
+    }
+    if (ret && (err_info = sr_mkpath(dir_path, SR_DIR_PERM))) {
+        free(dir_path);
+        return err_info;
+    }
+    free(dir_path);
+
     return NULL;
 }
 
@@ -778,34 +544,39 @@ sr_shmmain_conn_add(sr_conn_ctx_t *conn)
 
     main_shm = (sr_main_shm_t *)conn->main_shm.addr;
 
-    /* allocate new connection and its module locks */
+    /* allocate new connection and its module and subscription locks */
     if ((err_info = sr_shmrealloc_add(&conn->ext_shm, &main_shm->conns, &main_shm->conn_count, 0, sizeof *shm_conn, -1,
-            (void **)&shm_conn, SR_SHM_SIZE(main_shm->mod_count * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT])), &mod_locks_off))) {
+            (void **)&shm_conn, SR_CONN_SHM_MOD_LOCKS_SIZE(main_shm->mod_count), &mod_locks_off))) {
         return err_info;
     }
 
     /* clear new connection state and mods lock array */
     memset(shm_conn, 0, sizeof *shm_conn);
-    memset(conn->ext_shm.addr + mod_locks_off, 0, main_shm->mod_count * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT]));
+    memset(conn->ext_shm.addr + mod_locks_off, 0, SR_CONN_SHM_MOD_LOCKS_SIZE(main_shm->mod_count));
 
     /* fill the attributes */
     shm_conn->conn_ctx = conn;
     shm_conn->pid = getpid();
     shm_conn->mod_locks = mod_locks_off;
+    shm_conn->sub_locks = mod_locks_off + main_shm->mod_count * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT]);
+    conn->shm_sub_locks = shm_conn->sub_locks;
+    if (conn->opts & SR_CONN_CACHE_RUNNING) {
+        shm_conn->cache_running = 1;
+        ++main_shm->cache_running_conn_count;
+    }
 
     return NULL;
 }
 
 void
-sr_shmmain_conn_del(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_conn_ctx_t *conn, pid_t pid)
+sr_shmmain_conn_del(sr_main_shm_t *main_shm, sr_shm_t *shm_ext, sr_conn_ctx_t *conn, pid_t pid)
 {
     sr_error_info_t *err_info = NULL;
     sr_conn_shm_t *shm_conn;
-    size_t dyn_attr_size;
     uint16_t i;
 
     /* find the connection */
-    shm_conn = (sr_conn_shm_t *)(ext_shm_addr + main_shm->conns);
+    shm_conn = (sr_conn_shm_t *)(shm_ext->addr + main_shm->conns);
     for (i = 0; i < main_shm->conn_count; ++i) {
         if ((conn == shm_conn[i].conn_ctx) && (pid == shm_conn[i].pid)) {
             break;
@@ -817,10 +588,18 @@ sr_shmmain_conn_del(sr_main_shm_t *main_shm, char *ext_shm_addr, sr_conn_ctx_t *
         return;
     }
 
-    /* remove the connection with its mod locks and evpipes */
-    dyn_attr_size = SR_SHM_SIZE(main_shm->mod_count * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT]))
-            + SR_SHM_SIZE(shm_conn[i].evpipe_count * sizeof(uint32_t));
-    sr_shmrealloc_del(ext_shm_addr, &main_shm->conns, &main_shm->conn_count, sizeof *shm_conn, i, dyn_attr_size);
+    /* free its evpipes */
+    if (shm_conn[i].evpipe_count) {
+        sr_shmfree(shm_ext, shm_conn[i].evpipes, shm_conn[i].evpipe_count * sizeof(uint32_t));
+    }
+
+    if (shm_conn[i].cache_running) {
+        --main_shm->cache_running_conn_count;
+    }
+
+    /* remove the connection with its mod locks */
+    sr_shmrealloc_del(shm_ext, &main_shm->conns, &main_shm->conn_count, sizeof *shm_conn, i, shm_conn[i].mod_locks,
+            SR_CONN_SHM_MOD_LOCKS_SIZE(main_shm->mod_count));
 }
 
 sr_conn_shm_t *
@@ -846,35 +625,51 @@ sr_error_info_t *
 sr_shmmain_conn_add_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe_num)
 {
     sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)conn->main_shm.addr;
     sr_conn_shm_t *shm_conn;
     uint32_t *new_item;
 
+    /* CONN WRITE LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &main_shm->conn_lock, SR_LOCK_WRITE, __func__))) {
+        return err_info;
+    }
+
     /* find the connection */
     shm_conn = sr_shmmain_conn_find(conn->main_shm.addr, conn->ext_shm.addr, conn, getpid());
     if (!shm_conn) {
         sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, NULL,
                 "Connection not found in internal state (perhaps fork() was used and PID has changed).");
-        return err_info;
+        goto cleanup;
     }
 
     if ((err_info = sr_shmrealloc_add(&conn->ext_shm, &shm_conn->evpipes, &shm_conn->evpipe_count, 1, sizeof evpipe_num, -1,
             (void **)&new_item, 0, NULL))) {
-        return err_info;
+        goto cleanup;
     }
 
     /* set new evpipe */
     *new_item = evpipe_num;
 
-    return NULL;
+cleanup:
+    /* CONN WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->conn_lock, SR_LOCK_WRITE, __func__);
+    return err_info;
 }
 
 void
 sr_shmmain_conn_del_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe_num)
 {
     sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)conn->main_shm.addr;
     sr_conn_shm_t *shm_conn;
     uint32_t i, *evpipes;
 
+    /* CONN WRITE LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &main_shm->conn_lock, SR_LOCK_WRITE, __func__))) {
+        sr_errinfo_free(&err_info);
+        return;
+    }
+
     /* find the connection */
     shm_conn = sr_shmmain_conn_find(conn->main_shm.addr, conn->ext_shm.addr, conn, getpid());
     if (!shm_conn) {
@@ -895,29 +690,54 @@ sr_shmmain_conn_del_evpipe(sr_conn_ctx_t *conn, uint32_t evpipe_num)
     }
 
     /* delete the evpipe num */
-    sr_shmrealloc_del(conn->ext_shm.addr, &shm_conn->evpipes, &shm_conn->evpipe_count, sizeof evpipe_num, i, 0);
+    sr_shmrealloc_del(&conn->ext_shm, &shm_conn->evpipes, &shm_conn->evpipe_count, sizeof evpipe_num, i, 0, 0);
 
 cleanup:
+    /* CONN WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->conn_lock, SR_LOCK_WRITE, __func__);
     sr_errinfo_free(&err_info);
 }
 
+/**
+ * @brief Recover a main SHM subscription lock held by a terminated connection.
+ *
+ * @param[in] sub_lock Subscription lock.
+ * @param[in] shm_lock Connection held lock information.
+ * @param[in,out] err_info Error info to add any errors to.
+ */
+static void
+sr_shmmain_conn_recover_sub_lock(sr_rwlock_t *sub_lock, sr_conn_shm_lock_t *shm_lock, sr_error_info_t **err_info)
+{
+    sr_error_info_t *tmp_err;
+    uint32_t rcount;
+
+    /* WRITE lock is recovered by its robust mutex, remove all the READ locks */
+    rcount = ATOMIC_LOAD_RELAXED(shm_lock->rcount);
+    if (rcount && (tmp_err = sr_rwlock_recover(sub_lock, rcount, __func__))) {
+        sr_errinfo_merge(err_info, tmp_err);
+    }
+}
+
 /**
  * @brief Recover (properly unsubscribe and close) all connections whose process no longer exists.
- * Main SHM lock is expected to be held.
+ * Main SHM WRITE lock is expected to be held.
  *
  * @param[in] conn Connection to use.
+ * @param[in] pid Only recover connections of this terminated process, 0 to check all the connections.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_shmmain_conn_recover(sr_conn_ctx_t *conn)
+sr_shmmain_conn_recover(sr_conn_ctx_t *conn, pid_t pid)
 {
     sr_error_info_t *err_info = NULL, *tmp_err;
     sr_conn_shm_t *shm_conn;
     sr_mod_t *shm_mod;
     sr_rpc_t *shm_rpc;
     sr_main_shm_t *main_shm;
+    sr_conn_ctx_t *conn_ctx;
+    pid_t conn_pid;
     uint32_t i, j, k, *evpipes;
-    sr_conn_shm_lock_t (*mod_locks)[SR_DS_COUNT];
+    sr_conn_shm_lock_t (*mod_locks)[SR_DS_COUNT], *sub_locks;
     struct sr_mod_lock_s *shm_lock;
     struct timespec timeout_ts;
     char *path;
@@ -929,7 +749,7 @@ sr_shmmain_conn_recover(sr_conn_ctx_t *conn)
     shm_conn = (sr_conn_shm_t *)(conn->ext_shm.addr + main_shm->conns);
     i = 0;
     while (i < main_shm->conn_count) {
-        if (!sr_process_exists(shm_conn[i].pid)) {
+        if (pid ? (shm_conn[i].pid == pid) : !sr_process_exists(shm_conn[i].pid)) {
             SR_LOG_WRN("Cleaning up after a non-existent sysrepo client with PID %ld.", (long)shm_conn[i].pid);
 
             /* recover held main SHM locks */
@@ -948,6 +768,16 @@ sr_shmmain_conn_recover(sr_conn_ctx_t *conn)
                 break;
             }
 
+            /* recover held subscription locks, before they are needed for removing its subscriptions */
+            sub_locks = (sr_conn_shm_lock_t *)(conn->ext_shm.addr + shm_conn[i].sub_locks);
+            shm_mod = SR_FIRST_SHM_MOD(conn->main_shm.addr);
+            for (j = 0; j < main_shm->mod_count; ++j) {
+                sr_shmmain_conn_recover_sub_lock(&shm_mod[j].sub_lock, &sub_locks[j], &err_info);
+            }
+            j = SR_CONN_SHM_SUB_LOCK_RPC_IDX(main_shm->mod_count);
+            sr_shmmain_conn_recover_sub_lock(&main_shm->rpc_lock, &sub_locks[j], &err_info);
+            sr_shmmain_conn_recover_sub_lock(&main_shm->conn_lock, &sub_locks[j + 1], &err_info);
+
             /* recover held module locks */
             mod_locks = (sr_conn_shm_lock_t (*)[SR_DS_COUNT])(conn->ext_shm.addr + shm_conn[i].mod_locks);
             shm_mod = SR_FIRST_SHM_MOD(conn->main_shm.addr);
@@ -987,10 +817,10 @@ sr_shmmain_conn_recover(sr_conn_ctx_t *conn)
                             sr_errinfo_merge(&err_info, tmp_err);
                         }
                     }
-                    if ((tmp_err = sr_shmmod_oper_subscription_stop(conn->ext_shm.addr, shm_mod, NULL, evpipes[j], 1))) {
+                    if ((tmp_err = sr_shmmod_oper_subscription_stop(conn, shm_mod, NULL, evpipes[j], 1))) {
                         sr_errinfo_merge(&err_info, tmp_err);
                     }
-                    if ((tmp_err = sr_shmmod_notif_subscription_stop(conn->ext_shm.addr, shm_mod, evpipes[j], 1))) {
+                    if ((tmp_err = sr_shmmod_notif_subscription_stop(conn, shm_mod, evpipes[j], 1))) {
                         sr_errinfo_merge(&err_info, tmp_err);
                     }
                 }
@@ -1018,11 +848,23 @@ sr_shmmain_conn_recover(sr_conn_ctx_t *conn)
                 }
             }
 
-            /* remove this connection from state */
-            sr_shmmain_conn_del(main_shm, conn->ext_shm.addr, shm_conn[i].conn_ctx, shm_conn[i].pid);
+            /* remove its connection file */
+            if ((tmp_err = sr_path_conn_file(shm_conn[i].pid, shm_conn[i].conn_ctx, &path))) {
+                sr_errinfo_merge(&err_info, tmp_err);
+            } else {
+                if ((unlink(path) == -1) && (errno != ENOENT)) {
+                    SR_ERRINFO_SYSERRNO(&err_info, "unlink");
+                }
+                free(path);
+            }
+
+            /* remove this connection from state, its item is freed */
+            conn_ctx = shm_conn[i].conn_ctx;
+            conn_pid = shm_conn[i].pid;
+            sr_shmmain_conn_del(main_shm, &conn->ext_shm, conn_ctx, conn_pid);
 
             /* remove any stored operational data of this connection */
-            if ((tmp_err = sr_shmmod_oper_stored_del_conn(conn, shm_conn[i].conn_ctx, shm_conn[i].pid))) {
+            if ((tmp_err = sr_shmmod_oper_stored_del_conn(conn, conn_ctx, conn_pid))) {
                 sr_errinfo_merge(&err_info, tmp_err);
             }
         } else {
@@ -1034,77 +876,214 @@ sr_shmmain_conn_recover(sr_conn_ctx_t *conn)
 }
 
 /**
- * @brief Calculate how much ext SHM space is taken by connection state, RPCs,
- * their subscriptions, and any existing module subscriptions in main and ext SHM.
+ * @brief Check whether a process has any connections in main SHM.
  *
- * @param[in] shm_main Main SHM.
- * @param[in] ext_shm_addr Ext SHM mapping address.
- * @return Ext SHM size of the considered data.
+ * @param[in] conn Connection to use.
+ * @param[in] pid Process PID.
+ * @return 0 if not, non-zero if it has.
  */
-static size_t
-sr_shmmain_ext_get_size_main_shm(sr_shm_t *shm_main, char *ext_shm_addr)
+static int
+sr_shmmain_conn_pid_has_conn(sr_conn_ctx_t *conn, pid_t pid)
 {
-    size_t shm_size = 0;
-    uint32_t i, j;
-    sr_main_shm_t *main_shm;
-    sr_rpc_t *shm_rpc;
-    sr_rpc_sub_t *rpc_subs;
-    sr_mod_t *shm_mod;
-    sr_mod_change_sub_t *change_subs;
-    sr_mod_oper_sub_t *oper_subs;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)conn->main_shm.addr;
     sr_conn_shm_t *shm_conn;
+    uint32_t i;
 
-    main_shm = (sr_main_shm_t *)shm_main->addr;
-
-    /* connection state */
-    shm_conn = (sr_conn_shm_t *)(ext_shm_addr + main_shm->conns);
+    shm_conn = (sr_conn_shm_t *)(conn->ext_shm.addr + main_shm->conns);
     for (i = 0; i < main_shm->conn_count; ++i) {
-        shm_size += SR_SHM_SIZE(main_shm->mod_count * sizeof(sr_conn_shm_lock_t[SR_DS_COUNT]));
-        shm_size += SR_SHM_SIZE(shm_conn[i].evpipe_count * sizeof(uint32_t));
+        if (shm_conn[i].pid == pid) {
+            return 1;
+        }
     }
-    shm_size += SR_SHM_SIZE(main_shm->conn_count * sizeof *shm_conn);
 
-    /* RPCs and their subscriptions */
-    shm_rpc = (sr_rpc_t *)(ext_shm_addr + main_shm->rpc_subs);
-    for (i = 0; i < main_shm->rpc_sub_count; ++i) {
-        assert(shm_rpc[i].op_path);
-        shm_size += sr_strshmlen(ext_shm_addr + shm_rpc[i].op_path);
+    return 0;
+}
+
+/**
+ * @brief Process-wide watch of connection files being closed, shared by all the connections of the process
+ * because they all use the same main SHM.
+ */
+static struct {
+    pthread_mutex_t lock;           /**< Lock for accessing the members. */
+    pid_t pid;                      /**< Process that created the inotify instance, it is not shared with children. */
+    uint32_t conn_count;            /**< Number of connections using the watch. */
+    int fd;                         /**< Inotify watching connection files being closed, -1 if not available. */
+    int all;                        /**< Whether all the connections must be checked on the next check, the close
+                                         events are not available or some were lost. */
+    pid_t pending[SR_CONN_CHECK_PID_MAX]; /**< Processes whose connections were closed but which were still
+                                               running when checked (possibly exiting), checked again. */
+    uint32_t pending_count;         /**< Number of pending processes. */
+} sr_alive_ntf = {PTHREAD_MUTEX_INITIALIZER, 0, 0, -1, 0, {0}, 0};
+
+void
+sr_shmmain_alive_ntf_acquire(void)
+{
+    char *path;
+    sr_error_info_t *err_info;
 
-        rpc_subs = (sr_rpc_sub_t *)(ext_shm_addr + shm_rpc[i].subs);
-        for (j = 0; j < shm_rpc[i].sub_count; ++j) {
-            assert(rpc_subs[j].xpath);
-            shm_size += sr_strshmlen(ext_shm_addr + rpc_subs[j].xpath);
+    /* ALIVE NTF LOCK */
+    pthread_mutex_lock(&sr_alive_ntf.lock);
+
+    if (sr_alive_ntf.conn_count && (sr_alive_ntf.pid != getpid())) {
+        /* inherited from the parent process, its events are not ours to read */
+        if (sr_alive_ntf.fd > -1) {
+            close(sr_alive_ntf.fd);
         }
-        shm_size += SR_SHM_SIZE(shm_rpc[i].sub_count * sizeof *rpc_subs);
+        sr_alive_ntf.conn_count = 0;
     }
-    shm_size += SR_SHM_SIZE(main_shm->rpc_sub_count * sizeof *shm_rpc);
 
-    /* existing module subscriptions */
-    SR_SHM_MOD_FOR(shm_main->addr, shm_main->size, shm_mod) {
-        /* change subscriptions */
-        for (i = 0; i < SR_DS_COUNT; ++i) {
-            change_subs = (sr_mod_change_sub_t *)(ext_shm_addr + shm_mod->change_sub[i].subs);
-            for (j = 0; j < shm_mod->change_sub[i].sub_count; ++j) {
-                if (change_subs[j].xpath) {
-                    shm_size += sr_strshmlen(ext_shm_addr + change_subs[j].xpath);
-                }
+    if (!sr_alive_ntf.conn_count) {
+        /* the connections closed before the watch was created are not known, check all of them the first time */
+        sr_alive_ntf.pid = getpid();
+        sr_alive_ntf.all = 1;
+        sr_alive_ntf.pending_count = 0;
+
+        /* watch for any connection files being closed, if it fails all the connections will always be checked */
+        sr_alive_ntf.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (sr_alive_ntf.fd == -1) {
+            SR_LOG_WRN("Failed to initialize inotify (%s).", strerror(errno));
+        } else if ((err_info = sr_path_conn_dir(&path))) {
+            sr_errinfo_free(&err_info);
+            close(sr_alive_ntf.fd);
+            sr_alive_ntf.fd = -1;
+        } else {
+            if (inotify_add_watch(sr_alive_ntf.fd, path, IN_CLOSE_WRITE | IN_CLOSE_NOWRITE) == -1) {
+                SR_LOG_WRN("Failed to watch connection files directory \"%s\" (%s).", path, strerror(errno));
+                close(sr_alive_ntf.fd);
+                sr_alive_ntf.fd = -1;
+            }
+            free(path);
+        }
+    }
+    ++sr_alive_ntf.conn_count;
+
+    /* ALIVE NTF UNLOCK */
+    pthread_mutex_unlock(&sr_alive_ntf.lock);
+}
+
+void
+sr_shmmain_alive_ntf_release(void)
+{
+    /* ALIVE NTF LOCK */
+    pthread_mutex_lock(&sr_alive_ntf.lock);
+
+    assert(sr_alive_ntf.conn_count);
+    if ((sr_alive_ntf.pid == getpid()) && !--sr_alive_ntf.conn_count) {
+        /* last connection of this process */
+        if (sr_alive_ntf.fd > -1) {
+            close(sr_alive_ntf.fd);
+            sr_alive_ntf.fd = -1;
+        }
+    }
+
+    /* ALIVE NTF UNLOCK */
+    pthread_mutex_unlock(&sr_alive_ntf.lock);
+}
+
+/**
+ * @brief Check whether any connections were closed since the last check and recover them if their
+ * process no longer exists. Main SHM WRITE lock is expected to be held.
+ *
+ * Connection files are kept open by their connections so a closed connection file means a closed connection
+ * or a terminated process. The close events are read from the watch shared by all the connections of this
+ * process, connections of all the processes are checked only when the watch was just created or if the close
+ * events cannot be relied on.
+ *
+ * The files are closed by the kernel while the process is exiting so it may still exist when checked. Such
+ * processes with some connections left are remembered and checked again on every following check until
+ * they either terminate or have no connections.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_conn_check(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *event;
+    pid_t pids[SR_CONN_CHECK_PID_MAX], pid;
+    uint32_t pid_count = 0, i;
+    ssize_t len;
+    char *ptr;
+    int all;
+
+    /* ALIVE NTF LOCK */
+    pthread_mutex_lock(&sr_alive_ntf.lock);
+
+    all = sr_alive_ntf.all || (sr_alive_ntf.fd == -1);
+    sr_alive_ntf.all = 0;
+
+    /* check the pending processes again */
+    memcpy(pids, sr_alive_ntf.pending, sr_alive_ntf.pending_count * sizeof *pids);
+    pid_count = sr_alive_ntf.pending_count;
+    sr_alive_ntf.pending_count = 0;
+
+    /* read all the queued close events, even if all the connections are going to be checked */
+    while (sr_alive_ntf.fd > -1) {
+        len = read(sr_alive_ntf.fd, buf, sizeof buf);
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN) {
+                SR_LOG_WRN("Reading connection close events failed (%s).", strerror(errno));
+                all = 1;
             }
-            shm_size += SR_SHM_SIZE(shm_mod->change_sub[i].sub_count * sizeof *change_subs);
+            break;
         }
 
-        /* oper subscriptions */
-        oper_subs = (sr_mod_oper_sub_t *)(ext_shm_addr + shm_mod->oper_subs);
-        for (i = 0; i < shm_mod->oper_sub_count; ++i) {
-            assert(oper_subs[i].xpath);
-            shm_size += sr_strshmlen(ext_shm_addr + oper_subs[i].xpath);
+        for (ptr = buf; ptr < buf + len; ptr += sizeof *event + event->len) {
+            event = (const struct inotify_event *)ptr;
+            if ((event->mask & IN_Q_OVERFLOW) || !event->len) {
+                /* some events were lost */
+                all = 1;
+                continue;
+            }
+
+            /* learn the PID of the closed connection */
+            pid = strtol(event->name, NULL, 10);
+            if (!pid || (pid == getpid())) {
+                /* our own connection or a foreign file */
+                continue;
+            }
+            for (i = 0; i < pid_count; ++i) {
+                if (pids[i] == pid) {
+                    break;
+                }
+            }
+            if (i < pid_count) {
+                continue;
+            }
+
+            if (pid_count == SR_CONN_CHECK_PID_MAX) {
+                /* too many, just check all of them */
+                all = 1;
+            } else {
+                pids[pid_count++] = pid;
+            }
         }
-        shm_size += SR_SHM_SIZE(shm_mod->oper_subs * sizeof *oper_subs);
+    }
 
-        /* notif subscriptions */
-        shm_size += SR_SHM_SIZE(shm_mod->notif_subs * sizeof(sr_mod_notif_sub_t));
+    if (all && (err_info = sr_shmmain_conn_recover(conn, 0))) {
+        goto cleanup;
     }
 
-    return shm_size;
+    for (i = 0; i < pid_count; ++i) {
+        if (sr_process_exists(pids[i])) {
+            if (sr_shmmain_conn_pid_has_conn(conn, pids[i])) {
+                /* the process may be exiting or only some of its connections were closed, check it again */
+                sr_alive_ntf.pending[sr_alive_ntf.pending_count++] = pids[i];
+            }
+        } else if (!all && (err_info = sr_shmmain_conn_recover(conn, pids[i]))) {
+            /* all the terminated processes were already recovered otherwise */
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    /* ALIVE NTF UNLOCK */
+    pthread_mutex_unlock(&sr_alive_ntf.lock);
+    return err_info;
 }
 
 /**
@@ -1220,16 +1199,79 @@ sr_shmmain_ly_ctx_init(struct ly_ctx **ly_ctx)
     return NULL;
 }
 
-sr_error_info_t *
-sr_shmmain_files_startup2running(sr_conn_ctx_t *conn, int replace)
-{
-    sr_error_info_t *err_info = NULL;
-    sr_mod_t *shm_mod = NULL;
-    char *startup_path, *running_path;
+/**
+ * @brief Copy of startup data of a single module into running.
+ */
+struct sr_startup_cp_mod_s {
+    const char *mod_name;           /**< Module name. */
+    char *running_path;             /**< Running SHM path. */
+    sr_error_info_t *err_info;      /**< Error info of the copy. */
+};
+
+/**
+ * @brief Copy of startup data of several modules shared by all the threads.
+ */
+struct sr_startup_cp_s {
+    struct sr_startup_cp_mod_s *mods;   /**< Modules to copy. */
+    uint32_t mod_count;             /**< Count of modules. */
+    ATOMIC_T next_mod;              /**< Index of the next module to copy. */
+};
+
+/**
+ * @brief Thread copying startup data of the next modules into running until there are none left.
+ *
+ * @param[in] arg Shared startup data copy structure.
+ * @return Always NULL.
+ */
+static void *
+sr_startup_cp_thread(void *arg)
+{
+    struct sr_startup_cp_s *cp = (struct sr_startup_cp_s *)arg;
+    struct sr_startup_cp_mod_s *cmod;
+    char *startup_path;
+    uint32_t idx;
+
+    while ((idx = ATOMIC_INC_RELAXED(cp->next_mod)) < cp->mod_count) {
+        cmod = &cp->mods[idx];
+
+        if ((cmod->err_info = sr_path_startup_file(cmod->mod_name, &startup_path))) {
+            continue;
+        }
+        cmod->err_info = sr_cp_file2shm(cmod->running_path, startup_path, SR_FILE_PERM);
+        free(startup_path);
+    }
+
+    return NULL;
+}
+
+sr_error_info_t *
+sr_shmmain_files_startup2running(sr_conn_ctx_t *conn, int replace)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_mod_t *shm_mod = NULL;
+    struct sr_startup_cp_s cp = {0};
+    pthread_t *tids = NULL;
+    char *running_path;
     const char *mod_name;
+    uint32_t i, thread_max, thread_count = 0;
+    long cpu_count;
+    int ret;
+
+    cp.mods = calloc(((sr_main_shm_t *)conn->main_shm.addr)->mod_count, sizeof *cp.mods);
+    SR_CHECK_MEM_RET(!cp.mods, err_info);
 
     SR_SHM_MOD_FOR(conn->main_shm.addr, conn->main_shm.size, shm_mod) {
         mod_name = conn->ext_shm.addr + shm_mod->name;
+
+        /* any previous running diff belongs to previous data versions */
+        if ((err_info = sr_path_running_diff_shm(mod_name, 0, &running_path))) {
+            goto error;
+        }
+        if ((shm_unlink(running_path) == -1) && (errno != ENOENT)) {
+            SR_LOG_WRN("Failed to unlink \"%s\" (%s).", running_path, strerror(errno));
+        }
+        free(running_path);
+
         if ((err_info = sr_path_ds_shm(mod_name, SR_DS_RUNNING, 0, &running_path))) {
             goto error;
         }
@@ -1240,25 +1282,64 @@ sr_shmmain_files_startup2running(sr_conn_ctx_t *conn, int replace)
             continue;
         }
 
-        if ((err_info = sr_path_startup_file(mod_name, &startup_path))) {
-            free(running_path);
-            goto error;
+        /* copy this module data */
+        cp.mods[cp.mod_count].mod_name = mod_name;
+        cp.mods[cp.mod_count].running_path = running_path;
+        ++cp.mod_count;
+    }
+
+    /* the files are independent so copy them using several threads, this thread is also one of them */
+    cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_max = (cpu_count > 0) ? (uint32_t)cpu_count : 1;
+    if (thread_max > SR_DATA_LOAD_THREAD_COUNT) {
+        thread_max = SR_DATA_LOAD_THREAD_COUNT;
+    }
+    if (thread_max > cp.mod_count) {
+        thread_max = cp.mod_count;
+    }
+    if (thread_max > 1) {
+        tids = malloc((thread_max - 1) * sizeof *tids);
+        SR_CHECK_MEM_GOTO(!tids, err_info, cleanup);
+        while (thread_count + 1 < thread_max) {
+            if ((ret = pthread_create(&tids[thread_count], NULL, sr_startup_cp_thread, &cp))) {
+                /* continue with the threads we have */
+                SR_LOG_WRN("Failed to create a thread (%s).", strerror(ret));
+                break;
+            }
+            ++thread_count;
         }
-        err_info = sr_cp_file2shm(running_path, startup_path, SR_FILE_PERM);
-        free(startup_path);
-        free(running_path);
-        if (err_info) {
-            goto error;
+    }
+    sr_startup_cp_thread(&cp);
+
+    /* wait for all the copies */
+    for (i = 0; i < thread_count; ++i) {
+        pthread_join(tids[i], NULL);
+    }
+
+    /* check the results, in the order of the modules */
+    for (i = 0; i < cp.mod_count; ++i) {
+        if (cp.mods[i].err_info) {
+            sr_errinfo_merge(&err_info, cp.mods[i].err_info);
+            cp.mods[i].err_info = NULL;
+            sr_errinfo_new(&err_info, SR_ERR_INTERNAL, NULL, "Copying module \"%s\" data from <startup> to <running> failed.",
+                    cp.mods[i].mod_name);
         }
     }
 
-    if (replace) {
+    if (!err_info && replace) {
         SR_LOG_INFMSG("Datastore copied from <startup> to <running>.");
     }
-    return NULL;
+    goto cleanup;
 
 error:
     sr_errinfo_new(&err_info, SR_ERR_INTERNAL, NULL, "Copying module \"%s\" data from <startup> to <running> failed.", mod_name);
+
+cleanup:
+    for (i = 0; i < cp.mod_count; ++i) {
+        free(cp.mods[i].running_path);
+    }
+    free(cp.mods);
+    free(tids);
     return err_info;
 }
 
@@ -1373,6 +1454,9 @@ sr_shmmain_add_modules(char *ext_shm_addr, struct lyd_node *first_sr_mod, sr_mod
         if ((err_info = sr_rwlock_init(&first_shm_mod->replay_lock, 1))) {
             return err_info;
         }
+        if ((err_info = sr_rwlock_init_robust(&first_shm_mod->sub_lock))) {
+            return err_info;
+        }
         first_shm_mod->ver = 1;
 
         /* set all arrays and pointers to ext SHM */
@@ -1559,6 +1643,144 @@ sr_shmmain_add_modules_deps(sr_shm_t *shm_main, char *ext_shm_addr, struct lyd_n
     return NULL;
 }
 
+/**
+ * @brief Collect the dependency closure of a module.
+ *
+ * @param[in] shm_main Main SHM.
+ * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] shm_mod Main SHM module whose closure to collect.
+ * @param[in,out] flags Array of closure flags for every main SHM module, is cleared first.
+ * @param[out] count Number of modules in the closure.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_dep_closure_collect(sr_shm_t *shm_main, char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t *flags,
+        uint16_t *count)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)shm_main->addr;
+    sr_mod_t *inv_mod, *dep_mod;
+    sr_mod_data_dep_t *shm_deps;
+    off_t *shm_inv_deps;
+    uint32_t i;
+    uint16_t j, k;
+
+    memset(flags, 0, main_shm->mod_count * sizeof *flags);
+
+    /* data dependencies, instance-identifiers are handled only once there are data */
+    shm_deps = (sr_mod_data_dep_t *)(ext_shm_addr + shm_mod->data_deps);
+    for (j = 0; j < shm_mod->data_dep_count; ++j) {
+        if (shm_deps[j].type == SR_DEP_INSTID) {
+            continue;
+        }
+        dep_mod = sr_shmmain_find_module(shm_main, NULL, NULL, shm_deps[j].module);
+        SR_CHECK_INT_RET(!dep_mod, err_info);
+        flags[SR_SHM_MOD_IDX(dep_mod, *shm_main)] |= SR_MOD_CLOSURE_DEP;
+    }
+
+    /* inverse data dependencies and their data dependencies */
+    shm_inv_deps = (off_t *)(ext_shm_addr + shm_mod->inv_data_deps);
+    for (j = 0; j < shm_mod->inv_data_dep_count; ++j) {
+        inv_mod = sr_shmmain_find_module(shm_main, NULL, NULL, shm_inv_deps[j]);
+        SR_CHECK_INT_RET(!inv_mod, err_info);
+        flags[SR_SHM_MOD_IDX(inv_mod, *shm_main)] |= SR_MOD_CLOSURE_INV_DEP;
+
+        shm_deps = (sr_mod_data_dep_t *)(ext_shm_addr + inv_mod->data_deps);
+        for (k = 0; k < inv_mod->data_dep_count; ++k) {
+            if (shm_deps[k].type == SR_DEP_INSTID) {
+                continue;
+            }
+            dep_mod = sr_shmmain_find_module(shm_main, NULL, NULL, shm_deps[k].module);
+            SR_CHECK_INT_RET(!dep_mod, err_info);
+            flags[SR_SHM_MOD_IDX(dep_mod, *shm_main)] |= SR_MOD_CLOSURE_INV_DEP_DEP;
+        }
+    }
+
+    /* the module itself is never part of its closure */
+    flags[SR_SHM_MOD_IDX(shm_mod, *shm_main)] = 0;
+
+    *count = 0;
+    for (i = 0; i < main_shm->mod_count; ++i) {
+        if (flags[i]) {
+            ++(*count);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Add modules dependency closures, data dependencies of all the modules must already be added.
+ * Ext SHM is remapped to fit them.
+ *
+ * @param[in] shm_main Main SHM.
+ * @param[in] shm_ext Ext SHM.
+ * @param[in,out] ext_end Current ext SHM end, must be equal to its size.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_add_modules_dep_closures(sr_shm_t *shm_main, sr_shm_t *shm_ext, off_t *ext_end)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)shm_main->addr;
+    sr_mod_t *shm_mod;
+    sr_mod_closure_t *shm_closure;
+    uint32_t *flags, i;
+    uint16_t count, j;
+    size_t closure_size = 0;
+    char *ext_cur;
+
+    assert((size_t)*ext_end == shm_ext->size);
+
+    if (!main_shm->mod_count) {
+        /* nothing to do */
+        return NULL;
+    }
+
+    flags = malloc(main_shm->mod_count * sizeof *flags);
+    SR_CHECK_MEM_RET(!flags, err_info);
+
+    /* learn the size of all the closures */
+    SR_SHM_MOD_FOR(shm_main->addr, shm_main->size, shm_mod) {
+        if ((err_info = sr_shmmain_dep_closure_collect(shm_main, shm_ext->addr, shm_mod, flags, &count))) {
+            goto cleanup;
+        }
+        closure_size += count * sizeof *shm_closure;
+    }
+
+    /* enlarge ext SHM */
+    if ((err_info = sr_shm_remap(shm_ext, shm_ext->size + closure_size))) {
+        goto cleanup;
+    }
+    ext_cur = shm_ext->addr + *ext_end;
+
+    /* fill the closures, sorted by the module index */
+    SR_SHM_MOD_FOR(shm_main->addr, shm_main->size, shm_mod) {
+        if ((err_info = sr_shmmain_dep_closure_collect(shm_main, shm_ext->addr, shm_mod, flags, &count))) {
+            goto cleanup;
+        }
+
+        shm_mod->dep_closure = sr_shmcpy(shm_ext->addr, NULL, count * sizeof *shm_closure, &ext_cur);
+        shm_mod->dep_closure_count = count;
+        shm_closure = (sr_mod_closure_t *)(shm_ext->addr + shm_mod->dep_closure);
+        for (i = 0, j = 0; i < main_shm->mod_count; ++i) {
+            if (flags[i]) {
+                shm_closure[j].mod_idx = i;
+                shm_closure[j].flags = flags[i];
+                ++j;
+            }
+        }
+        assert(j == count);
+    }
+
+    *ext_end = ext_cur - shm_ext->addr;
+    SR_CHECK_INT_GOTO((size_t)*ext_end != shm_ext->size, err_info, cleanup);
+
+cleanup:
+    free(flags);
+    return err_info;
+}
+
 /**
  * @brief Remove modules data/op/inverse dependencies.
  *
@@ -1575,7 +1797,7 @@ sr_shmmain_del_modules_deps(sr_shm_t *shm_main, char *ext_shm_addr, sr_mod_t *fi
     uint32_t i, j;
 
     assert(first_shm_mod);
-    ext_wasted = (size_t *)ext_shm_addr;
+    ext_wasted = &((sr_ext_shm_t *)ext_shm_addr)->wasted;
 
     do {
         shm_data_deps = (sr_mod_data_dep_t *)(ext_shm_addr + first_shm_mod->data_deps);
@@ -1596,6 +1818,11 @@ sr_shmmain_del_modules_deps(sr_shm_t *shm_main, char *ext_shm_addr, sr_mod_t *fi
         first_shm_mod->inv_data_deps = 0;
         first_shm_mod->inv_data_dep_count = 0;
 
+        /* add wasted for dependency closure array and clear it */
+        *ext_wasted += first_shm_mod->dep_closure_count * sizeof(sr_mod_closure_t);
+        first_shm_mod->dep_closure = 0;
+        first_shm_mod->dep_closure_count = 0;
+
         shm_op_deps = (sr_mod_op_dep_t *)(ext_shm_addr + first_shm_mod->op_deps);
         for (i = 0; i < first_shm_mod->op_dep_count; ++i) {
             if (shm_op_deps[i].xpath) {
@@ -1643,8 +1870,9 @@ sr_shmmain_add(sr_conn_ctx_t *conn, struct lyd_node *sr_mod)
     struct lyd_node *next;
     sr_mod_t *shm_mod;
     sr_main_shm_t *main_shm;
+    sr_ext_shm_t *ext_shm;
     off_t main_end, ext_end;
-    size_t *wasted_ext, new_ext_size, new_mod_count;
+    size_t prev_wasted, new_ext_size, new_mod_count;
 
     /* count how many modules are we going to add */
     new_mod_count = 0;
@@ -1663,14 +1891,13 @@ sr_shmmain_add(sr_conn_ctx_t *conn, struct lyd_node *sr_mod)
         return err_info;
     }
 
-    /* enlarge ext SHM */
-    wasted_ext = (size_t *)conn->ext_shm.addr;
-    new_ext_size = sizeof(size_t) + sr_shmmain_ext_get_size_main_shm(&conn->main_shm, conn->ext_shm.addr) +
-            sr_shmmain_ext_get_lydmods_size(sr_mod->parent);
-    if ((err_info = sr_shm_remap(&conn->ext_shm, new_ext_size + *wasted_ext))) {
+    /* enlarge ext SHM, the module data are always added at its end */
+    ext_shm = (sr_ext_shm_t *)conn->ext_shm.addr;
+    prev_wasted = ext_shm->wasted;
+    new_ext_size = conn->ext_shm.size + sr_shmmain_ext_get_lydmods_size(sr_mod->parent);
+    if ((err_info = sr_shm_remap(&conn->ext_shm, new_ext_size))) {
         return err_info;
     }
-    wasted_ext = (size_t *)conn->ext_shm.addr;
 
     /* add all newly implemented modules into SHM */
     if ((err_info = sr_shmmain_add_modules(conn->ext_shm.addr, sr_mod, (sr_mod_t *)(conn->main_shm.addr + main_end),
@@ -1694,10 +1921,11 @@ sr_shmmain_add(sr_conn_ctx_t *conn, struct lyd_node *sr_mod)
     sr_shmmain_del_modules_deps(&conn->main_shm, conn->ext_shm.addr, SR_FIRST_SHM_MOD(conn->main_shm.addr));
 
     /* enlarge ext SHM to account for the newly wasted memory */
-    if ((err_info = sr_shm_remap(&conn->ext_shm, new_ext_size + *wasted_ext))) {
+    ext_shm = (sr_ext_shm_t *)conn->ext_shm.addr;
+    new_ext_size += ext_shm->wasted - prev_wasted;
+    if ((err_info = sr_shm_remap(&conn->ext_shm, new_ext_size))) {
         return err_info;
     }
-    wasted_ext = (size_t *)conn->ext_shm.addr;
 
     /* add all dependencies for all modules in SHM */
     if ((err_info = sr_shmmain_add_modules_deps(&conn->main_shm, conn->ext_shm.addr, sr_mod->parent->child,
@@ -1706,7 +1934,12 @@ sr_shmmain_add(sr_conn_ctx_t *conn, struct lyd_node *sr_mod)
     }
 
     /* check expected size */
-    SR_CHECK_INT_RET((unsigned)ext_end != new_ext_size + *wasted_ext, err_info);
+    SR_CHECK_INT_RET((unsigned)ext_end != new_ext_size, err_info);
+
+    /* add dependency closures of all modules */
+    if ((err_info = sr_shmmain_add_modules_dep_closures(&conn->main_shm, &conn->ext_shm, &ext_end))) {
+        return err_info;
+    }
 
     return NULL;
 }
@@ -1760,6 +1993,12 @@ sr_shmmain_main_open(sr_shm_t *shm, int *created)
         if ((err_info = sr_rwlock_init(&main_shm->lock, 1))) {
             goto error;
         }
+        if ((err_info = sr_rwlock_init_robust(&main_shm->rpc_lock))) {
+            goto error;
+        }
+        if ((err_info = sr_rwlock_init_robust(&main_shm->conn_lock))) {
+            goto error;
+        }
         if ((err_info = sr_mutex_init(&main_shm->lydmods_lock, 1))) {
             goto error;
         }
@@ -1811,11 +2050,14 @@ sr_shmmain_ext_open(sr_shm_t *shm, int zero)
     }
 
     /* either zero the memory or keep it exactly the way it was */
-    if ((err_info = sr_shm_remap(shm, zero ? sizeof(size_t) : 0))) {
+    if ((err_info = sr_shm_remap(shm, zero ? sizeof(sr_ext_shm_t) : 0))) {
         goto error;
     }
     if (zero) {
-        *((size_t *)shm->addr) = 0;
+        memset(shm->addr, 0, sizeof(sr_ext_shm_t));
+        if ((err_info = sr_mutex_init_robust(&((sr_ext_shm_t *)shm->addr)->lock))) {
+            goto error;
+        }
     }
 
     return NULL;
@@ -1825,6 +2067,72 @@ error:
     return err_info;
 }
 
+void
+sr_stats_start(struct timespec *start)
+{
+    if (clock_gettime(CLOCK_MONOTONIC, start) == -1) {
+        /* will not happen anyway */
+        start->tv_sec = 0;
+        start->tv_nsec = 0;
+    }
+}
+
+/**
+ * @brief Get the duration elapsed since a start time.
+ *
+ * @param[in] start Start time.
+ * @return Duration in microseconds.
+ */
+static uint64_t
+sr_stats_usec(const struct timespec *start)
+{
+    struct timespec cur;
+    uint64_t usec;
+
+    sr_stats_start(&cur);
+    if ((cur.tv_sec < start->tv_sec) || ((cur.tv_sec == start->tv_sec) && (cur.tv_nsec < start->tv_nsec))) {
+        usec = 0;
+    } else {
+        usec = (cur.tv_sec - start->tv_sec) * 1000000ULL;
+        usec += (cur.tv_nsec - start->tv_nsec) / 1000;
+    }
+
+    return usec;
+}
+
+void
+sr_stats_hist_add(sr_stats_hist_t *hist, const struct timespec *start)
+{
+    uint64_t usec;
+    uint32_t bucket;
+
+    usec = sr_stats_usec(start);
+
+    /* bucket is the position of the highest bit set */
+    for (bucket = 0; usec && (bucket < SR_STATS_HIST_BUCKETS - 1); ++bucket) {
+        usec >>= 1;
+    }
+
+    ATOMIC_INC_RELAXED(hist->buckets[bucket]);
+}
+
+void
+sr_stats_sess_cb_add(sr_session_ctx_t *sess, const struct timespec *start)
+{
+    uint64_t usec;
+
+    usec = sr_stats_usec(start);
+
+    /* STATS LOCK */
+    pthread_mutex_lock(&sess->cb_stats.lock);
+
+    ++sess->cb_stats.count;
+    sess->cb_stats.usec += usec;
+
+    /* STATS UNLOCK */
+    pthread_mutex_unlock(&sess->cb_stats.lock);
+}
+
 sr_mod_t *
 sr_shmmain_find_module(sr_shm_t *shm_main, char *ext_shm_addr, const char *name, off_t name_off)
 {
@@ -1843,6 +2151,55 @@ sr_shmmain_find_module(sr_shm_t *shm_main, char *ext_shm_addr, const char *name,
     return NULL;
 }
 
+sr_error_info_t *
+sr_shmmain_ly_mods_index(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)conn->main_shm.addr;
+    sr_mod_t *shm_mod;
+    uint32_t i;
+
+    free(conn->ly_mods);
+    conn->ly_mods = NULL;
+    conn->ly_mod_count = 0;
+
+    if (!main_shm->mod_count) {
+        return NULL;
+    }
+
+    conn->ly_mods = malloc(main_shm->mod_count * sizeof *conn->ly_mods);
+    SR_CHECK_MEM_RET(!conn->ly_mods, err_info);
+
+    i = 0;
+    SR_SHM_MOD_FOR(conn->main_shm.addr, conn->main_shm.size, shm_mod) {
+        conn->ly_mods[i] = ly_ctx_get_module(conn->ly_ctx, conn->ext_shm.addr + shm_mod->name, NULL, 1);
+        if (!conn->ly_mods[i]) {
+            free(conn->ly_mods);
+            conn->ly_mods = NULL;
+            SR_ERRINFO_INT(&err_info);
+            return err_info;
+        }
+        ++i;
+    }
+    conn->ly_mod_count = i;
+
+    return NULL;
+}
+
+const struct lys_module *
+sr_shmmain_ly_mod(sr_conn_ctx_t *conn, const struct ly_ctx *ly_ctx, sr_mod_t *shm_mod)
+{
+    uint32_t idx;
+
+    idx = SR_SHM_MOD_IDX(shm_mod, conn->main_shm);
+    if ((idx < conn->ly_mod_count) && (conn->ly_mods[idx]->ctx == ly_ctx)) {
+        return conn->ly_mods[idx];
+    }
+
+    /* different context or no index */
+    return ly_ctx_get_module(ly_ctx, conn->ext_shm.addr + shm_mod->name, NULL, 1);
+}
+
 sr_rpc_t *
 sr_shmmain_find_rpc(sr_main_shm_t *main_shm, char *ext_shm_addr, const char *op_path, off_t op_path_off)
 {
@@ -1863,6 +2220,100 @@ sr_shmmain_find_rpc(sr_main_shm_t *main_shm, char *ext_shm_addr, const char *op_
     return NULL;
 }
 
+/**
+ * @brief Map ext SHM in its current size if it has grown, without unmapping the previous mapping because
+ * it may still be in use by other threads. Ext SHM REMAP lock is expected to be held.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_ext_remap_grow(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    size_t shm_file_size;
+    sr_shm_t *prev_shms;
+    char *addr;
+
+    /* EXT GROW LOCK */
+    if ((err_info = sr_mlock(&conn->ext_grow_lock, SR_MAIN_LOCK_TIMEOUT * 1000, __func__))) {
+        return err_info;
+    }
+
+    if ((err_info = sr_file_get_size(conn->ext_shm.fd, &shm_file_size))) {
+        goto cleanup;
+    }
+    if (shm_file_size <= conn->ext_shm.size) {
+        /* no remapping needed */
+        goto cleanup;
+    }
+
+    /* map it again in the full size */
+    addr = mmap(NULL, shm_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, conn->ext_shm.fd, 0);
+    if (addr == MAP_FAILED) {
+        sr_errinfo_new(&err_info, SR_ERR_NOMEM, NULL, "Failed to map shared memory (%s).", strerror(errno));
+        goto cleanup;
+    }
+
+    /* remember the previous mapping */
+    prev_shms = realloc(conn->ext_prev_shms, (conn->ext_prev_shm_count + 1) * sizeof *prev_shms);
+    if (!prev_shms) {
+        munmap(addr, shm_file_size);
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+    conn->ext_prev_shms = prev_shms;
+    conn->ext_prev_shms[conn->ext_prev_shm_count].fd = -1;
+    conn->ext_prev_shms[conn->ext_prev_shm_count].size = conn->ext_shm.size;
+    conn->ext_prev_shms[conn->ext_prev_shm_count].addr = conn->ext_shm.addr;
+    ++conn->ext_prev_shm_count;
+
+    /* use the new mapping, the previous one maps the same memory */
+    conn->ext_shm.addr = addr;
+    conn->ext_shm.size = shm_file_size;
+
+cleanup:
+    /* EXT GROW UNLOCK */
+    sr_munlock(&conn->ext_grow_lock);
+    return err_info;
+}
+
+void
+sr_shmmain_ext_prev_clear(sr_conn_ctx_t *conn)
+{
+    uint32_t i;
+
+    for (i = 0; i < conn->ext_prev_shm_count; ++i) {
+        munmap(conn->ext_prev_shms[i].addr, conn->ext_prev_shms[i].size);
+    }
+    free(conn->ext_prev_shms);
+    conn->ext_prev_shms = NULL;
+    conn->ext_prev_shm_count = 0;
+}
+
+/**
+ * @brief Unmap all previous ext SHM mappings of a connection if there is no ext SHM REMAP lock held.
+ *
+ * @param[in] conn Connection to use.
+ */
+static void
+sr_shmmain_ext_prev_tryclear(sr_conn_ctx_t *conn)
+{
+    /* REMAP MUTEX LOCK */
+    if (pthread_mutex_trylock(&conn->ext_remap_lock.mutex)) {
+        /* a WRITE lock is held or about to be, the mappings will be unmapped on the next remap */
+        return;
+    }
+
+    if (!conn->ext_remap_lock.readers) {
+        /* the same as holding WRITE lock, no thread can be using the previous mappings */
+        sr_shmmain_ext_prev_clear(conn);
+    }
+
+    /* REMAP MUTEX UNLOCK */
+    pthread_mutex_unlock(&conn->ext_remap_lock.mutex);
+}
+
 /**
  * @brief Update information about currently held main lock.
  *
@@ -1887,16 +2338,115 @@ sr_shmmain_conn_lock_update(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int lock)
     return NULL;
 }
 
+/**
+ * @brief Remove main SHM READ locks held by connections of terminated processes. The connections themselves
+ * are recovered once main SHM is WRITE locked.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_conn_recover_main_rdlock(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)conn->main_shm.addr;
+    sr_conn_shm_t *shm_conn;
+    uint32_t i, rcount;
+
+    /* SHM MUTEX LOCK (no READ locks can be added or removed) */
+    if ((err_info = sr_mlock(&main_shm->lock.mutex, SR_MAIN_LOCK_TIMEOUT * 1000, __func__))) {
+        return err_info;
+    }
+
+    /* REMAP READ LOCK */
+    if ((err_info = sr_rwlock(&conn->ext_remap_lock, SR_MAIN_LOCK_TIMEOUT * 1000, SR_LOCK_READ, __func__))) {
+        goto cleanup_shm_unlock;
+    }
+
+    /* the connections could have been added after we mapped ext SHM */
+    if ((err_info = sr_shmmain_ext_remap_grow(conn))) {
+        goto cleanup_remap_unlock;
+    }
+
+    shm_conn = (sr_conn_shm_t *)(conn->ext_shm.addr + main_shm->conns);
+    for (i = 0; i < main_shm->conn_count; ++i) {
+        if ((shm_conn[i].main_lock.mode != SR_LOCK_READ) || sr_process_exists(shm_conn[i].pid)) {
+            continue;
+        }
+
+        SR_LOG_WRN("Removing main SHM READ lock of a non-existent sysrepo client with PID %ld.",
+                (long)shm_conn[i].pid);
+        rcount = ATOMIC_LOAD_RELAXED(shm_conn[i].main_lock.rcount);
+        assert(rcount && (main_shm->lock.readers >= rcount));
+        main_shm->lock.readers -= rcount;
+        ATOMIC_STORE_RELAXED(shm_conn[i].main_lock.rcount, 0);
+        shm_conn[i].main_lock.mode = SR_LOCK_NONE;
+    }
+
+    if (!main_shm->lock.readers) {
+        /* broadcast on condition */
+        pthread_cond_broadcast(&main_shm->lock.cond);
+    }
+
+cleanup_remap_unlock:
+    /* REMAP READ UNLOCK */
+    sr_rwunlock(&conn->ext_remap_lock, SR_LOCK_READ, __func__);
+
+cleanup_shm_unlock:
+    /* SHM MUTEX UNLOCK */
+    sr_munlock(&main_shm->lock.mutex);
+    return err_info;
+}
+
+/**
+ * @brief WRITE lock main SHM. A connection that terminated while holding a READ lock would prevent it forever
+ * so READ locks of terminated connections are removed whenever the lock is not acquired in a second.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] func Caller function name.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_wrlock(sr_conn_ctx_t *conn, const char *func)
+{
+    sr_error_info_t *err_info = NULL;
+    uint32_t i;
+
+    for (i = 0; i < SR_MAIN_LOCK_TIMEOUT; ++i) {
+        /* SHM WRITE LOCK */
+        err_info = sr_rwlock(&((sr_main_shm_t *)conn->main_shm.addr)->lock, 1000, SR_LOCK_WRITE, func);
+        if (!err_info || (err_info->err_code != SR_ERR_TIME_OUT) || (i == SR_MAIN_LOCK_TIMEOUT - 1)) {
+            break;
+        }
+        sr_errinfo_free(&err_info);
+
+        /* some READ lock holders may have terminated */
+        if ((err_info = sr_shmmain_conn_recover_main_rdlock(conn))) {
+            break;
+        }
+    }
+
+    return err_info;
+}
+
 sr_error_info_t *
 sr_shmmain_lock_remap(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, const char *func)
 {
     sr_error_info_t *err_info = NULL;
-    size_t shm_file_size;
+    struct timespec wait_start;
+
+    sr_stats_start(&wait_start);
 
     /* SHM LOCK */
-    if ((err_info = sr_rwlock(&((sr_main_shm_t *)conn->main_shm.addr)->lock, SR_MAIN_LOCK_TIMEOUT * 1000, mode, func))) {
+    if (mode == SR_LOCK_WRITE) {
+        err_info = sr_shmmain_wrlock(conn, func);
+    } else {
+        err_info = sr_rwlock(&((sr_main_shm_t *)conn->main_shm.addr)->lock, SR_MAIN_LOCK_TIMEOUT * 1000, mode, func);
+    }
+    if (err_info) {
         return err_info;
     }
+    sr_stats_hist_add(&((sr_main_shm_t *)conn->main_shm.addr)->stats.lock_wait, &wait_start);
 
     /* REMAP READ/WRITE LOCK */
     if ((err_info = sr_rwlock(&conn->ext_remap_lock, SR_MAIN_LOCK_TIMEOUT * 1000,
@@ -1906,41 +2456,19 @@ sr_shmmain_lock_remap(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, const
 
     /* remap ext SHM */
     if (remap) {
-        /* we have WRITE lock, it is safe */
+        /* we have WRITE lock, it is safe, nobody can be using the previous mappings, either */
+        sr_shmmain_ext_prev_clear(conn);
         if ((err_info = sr_shm_remap(&conn->ext_shm, 0))) {
             goto error_shm_remap_unlock;
         }
-    } else {
-        if ((err_info = sr_file_get_size(conn->ext_shm.fd, &shm_file_size))) {
-            goto error_shm_remap_unlock;
-        }
-        if (shm_file_size > conn->ext_shm.size) {
-            /* ext SHM is larger now and we need to remap it */
-
-            /* REMAP READ UNLOCK */
-            sr_rwunlock(&conn->ext_remap_lock, SR_LOCK_READ, func);
-            /* REMAP WRITE LOCK */
-            if ((err_info = sr_rwlock(&conn->ext_remap_lock, SR_MAIN_LOCK_TIMEOUT * 1000, SR_LOCK_WRITE, func))) {
-                goto error_shm_unlock;
-            }
-
-            if ((err_info = sr_shm_remap(&conn->ext_shm, shm_file_size))) {
-                remap = 1;
-                goto error_shm_remap_unlock;
-            }
-
-            /* REMAP WRITE UNLOCK */
-            sr_rwunlock(&conn->ext_remap_lock, SR_LOCK_WRITE, func);
-            /* REMAP READ LOCK */
-            if ((err_info = sr_rwlock(&conn->ext_remap_lock, SR_MAIN_LOCK_TIMEOUT * 1000, SR_LOCK_READ, func))) {
-                goto error_shm_unlock;
-            }
-        } /* else no remapping needed */
+    } else if ((err_info = sr_shmmain_ext_remap_grow(conn))) {
+        /* other threads may be using the current mapping so it cannot be unmapped */
+        goto error_shm_remap_unlock;
     }
 
     if (mode == SR_LOCK_WRITE) {
-        /* check that all connections still exist */
-        if ((err_info = sr_shmmain_conn_recover(conn))) {
+        /* check that all closed connections were properly disconnected */
+        if ((err_info = sr_shmmain_conn_check(conn))) {
             goto error_shm_remap_unlock;
         }
     }
@@ -1966,7 +2494,6 @@ void
 sr_shmmain_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, const char *func)
 {
     sr_error_info_t *err_info = NULL;
-    char *buf;
 
     if (strcmp(func, "sr_connect") && strcmp(func, "sr_disconnect")) {
         /* update information about the held lock */
@@ -1975,50 +2502,132 @@ sr_shmmain_unlock(sr_conn_ctx_t *conn, sr_lock_mode_t mode, int remap, const cha
         }
     }
 
-    /* in case remap WRITE lock was held, it means wasted memory could have been added, defragment if needed */
-    if (remap && (*((size_t *)conn->ext_shm.addr) > SR_SHM_WASTED_MAX_MEM)) {
-        assert(mode == SR_LOCK_WRITE);
-
-        SR_LOG_DBGMSG("#SHM before defrag");
+    if (remap && (mode == SR_LOCK_WRITE)) {
+        /* ext SHM items could have been allocated or freed and no one else can be changing them now */
         sr_shmmain_ext_print(&conn->main_shm, conn->ext_shm.addr, conn->ext_shm.size);
-
-        /* defrag mem into a separate memory */
-        if (!(err_info = sr_shmmain_ext_defrag(&conn->main_shm, &conn->ext_shm, &buf))) {
-            /* remap ext SHM, it does not matter if it fails, will just be kept larger than needed */
-            err_info = sr_shm_remap(&conn->ext_shm, conn->ext_shm.size - *((size_t *)conn->ext_shm.addr));
-
-            SR_LOG_INF("Ext SHM was defragmented and %u B were saved.", *((size_t *)conn->ext_shm.addr));
-
-            /* copy the defragmented memory into ext SHM (has wasted set to 0) */
-            memcpy(conn->ext_shm.addr, buf, conn->ext_shm.size);
-            free(buf);
-
-            SR_LOG_DBGMSG("#SHM after defrag");
-            sr_shmmain_ext_print(&conn->main_shm, conn->ext_shm.addr, conn->ext_shm.size);
-        }
-        sr_errinfo_free(&err_info);
     }
 
     /* REMAP UNLOCK */
     sr_rwunlock(&conn->ext_remap_lock, remap ? SR_LOCK_WRITE : SR_LOCK_READ, func);
 
+    if (conn->ext_prev_shm_count) {
+        /* try to get rid of any previous mappings */
+        sr_shmmain_ext_prev_tryclear(conn);
+    }
+
     /* SHM UNLOCK */
     sr_rwunlock(&((sr_main_shm_t *)conn->main_shm.addr)->lock, mode, func);
 }
 
+/**
+ * @brief Update information about a held main SHM subscription lock of a connection.
+ *
+ * @param[in] conn Connection to update.
+ * @param[in] sub_lock Subscription lock.
+ * @param[in] mode Lock mode.
+ * @param[in] lock Whether the lock was LOCKED or UNLOCKED.
+ */
+static void
+sr_shmmain_conn_sub_lock_update(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, sr_lock_mode_t mode, int lock)
+{
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)conn->main_shm.addr;
+    sr_conn_shm_lock_t *sub_locks;
+    sr_mod_t *shm_mod;
+    uint32_t idx;
+
+    if (!conn->shm_sub_locks) {
+        /* connecting, the connection is not in main SHM yet */
+        return;
+    }
+
+    if (sub_lock == &main_shm->rpc_lock) {
+        idx = SR_CONN_SHM_SUB_LOCK_RPC_IDX(main_shm->mod_count);
+    } else if (sub_lock == &main_shm->conn_lock) {
+        idx = SR_CONN_SHM_SUB_LOCK_RPC_IDX(main_shm->mod_count) + 1;
+    } else {
+        /* module subscription lock */
+        shm_mod = (sr_mod_t *)(((char *)sub_lock) - offsetof(sr_mod_t, sub_lock));
+        idx = SR_SHM_MOD_IDX(shm_mod, conn->main_shm);
+    }
+
+    sub_locks = (sr_conn_shm_lock_t *)(conn->ext_shm.addr + conn->shm_sub_locks);
+    sr_shmlock_update(&sub_locks[idx], mode, lock);
+}
+
+sr_error_info_t *
+sr_shmmain_sub_lock_remap(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, sr_lock_mode_t mode, const char *func)
+{
+    sr_error_info_t *err_info = NULL;
+
+    /* SHM SUB LOCK */
+    if ((err_info = sr_rwlock(sub_lock, SR_MAIN_LOCK_TIMEOUT * 1000, mode, func))) {
+        return err_info;
+    }
+
+    /* the subscriptions could have been allocated in ext SHM after we mapped it */
+    if ((err_info = sr_shmmain_ext_remap_grow(conn))) {
+        /* SHM SUB UNLOCK */
+        sr_rwunlock(sub_lock, mode, func);
+        return err_info;
+    }
+
+    /* store information about the held lock */
+    sr_shmmain_conn_sub_lock_update(conn, sub_lock, mode, 1);
+
+    return NULL;
+}
+
+void
+sr_shmmain_sub_unlock(sr_conn_ctx_t *conn, sr_rwlock_t *sub_lock, sr_lock_mode_t mode, const char *func)
+{
+    /* update information about the held lock */
+    sr_shmmain_conn_sub_lock_update(conn, sub_lock, mode, 0);
+
+    /* SHM SUB UNLOCK */
+    sr_rwunlock(sub_lock, mode, func);
+}
+
 sr_error_info_t *
 sr_shmmain_rpc_subscription_add(sr_shm_t *shm_ext, off_t shm_rpc_off, const char *xpath, uint32_t priority, int sub_opts,
-        uint32_t evpipe_num)
+        uint32_t evpipe_num, uint32_t *slot)
 {
     sr_error_info_t *err_info = NULL;
     sr_rpc_t *shm_rpc;
     off_t xpath_off;
     sr_rpc_sub_t *shm_sub;
+    uint64_t used_slots = 0;
+    uint32_t i;
 
     assert(xpath);
 
     shm_rpc = (sr_rpc_t *)(shm_ext->addr + shm_rpc_off);
 
+    /* concurrent and standard subscriptions cannot be mixed, learn the used slots */
+    shm_sub = (sr_rpc_sub_t *)(shm_ext->addr + shm_rpc->subs);
+    for (i = 0; i < shm_rpc->sub_count; ++i) {
+        if ((shm_sub[i].opts & SR_SUBSCR_CONCURRENT) != (sub_opts & SR_SUBSCR_CONCURRENT)) {
+            sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, NULL, "RPC/action \"%s\" already has %s subscriptions.",
+                    shm_ext->addr + shm_rpc->op_path, (sub_opts & SR_SUBSCR_CONCURRENT) ? "standard" : "concurrent");
+            return err_info;
+        }
+        used_slots |= 1ULL << shm_sub[i].slot;
+    }
+
+    /* every concurrent subscription gets its own sub SHM slot */
+    *slot = 0;
+    if (sub_opts & SR_SUBSCR_CONCURRENT) {
+        for (*slot = 1; *slot <= SR_RPC_SUB_SLOT_COUNT; ++*slot) {
+            if (!(used_slots & (1ULL << *slot))) {
+                break;
+            }
+        }
+        if (*slot > SR_RPC_SUB_SLOT_COUNT) {
+            sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "RPC/action \"%s\" reached the maximum number of "
+                    "concurrent subscriptions (%d).", shm_ext->addr + shm_rpc->op_path, SR_RPC_SUB_SLOT_COUNT);
+            return err_info;
+        }
+    }
+
     /* add new subscription with its xpath */
     if ((err_info = sr_shmrealloc_add(shm_ext, &shm_rpc->subs, &shm_rpc->sub_count, 1, sizeof *shm_sub, -1,
             (void **)&shm_sub, sr_strshmlen(xpath), &xpath_off))) {
@@ -2031,29 +2640,34 @@ sr_shmmain_rpc_subscription_add(sr_shm_t *shm_ext, off_t shm_rpc_off, const char
     shm_sub->priority = priority;
     shm_sub->opts = sub_opts;
     shm_sub->evpipe_num = evpipe_num;
+    shm_sub->slot = *slot;
 
     return NULL;
 }
 
 int
-sr_shmmain_rpc_subscription_del(char *ext_shm_addr, sr_rpc_t *shm_rpc, const char *xpath, uint32_t priority,
-        uint32_t evpipe_num, int only_evpipe, int *last_removed)
+sr_shmmain_rpc_subscription_del(sr_shm_t *shm_ext, sr_rpc_t *shm_rpc, const char *xpath, uint32_t priority,
+        uint32_t evpipe_num, int only_evpipe, uint32_t *slot, int *last_removed)
 {
     sr_rpc_sub_t *shm_sub;
     uint16_t i;
 
+    if (slot) {
+        *slot = 0;
+    }
     if (last_removed) {
         *last_removed = 0;
     }
 
     /* find the subscription */
-    shm_sub = (sr_rpc_sub_t *)(ext_shm_addr + shm_rpc->subs);
+    shm_sub = (sr_rpc_sub_t *)(shm_ext->addr + shm_rpc->subs);
     for (i = 0; i < shm_rpc->sub_count; ++i) {
         if (only_evpipe) {
             if (shm_sub[i].evpipe_num == evpipe_num) {
                 break;
             }
-        } else if (!strcmp(ext_shm_addr + shm_sub[i].xpath, xpath) && (shm_sub[i].priority == priority)) {
+        } else if (!strcmp(shm_ext->addr + shm_sub[i].xpath, xpath) && (shm_sub[i].priority == priority)
+                && (shm_sub[i].evpipe_num == evpipe_num)) {
             break;
         }
     }
@@ -2061,10 +2675,13 @@ sr_shmmain_rpc_subscription_del(char *ext_shm_addr, sr_rpc_t *shm_rpc, const cha
         /* no matching subscription found */
         return 1;
     }
+    if (slot) {
+        *slot = shm_sub[i].slot;
+    }
 
     /* delete the subscription */
-    sr_shmrealloc_del(ext_shm_addr, &shm_rpc->subs, &shm_rpc->sub_count, sizeof *shm_sub, i,
-            sr_strshmlen(ext_shm_addr + shm_sub[i].xpath));
+    sr_shmrealloc_del(shm_ext, &shm_rpc->subs, &shm_rpc->sub_count, sizeof *shm_sub, i, shm_sub[i].xpath,
+            sr_strshmlen(shm_ext->addr + shm_sub[i].xpath));
 
     if (last_removed && !shm_rpc->subs) {
         *last_removed = 1;
@@ -2073,14 +2690,43 @@ sr_shmmain_rpc_subscription_del(char *ext_shm_addr, sr_rpc_t *shm_rpc, const cha
     return 0;
 }
 
+/**
+ * @brief Unlink RPC/action subscription SHM.
+ *
+ * @param[in] op_path RPC/action path.
+ * @param[in] slot Sub SHM slot.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmmain_rpc_sub_shm_unlink(const char *op_path, uint32_t slot)
+{
+    sr_error_info_t *err_info = NULL;
+    char *mod_name, *path, suffix[SR_RPC_SUB_SUFFIX_LEN];
+
+    /* get module name */
+    mod_name = sr_get_first_ns(op_path);
+
+    err_info = sr_path_sub_shm(mod_name, sr_path_sub_shm_rpc_suffix(slot, suffix), sr_str_hash(op_path), 0, &path);
+    free(mod_name);
+    if (err_info) {
+        return err_info;
+    }
+    if (shm_unlink(path) == -1) {
+        SR_LOG_WRN("Failed to unlink SHM \"%s\" (%s).", path, strerror(errno));
+    }
+    free(path);
+
+    return NULL;
+}
+
 sr_error_info_t *
 sr_shmmain_rpc_subscription_stop(sr_conn_ctx_t *conn, sr_rpc_t *shm_rpc, const char *xpath, uint32_t priority,
         uint32_t evpipe_num, int all_evpipe, int *last_removed)
 {
     sr_error_info_t *err_info = NULL;
     const char *op_path;
-    char *mod_name, *path;
     int last_sub_removed;
+    uint32_t slot;
 
     op_path = conn->ext_shm.addr + shm_rpc->op_path;
     if (last_removed) {
@@ -2089,31 +2735,24 @@ sr_shmmain_rpc_subscription_stop(sr_conn_ctx_t *conn, sr_rpc_t *shm_rpc, const c
 
     do {
         /* remove the subscription from the main SHM */
-        if (sr_shmmain_rpc_subscription_del(conn->ext_shm.addr, shm_rpc, xpath, priority, evpipe_num, all_evpipe,
-                &last_sub_removed)) {
+        if (sr_shmmain_rpc_subscription_del(&conn->ext_shm, shm_rpc, xpath, priority, evpipe_num, all_evpipe,
+                &slot, &last_sub_removed)) {
             if (!all_evpipe) {
                 SR_ERRINFO_INT(&err_info);
             }
             break;
         }
 
-        if (last_sub_removed) {
-            /* get module name */
-            mod_name = sr_get_first_ns(op_path);
-
-            /* delete the SHM file itself so that there is no leftover event */
-            err_info = sr_path_sub_shm(mod_name, "rpc", sr_str_hash(op_path), 0, &path);
-            free(mod_name);
-            if (err_info) {
+        if (slot || last_sub_removed) {
+            /* delete the SHM file itself so that there is no leftover event, a concurrent subscription has its own */
+            if ((err_info = sr_shmmain_rpc_sub_shm_unlink(op_path, slot))) {
                 break;
             }
-            if (shm_unlink(path) == -1) {
-                SR_LOG_WRN("Failed to unlink SHM \"%s\" (%s).", path, strerror(errno));
-            }
-            free(path);
+        }
 
+        if (last_sub_removed) {
             /* delete also RPC, we must break because shm_rpc was removed */
-            err_info = sr_shmmain_del_rpc((sr_main_shm_t *)conn->main_shm.addr, conn->ext_shm.addr, NULL, shm_rpc->op_path);
+            err_info = sr_shmmain_del_rpc((sr_main_shm_t *)conn->main_shm.addr, &conn->ext_shm, NULL, shm_rpc->op_path);
             if (!err_info && last_removed) {
                 *last_removed = 1;
             }
@@ -2163,21 +2802,21 @@ sr_shmmain_add_rpc(sr_conn_ctx_t *conn, const char *op_path, sr_rpc_t **shm_rpc_
 }
 
 sr_error_info_t *
-sr_shmmain_del_rpc(sr_main_shm_t *main_shm, char *ext_shm_addr, const char *op_path, off_t op_path_off)
+sr_shmmain_del_rpc(sr_main_shm_t *main_shm, sr_shm_t *shm_ext, const char *op_path, off_t op_path_off)
 {
     sr_error_info_t *err_info = NULL;
     sr_rpc_t *shm_rpc;
     uint16_t i;
 
-    shm_rpc = sr_shmmain_find_rpc(main_shm, ext_shm_addr, op_path, op_path_off);
+    shm_rpc = sr_shmmain_find_rpc(main_shm, shm_ext->addr, op_path, op_path_off);
     SR_CHECK_INT_RET(!shm_rpc, err_info);
 
     /* get index instead */
-    i = shm_rpc - ((sr_rpc_t *)(ext_shm_addr + main_shm->rpc_subs));
+    i = shm_rpc - ((sr_rpc_t *)(shm_ext->addr + main_shm->rpc_subs));
 
     /* remove the RPC and its op_path */
-    sr_shmrealloc_del(ext_shm_addr, &main_shm->rpc_subs, &main_shm->rpc_sub_count, sizeof *shm_rpc, i,
-            sr_strshmlen(ext_shm_addr + shm_rpc->op_path));
+    sr_shmrealloc_del(shm_ext, &main_shm->rpc_subs, &main_shm->rpc_sub_count, sizeof *shm_rpc, i, shm_rpc->op_path,
+            sr_strshmlen(shm_ext->addr + shm_rpc->op_path));
 
     return NULL;
 }
@@ -47,12 +47,13 @@ static sr_error_info_t *
 sr_shmmod_lock(const char *mod_name, struct sr_mod_lock_s *shm_lock, int timeout_ms, sr_lock_mode_t mode, sr_sid_t sid)
 {
     sr_error_info_t *err_info = NULL;
-    struct timespec timeout_ts;
+    struct timespec timeout_ts, wait_start;
     int ret;
 
     assert(timeout_ms > 0);
     assert((mode == SR_LOCK_READ) || (mode == SR_LOCK_WRITE));
 
+    sr_stats_start(&wait_start);
     sr_time_get(&timeout_ts, timeout_ms);
 
     /* MUTEX LOCK */
@@ -92,34 +93,10 @@ sr_shmmod_lock(const char *mod_name, struct sr_mod_lock_s *shm_lock, int timeout
         pthread_mutex_unlock(&shm_lock->lock.mutex);
     }
 
+    sr_stats_hist_add(&shm_lock->wait, &wait_start);
     return NULL;
 }
 
-/**
- * @brief Comparator function for qsort of mod info modules.
- *
- * @param[in] ptr1 First value pointer.
- * @param[in] ptr2 Second value pointer.
- * @return Less than, equal to, or greater than 0 if the first value is found
- * to be less than, equal to, or greater to the second value.
- */
-static int
-sr_modinfo_qsort_cmp(const void *ptr1, const void *ptr2)
-{
-    struct sr_mod_info_mod_s *mod1, *mod2;
-
-    mod1 = (struct sr_mod_info_mod_s *)ptr1;
-    mod2 = (struct sr_mod_info_mod_s *)ptr2;
-
-    if (mod1->shm_mod > mod2->shm_mod) {
-        return 1;
-    }
-    if (mod1->shm_mod < mod2->shm_mod) {
-        return -1;
-    }
-    return 0;
-}
-
 sr_error_info_t *
 sr_shmmod_modinfo_collect_edit(struct sr_mod_info_s *mod_info, const struct lyd_node *edit)
 {
@@ -152,9 +129,6 @@ sr_shmmod_modinfo_collect_edit(struct sr_mod_info_s *mod_info, const struct lyd_
         }
     }
 
-    /* sort the modules based on their offsets in the SHM so that we have a uniform order for locking */
-    qsort(mod_info->mods, mod_info->mod_count, sizeof *mod_info->mods, sr_modinfo_qsort_cmp);
-
     return NULL;
 }
 
@@ -226,9 +200,6 @@ sr_shmmod_modinfo_collect_xpath(struct sr_mod_info_s *mod_info, const char *xpat
         }
     }
 
-    /* sort the modules based on their offsets in the SHM so that we have a uniform order for locking */
-    qsort(mod_info->mods, mod_info->mod_count, sizeof *mod_info->mods, sr_modinfo_qsort_cmp);
-
     /* success */
 
 cleanup:
@@ -257,7 +228,7 @@ sr_shmmod_modinfo_collect_modules(struct sr_mod_info_s *mod_info, const struct l
 
     /* all modules */
     SR_SHM_MOD_FOR(conn->main_shm.addr, conn->main_shm.size, shm_mod) {
-        ly_mod = ly_ctx_get_module(conn->ly_ctx, conn->ext_shm.addr + shm_mod->name, NULL, 1);
+        ly_mod = sr_shmmain_ly_mod(conn, conn->ly_ctx, shm_mod);
         SR_CHECK_INT_RET(!ly_mod, err_info);
 
         /* do not collect dependencies, all the modules are added anyway */
@@ -320,7 +291,7 @@ sr_shmmod_modinfo_collect_op(struct sr_mod_info_s *mod_info, const char *op_path
         SR_CHECK_INT_RET(!dep_mod, err_info);
 
         /* find ly module */
-        ly_mod = ly_ctx_get_module(conn->ly_ctx, conn->ext_shm.addr + dep_mod->name, NULL, 1);
+        ly_mod = sr_shmmain_ly_mod(conn, conn->ly_ctx, dep_mod);
         SR_CHECK_INT_RET(!ly_mod, err_info);
 
         /* add dependency */
@@ -329,9 +300,6 @@ sr_shmmod_modinfo_collect_op(struct sr_mod_info_s *mod_info, const char *op_path
         }
     }
 
-    /* sort the modules based on their offsets in the SHM so that we have a uniform order for locking */
-    qsort(mod_info->mods, mod_info->mod_count, sizeof *mod_info->mods, sr_modinfo_qsort_cmp);
-
     return NULL;
 }
 
@@ -700,12 +668,63 @@ sr_shmmod_change_subscription_add(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const ch
     shm_sub->priority = priority;
     shm_sub->opts = sub_opts;
     shm_sub->evpipe_num = evpipe_num;
+    ATOMIC_STORE_RELAXED(shm_sub->events, 0);
 
     return NULL;
 }
 
+sr_error_info_t *
+sr_shmmod_change_subscriptions_add(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const sr_module_change_subscr_t *subscrs,
+        uint16_t subscr_count, sr_datastore_t ds, int sub_opts, uint32_t evpipe_num)
+{
+    sr_error_info_t *err_info = NULL;
+    off_t *xpath_offs;
+    sr_mod_change_sub_t *shm_sub;
+    uint16_t i;
+
+    xpath_offs = calloc(subscr_count, sizeof *xpath_offs);
+    SR_CHECK_MEM_RET(!xpath_offs, err_info);
+
+    /* allocate all the xpaths */
+    for (i = 0; i < subscr_count; ++i) {
+        if (subscrs[i].xpath) {
+            if ((err_info = sr_shmalloc(shm_ext, sr_strshmlen(subscrs[i].xpath), &xpath_offs[i]))) {
+                goto cleanup;
+            }
+            strcpy(shm_ext->addr + xpath_offs[i], subscrs[i].xpath);
+        }
+    }
+
+    /* allocate all the new subscriptions */
+    if ((err_info = sr_shmrealloc_add_items(shm_ext, &shm_mod->change_sub[ds].subs, &shm_mod->change_sub[ds].sub_count,
+            0, sizeof *shm_sub, subscr_count, (void **)&shm_sub))) {
+        goto cleanup;
+    }
+
+    /* fill new subscriptions */
+    for (i = 0; i < subscr_count; ++i) {
+        shm_sub[i].xpath = xpath_offs[i];
+        shm_sub[i].priority = subscrs[i].priority;
+        shm_sub[i].opts = sub_opts;
+        shm_sub[i].evpipe_num = evpipe_num;
+        ATOMIC_STORE_RELAXED(shm_sub[i].events, 0);
+    }
+
+cleanup:
+    if (err_info) {
+        /* free the allocated xpaths */
+        for (i = 0; i < subscr_count; ++i) {
+            if (xpath_offs[i]) {
+                sr_shmfree(shm_ext, xpath_offs[i], sr_strshmlen(subscrs[i].xpath));
+            }
+        }
+    }
+    free(xpath_offs);
+    return err_info;
+}
+
 int
-sr_shmmod_change_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const char *xpath, sr_datastore_t ds,
+sr_shmmod_change_subscription_del(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const char *xpath, sr_datastore_t ds,
         uint32_t priority, int sub_opts, uint32_t evpipe_num, int only_evpipe, int *last_removed)
 {
     sr_mod_change_sub_t *shm_sub;
@@ -716,14 +735,14 @@ sr_shmmod_change_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const c
     }
 
     /* find the subscription(s) */
-    shm_sub = (sr_mod_change_sub_t *)(ext_shm_addr + shm_mod->change_sub[ds].subs);
+    shm_sub = (sr_mod_change_sub_t *)(shm_ext->addr + shm_mod->change_sub[ds].subs);
     for (i = 0; i < shm_mod->change_sub[ds].sub_count; ++i) {
         if (only_evpipe) {
             if (shm_sub[i].evpipe_num == evpipe_num) {
                 break;
             }
         } else if ((!xpath && !shm_sub[i].xpath)
-                    || (xpath && shm_sub[i].xpath && !strcmp(ext_shm_addr + shm_sub[i].xpath, xpath))) {
+                    || (xpath && shm_sub[i].xpath && !strcmp(shm_ext->addr + shm_sub[i].xpath, xpath))) {
             if ((shm_sub[i].priority == priority) && (shm_sub[i].opts == sub_opts) && (shm_sub[i].evpipe_num == evpipe_num)) {
                 break;
             }
@@ -735,8 +754,8 @@ sr_shmmod_change_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const c
     }
 
     /* remove the subscription and its xpath, if any */
-    sr_shmrealloc_del(ext_shm_addr, &shm_mod->change_sub[ds].subs, &shm_mod->change_sub[ds].sub_count, sizeof *shm_sub,
-            i, shm_sub[i].xpath ? sr_strshmlen(ext_shm_addr + shm_sub[i].xpath) : 0);
+    sr_shmrealloc_del(shm_ext, &shm_mod->change_sub[ds].subs, &shm_mod->change_sub[ds].sub_count, sizeof *shm_sub,
+            i, shm_sub[i].xpath, shm_sub[i].xpath ? sr_strshmlen(shm_ext->addr + shm_sub[i].xpath) : 0);
 
     if (!shm_mod->change_sub[ds].subs && last_removed) {
         *last_removed = 1;
@@ -752,14 +771,24 @@ sr_shmmod_change_subscription_stop(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, const
     sr_error_info_t *err_info = NULL;
     const char *mod_name;
     char *path;
-    int last_removed;
+    int last_removed, ret;
 
     mod_name = conn->ext_shm.addr + shm_mod->name;
 
     do {
+        /* MOD SUBS WRITE LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            break;
+        }
+
         /* remove the subscription from the main SHM */
-        if (sr_shmmod_change_subscription_del(conn->ext_shm.addr, shm_mod, xpath, ds, priority, sub_opts, evpipe_num,
-                all_evpipe, &last_removed)) {
+        ret = sr_shmmod_change_subscription_del(&conn->ext_shm, shm_mod, xpath, ds, priority, sub_opts, evpipe_num,
+                all_evpipe, &last_removed);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+        if (ret) {
             if (!all_evpipe) {
                 /* error in this case */
                 SR_ERRINFO_INT(&err_info);
@@ -834,25 +863,26 @@ sr_shmmod_oper_subscription_add(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const char
     shm_sub->sub_type = sub_type;
     shm_sub->opts = sub_opts;
     shm_sub->evpipe_num = evpipe_num;
+    ATOMIC_STORE_RELAXED(shm_sub->events, 0);
 
     return NULL;
 }
 
 int
-sr_shmmod_oper_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const char *xpath, uint32_t evpipe_num,
-        int only_evpipe, const char **xpath_p)
+sr_shmmod_oper_subscription_del(sr_shm_t *shm_ext, sr_mod_t *shm_mod, const char *xpath, uint32_t evpipe_num,
+        int only_evpipe, uint32_t *xpath_hash_p)
 {
     sr_mod_oper_sub_t *shm_sub;
     uint16_t i;
 
     /* find the subscription */
-    shm_sub = (sr_mod_oper_sub_t *)(ext_shm_addr + shm_mod->oper_subs);
+    shm_sub = (sr_mod_oper_sub_t *)(shm_ext->addr + shm_mod->oper_subs);
     for (i = 0; i < shm_mod->oper_sub_count; ++i) {
         if (only_evpipe) {
             if (shm_sub[i].evpipe_num == evpipe_num) {
                 break;
             }
-        } else if (shm_sub[i].xpath && !strcmp(ext_shm_addr + shm_sub[i].xpath, xpath)) {
+        } else if (shm_sub[i].xpath && !strcmp(shm_ext->addr + shm_sub[i].xpath, xpath)) {
             break;
         }
     }
@@ -861,30 +891,43 @@ sr_shmmod_oper_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, const cha
         return 1;
     }
 
-    if (xpath_p) {
-        *xpath_p = ext_shm_addr + shm_sub[i].xpath;
+    if (xpath_hash_p) {
+        /* the xpath is freed with the subscription */
+        *xpath_hash_p = sr_str_hash(shm_ext->addr + shm_sub[i].xpath);
     }
 
     /* delete the subscription */
-    sr_shmrealloc_del(ext_shm_addr, &shm_mod->oper_subs, &shm_mod->oper_sub_count, sizeof *shm_sub, i,
-            shm_sub[i].xpath ? sr_strshmlen(ext_shm_addr + shm_sub[i].xpath) : 0);
+    sr_shmrealloc_del(shm_ext, &shm_mod->oper_subs, &shm_mod->oper_sub_count, sizeof *shm_sub, i, shm_sub[i].xpath,
+            shm_sub[i].xpath ? sr_strshmlen(shm_ext->addr + shm_sub[i].xpath) : 0);
 
     return 0;
 }
 
 sr_error_info_t *
-sr_shmmod_oper_subscription_stop(char *ext_shm_addr, sr_mod_t *shm_mod, const char *xpath, uint32_t evpipe_num,
+sr_shmmod_oper_subscription_stop(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, const char *xpath, uint32_t evpipe_num,
         int all_evpipe)
 {
     sr_error_info_t *err_info = NULL;
     const char *mod_name;
     char *path;
+    uint32_t xpath_hash;
+    int ret;
 
-    mod_name = ext_shm_addr + shm_mod->name;
+    mod_name = conn->ext_shm.addr + shm_mod->name;
 
     do {
+        /* MOD SUBS WRITE LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            break;
+        }
+
         /* remove the subscriptions from the main SHM */
-        if (sr_shmmod_oper_subscription_del(ext_shm_addr, shm_mod, xpath, evpipe_num, all_evpipe, &xpath)) {
+        ret = sr_shmmod_oper_subscription_del(&conn->ext_shm, shm_mod, xpath, evpipe_num, all_evpipe, &xpath_hash);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+        if (ret) {
             if (!all_evpipe) {
                 SR_ERRINFO_INT(&err_info);
             }
@@ -892,7 +935,7 @@ sr_shmmod_oper_subscription_stop(char *ext_shm_addr, sr_mod_t *shm_mod, const ch
         }
 
         /* delete the SHM file itself so that there is no leftover event */
-        if ((err_info = sr_path_sub_shm(mod_name, "oper", sr_str_hash(xpath), 0, &path))) {
+        if ((err_info = sr_path_sub_shm(mod_name, "oper", xpath_hash, 0, &path))) {
             break;
         }
         if (shm_unlink(path) == -1) {
@@ -923,7 +966,7 @@ sr_shmmod_notif_subscription_add(sr_shm_t *shm_ext, sr_mod_t *shm_mod, uint32_t
 }
 
 int
-sr_shmmod_notif_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t evpipe_num, int *last_removed)
+sr_shmmod_notif_subscription_del(sr_shm_t *shm_ext, sr_mod_t *shm_mod, uint32_t evpipe_num, int *last_removed)
 {
     sr_mod_notif_sub_t *shm_sub;
     uint16_t i;
@@ -933,7 +976,7 @@ sr_shmmod_notif_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t
     }
 
     /* find the subscription */
-    shm_sub = (sr_mod_notif_sub_t *)(ext_shm_addr + shm_mod->notif_subs);
+    shm_sub = (sr_mod_notif_sub_t *)(shm_ext->addr + shm_mod->notif_subs);
     for (i = 0; i < shm_mod->notif_sub_count; ++i) {
         if (shm_sub[i].evpipe_num == evpipe_num) {
             break;
@@ -945,7 +988,7 @@ sr_shmmod_notif_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t
     }
 
     /* remove the subscription */
-    sr_shmrealloc_del(ext_shm_addr, &shm_mod->notif_subs, &shm_mod->notif_sub_count, sizeof *shm_sub, i, 0);
+    sr_shmrealloc_del(shm_ext, &shm_mod->notif_subs, &shm_mod->notif_sub_count, sizeof *shm_sub, i, 0, 0);
 
     if (!shm_mod->notif_subs && last_removed) {
         *last_removed = 1;
@@ -955,18 +998,28 @@ sr_shmmod_notif_subscription_del(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t
 }
 
 sr_error_info_t *
-sr_shmmod_notif_subscription_stop(char *ext_shm_addr, sr_mod_t *shm_mod, uint32_t evpipe_num, int all_evpipe)
+sr_shmmod_notif_subscription_stop(sr_conn_ctx_t *conn, sr_mod_t *shm_mod, uint32_t evpipe_num, int all_evpipe)
 {
     sr_error_info_t *err_info = NULL;
     const char *mod_name;
     char *path;
-    int last_removed;
+    int last_removed, ret;
 
-    mod_name = ext_shm_addr + shm_mod->name;
+    mod_name = conn->ext_shm.addr + shm_mod->name;
 
     do {
+        /* MOD SUBS WRITE LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            break;
+        }
+
         /* remove the subscriptions from the main SHM */
-        if (sr_shmmod_notif_subscription_del(ext_shm_addr, shm_mod, evpipe_num, &last_removed)) {
+        ret = sr_shmmod_notif_subscription_del(&conn->ext_shm, shm_mod, evpipe_num, &last_removed);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+        if (ret) {
             if (!all_evpipe) {
                 SR_ERRINFO_INT(&err_info);
             }
@@ -22,6 +22,7 @@
 #include "common.h"
 
 #include <sys/select.h>
+#include <poll.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -145,6 +146,29 @@ sr_shmsub_notify_new_wrlock(sr_sub_shm_t *sub_shm, const char *shm_name, sr_sub_
     return NULL;
 }
 
+/**
+ * @brief Try to get WRITE lock on a subscription for a new event without waiting.
+ *
+ * @param[in] sub_shm Subscription SHM to lock.
+ * @return 0 if the subscription is busy, non-zero if it was locked.
+ */
+static int
+sr_shmsub_notify_new_trywrlock(sr_sub_shm_t *sub_shm)
+{
+    /* MUTEX LOCK */
+    if (pthread_mutex_trylock(&sub_shm->lock.mutex)) {
+        return 0;
+    }
+
+    if (sub_shm->lock.readers || sub_shm->event) {
+        /* MUTEX UNLOCK */
+        pthread_mutex_unlock(&sub_shm->lock.mutex);
+        return 0;
+    }
+
+    return 1;
+}
+
 /**
  * @brief Having WRITE lock, wait for subscribers to handle a generated event.
  *
@@ -156,15 +180,16 @@ sr_shmsub_notify_new_wrlock(sr_sub_shm_t *sub_shm, const char *shm_name, sr_sub_
  *                                    success (never error) event is cleared,
  *              ::SR_SUB_EV_ERROR - an answer is expected and SHM will be further accessed so do not clear any events.
  * @param[in] timeout_ms Timeout in milliseconds.
+ * @param[in] stats Event statistics to update.
  * @param[out] cb_err_info Callback error information generated by a subscriber, if any.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
 sr_shmsub_notify_finish_wrunlock(sr_sub_shm_t *sub_shm, size_t shm_struct_size, sr_sub_event_t expected_ev,
-        uint32_t timeout_ms, sr_error_info_t **cb_err_info)
+        uint32_t timeout_ms, sr_stats_event_t *stats, sr_error_info_t **cb_err_info)
 {
     sr_error_info_t *err_info = NULL;
-    struct timespec timeout_ts;
+    struct timespec timeout_ts, wait_start;
     sr_error_t err_code;
     char *ptr, *err_msg, *err_xpath;
     sr_sub_event_t event;
@@ -175,6 +200,7 @@ sr_shmsub_notify_finish_wrunlock(sr_sub_shm_t *sub_shm, size_t shm_struct_size,
 
     event = sub_shm->event;
     request_id = sub_shm->request_id;
+    sr_stats_start(&wait_start);
     sr_time_get(&timeout_ts, timeout_ms);
 
     /* wait until this event was processed */
@@ -184,6 +210,12 @@ sr_shmsub_notify_finish_wrunlock(sr_sub_shm_t *sub_shm, size_t shm_struct_size,
         ret = pthread_cond_timedwait(&sub_shm->lock.cond, &sub_shm->lock.mutex, &timeout_ts);
     }
 
+    ATOMIC_INC_RELAXED(stats->published);
+    sr_stats_hist_add(&stats->duration, &wait_start);
+    if (ret == ETIMEDOUT) {
+        ATOMIC_INC_RELAXED(stats->timeouts);
+    }
+
     if (ret) {
         if (ret == ETIMEDOUT) {
             /* handle corner-case when the subscriber has just woken up and is processing this event,
@@ -383,22 +415,29 @@ sr_shmsub_change_is_valid(sr_sub_event_t ev, sr_subscr_options_t sub_opts)
 /**
  * @brief Learn whether there is a subscription for a change event.
  *
- * @param[in] ext_shm_addr Main SHM mapping address.
+ * @param[in] conn Connection to use.
  * @param[in] mod Mod info module to use.
  * @param[in] ds Datastore.
  * @param[in] ev Event.
  * @param[out] max_priority_p Highest priority among the valid subscribers.
- * @return 0 if not, non-zero if there is.
+ * @param[out] has_sub_p 0 if not, non-zero if there is.
+ * @return err_info, NULL on success.
  */
-static int
-sr_shmsub_change_notify_has_subscription(char *ext_shm_addr, struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
-        sr_sub_event_t ev, uint32_t *max_priority_p)
+static sr_error_info_t *
+sr_shmsub_change_notify_has_subscription(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
+        sr_sub_event_t ev, uint32_t *max_priority_p, int *has_sub_p)
 {
-    int has_sub = 0;
+    sr_error_info_t *err_info = NULL;
     uint32_t i;
     sr_mod_change_sub_t *shm_msub;
 
-    shm_msub = (sr_mod_change_sub_t *)(ext_shm_addr + mod->shm_mod->change_sub[ds].subs);
+    /* MOD SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    shm_msub = (sr_mod_change_sub_t *)(conn->ext_shm.addr + mod->shm_mod->change_sub[ds].subs);
+    *has_sub_p = 0;
     *max_priority_p = 0;
     for (i = 0; i < mod->shm_mod->change_sub[ds].sub_count; ++i) {
         if (!sr_shmsub_change_is_valid(ev, shm_msub[i].opts)) {
@@ -406,37 +445,56 @@ sr_shmsub_change_notify_has_subscription(char *ext_shm_addr, struct sr_mod_info_
         }
 
         /* valid subscription */
-        has_sub = 1;
+        *has_sub_p = 1;
         if (shm_msub[i].priority > *max_priority_p) {
             *max_priority_p = shm_msub[i].priority;
         }
     }
 
-    return has_sub;
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__);
+
+    return NULL;
 }
 
 /**
  * @brief Learn the priority of the next valid subscriber for a change event.
  *
- * @param[in] ext_shm_addr Main SHM mapping address.
+ * Subscriber count and their event pipes are learned at once so that exactly the counted subscribers
+ * are notified even if subscriptions change in the meantime.
+ *
+ * @param[in] conn Connection to use.
  * @param[in] mod Mod info module to use.
  * @param[in] ds Datastore.
  * @param[in] ev Change event.
  * @param[in] last_priority Last priorty of a subscriber.
  * @param[out] next_priorty_p Next priorty of a subsciber(s).
+ * @param[out] evpipes_p Optional array of evpipe numbers of all subscribers with this priority, needs to be freed.
  * @param[out] sub_count_p Number of subscribers with this priority.
  * @param[out] opts_p Optional options of all subscribers with this priority.
+ * @return err_info, NULL on success.
  */
-static void
-sr_shmsub_change_notify_next_subscription(char *ext_shm_addr, struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
-        sr_sub_event_t ev, uint32_t last_priority, uint32_t *next_priority_p, uint32_t *sub_count_p, int *opts_p)
+static sr_error_info_t *
+sr_shmsub_change_notify_next_subscription(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod, sr_datastore_t ds,
+        sr_sub_event_t ev, uint32_t last_priority, uint32_t *next_priority_p, uint32_t **evpipes_p, uint32_t *sub_count_p,
+        int *opts_p)
 {
-    uint32_t i;
+    sr_error_info_t *err_info = NULL;
+    uint32_t i, *evpipes = NULL;
     sr_mod_change_sub_t *shm_msub;
     int opts = 0;
 
-    shm_msub = (sr_mod_change_sub_t *)(ext_shm_addr + mod->shm_mod->change_sub[ds].subs);
     *sub_count_p = 0;
+    if (evpipes_p) {
+        *evpipes_p = NULL;
+    }
+
+    /* MOD SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    shm_msub = (sr_mod_change_sub_t *)(conn->ext_shm.addr + mod->shm_mod->change_sub[ds].subs);
     for (i = 0; i < mod->shm_mod->change_sub[ds].sub_count; ++i) {
         if (!sr_shmsub_change_is_valid(ev, shm_msub[i].opts)) {
             continue;
@@ -455,6 +513,8 @@ sr_shmsub_change_notify_next_subscription(char *ext_shm_addr, struct sr_mod_info
                     /* same priority subscription */
                     ++(*sub_count_p);
                     opts |= shm_msub[i].opts;
+                } else {
+                    continue;
                 }
             } else {
                 /* first lower priority subscription than the last processed */
@@ -462,12 +522,33 @@ sr_shmsub_change_notify_next_subscription(char *ext_shm_addr, struct sr_mod_info
                 *sub_count_p = 1;
                 opts = shm_msub[i].opts;
             }
+
+            if (evpipes_p) {
+                /* remember the evpipe, the array is (re)filled from the start for a higher priority */
+                evpipes = sr_realloc(evpipes, *sub_count_p * sizeof *evpipes);
+                SR_CHECK_MEM_GOTO(!evpipes, err_info, cleanup);
+                evpipes[*sub_count_p - 1] = shm_msub[i].evpipe_num;
+            }
         }
     }
 
+cleanup:
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__);
+
+    if (err_info) {
+        free(evpipes);
+        *sub_count_p = 0;
+        return err_info;
+    }
+
+    if (evpipes_p) {
+        *evpipes_p = evpipes;
+    }
     if (opts_p) {
         *opts_p = opts;
     }
+    return NULL;
 }
 
 sr_error_info_t *
@@ -510,35 +591,45 @@ cleanup:
 /**
  * @brief Write into change subscribers event pipe to notify them there is a new event.
  *
- * @param[in] ext_shm_addr Ext SHM address.
+ * @param[in] conn Connection to use.
  * @param[in] mod Mod info module to use.
  * @param[in] ds Datastore.
  * @param[in] ev Change event.
  * @param[in] priority Priority of the subscribers with new event.
+ * @param[in] evpipes Event pipes of the subscribers learned together with their count.
+ * @param[in] evpipe_count Count of @p evpipes.
  * @return err_info, NULL on success.
  */
 static sr_error_info_t *
-sr_shmsub_change_notify_evpipe(char *ext_shm_addr, struct sr_mod_info_mod_s *mod, sr_datastore_t ds, sr_sub_event_t ev,
-        uint32_t priority)
+sr_shmsub_change_notify_evpipe(sr_conn_ctx_t *conn, struct sr_mod_info_mod_s *mod, sr_datastore_t ds, sr_sub_event_t ev,
+        uint32_t priority, const uint32_t *evpipes, uint32_t evpipe_count)
 {
     sr_error_info_t *err_info = NULL;
     uint32_t i;
     sr_mod_change_sub_t *shm_msub;
 
-    shm_msub = (sr_mod_change_sub_t *)(ext_shm_addr + mod->shm_mod->change_sub[ds].subs);
-    for (i = 0; i < mod->shm_mod->change_sub[ds].sub_count; ++i) {
-        if (!sr_shmsub_change_is_valid(ev, shm_msub[i].opts)) {
-            continue;
+    for (i = 0; i < evpipe_count; ++i) {
+        if ((err_info = sr_shmsub_notify_evpipe(evpipes[i]))) {
+            return err_info;
         }
+    }
 
-        /* valid subscription */
-        if (shm_msub[i].priority == priority) {
-            if ((err_info = sr_shmsub_notify_evpipe(shm_msub[i].evpipe_num))) {
-                return err_info;
-            }
+    /* MOD SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    /* update stats of the notified subscriptions */
+    shm_msub = (sr_mod_change_sub_t *)(conn->ext_shm.addr + mod->shm_mod->change_sub[ds].subs);
+    for (i = 0; i < mod->shm_mod->change_sub[ds].sub_count; ++i) {
+        if (sr_shmsub_change_is_valid(ev, shm_msub[i].opts) && (shm_msub[i].priority == priority)) {
+            ATOMIC_INC_RELAXED(shm_msub[i].events);
         }
     }
 
+    /* MOD SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &mod->shm_mod->sub_lock, SR_LOCK_READ, __func__);
+
     return NULL;
 }
 
@@ -582,10 +673,11 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
     sr_multi_sub_shm_t *multi_sub_shm;
     struct sr_mod_info_mod_s *mod = NULL;
     struct lyd_node *edit;
-    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL;
+    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL, *evpipes = NULL;
     char *diff_lyb = NULL;
     struct ly_ctx *ly_ctx;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
+    int has_sub;
 
     assert(mod_info->diff);
     *update_edit = NULL;
@@ -598,8 +690,11 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
         }
 
         /* just find out whether there are any subscriptions and if so, what is the highest priority */
-        if (!sr_shmsub_change_notify_has_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_UPDATE,
-                &cur_priority)) {
+        if ((err_info = sr_shmsub_change_notify_has_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_UPDATE,
+                &cur_priority, &has_sub))) {
+            goto cleanup;
+        }
+        if (!has_sub) {
             continue;
         }
 
@@ -618,8 +713,10 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
         multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
         /* correctly start the loop, with fake last priority 1 higher than the actual highest */
-        sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_UPDATE,
-                cur_priority + 1, &cur_priority, &subscriber_count, NULL);
+        if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_UPDATE,
+                cur_priority + 1, &cur_priority, &evpipes, &subscriber_count, NULL))) {
+            goto cleanup;
+        }
 
         do {
             /* there cannot be more subscribers on one module with the same priority */
@@ -645,14 +742,14 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
                     subscriber_count, 0, diff_lyb, diff_lyb_len, mod->ly_mod->name);
 
             /* notify using event pipe and wait until all the subscribers have processed the event */
-            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn->ext_shm.addr, mod, mod_info->ds,
-                    SR_SUB_EV_UPDATE, cur_priority))) {
+            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_UPDATE, cur_priority, evpipes, subscriber_count))) {
                 goto cleanup_wrunlock;
             }
 
             /* SUB WRITE UNLOCK */
             if ((err_info = sr_shmsub_notify_finish_wrunlock((sr_sub_shm_t *)multi_sub_shm, sizeof *multi_sub_shm,
-                    SR_SUB_EV_ERROR, timeout_ms, cb_err_info))) {
+                    SR_SUB_EV_ERROR, timeout_ms, &mod->shm_mod->stats.change[mod_info->ds], cb_err_info))) {
                 goto cleanup;
             }
 
@@ -704,8 +801,11 @@ sr_shmsub_change_notify_update(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
             }
 
             /* find out what is the next priority and how many subscribers have it */
-            sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_UPDATE,
-                    cur_priority, &cur_priority, &subscriber_count, NULL);
+            free(evpipes);
+            if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_UPDATE, cur_priority, &cur_priority, &evpipes, &subscriber_count, NULL))) {
+                goto cleanup;
+            }
         } while (subscriber_count);
 
         sr_shm_clear(&shm_sub);
@@ -723,6 +823,7 @@ cleanup_rdunlock:
     sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_READ, __func__);
 cleanup:
     free(aux);
+    free(evpipes);
     free(diff_lyb);
     sr_shm_clear(&shm_sub);
     if (err_info || *cb_err_info) {
@@ -740,6 +841,7 @@ sr_shmsub_change_notify_clear(struct sr_mod_info_s *mod_info, sr_sub_event_t ev)
     struct sr_mod_info_mod_s *mod = NULL;
     uint32_t cur_priority, subscriber_count, *aux = NULL;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
+    int has_sub;
 
     while ((mod = sr_modinfo_next_mod(mod, mod_info, mod_info->diff, &aux))) {
         /* open sub SHM and map it */
@@ -749,7 +851,11 @@ sr_shmsub_change_notify_clear(struct sr_mod_info_s *mod_info, sr_sub_event_t ev)
         multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
         /* just find out whether there are any subscriptions and if so, what is the highest priority */
-        if (!sr_shmsub_change_notify_has_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, ev, &cur_priority)) {
+        if ((err_info = sr_shmsub_change_notify_has_subscription(mod_info->conn, mod, mod_info->ds, ev, &cur_priority,
+                &has_sub))) {
+            goto cleanup;
+        }
+        if (!has_sub) {
             /* it is still possible that the subscription unsubscribed already */
 
             /* SUB WRITE LOCK */
@@ -774,8 +880,10 @@ sr_shmsub_change_notify_clear(struct sr_mod_info_s *mod_info, sr_sub_event_t ev)
         }
 
         /* correctly start the loop, with fake last priority 1 higher than the actual highest */
-        sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, ev,
-                cur_priority + 1, &cur_priority, &subscriber_count, NULL);
+        if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, ev,
+                cur_priority + 1, &cur_priority, NULL, &subscriber_count, NULL))) {
+            goto cleanup;
+        }
 
         do {
             /* SUB WRITE LOCK */
@@ -809,8 +917,10 @@ clear_event:
             sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_WRITE, __func__);
 
             /* find out what is the next priority and how many subscribers have it */
-            sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, ev,
-                    cur_priority, &cur_priority, &subscriber_count, NULL);
+            if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, ev,
+                    cur_priority, &cur_priority, NULL, &subscriber_count, NULL))) {
+                goto cleanup;
+            }
         } while (subscriber_count);
 
         /* this module event succeeded, let us check the next one */
@@ -833,13 +943,10 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
     sr_error_info_t *err_info = NULL;
     sr_multi_sub_shm_t *multi_sub_shm;
     struct sr_mod_info_mod_s *mod = NULL;
-    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL;
-    char *diff_lyb = NULL, *ext_shm_addr, *ext_shm_buf = NULL;
+    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL, *evpipes = NULL;
+    char *diff_lyb = NULL;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
-    int opts;
-
-    /* use our ext SHM mapping by default */
-    ext_shm_addr = mod_info->conn->ext_shm.addr;
+    int opts, has_sub, shm_unlocked = 0;
 
     while ((mod = sr_modinfo_next_mod(mod, mod_info, mod_info->diff, &aux))) {
         /* first check that there actually are some value changes (and not only dflt changes) */
@@ -848,10 +955,16 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
         }
 
         /* just find out whether there are any subscriptions and if so, what is the highest priority */
-        if (!sr_shmsub_change_notify_has_subscription(ext_shm_addr, mod, mod_info->ds, SR_SUB_EV_CHANGE,
-                    &cur_priority)) {
-            if (!sr_shmsub_change_notify_has_subscription(ext_shm_addr, mod, mod_info->ds, SR_SUB_EV_DONE,
-                    &cur_priority)) {
+        if ((err_info = sr_shmsub_change_notify_has_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_CHANGE,
+                &cur_priority, &has_sub))) {
+            goto cleanup;
+        }
+        if (!has_sub) {
+            if ((err_info = sr_shmsub_change_notify_has_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_DONE,
+                    &cur_priority, &has_sub))) {
+                goto cleanup;
+            }
+            if (!has_sub) {
                 if (mod_info->ds == SR_DS_RUNNING) {
                     SR_LOG_INF("There are no subscribers for changes of the module \"%s\" in %s DS.",
                             mod->ly_mod->name, sr_ds2str(mod_info->ds));
@@ -877,18 +990,15 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
         multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
         /* correctly start the loop, with fake last priority 1 higher than the actual highest */
-        sr_shmsub_change_notify_next_subscription(ext_shm_addr, mod, mod_info->ds, SR_SUB_EV_CHANGE,
-                cur_priority + 1, &cur_priority, &subscriber_count, &opts);
+        if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_CHANGE,
+                cur_priority + 1, &cur_priority, &evpipes, &subscriber_count, &opts))) {
+            goto cleanup;
+        }
 
         do {
-            if ((opts & SR_SUBSCR_UNLOCKED) && !ext_shm_buf) {
-                /* subscriber wants subscriptions (main/ext SHM) unlocked, so make a copy and unlock it */
-                ext_shm_buf = malloc(mod_info->conn->ext_shm.size);
-                SR_CHECK_MEM_GOTO(!ext_shm_buf, err_info, cleanup);
-                memcpy(ext_shm_buf, mod_info->conn->ext_shm.addr, mod_info->conn->ext_shm.size);
-
-                /* update pointers */
-                ext_shm_addr = ext_shm_buf;
+            if ((opts & SR_SUBSCR_UNLOCKED) && !shm_unlocked) {
+                /* subscriber wants main SHM unlocked, subscriptions are read only under their own locks */
+                shm_unlocked = 1;
 
                 /* SHM UNLOCK */
                 sr_shmmain_unlock(mod_info->conn, SR_LOCK_READ, 0, __func__);
@@ -913,14 +1023,14 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
                     subscriber_count, 0, diff_lyb, diff_lyb_len, mod->ly_mod->name);
 
             /* notify using event pipe and wait until all the subscribers have processed the event */
-            if ((err_info = sr_shmsub_change_notify_evpipe(ext_shm_addr, mod, mod_info->ds,
-                    SR_SUB_EV_CHANGE, cur_priority))) {
+            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_CHANGE, cur_priority, evpipes, subscriber_count))) {
                 goto cleanup_wrunlock;
             }
 
             /* SUB WRITE UNLOCK */
             if ((err_info = sr_shmsub_notify_finish_wrunlock((sr_sub_shm_t *)multi_sub_shm, sizeof *multi_sub_shm,
-                    SR_SUB_EV_SUCCESS, timeout_ms, cb_err_info))) {
+                    SR_SUB_EV_SUCCESS, timeout_ms, &mod->shm_mod->stats.change[mod_info->ds], cb_err_info))) {
                 goto cleanup;
             }
 
@@ -935,17 +1045,18 @@ sr_shmsub_change_notify_change(struct sr_mod_info_s *mod_info, sr_sid_t sid, uin
             }
 
             /* find out what is the next priority and how many subscribers have it */
-            sr_shmsub_change_notify_next_subscription(ext_shm_addr, mod, mod_info->ds, SR_SUB_EV_CHANGE,
-                    cur_priority, &cur_priority, &subscriber_count, &opts);
+            free(evpipes);
+            if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_CHANGE, cur_priority, &cur_priority, &evpipes, &subscriber_count, &opts))) {
+                goto cleanup;
+            }
         } while (subscriber_count);
 
         /* next module */
         sr_shm_clear(&shm_sub);
-        if (ext_shm_buf) {
+        if (shm_unlocked) {
             /* the unlocked callback was called, lock again */
-            free(ext_shm_buf);
-            ext_shm_buf = NULL;
-            ext_shm_addr = mod_info->conn->ext_shm.addr;
+            shm_unlocked = 0;
             /* SHM LOCK */
             err_info = sr_shmmain_lock_remap(mod_info->conn, SR_LOCK_READ, 0, __func__);
         }
@@ -959,10 +1070,10 @@ cleanup_wrunlock:
     sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_WRITE, __func__);
 cleanup:
     free(aux);
+    free(evpipes);
     free(diff_lyb);
     sr_shm_clear(&shm_sub);
-    if (ext_shm_buf) {
-        free(ext_shm_buf);
+    if (shm_unlocked) {
         /* SHM LOCK */
         err_info = sr_shmmain_lock_remap(mod_info->conn, SR_LOCK_READ, 0, __func__);
     }
@@ -975,9 +1086,10 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, sr_sid_t sid
     sr_error_info_t *err_info = NULL, *cb_err_info = NULL;
     sr_multi_sub_shm_t *multi_sub_shm;
     struct sr_mod_info_mod_s *mod = NULL;
-    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL;
+    uint32_t cur_priority, subscriber_count, diff_lyb_len, *aux = NULL, *evpipes = NULL;
     char *diff_lyb = NULL;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
+    int has_sub;
 
     while ((mod = sr_modinfo_next_mod(mod, mod_info, mod_info->diff, &aux))) {
         /* first check that there actually are some value changes (and not only dflt changes) */
@@ -985,8 +1097,11 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, sr_sid_t sid
             continue;
         }
 
-        if (!sr_shmsub_change_notify_has_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_DONE,
-                &cur_priority)) {
+        if ((err_info = sr_shmsub_change_notify_has_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_DONE,
+                &cur_priority, &has_sub))) {
+            goto cleanup;
+        }
+        if (!has_sub) {
             /* no subscriptions interested in this event */
             continue;
         }
@@ -1008,8 +1123,10 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, sr_sid_t sid
         multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
         /* correctly start the loop, with fake last priority 1 higher than the actual highest */
-        sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_DONE,
-                cur_priority + 1, &cur_priority, &subscriber_count, NULL);
+        if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_DONE,
+                cur_priority + 1, &cur_priority, &evpipes, &subscriber_count, NULL))) {
+            goto cleanup;
+        }
 
         do {
             /* SUB WRITE LOCK */
@@ -1031,8 +1148,8 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, sr_sid_t sid
                     subscriber_count, 0, diff_lyb, diff_lyb_len, mod->ly_mod->name);
 
             /* notify using event pipe and do not wait for subscribers */
-            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn->ext_shm.addr, mod, mod_info->ds,
-                    SR_SUB_EV_DONE, cur_priority))) {
+            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_DONE, cur_priority, evpipes, subscriber_count))) {
                 goto cleanup_wrunlock;
             }
 
@@ -1041,7 +1158,7 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, sr_sid_t sid
 
                 /* SUB WRITE UNLOCK */
                 if ((err_info = sr_shmsub_notify_finish_wrunlock((sr_sub_shm_t *)multi_sub_shm, sizeof *multi_sub_shm,
-                        SR_SUB_EV_NONE, timeout_ms, &cb_err_info))) {
+                        SR_SUB_EV_NONE, timeout_ms, &mod->shm_mod->stats.change[mod_info->ds], &cb_err_info))) {
                     goto cleanup;
                 }
 
@@ -1053,8 +1170,11 @@ sr_shmsub_change_notify_change_done(struct sr_mod_info_s *mod_info, sr_sid_t sid
             }
 
             /* find out what is the next priority and how many subscribers have it */
-            sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_DONE,
-                    cur_priority, &cur_priority, &subscriber_count, NULL);
+            free(evpipes);
+            if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_DONE,
+                    cur_priority, &cur_priority, &evpipes, &subscriber_count, NULL))) {
+                goto cleanup;
+            }
         } while (subscriber_count);
 
         sr_shm_clear(&shm_sub);
@@ -1068,6 +1188,7 @@ cleanup_wrunlock:
     sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_WRITE, __func__);
 cleanup:
     free(aux);
+    free(evpipes);
     free(diff_lyb);
     sr_shm_clear(&shm_sub);
     return err_info;
@@ -1081,9 +1202,10 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, sr_sid_t si
     struct lyd_node *abort_diff;
     struct sr_mod_info_mod_s *mod = NULL;
     uint32_t cur_priority, err_priority, subscriber_count, err_subscriber_count, diff_lyb_len, *aux = NULL;
+    uint32_t *evpipes = NULL, evpipe_count;
     char *diff_lyb = NULL;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
-    int last_subscr = 0;
+    int last_subscr = 0, has_sub;
 
     while ((mod = sr_modinfo_next_mod(mod, mod_info, mod_info->diff, &aux))) {
         /* first check that there actually are some value changes (and not only dflt changes) */
@@ -1097,8 +1219,11 @@ sr_shmsub_change_notify_change_abort(struct sr_mod_info_s *mod_info, sr_sid_t si
         }
         multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
-        if (!sr_shmsub_change_notify_has_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_ABORT,
-                &cur_priority)) {
+        if ((err_info = sr_shmsub_change_notify_has_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_ABORT,
+                &cur_priority, &has_sub))) {
+            goto cleanup;
+        }
+        if (!has_sub) {
             /* no subscriptions interested in this event, but we still want to clear the event */
 clear_shm:
             /* SUB WRITE LOCK */
@@ -1153,8 +1278,12 @@ clear_shm:
         }
 
         /* correctly start the loop, with fake last priority 1 higher than the actual highest */
-        sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_ABORT,
-                cur_priority + 1, &cur_priority, &subscriber_count, NULL);
+        free(evpipes);
+        if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds, SR_SUB_EV_ABORT,
+                cur_priority + 1, &cur_priority, &evpipes, &subscriber_count, NULL))) {
+            goto cleanup;
+        }
+        evpipe_count = subscriber_count;
         if (last_subscr && (err_priority == cur_priority)) {
             /* do not notify subscribers that did not process the previous event */
             subscriber_count -= err_subscriber_count;
@@ -1180,8 +1309,8 @@ clear_shm:
                     subscriber_count, 0, diff_lyb, diff_lyb_len, mod->ly_mod->name);
 
             /* notify using event pipe */
-            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn->ext_shm.addr, mod, mod_info->ds,
-                    SR_SUB_EV_ABORT, cur_priority))) {
+            if ((err_info = sr_shmsub_change_notify_evpipe(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_ABORT, cur_priority, evpipes, evpipe_count))) {
                 goto cleanup_wrunlock;
             }
 
@@ -1190,7 +1319,7 @@ clear_shm:
 
                 /* SUB WRITE UNLOCK */
                 if ((err_info = sr_shmsub_notify_finish_wrunlock((sr_sub_shm_t *)multi_sub_shm, sizeof *multi_sub_shm,
-                        SR_SUB_EV_NONE, timeout_ms, &cb_err_info))) {
+                        SR_SUB_EV_NONE, timeout_ms, &mod->shm_mod->stats.change[mod_info->ds], &cb_err_info))) {
                     goto cleanup;
                 }
 
@@ -1207,8 +1336,12 @@ clear_shm:
             }
 
             /* find out what is the next priority and how many subscribers have it */
-            sr_shmsub_change_notify_next_subscription(mod_info->conn->ext_shm.addr, mod, mod_info->ds, SR_SUB_EV_ABORT,
-                    cur_priority, &cur_priority, &subscriber_count, NULL);
+            free(evpipes);
+            if ((err_info = sr_shmsub_change_notify_next_subscription(mod_info->conn, mod, mod_info->ds,
+                    SR_SUB_EV_ABORT, cur_priority, &cur_priority, &evpipes, &subscriber_count, NULL))) {
+                goto cleanup;
+            }
+            evpipe_count = subscriber_count;
 
             if (last_subscr && (err_priority == cur_priority)) {
                 /* do not notify subscribers that did not process the previous event */
@@ -1228,6 +1361,7 @@ cleanup_wrunlock:
     sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_WRITE, __func__);
 cleanup:
     free(aux);
+    free(evpipes);
     free(diff_lyb);
     sr_shm_clear(&shm_sub);
     return err_info;
@@ -1235,8 +1369,8 @@ cleanup:
 
 sr_error_info_t *
 sr_shmsub_oper_notify(const struct lys_module *ly_mod, const char *xpath, const char *request_xpath,
-        const struct lyd_node *parent, sr_sid_t sid, uint32_t evpipe_num, uint32_t timeout_ms, struct lyd_node **data,
-        sr_error_info_t **cb_err_info)
+        const struct lyd_node *parent, sr_sid_t sid, uint32_t evpipe_num, uint32_t timeout_ms, sr_stats_event_t *stats,
+        struct lyd_node **data, sr_error_info_t **cb_err_info)
 {
     sr_error_info_t *err_info = NULL;
     char *parent_lyb = NULL;
@@ -1282,7 +1416,8 @@ sr_shmsub_oper_notify(const struct lys_module *ly_mod, const char *xpath, const
     }
 
     /* SUB WRITE UNLOCK */
-    if ((err_info = sr_shmsub_notify_finish_wrunlock(sub_shm, sizeof *sub_shm, SR_SUB_EV_ERROR, timeout_ms, cb_err_info))) {
+    if ((err_info = sr_shmsub_notify_finish_wrunlock(sub_shm, sizeof *sub_shm, SR_SUB_EV_ERROR, timeout_ms, stats,
+            cb_err_info))) {
         goto cleanup;
     }
 
@@ -1372,67 +1507,97 @@ sr_shmsub_rpc_is_valid(const struct lyd_node *input, const char *xpath)
 /**
  * @brief Learn whether there is a subscription for an RPC event.
  *
- * @param[in] ext_shm_addr Main SHM mapping address.
- * @param[in] shm_rpc SHM RPC structure of the event.
+ * @param[in] conn Connection to use.
+ * @param[in] op_path Path identifying the RPC/action.
  * @param[in] input Operation input.
  * @param[out] max_priority_p Highest priority among the valid subscribers.
- * @return 0 if not, non-zero if there is.
+ * @param[out] has_sub_p 0 if not, non-zero if there is.
+ * @return err_info, NULL on success.
  */
-static int
-sr_shmsub_rpc_notify_has_subscription(char *ext_shm_addr, sr_rpc_t *shm_rpc, const struct lyd_node *input,
-        uint32_t *max_priority_p)
+static sr_error_info_t *
+sr_shmsub_rpc_notify_has_subscription(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_node *input,
+        uint32_t *max_priority_p, int *has_sub_p)
 {
+    sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm;
+    sr_rpc_t *shm_rpc;
     sr_rpc_sub_t *shm_subs;
     uint32_t i;
-    int has_sub = 0;
 
+    main_shm = (sr_main_shm_t *)conn->main_shm.addr;
+
+    /* RPC SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    *has_sub_p = 0;
     *max_priority_p = 0;
+    shm_rpc = sr_shmmain_find_rpc(main_shm, conn->ext_shm.addr, op_path, 0);
     if (shm_rpc) {
         /* try to find a matching subscription */
-        shm_subs = (sr_rpc_sub_t *)(ext_shm_addr + shm_rpc->subs);
+        shm_subs = (sr_rpc_sub_t *)(conn->ext_shm.addr + shm_rpc->subs);
         for (i = 0; i < shm_rpc->sub_count; ++i) {
-            if (!sr_shmsub_rpc_is_valid(input, ext_shm_addr + shm_subs[i].xpath)) {
+            if (!sr_shmsub_rpc_is_valid(input, conn->ext_shm.addr + shm_subs[i].xpath)) {
                 continue;
             }
 
             /* valid subscription */
-            has_sub = 1;
+            *has_sub_p = 1;
             if (shm_subs[i].priority > *max_priority_p) {
                 *max_priority_p = shm_subs[i].priority;
             }
         }
     }
 
-    return has_sub;
+    /* RPC SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__);
+
+    return NULL;
 }
 
 /**
  * @brief Learn the priority of the next valid subscriber for an RPC event.
  *
- * @param[in] ext_shm_addr Main SHM mapping address.
- * @param[in] shm_rpc SHM RPC structure of the event.
+ * @param[in] conn Connection to use.
+ * @param[in] op_path Path identifying the RPC/action.
  * @param[in] input Operation input.
  * @param[in] last_priority Last priorty of a subscriber.
  * @param[out] next_priorty_p Next priorty of a subscriber(s).
  * @param[out] evpipes_p Array of evpipe numbers of all subscribers, needs to be freed.
  * @param[out] sub_count_p Number of subscribers with this priority.
  * @param[out] opts_p Optional options of all subscribers with this priority.
+ * @return err_info, NULL on success.
  */
-static void
-sr_shmsub_rpc_notify_next_subscription(char *ext_shm_addr, sr_rpc_t *shm_rpc, const struct lyd_node *input,
+static sr_error_info_t *
+sr_shmsub_rpc_notify_next_subscription(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_node *input,
         uint32_t last_priority, uint32_t *next_priority_p, uint32_t **evpipes_p, uint32_t *sub_count_p, int *opts_p)
 {
     sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm;
+    sr_rpc_t *shm_rpc;
     sr_rpc_sub_t *shm_subs;
     uint32_t i;
     int opts = 0;
 
-    shm_subs = (sr_rpc_sub_t *)(ext_shm_addr + shm_rpc->subs);
-
+    main_shm = (sr_main_shm_t *)conn->main_shm.addr;
     *evpipes_p = NULL;
     *sub_count_p = 0;
+
+    /* RPC SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__))) {
+        return err_info;
+    }
+
+    /* the RPC could have been removed in the meantime */
+    shm_rpc = sr_shmmain_find_rpc(main_shm, conn->ext_shm.addr, op_path, 0);
+    if (!shm_rpc) {
+        goto cleanup;
+    }
+
+    shm_subs = (sr_rpc_sub_t *)(conn->ext_shm.addr + shm_rpc->subs);
     for (i = 0; i < shm_rpc->sub_count; ++i) {
-        if (!sr_shmsub_rpc_is_valid(input, ext_shm_addr + shm_subs[i].xpath)) {
+        if (!sr_shmsub_rpc_is_valid(input, conn->ext_shm.addr + shm_subs[i].xpath)) {
             continue;
         }
 
@@ -1470,38 +1635,142 @@ sr_shmsub_rpc_notify_next_subscription(char *ext_shm_addr, sr_rpc_t *shm_rpc, co
     }
 
 cleanup:
+    /* RPC SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__);
+
     if (err_info) {
-        /* it was printed */
-        sr_errinfo_free(&err_info);
         *sub_count_p = 0;
     } else if (opts_p) {
         *opts_p = opts;
     }
+    return err_info;
+}
+
+/**
+ * @brief Collect all valid concurrent subscribers for an RPC event.
+ *
+ * @param[in] ext_shm_addr Main SHM mapping address.
+ * @param[in] shm_rpc SHM RPC structure of the event.
+ * @param[in] input Operation input.
+ * @param[out] sub_idx_p Array of indices of all the valid concurrent subscriptions, needs to be freed.
+ * @param[out] sub_count_p Number of valid concurrent subscriptions, 0 if the subscriptions are not concurrent.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_rpc_notify_concurrent_subscriptions(char *ext_shm_addr, sr_rpc_t *shm_rpc, const struct lyd_node *input,
+        uint32_t **sub_idx_p, uint32_t *sub_count_p)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_rpc_sub_t *shm_subs;
+    uint32_t i;
+
+    *sub_idx_p = NULL;
+    *sub_count_p = 0;
+
+    shm_subs = (sr_rpc_sub_t *)(ext_shm_addr + shm_rpc->subs);
+    if (!shm_rpc->sub_count || !(shm_subs[0].opts & SR_SUBSCR_CONCURRENT)) {
+        /* standard subscriptions, they are never mixed with concurrent ones */
+        return NULL;
+    }
+
+    *sub_idx_p = malloc(shm_rpc->sub_count * sizeof **sub_idx_p);
+    SR_CHECK_MEM_RET(!*sub_idx_p, err_info);
+
+    for (i = 0; i < shm_rpc->sub_count; ++i) {
+        if (sr_shmsub_rpc_is_valid(input, ext_shm_addr + shm_subs[i].xpath)) {
+            (*sub_idx_p)[*sub_count_p] = i;
+            ++(*sub_count_p);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Choose the concurrent subscriber to handle an RPC event and WRITE lock its sub SHM slot.
+ * An idle slot is preferred, if there is none, wait for one of them.
+ *
+ * @param[in] ext_shm_addr Main SHM mapping address.
+ * @param[in] shm_rpc SHM RPC structure of the event.
+ * @param[in] input Operation input.
+ * @param[in] op_path Path identifying the RPC/action.
+ * @param[in] sub_idx Array of indices of the valid concurrent subscriptions.
+ * @param[in] sub_count Count of \p sub_idx.
+ * @param[in] start Index in \p sub_idx to start with.
+ * @param[out] shm_sub Opened and locked sub SHM.
+ * @param[out] chosen_idx Index of the chosen subscription in SHM RPC subscriptions.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_shmsub_rpc_notify_slot_wrlock(char *ext_shm_addr, sr_rpc_t *shm_rpc, const struct lyd_node *input,
+        const char *op_path, uint32_t *sub_idx, uint32_t sub_count, uint32_t start, sr_shm_t *shm_sub,
+        uint32_t *chosen_idx)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_rpc_sub_t *shm_subs;
+    char suffix[SR_RPC_SUB_SUFFIX_LEN];
+    uint32_t i, j;
+
+    shm_subs = (sr_rpc_sub_t *)(ext_shm_addr + shm_rpc->subs);
+
+    for (i = 0; i < sub_count; ++i) {
+        j = sub_idx[(start + i) % sub_count];
+
+        /* open sub SHM of the slot and map it */
+        if ((err_info = sr_shmsub_open_map(lyd_node_module(input)->name, sr_path_sub_shm_rpc_suffix(shm_subs[j].slot,
+                suffix), sr_str_hash(op_path), shm_sub, sizeof(sr_multi_sub_shm_t)))) {
+            return err_info;
+        }
+
+        /* SUB WRITE LOCK, if idle */
+        if (sr_shmsub_notify_new_trywrlock((sr_sub_shm_t *)shm_sub->addr)) {
+            *chosen_idx = j;
+            return NULL;
+        }
+
+        sr_shm_clear(shm_sub);
+    }
+
+    /* all the slots are busy, wait on the first one */
+    j = sub_idx[start % sub_count];
+    if ((err_info = sr_shmsub_open_map(lyd_node_module(input)->name, sr_path_sub_shm_rpc_suffix(shm_subs[j].slot,
+            suffix), sr_str_hash(op_path), shm_sub, sizeof(sr_multi_sub_shm_t)))) {
+        return err_info;
+    }
+
+    /* SUB WRITE LOCK */
+    if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)shm_sub->addr, op_path, 0))) {
+        return err_info;
+    }
+
+    *chosen_idx = j;
+    return NULL;
 }
 
 sr_error_info_t *
 sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_node *input, sr_sid_t sid,
-        uint32_t timeout_ms, uint32_t *request_id, struct lyd_node **output, sr_error_info_t **cb_err_info)
+        uint32_t timeout_ms, uint32_t *request_id, uint32_t *slot, struct lyd_node **output, sr_error_info_t **cb_err_info)
 {
     sr_error_info_t *err_info = NULL;
+    sr_main_shm_t *main_shm;
     sr_rpc_t *shm_rpc;
-    char *input_lyb = NULL, *ext_shm_addr, *ext_shm_buf = NULL;
-    uint32_t i, input_lyb_len, cur_priority, subscriber_count, *evpipes = NULL;
-    int opts;
+    sr_rpc_sub_t *shm_subs;
+    char *input_lyb = NULL;
+    uint32_t i, input_lyb_len, cur_priority, subscriber_count, *evpipes = NULL, *sub_idx = NULL, sub_idx_count, idx;
+    int opts, has_sub, locked = 0, shm_unlocked = 0;
     sr_multi_sub_shm_t *multi_sub_shm;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
 
     assert(!input->parent);
     *output = NULL;
-
-    /* use our ext SHM mapping by default */
-    ext_shm_addr = conn->ext_shm.addr;
-
-    /* find the RPC */
-    shm_rpc = sr_shmmain_find_rpc((sr_main_shm_t *)conn->main_shm.addr, ext_shm_addr, op_path, 0);
+    *slot = 0;
+    main_shm = (sr_main_shm_t *)conn->main_shm.addr;
 
     /* just find out whether there are any subscriptions and if so, what is the highest priority */
-    if (!shm_rpc || !sr_shmsub_rpc_notify_has_subscription(ext_shm_addr, shm_rpc, input, &cur_priority)) {
+    if ((err_info = sr_shmsub_rpc_notify_has_subscription(conn, op_path, input, &cur_priority, &has_sub))) {
+        return err_info;
+    }
+    if (!has_sub) {
         sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, op_path, "There are no matching subscribers for RPC/action \"%s\".",
                 op_path);
         return err_info;
@@ -1514,34 +1783,84 @@ sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_
     }
     input_lyb_len = lyd_lyb_data_length(input_lyb);
 
-    /* open sub SHM and map it */
-    if ((err_info = sr_shmsub_open_map(lyd_node_module(input)->name, "rpc", sr_str_hash(op_path), &shm_sub, sizeof *multi_sub_shm))) {
+    /* RPC SUBS READ LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__))) {
         goto cleanup;
     }
-    multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
-    /* correctly start the loop, with fake last priority 1 higher than the actual highest */
-    sr_shmsub_rpc_notify_next_subscription(ext_shm_addr, shm_rpc, input, cur_priority + 1, &cur_priority,
-            &evpipes, &subscriber_count, &opts);
+    /* learn whether the event can be handled by any one of concurrent subscribers */
+    shm_rpc = sr_shmmain_find_rpc(main_shm, conn->ext_shm.addr, op_path, 0);
+    if (!shm_rpc) {
+        sub_idx_count = 0;
+    } else if ((err_info = sr_shmsub_rpc_notify_concurrent_subscriptions(conn->ext_shm.addr, shm_rpc, input, &sub_idx,
+            &sub_idx_count))) {
+        goto cleanup_rpc_unlock;
+    }
 
-    do {
-        if ((opts & SR_SUBSCR_UNLOCKED) && !ext_shm_buf) {
-            /* subscriber wants subscriptions (main/ext SHM) unlocked, so make a copy and unlock it */
-            ext_shm_buf = malloc(conn->ext_shm.size);
-            SR_CHECK_MEM_GOTO(!ext_shm_buf, err_info, cleanup);
-            memcpy(ext_shm_buf, conn->ext_shm.addr, conn->ext_shm.size);
+    if (sub_idx_count) {
+        /* choose the subscriber and lock its sub SHM slot, prefer an idle one */
+        if ((err_info = sr_shmsub_rpc_notify_slot_wrlock(conn->ext_shm.addr, shm_rpc, input, op_path, sub_idx,
+                sub_idx_count, sid.sr, &shm_sub, &idx))) {
+            goto cleanup_rpc_unlock;
+        }
+        locked = 1;
+        multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
+
+        /* only the chosen subscriber is notified */
+        shm_subs = (sr_rpc_sub_t *)(conn->ext_shm.addr + shm_rpc->subs);
+        evpipes = malloc(sizeof *evpipes);
+        if (!evpipes) {
+            SR_ERRINFO_MEM(&err_info);
+
+            /* SUB WRITE UNLOCK */
+            sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_WRITE, __func__);
+            goto cleanup_rpc_unlock;
+        }
+        evpipes[0] = shm_subs[idx].evpipe_num;
+        subscriber_count = 1;
+        cur_priority = shm_subs[idx].priority;
+        opts = shm_subs[idx].opts;
+        *slot = shm_subs[idx].slot;
+    }
 
-            /* update pointers */
-            ext_shm_addr = ext_shm_buf;
-            shm_rpc = sr_shmmain_find_rpc((sr_main_shm_t *)conn->main_shm.addr, ext_shm_addr, op_path, 0);
-            assert(shm_rpc);
+    /* RPC SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__);
+
+    if (!sub_idx_count) {
+        /* open sub SHM and map it */
+        if ((err_info = sr_shmsub_open_map(lyd_node_module(input)->name, "rpc", sr_str_hash(op_path), &shm_sub,
+                sizeof *multi_sub_shm))) {
+            goto cleanup;
+        }
+        multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
+
+        /* correctly start the loop, with fake last priority 1 higher than the actual highest */
+        if ((err_info = sr_shmsub_rpc_notify_next_subscription(conn, op_path, input, cur_priority + 1, &cur_priority,
+                &evpipes, &subscriber_count, &opts))) {
+            goto cleanup;
+        }
+        if (!subscriber_count) {
+            /* all the subscribers unsubscribed in the meantime */
+            sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, op_path, "There are no matching subscribers for RPC/action"
+                    " \"%s\".", op_path);
+            goto cleanup;
+        }
+    }
+
+    do {
+        if ((opts & SR_SUBSCR_UNLOCKED) && !shm_unlocked) {
+            /* subscriber wants main SHM unlocked, subscriptions are read only under their own locks */
+            shm_unlocked = 1;
 
             /* SHM UNLOCK */
             sr_shmmain_unlock(conn, SR_LOCK_READ, 0, __func__);
         }
 
-        /* SUB WRITE LOCK */
-        if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, op_path, 0))) {
+        if (locked) {
+            /* sub SHM slot was locked when it was chosen */
+            locked = 0;
+        } else if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, op_path, 0))) {
+            /* SUB WRITE LOCK */
             goto cleanup;
         }
 
@@ -1567,7 +1886,7 @@ sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_
 
         /* SUB WRITE UNLOCK */
         if ((err_info = sr_shmsub_notify_finish_wrunlock((sr_sub_shm_t *)multi_sub_shm, sizeof *multi_sub_shm,
-                SR_SUB_EV_ERROR, timeout_ms, cb_err_info))) {
+                SR_SUB_EV_ERROR, timeout_ms, &((sr_main_shm_t *)conn->main_shm.addr)->stats.rpc, cb_err_info))) {
             goto cleanup;
         }
 
@@ -1610,15 +1929,27 @@ sr_shmsub_rpc_notify(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_
         /* SUB READ UNLOCK */
         sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_READ, __func__);
 
+        if (*slot) {
+            /* the event was handled by the single chosen concurrent subscriber */
+            break;
+        }
+
         /* find out what is the next priority and how many subscribers have it */
         free(evpipes);
-        sr_shmsub_rpc_notify_next_subscription(ext_shm_addr, shm_rpc, input, cur_priority, &cur_priority,
-                &evpipes, &subscriber_count, &opts);
+        if ((err_info = sr_shmsub_rpc_notify_next_subscription(conn, op_path, input, cur_priority, &cur_priority,
+                &evpipes, &subscriber_count, &opts))) {
+            goto cleanup;
+        }
     } while (subscriber_count);
 
     /* success */
     goto cleanup;
 
+cleanup_rpc_unlock:
+    /* RPC SUBS READ UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_READ, __func__);
+    goto cleanup;
+
 cleanup_rdunlock:
     /* SUB READ UNLOCK */
     sr_rwunlock(&multi_sub_shm->lock, SR_LOCK_READ, __func__);
@@ -1631,8 +1962,8 @@ cleanup:
     sr_shm_clear(&shm_sub);
     free(input_lyb);
     free(evpipes);
-    if (ext_shm_buf) {
-        free(ext_shm_buf);
+    free(sub_idx);
+    if (shm_unlocked) {
         /* SHM LOCK */
         err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 0, __func__);
     }
@@ -1645,28 +1976,32 @@ cleanup:
 
 sr_error_info_t *
 sr_shmsub_rpc_notify_abort(sr_conn_ctx_t *conn, const char *op_path, const struct lyd_node *input, sr_sid_t sid,
-        uint32_t request_id)
+        uint32_t request_id, uint32_t slot)
 {
     sr_error_info_t *err_info = NULL;
-    sr_rpc_t *shm_rpc;
-    char *input_lyb = NULL;
+    char *input_lyb = NULL, suffix[SR_RPC_SUB_SUFFIX_LEN];
     uint32_t i, input_lyb_len, cur_priority, err_priority, subscriber_count, err_subscriber_count, *evpipes = NULL;
     sr_multi_sub_shm_t *multi_sub_shm;
     sr_shm_t shm_sub = SR_SHM_INITIALIZER;
-    int first_iter;
+    int first_iter, has_sub = 0;
 
     assert(request_id);
+    cur_priority = 0;
 
     /* open sub SHM and map it */
-    if ((err_info = sr_shmsub_open_map(lyd_node_module(input)->name, "rpc", sr_str_hash(op_path), &shm_sub, sizeof *multi_sub_shm))) {
+    if ((err_info = sr_shmsub_open_map(lyd_node_module(input)->name, sr_path_sub_shm_rpc_suffix(slot, suffix),
+            sr_str_hash(op_path), &shm_sub, sizeof *multi_sub_shm))) {
         goto cleanup;
     }
     multi_sub_shm = (sr_multi_sub_shm_t *)shm_sub.addr;
 
-    /* find the RPC */
-    shm_rpc = sr_shmmain_find_rpc((sr_main_shm_t *)conn->main_shm.addr, conn->ext_shm.addr, op_path, 0);
-    if (!shm_rpc || !sr_shmsub_rpc_notify_has_subscription(conn->ext_shm.addr, shm_rpc, input, &cur_priority)) {
-        /* no subscriptions interested in this event, but we still want to clear the event */
+    /* find out whether there are any subscriptions, the only concurrent subscriber was the failed one */
+    if (!slot && (err_info = sr_shmsub_rpc_notify_has_subscription(conn, op_path, input, &cur_priority, &has_sub))) {
+        goto cleanup;
+    }
+    if (!has_sub) {
+        /* no subscriptions interested in this event (the only concurrent subscriber has failed),
+         * but we still want to clear the event */
 clear_shm:
         /* SUB WRITE LOCK */
         if ((err_info = sr_shmsub_notify_new_wrlock((sr_sub_shm_t *)multi_sub_shm, op_path, SR_SUB_EV_ERROR))) {
@@ -1703,8 +2038,10 @@ clear_shm:
     do {
         free(evpipes);
         /* find the next subscription */
-        sr_shmsub_rpc_notify_next_subscription(conn->ext_shm.addr, shm_rpc, input, cur_priority, &cur_priority,
-                &evpipes, &subscriber_count, NULL);
+        if ((err_info = sr_shmsub_rpc_notify_next_subscription(conn, op_path, input, cur_priority, &cur_priority,
+                &evpipes, &subscriber_count, NULL))) {
+            goto cleanup;
+        }
         if (err_priority == cur_priority) {
             /* do not notify subscribers that did not process the previous event */
             subscriber_count -= err_subscriber_count;
@@ -2047,6 +2384,7 @@ sr_shmsub_change_listen_relock(sr_multi_sub_shm_t *multi_sub_shm, sr_lock_mode_t
         sr_error_info_t **err_info)
 {
     struct lyd_node *abort_diff;
+    struct timespec cb_start;
 
     assert(!*err_info);
 
@@ -2078,8 +2416,10 @@ sr_shmsub_change_listen_relock(sr_multi_sub_shm_t *multi_sub_shm, sr_lock_mode_t
                     module_name, sr_ev2str(SR_SUB_EV_ABORT), sub_info->request_id, sub_info->priority);
 
             /* call callback */
+            sr_stats_start(&cb_start);
             sub->cb(tmp_sess, module_name, sub->xpath, sr_ev2api(SR_SUB_EV_ABORT), sub_info->request_id,
                     sub->private_data);
+            sr_stats_sess_cb_add(sub->sess, &cb_start);
         }
 
         /* we have completely finished processing (with no error) */
@@ -2103,6 +2443,7 @@ sr_shmsub_change_listen_process_module_events(struct modsub_change_s *change_sub
     sr_multi_sub_shm_t *multi_sub_shm;
     sr_session_ctx_t tmp_sess;
     struct info_sub_s sub_info;
+    struct timespec cb_start;
 
     memset(&tmp_sess, 0, sizeof tmp_sess);
     multi_sub_shm = (sr_multi_sub_shm_t *)change_subs->sub_shm.addr;
@@ -2164,8 +2505,10 @@ process_event:
 
         /* call callback if there are some changes */
         if (sr_shmsub_change_listen_has_diff(change_sub, diff)) {
+            sr_stats_start(&cb_start);
             ret = change_sub->cb(&tmp_sess, change_subs->module_name, change_sub->xpath, sr_ev2api(sub_info.event),
                     sub_info.request_id, change_sub->private_data);
+            sr_stats_sess_cb_add(change_sub->sess, &cb_start);
         }
 
         /* SUB READ LOCK */
@@ -2363,6 +2706,7 @@ sr_shmsub_oper_listen_process_module_events(struct modsub_oper_s *oper_subs, sr_
     struct lyd_node *parent = NULL, *orig_parent, *node;
     sr_sub_shm_t *sub_shm;
     sr_session_ctx_t tmp_sess;
+    struct timespec cb_start;
 
     memset(&tmp_sess, 0, sizeof tmp_sess);
     tmp_sess.conn = conn;
@@ -2421,8 +2765,10 @@ sr_shmsub_oper_listen_process_module_events(struct modsub_oper_s *oper_subs, sr_
 
         /* call callback */
         orig_parent = parent;
+        sr_stats_start(&cb_start);
         err_code = oper_sub->cb(&tmp_sess, oper_subs->module_name, oper_sub->xpath, request_xpath[0] ? request_xpath : NULL,
                 request_id, &parent, oper_sub->private_data);
+        sr_stats_sess_cb_add(oper_sub->sess, &cb_start);
 
         /* go again to the top-level root for printing */
         if (parent) {
@@ -2534,6 +2880,7 @@ sr_shmsub_rpc_listen_call_callback(struct opsub_rpcsub_s *rpc_sub, sr_session_ct
     char buf[22], *val_str, *op_xpath = NULL;
     sr_val_t *input_vals = NULL, *output_vals = NULL;
     size_t i, input_val_count = 0, output_val_count = 0;
+    struct timespec cb_start;
 
     assert(input_op->schema->nodetype & (LYS_RPC | LYS_ACTION));
     assert((rpc_sub->tree_cb && !rpc_sub->cb) || (!rpc_sub->tree_cb && rpc_sub->cb));
@@ -2550,8 +2897,10 @@ sr_shmsub_rpc_listen_call_callback(struct opsub_rpcsub_s *rpc_sub, sr_session_ct
         }
 
         /* callback */
+        sr_stats_start(&cb_start);
         *err_code = rpc_sub->tree_cb(tmp_sess, rpc_sub->xpath, input_op, sr_ev2api(event), request_id, *output_op,
                 rpc_sub->private_data);
+        sr_stats_sess_cb_add(rpc_sub->sess, &cb_start);
         if (*err_code) {
             goto cleanup;
         }
@@ -2586,8 +2935,10 @@ sr_shmsub_rpc_listen_call_callback(struct opsub_rpcsub_s *rpc_sub, sr_session_ct
         /* callback */
         output_vals = NULL;
         output_val_count = 0;
+        sr_stats_start(&cb_start);
         *err_code = rpc_sub->cb(tmp_sess, op_xpath, input_vals, input_val_count, sr_ev2api(event), request_id,
                 &output_vals, &output_val_count, rpc_sub->private_data);
+        sr_stats_sess_cb_add(rpc_sub->sess, &cb_start);
         if (*err_code) {
             goto cleanup;
         }
@@ -2938,6 +3289,7 @@ sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs,
     time_t notif_ts;
     sr_multi_sub_shm_t *multi_sub_shm;
     sr_sid_t sid;
+    struct timespec cb_start;
 
     multi_sub_shm = (sr_multi_sub_shm_t *)notif_subs->sub_shm.addr;
 
@@ -3012,8 +3364,11 @@ sr_shmsub_notif_listen_process_module_events(struct modsub_notif_s *notif_subs,
             ly_set_free(set);
         }
 
-        if ((err_info = sr_notif_call_callback(conn, notif_subs->subs[i].cb, notif_subs->subs[i].tree_cb,
-                notif_subs->subs[i].private_data, SR_EV_NOTIF_REALTIME, notif_op, notif_ts, sid))) {
+        sr_stats_start(&cb_start);
+        err_info = sr_notif_call_callback(conn, notif_subs->subs[i].cb, notif_subs->subs[i].tree_cb,
+                notif_subs->subs[i].private_data, SR_EV_NOTIF_REALTIME, notif_op, notif_ts, sid);
+        sr_stats_sess_cb_add(notif_subs->subs[i].sess, &cb_start);
+        if (err_info) {
             goto cleanup;
         }
     }
@@ -3125,10 +3480,19 @@ sr_shmsub_notif_listen_module_stop_time(struct modsub_notif_s *notif_subs, sr_su
             shm_mod = sr_shmmain_find_module(&subs->conn->main_shm, subs->conn->ext_shm.addr, notif_subs->module_name, 0);
             SR_CHECK_INT_RET(!shm_mod, err_info);
 
-            /* remove the subscription from main SHM */
-            if (sr_shmmod_notif_subscription_del(subs->conn->ext_shm.addr, shm_mod, subs->evpipe_num, NULL)) {
+            /* MOD SUBS WRITE LOCK */
+            if ((tmp_err = sr_shmmain_sub_lock_remap(subs->conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
                 /* continue */
-                SR_ERRINFO_INT(&err_info);
+                sr_errinfo_merge(&err_info, tmp_err);
+            } else {
+                /* remove the subscription from main SHM */
+                if (sr_shmmod_notif_subscription_del(&subs->conn->ext_shm, shm_mod, subs->evpipe_num, NULL)) {
+                    /* continue */
+                    SR_ERRINFO_INT(&err_info);
+                }
+
+                /* MOD SUBS WRITE UNLOCK */
+                sr_shmmain_sub_unlock(subs->conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
             }
 
             if (notif_subs->sub_count == 1) {
@@ -3177,8 +3541,18 @@ sr_shmsub_notif_listen_module_replay(struct modsub_notif_s *notif_subs, sr_subsc
             shm_mod = sr_shmmain_find_module(&subs->conn->main_shm, subs->conn->ext_shm.addr, notif_subs->module_name, 0);
             SR_CHECK_INT_RET(!shm_mod, err_info);
 
+            /* MOD SUBS WRITE LOCK */
+            if ((err_info = sr_shmmain_sub_lock_remap(subs->conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+                return err_info;
+            }
+
             /* now we can add notification subscription into main SHM because it will process realtime notifications */
-            if ((err_info = sr_shmmod_notif_subscription_add(&subs->conn->ext_shm, shm_mod, subs->evpipe_num))) {
+            err_info = sr_shmmod_notif_subscription_add(&subs->conn->ext_shm, shm_mod, subs->evpipe_num);
+
+            /* MOD SUBS WRITE UNLOCK */
+            sr_shmmain_sub_unlock(subs->conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+            if (err_info) {
                 return err_info;
             }
 
@@ -3245,3 +3619,542 @@ error:
     pthread_detach(pthread_self());
     return NULL;
 }
+
+/**
+ * @brief Wake up the poller thread of a handler pool.
+ *
+ * @param[in] hpool Handler pool.
+ */
+static void
+sr_shmsub_hpool_wake(struct sr_hpool_s *hpool)
+{
+    char c = 0;
+
+    while ((write(hpool->wake_pipe[1], &c, 1) == -1) && (errno == EINTR)) {}
+}
+
+/**
+ * @brief Queue a subscription with new events into a worker queue, unless it is already queued or processed.
+ * Pool lock is expected to be held.
+ *
+ * @param[in] hpool Handler pool.
+ * @param[in] subs Subscription with new events.
+ */
+static void
+sr_shmsub_hpool_schedule(struct sr_hpool_s *hpool, sr_subscription_ctx_t *subs)
+{
+    struct sr_hpool_worker_s *worker;
+
+    switch (ATOMIC_LOAD_RELAXED(subs->hpool_state)) {
+    case SR_HPOOL_IDLE:
+        break;
+    case SR_HPOOL_RUNNING:
+        /* the worker processes the subscription once more when finished */
+        ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_RERUN);
+        return;
+    default:
+        /* new events will be processed */
+        return;
+    }
+
+    /* add into the queues in a round-robin manner, idle workers steal the work anyway */
+    worker = &hpool->workers[hpool->next_worker];
+    hpool->next_worker = (hpool->next_worker + 1) % hpool->worker_count;
+
+    /* QUEUE LOCK */
+    pthread_mutex_lock(&worker->lock);
+
+    ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_QUEUED);
+    subs->hpool_next = NULL;
+    if (worker->last) {
+        worker->last->hpool_next = subs;
+    } else {
+        worker->first = subs;
+    }
+    worker->last = subs;
+
+    /* QUEUE UNLOCK */
+    pthread_mutex_unlock(&worker->lock);
+
+    ATOMIC_INC_RELAXED(hpool->queued);
+    pthread_cond_signal(&hpool->cond);
+}
+
+/**
+ * @brief Remove a queued subscription from the worker queues. Pool lock is expected to be held.
+ *
+ * @param[in] hpool Handler pool.
+ * @param[in] subs Subscription to remove.
+ */
+static void
+sr_shmsub_hpool_unqueue(struct sr_hpool_s *hpool, sr_subscription_ctx_t *subs)
+{
+    struct sr_hpool_worker_s *worker;
+    sr_subscription_ctx_t *iter, *prev;
+    uint32_t i;
+
+    for (i = 0; i < hpool->worker_count; ++i) {
+        worker = &hpool->workers[i];
+
+        /* QUEUE LOCK */
+        pthread_mutex_lock(&worker->lock);
+
+        for (prev = NULL, iter = worker->first; iter && (iter != subs); prev = iter, iter = iter->hpool_next) {}
+        if (iter) {
+            if (prev) {
+                prev->hpool_next = iter->hpool_next;
+            } else {
+                worker->first = iter->hpool_next;
+            }
+            if (worker->last == iter) {
+                worker->last = prev;
+            }
+            ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_IDLE);
+            ATOMIC_DEC_RELAXED(hpool->queued);
+        }
+
+        /* QUEUE UNLOCK */
+        pthread_mutex_unlock(&worker->lock);
+
+        if (iter) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Take the first queued subscription from the worker queue or, if empty, steal one from the other workers.
+ *
+ * @param[in] hpool Handler pool.
+ * @param[in] idx Index of the worker.
+ * @return Subscription to process, NULL if there are none.
+ */
+static sr_subscription_ctx_t *
+sr_shmsub_hpool_pop(struct sr_hpool_s *hpool, uint32_t idx)
+{
+    struct sr_hpool_worker_s *worker;
+    sr_subscription_ctx_t *subs;
+    uint32_t i;
+
+    for (i = 0; i < hpool->worker_count; ++i) {
+        worker = &hpool->workers[(idx + i) % hpool->worker_count];
+
+        /* QUEUE LOCK */
+        pthread_mutex_lock(&worker->lock);
+
+        subs = worker->first;
+        if (subs) {
+            worker->first = subs->hpool_next;
+            if (!worker->first) {
+                worker->last = NULL;
+            }
+            ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_RUNNING);
+        }
+
+        /* QUEUE UNLOCK */
+        pthread_mutex_unlock(&worker->lock);
+
+        if (subs) {
+            ATOMIC_DEC_RELAXED(hpool->queued);
+            return subs;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Handler pool worker thread processing events of queued subscriptions.
+ *
+ * @param[in] arg Pointer to the worker structure.
+ * @return Always NULL.
+ */
+static void *
+sr_shmsub_hpool_worker_thread(void *arg)
+{
+    struct sr_hpool_worker_s *worker = (struct sr_hpool_worker_s *)arg;
+    struct sr_hpool_s *hpool = worker->hpool;
+    sr_subscription_ctx_t *subs;
+    time_t stop_time_in;
+    uint32_t idx = worker - hpool->workers;
+    int ret;
+
+    while (ATOMIC_LOAD_RELAXED(hpool->running)) {
+        if (!(subs = sr_shmsub_hpool_pop(hpool, idx))) {
+            /* POOL LOCK */
+            pthread_mutex_lock(&hpool->lock);
+
+            /* nothing to do, wait for new work */
+            while (ATOMIC_LOAD_RELAXED(hpool->running) && !ATOMIC_LOAD_RELAXED(hpool->queued)) {
+                pthread_cond_wait(&hpool->cond, &hpool->lock);
+            }
+
+            /* POOL UNLOCK */
+            pthread_mutex_unlock(&hpool->lock);
+            continue;
+        }
+
+        while (1) {
+            /* process the new events, errors are printed */
+            ret = sr_process_events(subs, NULL, &stop_time_in);
+            if (ret != SR_ERR_OK) {
+                stop_time_in = 0;
+            }
+
+            /* POOL LOCK */
+            pthread_mutex_lock(&hpool->lock);
+
+            subs->hpool_stop_time = stop_time_in ? time(NULL) + stop_time_in : 0;
+            if (ATOMIC_LOAD_RELAXED(subs->hpool_state) == SR_HPOOL_RUNNING) {
+                /* finished, no other events have arrived */
+                ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_IDLE);
+                pthread_cond_broadcast(&hpool->idle_cond);
+
+                /* POOL UNLOCK */
+                pthread_mutex_unlock(&hpool->lock);
+                break;
+            }
+
+            /* process the subscription again, the events must be processed in order */
+            ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_RUNNING);
+
+            /* POOL UNLOCK */
+            pthread_mutex_unlock(&hpool->lock);
+        }
+
+        if (stop_time_in) {
+            /* poller needs to learn the new stop time */
+            sr_shmsub_hpool_wake(hpool);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Handler pool poller thread waiting for events on all the subscriptions.
+ *
+ * @param[in] arg Pointer to the handler pool.
+ * @return Always NULL.
+ */
+static void *
+sr_shmsub_hpool_poll_thread(void *arg)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_hpool_s *hpool = (struct sr_hpool_s *)arg;
+    struct pollfd *pfds = NULL, *ptr;
+    sr_subscription_ctx_t **subs = NULL, **ptr2;
+    uint32_t i, sub_count, subs_change;
+    time_t stop_time, now;
+    char buf[64];
+    int timeout, ret;
+
+    while (ATOMIC_LOAD_RELAXED(hpool->running)) {
+        /* POOL LOCK */
+        pthread_mutex_lock(&hpool->lock);
+
+        /* collect the event pipes of all the subscriptions and the nearest stop time */
+        sub_count = hpool->sub_count;
+        subs_change = hpool->subs_change;
+        ptr = realloc(pfds, (sub_count + 1) * sizeof *pfds);
+        ptr2 = realloc(subs, (sub_count + 1) * sizeof *subs);
+        if (!ptr || !ptr2) {
+            pfds = ptr ? ptr : pfds;
+            subs = ptr2 ? ptr2 : subs;
+
+            /* POOL UNLOCK */
+            pthread_mutex_unlock(&hpool->lock);
+            SR_ERRINFO_MEM(&err_info);
+            break;
+        }
+        pfds = ptr;
+        subs = ptr2;
+
+        pfds[0].fd = hpool->wake_pipe[0];
+        pfds[0].events = POLLIN;
+        stop_time = 0;
+        for (i = 0; i < sub_count; ++i) {
+            subs[i] = hpool->subs[i];
+            pfds[i + 1].fd = subs[i]->evpipe;
+            pfds[i + 1].events = POLLIN;
+            if (subs[i]->hpool_stop_time && (!stop_time || (subs[i]->hpool_stop_time < stop_time))) {
+                stop_time = subs[i]->hpool_stop_time;
+            }
+        }
+
+        /* POOL UNLOCK */
+        pthread_mutex_unlock(&hpool->lock);
+
+        /* wait for an event or until the nearest stop time elapses */
+        timeout = -1;
+        if (stop_time) {
+            now = time(NULL);
+            timeout = (stop_time > now) ? (stop_time - now) * 1000 : 0;
+        }
+        ret = poll(pfds, sub_count + 1, timeout);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SR_ERRINFO_SYSERRNO(&err_info, "poll");
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            /* subscriptions or stop times have changed */
+            while (read(hpool->wake_pipe[0], buf, sizeof buf) == sizeof buf) {}
+        }
+
+        /* POOL LOCK */
+        pthread_mutex_lock(&hpool->lock);
+
+        if (subs_change == hpool->subs_change) {
+            now = time(NULL);
+            for (i = 0; i < sub_count; ++i) {
+                if (pfds[i + 1].revents & POLLIN) {
+                    /* read all the bytes so that the pipe is not ready until a new event is generated */
+                    while (read(subs[i]->evpipe, buf, sizeof buf) == sizeof buf) {}
+                } else if (!subs[i]->hpool_stop_time || (subs[i]->hpool_stop_time > now)) {
+                    continue;
+                }
+
+                subs[i]->hpool_stop_time = 0;
+                sr_shmsub_hpool_schedule(hpool, subs[i]);
+            }
+        } /* else some subscriptions may have been freed, the events are processed in the next iteration */
+
+        /* POOL UNLOCK */
+        pthread_mutex_unlock(&hpool->lock);
+    }
+
+    free(pfds);
+    free(subs);
+    if (err_info) {
+        sr_errinfo_new(&err_info, SR_ERR_INTERNAL, NULL, "Handler pool stopped processing events.");
+        sr_errinfo_free(&err_info);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Free a handler pool, its threads must not be running.
+ *
+ * @param[in] hpool Handler pool to free.
+ */
+static void
+sr_shmsub_hpool_free(struct sr_hpool_s *hpool)
+{
+    uint32_t i;
+
+    if (!hpool) {
+        return;
+    }
+
+    for (i = 0; i < hpool->worker_count; ++i) {
+        pthread_mutex_destroy(&hpool->workers[i].lock);
+    }
+    free(hpool->workers);
+    free(hpool->subs);
+    pthread_cond_destroy(&hpool->idle_cond);
+    pthread_cond_destroy(&hpool->cond);
+    pthread_mutex_destroy(&hpool->lock);
+    if (hpool->wake_pipe[0] > -1) {
+        close(hpool->wake_pipe[0]);
+        close(hpool->wake_pipe[1]);
+    }
+    free(hpool);
+}
+
+/**
+ * @brief Stop all the started threads of a handler pool.
+ *
+ * @param[in] hpool Handler pool.
+ * @param[in] worker_count Number of started worker threads.
+ * @param[in] poller Whether the poller thread was started.
+ */
+static void
+sr_shmsub_hpool_join(struct sr_hpool_s *hpool, uint32_t worker_count, int poller)
+{
+    uint32_t i;
+
+    ATOMIC_STORE_RELAXED(hpool->running, 0);
+
+    /* POOL LOCK */
+    pthread_mutex_lock(&hpool->lock);
+    pthread_cond_broadcast(&hpool->cond);
+    /* POOL UNLOCK */
+    pthread_mutex_unlock(&hpool->lock);
+
+    if (poller) {
+        sr_shmsub_hpool_wake(hpool);
+        pthread_join(hpool->poll_tid, NULL);
+    }
+    for (i = 0; i < worker_count; ++i) {
+        pthread_join(hpool->workers[i].tid, NULL);
+    }
+}
+
+sr_error_info_t *
+sr_shmsub_hpool_start(sr_conn_ctx_t *conn, uint32_t worker_count)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_hpool_s *hpool;
+    uint32_t i;
+    int ret;
+
+    assert(worker_count);
+
+    hpool = calloc(1, sizeof *hpool);
+    SR_CHECK_MEM_RET(!hpool, err_info);
+    hpool->conn = conn;
+    hpool->wake_pipe[0] = -1;
+    hpool->wake_pipe[1] = -1;
+
+    /* init */
+    if ((err_info = sr_mutex_init(&hpool->lock, 0))) {
+        free(hpool);
+        return err_info;
+    }
+    if ((ret = pthread_cond_init(&hpool->cond, NULL))) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Initializing pthread cond failed (%s).", strerror(ret));
+        pthread_mutex_destroy(&hpool->lock);
+        free(hpool);
+        return err_info;
+    }
+    if ((ret = pthread_cond_init(&hpool->idle_cond, NULL))) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Initializing pthread cond failed (%s).", strerror(ret));
+        pthread_cond_destroy(&hpool->cond);
+        pthread_mutex_destroy(&hpool->lock);
+        free(hpool);
+        return err_info;
+    }
+    if (pipe2(hpool->wake_pipe, O_NONBLOCK) == -1) {
+        hpool->wake_pipe[0] = -1;
+        SR_ERRINFO_SYSERRNO(&err_info, "pipe2");
+        sr_shmsub_hpool_free(hpool);
+        return err_info;
+    }
+
+    hpool->workers = calloc(worker_count, sizeof *hpool->workers);
+    if (!hpool->workers) {
+        SR_ERRINFO_MEM(&err_info);
+        sr_shmsub_hpool_free(hpool);
+        return err_info;
+    }
+    for (hpool->worker_count = 0; hpool->worker_count < worker_count; ++hpool->worker_count) {
+        hpool->workers[hpool->worker_count].hpool = hpool;
+        if ((err_info = sr_mutex_init(&hpool->workers[hpool->worker_count].lock, 0))) {
+            sr_shmsub_hpool_free(hpool);
+            return err_info;
+        }
+    }
+
+    /* start the threads */
+    ATOMIC_STORE_RELAXED(hpool->running, 1);
+    for (i = 0; i < worker_count; ++i) {
+        if ((ret = pthread_create(&hpool->workers[i].tid, NULL, sr_shmsub_hpool_worker_thread, &hpool->workers[i]))) {
+            sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Creating a new thread failed (%s).", strerror(ret));
+            sr_shmsub_hpool_join(hpool, i, 0);
+            sr_shmsub_hpool_free(hpool);
+            return err_info;
+        }
+    }
+    if ((ret = pthread_create(&hpool->poll_tid, NULL, sr_shmsub_hpool_poll_thread, hpool))) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Creating a new thread failed (%s).", strerror(ret));
+        sr_shmsub_hpool_join(hpool, worker_count, 0);
+        sr_shmsub_hpool_free(hpool);
+        return err_info;
+    }
+
+    conn->hpool = hpool;
+    return NULL;
+}
+
+void
+sr_shmsub_hpool_stop(sr_conn_ctx_t *conn)
+{
+    struct sr_hpool_s *hpool = conn->hpool;
+
+    if (!hpool) {
+        return;
+    }
+    assert(!hpool->sub_count);
+
+    sr_shmsub_hpool_join(hpool, hpool->worker_count, 1);
+    sr_shmsub_hpool_free(hpool);
+    conn->hpool = NULL;
+}
+
+sr_error_info_t *
+sr_shmsub_hpool_add(sr_subscription_ctx_t *subs)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_hpool_s *hpool = subs->conn->hpool;
+    sr_subscription_ctx_t **mem;
+
+    assert(hpool && !subs->hpool_member);
+
+    /* POOL LOCK */
+    pthread_mutex_lock(&hpool->lock);
+
+    mem = realloc(hpool->subs, (hpool->sub_count + 1) * sizeof *mem);
+    if (!mem) {
+        /* POOL UNLOCK */
+        pthread_mutex_unlock(&hpool->lock);
+        SR_ERRINFO_MEM(&err_info);
+        return err_info;
+    }
+    hpool->subs = mem;
+    hpool->subs[hpool->sub_count] = subs;
+    ++hpool->sub_count;
+    ++hpool->subs_change;
+
+    subs->hpool_member = 1;
+    ATOMIC_STORE_RELAXED(subs->hpool_state, SR_HPOOL_IDLE);
+    subs->hpool_stop_time = 0;
+
+    /* POOL UNLOCK */
+    pthread_mutex_unlock(&hpool->lock);
+
+    /* poll also on the new subscription */
+    sr_shmsub_hpool_wake(hpool);
+    return NULL;
+}
+
+void
+sr_shmsub_hpool_del(sr_subscription_ctx_t *subs)
+{
+    struct sr_hpool_s *hpool = subs->conn->hpool;
+    uint32_t i;
+
+    assert(hpool && subs->hpool_member);
+
+    /* POOL LOCK */
+    pthread_mutex_lock(&hpool->lock);
+
+    /* remove it so it is not queued anymore */
+    for (i = 0; (i < hpool->sub_count) && (hpool->subs[i] != subs); ++i) {}
+    assert(i < hpool->sub_count);
+    if (i < hpool->sub_count - 1) {
+        hpool->subs[i] = hpool->subs[hpool->sub_count - 1];
+    }
+    --hpool->sub_count;
+    ++hpool->subs_change;
+    subs->hpool_member = 0;
+
+    if (ATOMIC_LOAD_RELAXED(subs->hpool_state) == SR_HPOOL_QUEUED) {
+        /* no need to process it anymore */
+        sr_shmsub_hpool_unqueue(hpool, subs);
+    }
+
+    /* wait for the worker processing it, if any */
+    while (ATOMIC_LOAD_RELAXED(subs->hpool_state) != SR_HPOOL_IDLE) {
+        pthread_cond_wait(&hpool->idle_cond, &hpool->lock);
+    }
+
+    /* POOL UNLOCK */
+    pthread_mutex_unlock(&hpool->lock);
+
+    /* stop polling on the subscription */
+    sr_shmsub_hpool_wake(hpool);
+}
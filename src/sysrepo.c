@@ -34,12 +34,37 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <poll.h>
 
 #include <libyang/libyang.h>
 
 static sr_error_info_t *sr_session_notif_buf_stop(sr_session_ctx_t *session);
 static sr_error_info_t *_sr_session_stop(sr_session_ctx_t *session);
 static sr_error_info_t *_sr_unsubscribe(sr_subscription_ctx_t *subscription);
+static sr_error_info_t *sr_async_pool_init(sr_conn_ctx_t *conn);
+static void sr_async_pool_stop(sr_conn_ctx_t *conn);
+static void sr_async_pool_free(sr_conn_ctx_t *conn);
+
+/**
+ * @brief Close and remove the connection file of a connection.
+ *
+ * @param[in] conn Connection whose file to remove.
+ */
+static void
+sr_conn_file_del(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    char *path;
+
+    /* remove the file first so that it no longer exists once its close is noticed */
+    if ((err_info = sr_path_conn_file(getpid(), conn, &path))) {
+        sr_errinfo_free(&err_info);
+    } else {
+        unlink(path);
+        free(path);
+    }
+    close(conn->alive_fd);
+}
 
 /**
  * @brief Allocate a new connection structure.
@@ -53,6 +78,8 @@ sr_conn_new(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
 {
     sr_conn_ctx_t *conn;
     sr_error_info_t *err_info = NULL;
+    char *path;
+    mode_t um;
 
     conn = calloc(1, sizeof *conn);
     SR_CHECK_MEM_RET(!conn, err_info);
@@ -62,6 +89,7 @@ sr_conn_new(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
     }
 
     conn->opts = opts;
+    conn->oper_parallel_limit = 1;
 
     if ((err_info = sr_mutex_init(&conn->ptr_lock, 0))) {
         goto error2;
@@ -75,16 +103,54 @@ sr_conn_new(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
         goto error4;
     }
 
+    if ((err_info = sr_mutex_init(&conn->ext_grow_lock, 0))) {
+        goto error5;
+    }
+
     conn->main_shm.fd = -1;
     conn->ext_shm.fd = -1;
 
     if ((conn->opts & SR_CONN_CACHE_RUNNING) && (err_info = sr_rwlock_init(&conn->mod_cache.lock, 0))) {
-        goto error5;
+        goto error6;
+    }
+
+    if ((err_info = sr_rwlock_init(&conn->yanglib_cache.lock, 0))) {
+        goto error7;
+    }
+
+    if ((err_info = sr_async_pool_init(conn))) {
+        goto error8;
     }
 
+    /* create and keep open our connection file, it gets closed when the connection or the process terminates */
+    if ((err_info = sr_path_conn_file(getpid(), conn, &path))) {
+        goto error9;
+    }
+    um = umask(00000);
+    conn->alive_fd = open(path, O_RDONLY | O_CREAT | O_CLOEXEC, SR_FILE_PERM);
+    umask(um);
+    free(path);
+    if (conn->alive_fd == -1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "open");
+        goto error9;
+    }
+
+    /* use the process-wide watch of connection files being closed */
+    sr_shmmain_alive_ntf_acquire();
+
     *conn_p = conn;
     return NULL;
 
+error9:
+    sr_async_pool_free(conn);
+error8:
+    sr_rwlock_destroy(&conn->yanglib_cache.lock);
+error7:
+    if (conn->opts & SR_CONN_CACHE_RUNNING) {
+        sr_rwlock_destroy(&conn->mod_cache.lock);
+    }
+error6:
+    pthread_mutex_destroy(&conn->ext_grow_lock);
 error5:
     sr_rwlock_destroy(&conn->ext_remap_lock);
 error4:
@@ -107,12 +173,20 @@ static void
 sr_conn_free(sr_conn_ctx_t *conn)
 {
     if (conn) {
+        /* stop the handler pool, there are no subscriptions anymore */
+        sr_shmsub_hpool_stop(conn);
+
+        /* free the stopped asynchronous request pool */
+        sr_async_pool_free(conn);
+
         /* free cache before context */
         if (conn->opts & SR_CONN_CACHE_RUNNING) {
             sr_rwlock_destroy(&conn->mod_cache.lock);
             lyd_free_withsiblings(conn->mod_cache.data);
             free(conn->mod_cache.mods);
         }
+        sr_rwlock_destroy(&conn->yanglib_cache.lock);
+        lyd_free_withsiblings(conn->yanglib_cache.data);
 
         ly_ctx_destroy(conn->ly_ctx, NULL);
         pthread_mutex_destroy(&conn->ptr_lock);
@@ -120,8 +194,14 @@ sr_conn_free(sr_conn_ctx_t *conn)
             close(conn->main_create_lock);
         }
         sr_rwlock_destroy(&conn->ext_remap_lock);
+        pthread_mutex_destroy(&conn->ext_grow_lock);
+        sr_shmmain_ext_prev_clear(conn);
         sr_shm_clear(&conn->main_shm);
         sr_shm_clear(&conn->ext_shm);
+        free(conn->ly_mods);
+
+        sr_conn_file_del(conn);
+        sr_shmmain_alive_ntf_release();
 
         free(conn);
     }
@@ -288,11 +368,14 @@ sr_connect(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
         main_shm->mod_count = 0;
 
         /* clear ext SHM (there can be no connections and no modules) */
-        if ((err_info = sr_shm_remap(&conn->ext_shm, sizeof(size_t)))) {
+        if ((err_info = sr_shm_remap(&conn->ext_shm, sizeof(sr_ext_shm_t)))) {
+            goto cleanup_unlock;
+        }
+        /* no wasted mem and no free blocks */
+        memset(conn->ext_shm.addr, 0, sizeof(sr_ext_shm_t));
+        if ((err_info = sr_mutex_init_robust(&((sr_ext_shm_t *)conn->ext_shm.addr)->lock))) {
             goto cleanup_unlock;
         }
-        /* set wasted mem to 0 */
-        *((size_t *)conn->ext_shm.addr) = 0;
 
         /* add all the modules in lydmods data into main SHM */
         if ((err_info = sr_shmmain_add(conn, sr_mods->child))) {
@@ -310,6 +393,11 @@ sr_connect(const sr_conn_options_t opts, sr_conn_ctx_t **conn_p)
         }
     }
 
+    /* index libyang modules of all SHM modules, they cannot change anymore */
+    if ((err_info = sr_shmmain_ly_mods_index(conn))) {
+        goto cleanup_unlock;
+    }
+
     /* remember connection count */
     main_shm = (sr_main_shm_t *)conn->main_shm.addr;
     conn_count = main_shm->conn_count;
@@ -383,6 +471,9 @@ sr_disconnect(sr_conn_ctx_t *conn)
         return sr_api_ret(NULL, NULL);
     }
 
+    /* perform all the queued asynchronous requests and stop the workers, they use sessions of this connection */
+    sr_async_pool_stop(conn);
+
     /* stop all session notification buffer threads, they use read lock so they need conn state in SHM */
     for (i = 0; i < conn->session_count; ++i) {
         tmp_err = sr_session_notif_buf_stop(conn->sessions[i]);
@@ -402,7 +493,8 @@ sr_disconnect(sr_conn_ctx_t *conn)
     }
 
     /* remove from state */
-    sr_shmmain_conn_del((sr_main_shm_t *)conn->main_shm.addr, conn->ext_shm.addr, conn, getpid());
+    sr_shmmain_conn_del((sr_main_shm_t *)conn->main_shm.addr, &conn->ext_shm, conn, getpid());
+    conn->shm_sub_locks = 0;
 
     if (!lock_err) {
         /* SHM UNLOCK */
@@ -506,6 +598,33 @@ sr_set_diff_check_callback(sr_conn_ctx_t *conn, sr_diff_check_cb callback)
     conn->diff_check_cb = callback;
 }
 
+API int
+sr_set_oper_parallel_limit(sr_conn_ctx_t *conn, uint32_t limit)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || !limit, NULL, err_info);
+
+    conn->oper_parallel_limit = limit;
+    return sr_api_ret(NULL, NULL);
+}
+
+API int
+sr_set_handler_pool(sr_conn_ctx_t *conn, uint32_t thread_count)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || !thread_count, NULL, err_info);
+
+    if (conn->hpool) {
+        sr_errinfo_new(&err_info, SR_ERR_EXISTS, NULL, "Handler pool of the connection has already been created.");
+        return sr_api_ret(NULL, err_info);
+    }
+
+    err_info = sr_shmsub_hpool_start(conn, thread_count);
+    return sr_api_ret(NULL, err_info);
+}
+
 API int
 sr_session_start(sr_conn_ctx_t *conn, const sr_datastore_t datastore, sr_session_ctx_t **session)
 {
@@ -548,6 +667,9 @@ sr_session_start(sr_conn_ctx_t *conn, const sr_datastore_t datastore, sr_session
     if ((err_info = sr_rwlock_init(&(*session)->notif_buf.lock, 0))) {
         goto error;
     }
+    if ((err_info = sr_mutex_init(&(*session)->cb_stats.lock, 0))) {
+        goto error;
+    }
 
     SR_LOG_INF("Session %u (user \"%s\") created.", (*session)->sid.sr, (*session)->sid.user);
 
@@ -629,6 +751,7 @@ _sr_session_stop(sr_session_ctx_t *session)
     sr_errinfo_free(&session->err_info);
     pthread_mutex_destroy(&session->ptr_lock);
     sr_rwlock_destroy(&session->notif_buf.lock);
+    pthread_mutex_destroy(&session->cb_stats.lock);
     free(session);
 
     return err_info;
@@ -650,8 +773,8 @@ sr_session_stop(sr_session_ctx_t *session)
     /* stop all subscriptions of this session */
     while (session->subscription_count) {
         if (!wr_lock) {
-            /* SHM LOCK (writing into subscriptions) */
-            lock_err = sr_shmmain_lock_remap(conn, SR_LOCK_WRITE, 1, __func__);
+            /* SHM LOCK (subscriptions are removed under their own locks) */
+            lock_err = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 0, __func__);
             sr_errinfo_merge(&err_info, lock_err);
 
             wr_lock = 1;
@@ -663,7 +786,7 @@ sr_session_stop(sr_session_ctx_t *session)
 
     /* SHM UNLOCK */
     if (wr_lock && !lock_err) {
-        sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+        sr_shmmain_unlock(conn, SR_LOCK_READ, 0, __func__);
     }
 
     /* no lock needed, we are just reading main SHM */
@@ -838,6 +961,29 @@ sr_session_get_connection(sr_session_ctx_t *session)
     return session->conn;
 }
 
+API int
+sr_session_get_cb_stats(sr_session_ctx_t *session, uint64_t *cb_count, uint64_t *cb_usec)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session, session, err_info);
+
+    /* STATS LOCK */
+    pthread_mutex_lock(&session->cb_stats.lock);
+
+    if (cb_count) {
+        *cb_count = session->cb_stats.count;
+    }
+    if (cb_usec) {
+        *cb_usec = session->cb_stats.usec;
+    }
+
+    /* STATS UNLOCK */
+    pthread_mutex_unlock(&session->cb_stats.lock);
+
+    return sr_api_ret(session, NULL);
+}
+
 API const char *
 sr_get_repo_path(void)
 {
@@ -976,100 +1122,141 @@ cleanup:
     return ly_mod;
 }
 
-API int
-sr_install_module(sr_conn_ctx_t *conn, const char *schema_path, const char *search_dirs, const char **features,
-        int feat_count)
+/**
+ * @brief Schedule installation of new modules, all parsed in a single temporary context. All the modules
+ * are checked first and then scheduled at once, modules already installed are skipped.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] schema_paths Array of paths to the new schemas.
+ * @param[in] mod_count Count of @p schema_paths.
+ * @param[in] search_dirs Optional search directories for import schemas.
+ * @param[in] features Array of enabled features for every module, may be NULL.
+ * @param[in] feat_counts Number of enabled features for every module.
+ * @return err_info, NULL on success, SR_ERR_EXISTS if all the modules are already installed.
+ */
+static sr_error_info_t *
+_sr_install_modules(sr_conn_ctx_t *conn, const char **schema_paths, uint32_t mod_count, const char *search_dirs,
+        const char ***features, const int *feat_counts)
 {
     sr_error_info_t *err_info = NULL;
     struct ly_ctx *tmp_ly_ctx = NULL;
-    const struct lys_module *ly_mod, *ly_iter, *ly_iter2;
+    const struct lys_module *ly_mod, *ly_iter, *ly_iter2, **ly_mods = NULL, **inst_mods = NULL;
+    const char ***new_features = NULL;
+    int *new_feat_counts = NULL;
     LYS_INFORMAT format;
     char *mod_name = NULL;
-    uint32_t i;
-
-    SR_CHECK_ARG_APIRET(!conn || !schema_path, NULL, err_info);
+    uint32_t i, idx, new_count = 0, inst_count = 0, skip_count;
+    int j;
 
     /* create new temporary context */
     if ((err_info = sr_ly_ctx_new(&tmp_ly_ctx))) {
-        return sr_api_ret(NULL, err_info);
+        return err_info;
     }
 
-    /* learn module name and format */
-    if ((err_info = sr_get_module_name_format(schema_path, &mod_name, &format))) {
-        goto cleanup;
-    }
+    ly_mods = malloc(mod_count * sizeof *ly_mods);
+    inst_mods = malloc(mod_count * sizeof *inst_mods);
+    new_features = malloc(mod_count * sizeof *new_features);
+    new_feat_counts = malloc(mod_count * sizeof *new_feat_counts);
+    SR_CHECK_MEM_GOTO(!ly_mods || !inst_mods || !new_features || !new_feat_counts, err_info, cleanup);
 
     /* LYDMODS LOCK (not accessing ext SHM) */
     if ((err_info = sr_mlock(&SR_SHM_LYDMODS_LOCK(conn), SR_MAIN_LOCK_TIMEOUT * 1000, __func__))) {
         goto cleanup;
     }
 
-    /* check whether the module is not already in the context */
-    ly_mod = ly_ctx_get_module(conn->ly_ctx, mod_name, NULL, 1);
-    if (ly_mod && ly_mod->implemented) {
-        /* it is currently in the context, try to parse it again to check revisions */
-        ly_mod = sr_parse_module(tmp_ly_ctx, schema_path, format, search_dirs);
-        if (!ly_mod) {
-            sr_errinfo_new_ly_first(&err_info, tmp_ly_ctx);
-            sr_errinfo_new(&err_info, SR_ERR_EXISTS, NULL, "Module \"%s\" is already in sysrepo.", mod_name);
+    for (i = 0; i < mod_count; ++i) {
+        /* learn module name and format */
+        free(mod_name);
+        if ((err_info = sr_get_module_name_format(schema_paths[i], &mod_name, &format))) {
             goto cleanup_unlock;
         }
 
-        /* same modules, so if it is scheduled for deletion, we can unschedule it */
-        err_info = sr_lydmods_unsched_del_module_with_imps(conn->ly_ctx, ly_mod);
-        if (err_info && (err_info->err_code == SR_ERR_NOT_FOUND)) {
-            sr_errinfo_free(&err_info);
-            sr_errinfo_new(&err_info, SR_ERR_EXISTS, NULL, "Module \"%s\" is already in sysrepo.", ly_mod->name);
-            goto cleanup_unlock;
-        }
-        goto cleanup_unlock;
-    }
+        /* check whether the module is not already in the context */
+        ly_mod = ly_ctx_get_module(conn->ly_ctx, mod_name, NULL, 1);
+        if (ly_mod && ly_mod->implemented) {
+            /* it is currently in the context, try to parse it again to check revisions */
+            ly_mod = sr_parse_module(tmp_ly_ctx, schema_paths[i], format, search_dirs);
+            if (!ly_mod) {
+                sr_errinfo_new_ly_first(&err_info, tmp_ly_ctx);
+                if (mod_count == 1) {
+                    sr_errinfo_new(&err_info, SR_ERR_EXISTS, NULL, "Module \"%s\" is already in sysrepo.", mod_name);
+                } else {
+                    /* not a module that can be skipped in a batch */
+                    sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "Module \"%s\" is already in sysrepo in"
+                            " a different revision.", mod_name);
+                }
+                goto cleanup_unlock;
+            }
 
-    /* parse the module */
-    if (!(ly_mod = sr_parse_module(tmp_ly_ctx, schema_path, format, search_dirs))) {
-        sr_errinfo_new_ly(&err_info, tmp_ly_ctx);
-        goto cleanup_unlock;
-    }
+            /* same modules, so if it is scheduled for deletion, we can unschedule it, once all are checked */
+            inst_mods[inst_count++] = ly_mod;
+            continue;
+        }
 
-    /* enable all features to check their existence */
-    for (i = 0; i < (unsigned)feat_count; ++i) {
-        if (lys_features_enable(ly_mod, features[i])) {
-            sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, NULL, "Module \"%s\" does not define feature \"%s\".",
-                    ly_mod->name, features[i]);
+        /* parse the module */
+        if (!(ly_mod = sr_parse_module(tmp_ly_ctx, schema_paths[i], format, search_dirs))) {
+            sr_errinfo_new_ly(&err_info, tmp_ly_ctx);
             goto cleanup_unlock;
         }
-    }
 
-    /* check that the module does not implement some other modules in different revisions than already in the context */
-    i = 0;
-    while ((ly_iter = ly_ctx_get_module_iter(tmp_ly_ctx, &i))) {
-        if (!ly_iter->implemented) {
-            continue;
+        /* enable all features to check their existence */
+        for (j = 0; j < feat_counts[i]; ++j) {
+            if (lys_features_enable(ly_mod, features[i][j])) {
+                sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, NULL, "Module \"%s\" does not define feature \"%s\".",
+                        ly_mod->name, features[i][j]);
+                goto cleanup_unlock;
+            }
         }
 
-        ly_iter2 = ly_ctx_get_module(conn->ly_ctx, ly_iter->name, NULL, 1);
-        if (!ly_iter2) {
-            continue;
-        }
+        /* check that the module does not implement some other modules in different revisions than already in the context */
+        idx = 0;
+        while ((ly_iter = ly_ctx_get_module_iter(tmp_ly_ctx, &idx))) {
+            if (!ly_iter->implemented) {
+                continue;
+            }
 
-        /* modules are implemented in both contexts, compare revisions */
-        if ((!ly_iter->rev_size && ly_iter2->rev_size) || (ly_iter->rev_size && !ly_iter2->rev_size)
-                || (ly_iter->rev_size && ly_iter2->rev_size && strcmp(ly_iter->rev[0].date, ly_iter2->rev[0].date))) {
-            sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "Module \"%s\" implements module \"%s@%s\" that is already"
-                    " in sysrepo in revision %s.", ly_mod->name, ly_iter->name,
-                    ly_iter->rev_size ? ly_iter->rev[0].date : "<none>", ly_iter2->rev_size ? ly_iter2->rev[0].date : "<none>");
-            goto cleanup_unlock;
+            ly_iter2 = ly_ctx_get_module(conn->ly_ctx, ly_iter->name, NULL, 1);
+            if (!ly_iter2) {
+                continue;
+            }
+
+            /* modules are implemented in both contexts, compare revisions */
+            if ((!ly_iter->rev_size && ly_iter2->rev_size) || (ly_iter->rev_size && !ly_iter2->rev_size)
+                    || (ly_iter->rev_size && ly_iter2->rev_size && strcmp(ly_iter->rev[0].date, ly_iter2->rev[0].date))) {
+                sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "Module \"%s\" implements module \"%s@%s\" that is"
+                        " already in sysrepo in revision %s.", ly_mod->name, ly_iter->name,
+                        ly_iter->rev_size ? ly_iter->rev[0].date : "<none>",
+                        ly_iter2->rev_size ? ly_iter2->rev[0].date : "<none>");
+                goto cleanup_unlock;
+            }
         }
+
+        ly_mods[new_count] = ly_mod;
+        new_features[new_count] = features[i];
+        new_feat_counts[new_count] = feat_counts[i];
+        ++new_count;
     }
 
-    /* schedule module installation */
-    if ((err_info = sr_lydmods_deferred_add_module(conn->ly_ctx, ly_mod, features, feat_count))) {
+    /* schedule installation of all the new modules and unschedule deletion of the installed ones at once */
+    if ((err_info = sr_lydmods_deferred_add_modules(conn->ly_ctx, ly_mods, new_count, new_features, new_feat_counts,
+            inst_mods, inst_count, &skip_count))) {
+        goto cleanup_unlock;
+    }
+    if (skip_count == mod_count) {
+        /* all the modules are already installed */
+        if (mod_count == 1) {
+            sr_errinfo_new(&err_info, SR_ERR_EXISTS, NULL, "Module \"%s\" is already in sysrepo.", inst_mods[0]->name);
+        } else {
+            sr_errinfo_new(&err_info, SR_ERR_EXISTS, NULL, "All the modules are already in sysrepo.");
+        }
         goto cleanup_unlock;
     }
 
     /* store new module imports */
-    if ((err_info = sr_create_module_imps_incs_r(ly_mod))) {
-        goto cleanup_unlock;
+    for (i = 0; i < new_count; ++i) {
+        if ((err_info = sr_create_module_imps_incs_r(ly_mods[i]))) {
+            goto cleanup_unlock;
+        }
     }
 
     /* success */
@@ -1081,6 +1268,54 @@ cleanup_unlock:
 cleanup:
     ly_ctx_destroy(tmp_ly_ctx, NULL);
     free(mod_name);
+    free(ly_mods);
+    free(inst_mods);
+    free(new_features);
+    free(new_feat_counts);
+    return err_info;
+}
+
+API int
+sr_install_module(sr_conn_ctx_t *conn, const char *schema_path, const char *search_dirs, const char **features,
+        int feat_count)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!conn || !schema_path, NULL, err_info);
+
+    err_info = _sr_install_modules(conn, &schema_path, 1, search_dirs, &features, &feat_count);
+    return sr_api_ret(NULL, err_info);
+}
+
+API int
+sr_install_modules(sr_conn_ctx_t *conn, const char **schema_paths, const char *search_dirs, const char ***features)
+{
+    sr_error_info_t *err_info = NULL;
+    const char ***mod_features = NULL;
+    int *feat_counts = NULL;
+    uint32_t i, mod_count;
+
+    SR_CHECK_ARG_APIRET(!conn || !schema_paths, NULL, err_info);
+
+    for (mod_count = 0; schema_paths[mod_count]; ++mod_count) {}
+    if (!mod_count) {
+        return sr_api_ret(NULL, NULL);
+    }
+
+    /* learn the feature counts */
+    mod_features = calloc(mod_count, sizeof *mod_features);
+    feat_counts = calloc(mod_count, sizeof *feat_counts);
+    SR_CHECK_MEM_GOTO(!mod_features || !feat_counts, err_info, cleanup);
+    for (i = 0; features && (i < mod_count); ++i) {
+        mod_features[i] = features[i];
+        for (feat_counts[i] = 0; features[i] && features[i][feat_counts[i]]; ++feat_counts[i]) {}
+    }
+
+    err_info = _sr_install_modules(conn, schema_paths, mod_count, search_dirs, mod_features, feat_counts);
+
+cleanup:
+    free(mod_features);
+    free(feat_counts);
     return sr_api_ret(NULL, err_info);
 }
 
@@ -1417,6 +1652,20 @@ sr_set_module_access(sr_conn_ctx_t *conn, const char *module_name, const char *o
         goto cleanup_unlock;
     }
 
+    /* get running diff SHM file path */
+    if ((err_info = sr_path_running_diff_shm(module_name, 1, &path))) {
+        goto cleanup_unlock;
+    }
+
+    /* update running diff file permissions and owner, if it exists */
+    if (sr_file_exists(path)) {
+        err_info = sr_chmodown(path, owner, group, perm);
+    }
+    free(path);
+    if (err_info) {
+        goto cleanup_unlock;
+    }
+
     /* get operational SHM file path */
     if ((err_info = sr_path_ds_shm(module_name, SR_DS_OPERATIONAL, 1, &path))) {
         goto cleanup_unlock;
@@ -1577,6 +1826,18 @@ sr_get_module_info(sr_conn_ctx_t *conn, struct lyd_node **sysrepo_data)
     return sr_api_ret(NULL, err_info);
 }
 
+/**
+ * @brief Learn whether there are any session changes that will be applied on the data it reads.
+ *
+ * @param[in] session Session to examine.
+ * @return 0 if there are no changes, non-zero if there are some.
+ */
+static int
+sr_session_has_changes(sr_session_ctx_t *session)
+{
+    return session->dt[session->ds].edit || session->dt[session->ds].diff;
+}
+
 API int
 sr_get_item(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr_val_t **value)
 {
@@ -1613,9 +1874,9 @@ sr_get_item(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms, sr
         goto cleanup_mods_unlock;
     }
 
-    /* load modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 1, &session->sid, path, timeout_ms, 0, &cb_err_info))
-            || cb_err_info) {
+    /* load modules data snapshot, modules get unlocked */
+    if ((err_info = sr_modinfo_data_load_snapshot(&mod_info, &session->sid, path, 0, !sr_session_has_changes(session),
+            timeout_ms, 0, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -1700,9 +1961,9 @@ sr_get_items(sr_session_ctx_t *session, const char *xpath, uint32_t timeout_ms,
         goto cleanup_mods_unlock;
     }
 
-    /* load modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 1, &session->sid, xpath, timeout_ms, opts, &cb_err_info))
-            || cb_err_info) {
+    /* load modules data snapshot, modules get unlocked */
+    if ((err_info = sr_modinfo_data_load_snapshot(&mod_info, &session->sid, xpath, 0, !sr_session_has_changes(session),
+            timeout_ms, opts, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -1783,9 +2044,9 @@ sr_get_subtree(sr_session_ctx_t *session, const char *path, uint32_t timeout_ms,
         goto cleanup_mods_unlock;
     }
 
-    /* load modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 1, &session->sid, path, timeout_ms, 0, &cb_err_info))
-            || cb_err_info) {
+    /* load modules data snapshot, modules get unlocked */
+    if ((err_info = sr_modinfo_data_load_snapshot(&mod_info, &session->sid, path, 0, !sr_session_has_changes(session),
+            timeout_ms, 0, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -1869,9 +2130,9 @@ sr_get_data(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, ui
         goto cleanup_mods_unlock;
     }
 
-    /* load modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 1, &session->sid, xpath, timeout_ms, opts, &cb_err_info))
-            || cb_err_info) {
+    /* load modules data snapshot, modules get unlocked */
+    if ((err_info = sr_modinfo_data_load_snapshot(&mod_info, &session->sid, xpath, max_depth,
+            !sr_session_has_changes(session), timeout_ms, opts, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -2075,11 +2336,49 @@ sr_move_item(sr_session_ctx_t *session, const char *path, const sr_move_position
     return sr_api_ret(session, err_info);
 }
 
+/**
+ * @brief Store an edit in the session, it is spent.
+ *
+ * @param[in] session Session to use.
+ * @param[in] edit Edit to store, is always spent.
+ * @param[in] default_operation Default operation for nodes without an operation.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_edit_batch_store(sr_session_ctx_t *session, struct lyd_node *edit, const char *default_operation)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *node;
+
+    if (session->dt[session->ds].edit) {
+        /* do not allow merging NETCONF edits into sysrepo ones, it can cause some unexpected results */
+        sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "There are already some session changes.");
+        goto error;
+    }
+
+    /* add default operation and default origin */
+    LY_TREE_FOR(edit, node) {
+        if (!sr_edit_find_oper(node, 0, NULL) && (err_info = sr_edit_set_oper(node, default_operation))) {
+            goto error;
+        }
+        if ((session->ds == SR_DS_OPERATIONAL) && (err_info = sr_edit_diff_set_origin(node, SR_OPER_ORIGIN, 0))) {
+            goto error;
+        }
+    }
+
+    session->dt[session->ds].edit = edit;
+    return NULL;
+
+error:
+    lyd_free_withsiblings(edit);
+    return err_info;
+}
+
 API int
 sr_edit_batch(sr_session_ctx_t *session, const struct lyd_node *edit, const char *default_operation)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *dup_edit = NULL, *node;
+    struct lyd_node *dup_edit;
 
     SR_CHECK_ARG_APIRET(!session || !edit || !default_operation, session, err_info);
     SR_CHECK_ARG_APIRET(strcmp(default_operation, "merge") && strcmp(default_operation, "replace")
@@ -2089,7 +2388,6 @@ sr_edit_batch(sr_session_ctx_t *session, const struct lyd_node *edit, const char
         sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, NULL, "Data trees must be created using the session connection libyang context.");
         return sr_api_ret(session, err_info);
     } else if (session->dt[session->ds].edit) {
-        /* do not allow merging NETCONF edits into sysrepo ones, it can cause some unexpected results */
         sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "There are already some session changes.");
         return sr_api_ret(session, err_info);
     }
@@ -2097,24 +2395,48 @@ sr_edit_batch(sr_session_ctx_t *session, const struct lyd_node *edit, const char
     dup_edit = lyd_dup_withsiblings(edit, LYD_DUP_OPT_RECURSIVE);
     if (!dup_edit) {
         sr_errinfo_new_ly(&err_info, session->conn->ly_ctx);
-        goto error;
+        return sr_api_ret(session, err_info);
     }
 
-    /* add default operation and default origin */
-    LY_TREE_FOR(dup_edit, node) {
-        if (!sr_edit_find_oper(node, 0, NULL) && (err_info = sr_edit_set_oper(node, default_operation))) {
-            goto error;
-        }
-        if ((session->ds == SR_DS_OPERATIONAL) && (err_info = sr_edit_diff_set_origin(node, SR_OPER_ORIGIN, 0))) {
-            goto error;
-        }
+    err_info = sr_edit_batch_store(session, dup_edit, default_operation);
+    return sr_api_ret(session, err_info);
+}
+
+API int
+sr_edit_batch_data(sr_session_ctx_t *session, const char *data, const char *data_path, LYD_FORMAT format,
+        const char *default_operation)
+{
+    sr_error_info_t *err_info = NULL;
+    struct lyd_node *edit;
+
+    SR_CHECK_ARG_APIRET(!session || (data && data_path) || (!data && !data_path) || !format || !default_operation,
+            session, err_info);
+    SR_CHECK_ARG_APIRET(strcmp(default_operation, "merge") && strcmp(default_operation, "replace")
+            && strcmp(default_operation, "none"), session, err_info);
+
+    if (session->dt[session->ds].edit) {
+        sr_errinfo_new(&err_info, SR_ERR_UNSUPPORTED, NULL, "There are already some session changes.");
+        return sr_api_ret(session, err_info);
     }
 
-    session->dt[session->ds].edit = dup_edit;
-    return sr_api_ret(session, NULL);
+    /* parse the edit directly in the connection context, no duplication needed */
+    ly_errno = 0;
+    if (data_path) {
+        edit = lyd_parse_path(session->conn->ly_ctx, data_path, format, LYD_OPT_EDIT | LYD_OPT_STRICT);
+    } else {
+        edit = lyd_parse_mem(session->conn->ly_ctx, data, format, LYD_OPT_EDIT | LYD_OPT_STRICT);
+    }
+    if (ly_errno) {
+        sr_errinfo_new_ly(&err_info, session->conn->ly_ctx);
+        return sr_api_ret(session, err_info);
+    }
 
-error:
-    lyd_free_withsiblings(dup_edit);
+    if (!edit) {
+        /* empty edit, nothing to do */
+        return sr_api_ret(session, NULL);
+    }
+
+    err_info = sr_edit_batch_store(session, edit, default_operation);
     return sr_api_ret(session, err_info);
 }
 
@@ -2190,8 +2512,8 @@ sr_validate(sr_session_ctx_t *session, const char *module_name, uint32_t timeout
     }
 
     /* load all modules data (we need dependencies for validation) */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 0, &session->sid, NULL, timeout_ms, 0,
-            &cb_err_info)) || cb_err_info) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 0, &session->sid, NULL, 0, 0, timeout_ms,
+            0, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -2242,7 +2564,9 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
 {
     sr_error_info_t *err_info = NULL;
     struct lyd_node *update_edit = NULL, *old_diff = NULL, *new_diff = NULL;
+    sr_main_shm_t *main_shm = (sr_main_shm_t *)session->conn->main_shm.addr;
     sr_session_ctx_t tmp_sess;
+    struct timespec start;
     int ret;
 
     memset(&tmp_sess, 0, sizeof tmp_sess);
@@ -2269,6 +2593,7 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* validate new data trees */
+    sr_stats_start(&start);
     switch (session->ds) {
     case SR_DS_STARTUP:
     case SR_DS_RUNNING:
@@ -2284,6 +2609,7 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
         }
         break;
     }
+    sr_stats_hist_add(&main_shm->stats.commit[SR_STATS_COMMIT_VALIDATE], &start);
 
     /* check write perm (we must wait until after validation, some additional modules can be modified) */
     if ((err_info = sr_modinfo_perm_check(mod_info, 1, 1))) {
@@ -2296,9 +2622,11 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* publish current diff in an "update" event for the subscribers to update it */
+    sr_stats_start(&start);
     if ((err_info = sr_shmsub_change_notify_update(mod_info, session->sid, timeout_ms, &update_edit, cb_err_info))) {
         goto cleanup;
     }
+    sr_stats_hist_add(&main_shm->stats.commit[SR_STATS_COMMIT_UPDATE], &start);
     if (*cb_err_info) {
         /* "update" event failed, just clear the sub SHM and finish */
         err_info = sr_shmsub_change_notify_clear(mod_info, SR_SUB_EV_UPDATE);
@@ -2317,6 +2645,7 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
         }
 
         /* validate updated data trees and finish new diff */
+        sr_stats_start(&start);
         switch (session->ds) {
         case SR_DS_STARTUP:
         case SR_DS_RUNNING:
@@ -2331,6 +2660,7 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
             }
             break;
         }
+        sr_stats_hist_add(&main_shm->stats.commit[SR_STATS_COMMIT_VALIDATE], &start);
 
         /* put the old diff back */
         new_diff = mod_info->diff;
@@ -2349,9 +2679,11 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* publish final diff in a "change" event for any subscribers and wait for them */
+    sr_stats_start(&start);
     if ((err_info = sr_shmsub_change_notify_change(mod_info, session->sid, timeout_ms, cb_err_info))) {
         goto cleanup;
     }
+    sr_stats_hist_add(&main_shm->stats.commit[SR_STATS_COMMIT_CHANGE], &start);
     if (*cb_err_info) {
         /* "change" event failed, publish "abort" event and finish */
         err_info = sr_shmsub_change_notify_change_abort(mod_info, session->sid, wait ? timeout_ms : 0);
@@ -2364,9 +2696,11 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* store updated datastore */
+    sr_stats_start(&start);
     if ((err_info = sr_modinfo_data_store(mod_info))) {
         goto cleanup;
     }
+    sr_stats_hist_add(&main_shm->stats.commit[SR_STATS_COMMIT_STORE], &start);
 
     /* MODULES READ LOCK (downgrade) */
     if ((err_info = sr_shmmod_modinfo_wrlock_downgrade(mod_info, session->sid))) {
@@ -2374,9 +2708,11 @@ sr_changes_notify_store(struct sr_mod_info_s *mod_info, sr_session_ctx_t *sessio
     }
 
     /* publish "done" event, all changes were applied */
+    sr_stats_start(&start);
     if ((err_info = sr_shmsub_change_notify_change_done(mod_info, session->sid, wait ? timeout_ms : 0))) {
         goto cleanup;
     }
+    sr_stats_hist_add(&main_shm->stats.commit[SR_STATS_COMMIT_DONE], &start);
 
     /* generate netconf-config-change notification */
     if ((err_info = sr_modinfo_generate_config_change_notif(mod_info, session))) {
@@ -2435,7 +2771,7 @@ sr_apply_changes(sr_session_ctx_t *session, uint32_t timeout_ms, int wait)
     }
 
     /* load all modules data (we need dependencies for validation) */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 0, NULL, NULL, 0, get_opts, NULL))) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 0, NULL, NULL, 0, 0, 0, get_opts, NULL))) {
         goto cleanup_mods_unlock;
     }
 
@@ -2533,7 +2869,7 @@ _sr_replace_config(sr_session_ctx_t *session, const struct lys_module *ly_mod, s
     }
 
     /* load all current modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 0, NULL, NULL, 0, 0, NULL))) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 0, NULL, NULL, 0, 0, 0, 0, NULL))) {
         goto cleanup_mods_unlock;
     }
 
@@ -2608,22 +2944,49 @@ cleanup_shm_unlock:
 }
 
 API int
-sr_copy_config(sr_session_ctx_t *session, const char *module_name, sr_datastore_t src_datastore, uint32_t timeout_ms,
-        int wait)
+sr_replace_config_data(sr_session_ctx_t *session, const char *module_name, const char *data, const char *data_path,
+        LYD_FORMAT format, uint32_t timeout_ms, int wait)
 {
     sr_error_info_t *err_info = NULL;
-    struct sr_mod_info_s mod_info;
-    const struct lys_module *ly_mod = NULL;
+    struct lyd_node *src_config;
 
-    SR_CHECK_ARG_APIRET(!session || !SR_IS_CONVENTIONAL_DS(src_datastore) || !SR_IS_CONVENTIONAL_DS(session->ds),
-            session, err_info);
+    SR_CHECK_ARG_APIRET(!session || !SR_IS_CONVENTIONAL_DS(session->ds) || (data && data_path) || (!data && !data_path)
+            || !format, session, err_info);
 
-    if (src_datastore == session->ds) {
-        /* nothing to do */
-        return sr_api_ret(session, NULL);
+    /* parse the data directly in the connection context, they are validated when replacing */
+    ly_errno = 0;
+    if (data_path) {
+        src_config = lyd_parse_path(session->conn->ly_ctx, data_path, format,
+                LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_TRUSTED);
+    } else {
+        src_config = lyd_parse_mem(session->conn->ly_ctx, data, format, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_TRUSTED);
     }
-
-    if (!timeout_ms) {
+    if (ly_errno) {
+        sr_errinfo_new_ly(&err_info, session->conn->ly_ctx);
+        return sr_api_ret(session, err_info);
+    }
+
+    /* spends src_config */
+    return sr_replace_config(session, module_name, src_config, timeout_ms, wait);
+}
+
+API int
+sr_copy_config(sr_session_ctx_t *session, const char *module_name, sr_datastore_t src_datastore, uint32_t timeout_ms,
+        int wait)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_mod_info_s mod_info;
+    const struct lys_module *ly_mod = NULL;
+
+    SR_CHECK_ARG_APIRET(!session || !SR_IS_CONVENTIONAL_DS(src_datastore) || !SR_IS_CONVENTIONAL_DS(session->ds),
+            session, err_info);
+
+    if (src_datastore == session->ds) {
+        /* nothing to do */
+        return sr_api_ret(session, NULL);
+    }
+
+    if (!timeout_ms) {
         timeout_ms = SR_CHANGE_CB_TIMEOUT;
     }
     SR_MODINFO_INIT(mod_info, session->conn, src_datastore, src_datastore);
@@ -2664,7 +3027,7 @@ sr_copy_config(sr_session_ctx_t *session, const char *module_name, sr_datastore_
     }
 
     /* get their data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 0, NULL, NULL, 0, 0, NULL))) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 0, NULL, NULL, 0, 0, 0, 0, NULL))) {
         goto cleanup_modules_unlock;
     }
 
@@ -2982,8 +3345,8 @@ sr_process_events_notif_replay_stop(sr_subscription_ctx_t *subscription)
     uint32_t i;
     int mod_finished;
 
-    /* SHM LOCK (writing into subscriptions) */
-    if ((err_info = sr_shmmain_lock_remap(subscription->conn, SR_LOCK_WRITE, 1, __func__))) {
+    /* SHM LOCK (replays may add subscriptions into ext SHM) */
+    if ((err_info = sr_shmmain_lock_remap(subscription->conn, SR_LOCK_READ, 1, __func__))) {
         return err_info;
     }
 
@@ -3021,7 +3384,7 @@ cleanup_subs_unlock:
 
 cleanup_unlock:
     /* SHM UNLOCK */
-    sr_shmmain_unlock(subscription->conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(subscription->conn, SR_LOCK_READ, 1, __func__);
     return err_info;
 }
 
@@ -3142,6 +3505,9 @@ _sr_unsubscribe(sr_subscription_ctx_t *subscription)
                 sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Joining the subscriber thread failed (%s).", strerror(ret));
             }
         }
+    } else if (subscription->hpool_member) {
+        /* stop handling it in the handler pool */
+        sr_shmsub_hpool_del(subscription);
     }
 
     /* delete all subscriptions (also removes this subscription from all the sessions) */
@@ -3184,125 +3550,189 @@ sr_unsubscribe(sr_subscription_ctx_t *subscription)
 
     conn = subscription->conn;
 
-    /* SHM LOCK (writing into subscriptions) */
-    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_WRITE, 1, __func__))) {
+    /* SHM LOCK (subscriptions are removed under their own locks) */
+    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 0, __func__))) {
         return sr_api_ret(NULL, err_info);
     }
 
     err_info = _sr_unsubscribe(subscription);
 
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 0, __func__);
 
     return sr_api_ret(NULL, err_info);
 }
 
 /**
- * @brief Perform enabled event on a subscription.
+ * @brief Call a module change subscription callback with an event on its enabled data.
  *
- * @param[in] session Session to use.
- * @param[in] ly_mod Specific module.
- * @param[in] xpath Optional subscription xpath.
- * @param[in] callback Callback to call.
- * @param[in] private_data Arbitrary callback data.
- * @return err_info, NULL on success.
+ * @param[in] conn Connection to use.
+ * @param[in] ly_mod Subscription module.
+ * @param[in] subscr Subscription.
+ * @param[in] diff Enabled data diff.
+ * @param[in] ev Event to call the callback with.
+ * @return err_info if the callback failed an ::SR_SUB_EV_ENABLED event, NULL otherwise.
  */
 static sr_error_info_t *
-sr_module_change_subscribe_running_enable(sr_session_ctx_t *session, const struct lys_module *ly_mod, const char *xpath,
-        sr_module_change_cb callback, void *private_data, int opts)
+sr_module_change_subscribe_running_event(sr_conn_ctx_t *conn, const struct lys_module *ly_mod,
+        const sr_module_change_subscr_t *subscr, struct lyd_node *diff, sr_sub_event_t ev)
 {
     sr_error_info_t *err_info = NULL;
-    struct lyd_node *enabled_data = NULL, *node;
-    struct sr_mod_info_s mod_info;
     sr_session_ctx_t tmp_sess;
     sr_error_t err_code;
 
-    SR_MODINFO_INIT(mod_info, session->conn, SR_DS_RUNNING, SR_DS_RUNNING);
     memset(&tmp_sess, 0, sizeof tmp_sess);
+    tmp_sess.conn = conn;
+    tmp_sess.ds = SR_DS_RUNNING;
+    tmp_sess.dt[tmp_sess.ds].diff = diff;
+    tmp_sess.ev = ev;
+
+    SR_LOG_INF("Triggering \"%s\" \"%s\" event on enabled data.", ly_mod->name, sr_ev2str(ev));
+    err_code = subscr->callback(&tmp_sess, ly_mod->name, subscr->xpath, sr_ev2api(ev), 0, subscr->private_data);
+    if ((ev == SR_SUB_EV_ENABLED) && (err_code != SR_ERR_OK)) {
+        sr_errinfo_new(&err_info, SR_ERR_CALLBACK_FAILED, NULL, "Subscribing to \"%s\" changes failed.", ly_mod->name);
+        if (tmp_sess.err_info && (tmp_sess.err_info->err_code == SR_ERR_OK)) {
+            /* remember callback error info, it has no error code of its own */
+            sr_errinfo_merge(&err_info, tmp_sess.err_info);
+            tmp_sess.err_info = NULL;
+            err_info->err_code = SR_ERR_CALLBACK_FAILED;
+        }
+    }
 
-    /* create mod_info structure with this module only */
-    if ((err_info = sr_shmmod_modinfo_collect_modules(&mod_info, ly_mod, 0))) {
-        return err_info;
+    sr_errinfo_free(&tmp_sess.err_info);
+    return err_info;
+}
+
+/**
+ * @brief Perform enabled event on subscriptions. Current running data of all the modules are loaded only once.
+ * If a callback fails, the subscriptions that were already successfully enabled get an "abort" event.
+ *
+ * @param[in] session Session to use.
+ * @param[in] ly_mods Specific modules of each subscription.
+ * @param[in] subscrs Subscriptions to perform the event on.
+ * @param[in] subscr_count Count of @p subscrs.
+ * @param[in] opts Subscription options.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_module_change_subscribe_running_enable(sr_session_ctx_t *session, const struct lys_module **ly_mods,
+        const sr_module_change_subscr_t *subscrs, uint32_t subscr_count, int opts)
+{
+    sr_error_info_t *err_info = NULL, *tmp_err;
+    struct lyd_node **enabled_data, *node, *dup, *abort_diff;
+    struct sr_mod_info_s mod_info;
+    const char *xpath;
+    uint32_t i, j;
+
+    SR_MODINFO_INIT(mod_info, session->conn, SR_DS_RUNNING, SR_DS_RUNNING);
+
+    enabled_data = calloc(subscr_count, sizeof *enabled_data);
+    SR_CHECK_MEM_RET(!enabled_data, err_info);
+
+    /* create mod_info structure with all the subscribed modules */
+    for (i = 0; i < subscr_count; ++i) {
+        if ((err_info = sr_shmmod_modinfo_collect_modules(&mod_info, ly_mods[i], 0))) {
+            goto cleanup_modinfo;
+        }
     }
 
     /* MODULES READ LOCK */
     if ((err_info = sr_shmmod_modinfo_rdlock(&mod_info, 0, session->sid))) {
-        sr_modinfo_free(&mod_info);
-        return err_info;
+        goto cleanup_modinfo;
     }
 
     /* get the current running datastore data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 1, NULL, NULL, 0, 0, NULL))) {
-        goto error_mods_unlock;
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_REQ, 1, NULL, NULL, 0, 0, 0, 0, NULL))) {
+        goto cleanup_mods_unlock;
     }
 
-    /* select only the subscribed-to subtree */
-    if (mod_info.data) {
-        if (xpath) {
-            if ((err_info = sr_lyd_xpath_dup(mod_info.data, (char **)&xpath, 1, ly_mod, &enabled_data))) {
-                goto error_mods_unlock;
+    /* select only the subscribed-to subtrees */
+    for (i = 0; mod_info.data && (i < subscr_count); ++i) {
+        if (subscrs[i].xpath) {
+            xpath = subscrs[i].xpath;
+            if ((err_info = sr_lyd_xpath_dup(mod_info.data, (char **)&xpath, 1, ly_mods[i], &enabled_data[i]))) {
+                goto cleanup_mods_unlock;
             }
         } else {
-            if (!(enabled_data = lyd_dup_withsiblings(mod_info.data, LYD_DUP_OPT_RECURSIVE))) {
-                sr_errinfo_new_ly(&err_info, session->conn->ly_ctx);
-                goto error_mods_unlock;
+            LY_TREE_FOR(mod_info.data, node) {
+                if (lyd_node_module(node) != ly_mods[i]) {
+                    continue;
+                }
+
+                dup = lyd_dup(node, LYD_DUP_OPT_RECURSIVE);
+                if (!dup || (enabled_data[i] && lyd_insert_sibling(&enabled_data[i], dup))) {
+                    lyd_free(dup);
+                    sr_errinfo_new_ly(&err_info, session->conn->ly_ctx);
+                    goto cleanup_mods_unlock;
+                }
+                if (!enabled_data[i]) {
+                    enabled_data[i] = dup;
+                }
             }
         }
     }
 
+cleanup_mods_unlock:
     /* MODULES UNLOCK */
     sr_shmmod_modinfo_unlock(&mod_info, 0);
 
+cleanup_modinfo:
     sr_modinfo_free(&mod_info);
+    if (err_info) {
+        goto cleanup;
+    }
 
-    /* these data will be presented as newly created, make such a diff */
-    LY_TREE_FOR(enabled_data, node) {
-        /* top-level "create" operation that is inherited */
-        if ((err_info = sr_edit_set_oper(node, "create"))) {
-            goto cleanup;
-        }
+    for (i = 0; i < subscr_count; ++i) {
+        /* these data will be presented as newly created, make such a diff */
+        LY_TREE_FOR(enabled_data[i], node) {
+            /* top-level "create" operation that is inherited */
+            if ((err_info = sr_edit_set_oper(node, "create"))) {
+                goto cleanup;
+            }
 
-        /* user-ordered lists need information about position */
-        if ((err_info = sr_edit_created_subtree_apply_move(node))) {
-            goto cleanup;
+            /* user-ordered lists need information about position */
+            if ((err_info = sr_edit_created_subtree_apply_move(node))) {
+                goto cleanup;
+            }
         }
     }
 
-    tmp_sess.conn = session->conn;
-    tmp_sess.ds = SR_DS_RUNNING;
-    tmp_sess.dt[tmp_sess.ds].diff = enabled_data;
-
     if (!(opts & SR_SUBSCR_DONE_ONLY)) {
-        tmp_sess.ev = SR_SUB_EV_ENABLED;
-        SR_LOG_INF("Triggering \"%s\" \"%s\" event on enabled data.", ly_mod->name, sr_ev2str(tmp_sess.ev));
-
         /* present all changes in an "enabled" event */
-        err_code = callback(&tmp_sess, ly_mod->name, xpath, sr_ev2api(tmp_sess.ev), 0, private_data);
-        if (err_code != SR_ERR_OK) {
-            /* callback failed but it is the only one so no "abort" event is necessary */
-            sr_errinfo_new(&err_info, SR_ERR_CALLBACK_FAILED, NULL, "Subscribing to \"%s\" changes failed.", ly_mod->name);
-            if (tmp_sess.err_info && (tmp_sess.err_info->err_code == SR_ERR_OK)) {
-                /* remember callback error info */
-                sr_errinfo_merge(&err_info, tmp_sess.err_info);
+        for (i = 0; i < subscr_count; ++i) {
+            if ((err_info = sr_module_change_subscribe_running_event(session->conn, ly_mods[i], &subscrs[i],
+                    enabled_data[i], SR_SUB_EV_ENABLED))) {
+                break;
+            }
+        }
+
+        if (err_info) {
+            /* none of the subscriptions will be added, those that already applied their data must revert them */
+            for (j = 0; j < i; ++j) {
+                abort_diff = NULL;
+                if (enabled_data[j] && (tmp_err = sr_diff_reverse(enabled_data[j], &abort_diff))) {
+                    sr_errinfo_merge(&err_info, tmp_err);
+                    continue;
+                }
+                sr_module_change_subscribe_running_event(session->conn, ly_mods[j], &subscrs[j], abort_diff,
+                        SR_SUB_EV_ABORT);
+                lyd_free_withsiblings(abort_diff);
             }
             goto cleanup;
         }
     }
 
     /* finish with a "done" event just because this event should imitate a regular change */
-    tmp_sess.ev = SR_SUB_EV_DONE;
-    SR_LOG_INF("Triggering \"%s\" \"%s\" event on enabled data.", ly_mod->name, sr_ev2str(tmp_sess.ev));
-    callback(&tmp_sess, ly_mod->name, xpath, sr_ev2api(tmp_sess.ev), 0, private_data);
+    for (i = 0; i < subscr_count; ++i) {
+        sr_module_change_subscribe_running_event(session->conn, ly_mods[i], &subscrs[i], enabled_data[i],
+                SR_SUB_EV_DONE);
+    }
 
 cleanup:
-    lyd_free_withsiblings(enabled_data);
-    return NULL;
-
-error_mods_unlock:
-    /* MODULES UNLOCK */
-    sr_shmmod_modinfo_unlock(&mod_info, 0);
-
-    sr_modinfo_free(&mod_info);
+    for (i = 0; i < subscr_count; ++i) {
+        lyd_free_withsiblings(enabled_data[i]);
+    }
+    free(enabled_data);
     return err_info;
 }
 
@@ -3367,7 +3797,12 @@ sr_subs_new(sr_conn_ctx_t *conn, sr_subscr_options_t opts, sr_subscription_ctx_t
         goto error;
     }
 
-    if (!(opts & SR_SUBSCR_NO_THREAD)) {
+    if (!(opts & SR_SUBSCR_NO_THREAD) && conn->hpool) {
+        /* events will be processed by the connection handler pool */
+        if ((err_info = sr_shmsub_hpool_add(*subs_p))) {
+            goto error;
+        }
+    } else if (!(opts & SR_SUBSCR_NO_THREAD)) {
         /* set thread_running to non-zero so that thread does not immediately quit */
         ATOMIC_STORE_RELAXED((*subs_p)->thread_running, 1);
 
@@ -3396,8 +3831,9 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
         sr_module_change_cb callback, void *private_data, uint32_t priority, sr_subscr_options_t opts,
         sr_subscription_ctx_t **subscription)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_error_info_t *err_info = NULL, *tmp_err;
     const struct lys_module *ly_mod;
+    sr_module_change_subscr_t subscr;
     sr_conn_ctx_t *conn;
     sr_subscr_options_t sub_opts;
     sr_mod_change_sub_t *shm_sub;
@@ -3430,14 +3866,24 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
 
     /* call the callback with the current running configuration so that it is properly applied */
     if ((session->ds == SR_DS_RUNNING) && (opts & SR_SUBSCR_ENABLED)) {
+        subscr.module_name = module_name;
+        subscr.xpath = xpath;
+        subscr.callback = callback;
+        subscr.private_data = private_data;
+        subscr.priority = priority;
+
         /* do not hold write lock here, would block callback from calling API functions (we are only reading running data anyway) */
-        if ((err_info = sr_module_change_subscribe_running_enable(session, ly_mod, xpath, callback, private_data, opts))) {
+        err_info = sr_module_change_subscribe_running_enable(session, &ly_mod, &subscr, 1, opts);
+        if (err_info && (err_info->err_code == SR_ERR_CALLBACK_FAILED)) {
+            /* the callback failed, it is only logged and the subscription is created anyway */
+            sr_errinfo_free(&err_info);
+        } else if (err_info) {
             return sr_api_ret(session, err_info);
         }
     }
 
-    /* SHM LOCK (writing into subscriptions) */
-    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_WRITE, 1, __func__))) {
+    /* SHM LOCK (subscriptions are added into ext SHM under their own locks) */
+    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 1, __func__))) {
         return sr_api_ret(session, err_info);
     }
 
@@ -3445,6 +3891,18 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
     shm_mod = sr_shmmain_find_module(&conn->main_shm, conn->ext_shm.addr, module_name, 0);
     SR_CHECK_INT_GOTO(!shm_mod, err_info, error_unlock);
 
+    if (!(opts & SR_SUBSCR_CTX_REUSE)) {
+        /* create a new subscription */
+        if ((err_info = sr_subs_new(conn, opts, subscription))) {
+            goto error_unlock;
+        }
+    }
+
+    /* MOD SUBS WRITE LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+        goto error_unlock_unsub;
+    }
+
     if (opts & SR_SUBSCR_UPDATE) {
         /* check that there is not already an update subscription with the same priority */
         shm_sub = (sr_mod_change_sub_t *)(conn->ext_shm.addr + shm_mod->change_sub[session->ds].subs);
@@ -3452,24 +3910,20 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
             if ((shm_sub[i].opts & SR_SUBSCR_UPDATE) && (shm_sub[i].priority == priority)) {
                 sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, NULL, "There already is an \"update\" subscription on"
                         " module \"%s\" with priority %u for %s DS.", module_name, priority, sr_ds2str(session->ds));
-                goto error_unlock;
+                goto error_sub_unlock;
             }
         }
     }
 
-    if (!(opts & SR_SUBSCR_CTX_REUSE)) {
-        /* create a new subscription */
-        if ((err_info = sr_subs_new(conn, opts, subscription))) {
-            goto error_unlock;
-        }
-    }
-
     /* add module subscription into main SHM */
     if ((err_info = sr_shmmod_change_subscription_add(&conn->ext_shm, shm_mod, xpath, session->ds, priority, sub_opts,
             (*subscription)->evpipe_num))) {
-        goto error_unlock_unsub;
+        goto error_sub_unlock;
     }
 
+    /* MOD SUBS WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
     /* add subscription into structure and create separate specific SHM segment */
     if ((err_info = sr_sub_change_add(session, module_name, xpath, callback, private_data, priority, sub_opts,
             *subscription))) {
@@ -3483,26 +3937,268 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, c
     }
 
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
 
     return sr_api_ret(session, NULL);
 
 error_unlock_unsub_unmod:
-    sr_shmmod_change_subscription_del(conn->ext_shm.addr, shm_mod, xpath, session->ds, priority, sub_opts,
-            (*subscription)->evpipe_num, 0, NULL);
+    /* MOD SUBS WRITE LOCK */
+    if ((tmp_err = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+        sr_errinfo_merge(&err_info, tmp_err);
+    } else {
+        sr_shmmod_change_subscription_del(&conn->ext_shm, shm_mod, xpath, session->ds, priority, sub_opts,
+                (*subscription)->evpipe_num, 0, NULL);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+    }
 
-error_unlock_unsub:
     if (opts & SR_SUBSCR_CTX_REUSE) {
         sr_sub_change_del(module_name, xpath, session->ds, callback, private_data, priority, sub_opts, *subscription);
-    } else {
+    }
+    goto error_unlock_unsub;
+
+error_sub_unlock:
+    /* MOD SUBS WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+error_unlock_unsub:
+    if (!(opts & SR_SUBSCR_CTX_REUSE)) {
         _sr_unsubscribe(*subscription);
         *subscription = NULL;
     }
 
 error_unlock:
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
+
+    return sr_api_ret(session, err_info);
+}
+
+/**
+ * @brief Remove subscriptions of a batch that were already added.
+ *
+ * @param[in] session Session of the subscriptions.
+ * @param[in] subscrs Subscriptions of the batch.
+ * @param[in] order Indices of subscriptions in @p subscrs in the order they were added.
+ * @param[in] shm_count Number of subscriptions from @p order added into main SHM.
+ * @param[in] subs_count Number of subscriptions from @p order added into @p subscription.
+ * @param[in] sub_opts Subscription options.
+ * @param[in] subscription Subscription structure.
+ */
+static void
+sr_module_change_subscribe_batch_revert(sr_session_ctx_t *session, const sr_module_change_subscr_t *subscrs,
+        const uint32_t *order, uint32_t shm_count, uint32_t subs_count, sr_subscr_options_t sub_opts,
+        sr_subscription_ctx_t *subscription)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = session->conn;
+    const sr_module_change_subscr_t *subscr;
+    sr_mod_t *shm_mod;
+    uint32_t i;
+
+    for (i = 0; i < shm_count; ++i) {
+        subscr = &subscrs[order[i]];
+        shm_mod = sr_shmmain_find_module(&conn->main_shm, conn->ext_shm.addr, subscr->module_name, 0);
+        assert(shm_mod);
+
+        /* MOD SUBS WRITE LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            /* the subscription will be removed once this connection is recovered */
+            sr_errinfo_free(&err_info);
+            continue;
+        }
+
+        sr_shmmod_change_subscription_del(&conn->ext_shm, shm_mod, subscr->xpath, session->ds, subscr->priority,
+                sub_opts, subscription->evpipe_num, 0, NULL);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+    }
+
+    for (i = 0; i < subs_count; ++i) {
+        subscr = &subscrs[order[i]];
+        sr_sub_change_del(subscr->module_name, subscr->xpath, session->ds, subscr->callback, subscr->private_data,
+                subscr->priority, sub_opts, subscription);
+    }
+}
+
+API int
+sr_module_change_subscribe_batch(sr_session_ctx_t *session, const sr_module_change_subscr_t *subscrs,
+        uint32_t subscr_count, sr_subscr_options_t opts, sr_subscription_ctx_t **subscription)
+{
+    sr_error_info_t *err_info = NULL;
+    const struct lys_module **ly_mods = NULL;
+    sr_module_change_subscr_t *mod_subscrs = NULL;
+    sr_conn_ctx_t *conn;
+    sr_subscr_options_t sub_opts;
+    sr_mod_change_sub_t *shm_sub;
+    sr_mod_t *shm_mod;
+    uint32_t i, j, k, *order = NULL, order_count = 0, shm_count = 0, subs_count = 0;
+    uint16_t mod_subscr_count;
+    int new_subs = 0, dup_prio;
+
+    SR_CHECK_ARG_APIRET(!session || SR_IS_EVENT_SESS(session) || !subscrs || !subscr_count
+            || ((opts & SR_SUBSCR_PASSIVE) && (opts & SR_SUBSCR_ENABLED)) || !subscription, session, err_info);
+    for (i = 0; i < subscr_count; ++i) {
+        SR_CHECK_ARG_APIRET(!subscrs[i].module_name || !subscrs[i].callback, session, err_info);
+    }
+
+    if ((opts & SR_SUBSCR_CTX_REUSE) && !*subscription) {
+        /* invalid option, remove */
+        opts &= ~SR_SUBSCR_CTX_REUSE;
+    }
+
+    conn = session->conn;
+    /* only these options are relevant outside this function and will be stored */
+    sub_opts = opts & (SR_SUBSCR_DONE_ONLY | SR_SUBSCR_PASSIVE | SR_SUBSCR_UPDATE | SR_SUBSCR_UNLOCKED);
+
+    ly_mods = malloc(subscr_count * sizeof *ly_mods);
+    order = malloc(subscr_count * sizeof *order);
+    mod_subscrs = malloc(subscr_count * sizeof *mod_subscrs);
+    SR_CHECK_MEM_GOTO(!ly_mods || !order || !mod_subscrs, err_info, cleanup);
+
+    for (i = 0; i < subscr_count; ++i) {
+        /* is the module name valid? */
+        ly_mods[i] = ly_ctx_get_module(conn->ly_ctx, subscrs[i].module_name, NULL, 1);
+        if (!ly_mods[i]) {
+            sr_errinfo_new(&err_info, SR_ERR_NOT_FOUND, NULL, "Module \"%s\" was not found in sysrepo.",
+                    subscrs[i].module_name);
+            goto cleanup;
+        }
+
+        /* check write/read perm, only once for every module */
+        for (j = 0; (j < i) && (ly_mods[j] != ly_mods[i]); ++j);
+        if ((j == i) && (err_info = sr_perm_check(ly_mods[i]->name, (opts & SR_SUBSCR_PASSIVE) ? 0 : 1, NULL))) {
+            goto cleanup;
+        }
+    }
+
+    /* call the callbacks with the current running configuration so that it is properly applied */
+    if ((session->ds == SR_DS_RUNNING) && (opts & SR_SUBSCR_ENABLED)) {
+        /* do not hold write lock here, would block callbacks from calling API functions */
+        if ((err_info = sr_module_change_subscribe_running_enable(session, ly_mods, subscrs, subscr_count, opts))) {
+            goto cleanup;
+        }
+    }
+
+    /* SHM LOCK (subscriptions are added into ext SHM under their own locks) */
+    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 1, __func__))) {
+        goto cleanup;
+    }
+
+    if (!(opts & SR_SUBSCR_CTX_REUSE)) {
+        /* create a new subscription */
+        if ((err_info = sr_subs_new(conn, opts, subscription))) {
+            goto cleanup_unlock;
+        }
+        new_subs = 1;
+    }
+
+    for (i = 0; i < subscr_count; ++i) {
+        /* process every module only once */
+        for (j = 0; (j < i) && (ly_mods[j] != ly_mods[i]); ++j);
+        if (j < i) {
+            continue;
+        }
+
+        /* find module */
+        shm_mod = sr_shmmain_find_module(&conn->main_shm, conn->ext_shm.addr, ly_mods[i]->name, 0);
+        SR_CHECK_INT_GOTO(!shm_mod, err_info, cleanup_unlock);
+
+        /* MOD SUBS WRITE LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            goto cleanup_unlock;
+        }
+
+        /* gather all the subscriptions of this module */
+        mod_subscr_count = 0;
+        for (j = i; j < subscr_count; ++j) {
+            if (ly_mods[j] != ly_mods[i]) {
+                continue;
+            }
+
+            if (mod_subscr_count == UINT16_MAX) {
+                sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, NULL, "Too many subscriptions of module \"%s\".",
+                        ly_mods[i]->name);
+                break;
+            }
+
+            if (opts & SR_SUBSCR_UPDATE) {
+                /* check that there is not already an update subscription with the same priority, even in the batch */
+                dup_prio = 0;
+                shm_sub = (sr_mod_change_sub_t *)(conn->ext_shm.addr + shm_mod->change_sub[session->ds].subs);
+                for (k = 0; k < shm_mod->change_sub[session->ds].sub_count; ++k) {
+                    if ((shm_sub[k].opts & SR_SUBSCR_UPDATE) && (shm_sub[k].priority == subscrs[j].priority)) {
+                        dup_prio = 1;
+                    }
+                }
+                for (k = 0; k < mod_subscr_count; ++k) {
+                    if (mod_subscrs[k].priority == subscrs[j].priority) {
+                        dup_prio = 1;
+                    }
+                }
+                if (dup_prio) {
+                    sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, NULL, "There already is an \"update\" subscription on"
+                            " module \"%s\" with priority %u for %s DS.", ly_mods[i]->name, subscrs[j].priority,
+                            sr_ds2str(session->ds));
+                    break;
+                }
+            }
+
+            mod_subscrs[mod_subscr_count++] = subscrs[j];
+            order[order_count++] = j;
+        }
+
+        if (!err_info) {
+            /* add all the module subscriptions into main SHM at once */
+            err_info = sr_shmmod_change_subscriptions_add(&conn->ext_shm, shm_mod, mod_subscrs, mod_subscr_count,
+                    session->ds, sub_opts, (*subscription)->evpipe_num);
+        }
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
 
+        if (err_info) {
+            goto cleanup_unlock;
+        }
+        shm_count = order_count;
+    }
+
+    for (i = 0; i < order_count; ++i) {
+        /* add subscription into structure and create separate specific SHM segment */
+        j = order[i];
+        if ((err_info = sr_sub_change_add(session, subscrs[j].module_name, subscrs[j].xpath, subscrs[j].callback,
+                subscrs[j].private_data, subscrs[j].priority, sub_opts, *subscription))) {
+            goto cleanup_unlock;
+        }
+        ++subs_count;
+    }
+
+    /* add the subscription into session */
+    if ((err_info = sr_ptr_add(&session->ptr_lock, (void ***)&session->subscriptions, &session->subscription_count,
+            *subscription))) {
+        goto cleanup_unlock;
+    }
+
+cleanup_unlock:
+    if (err_info && (new_subs || (opts & SR_SUBSCR_CTX_REUSE))) {
+        /* remove all the added subscriptions */
+        sr_module_change_subscribe_batch_revert(session, subscrs, order, shm_count, subs_count, sub_opts,
+                *subscription);
+        if (new_subs) {
+            _sr_unsubscribe(*subscription);
+            *subscription = NULL;
+        }
+    }
+
+    /* SHM UNLOCK */
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
+
+cleanup:
+    free(ly_mods);
+    free(order);
+    free(mod_subscrs);
     return sr_api_ret(session, err_info);
 }
 
@@ -3990,14 +4686,16 @@ static int
 _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callback, sr_rpc_tree_cb tree_callback,
         void *private_data, uint32_t priority, sr_subscr_options_t opts, sr_subscription_ctx_t **subscription)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_error_info_t *err_info = NULL, *tmp_err;
     char *module_name = NULL, *op_path = NULL;
     const struct lys_node *op;
     const struct lys_module *ly_mod;
     sr_conn_ctx_t *conn;
     sr_subscr_options_t sub_opts;
+    sr_main_shm_t *main_shm;
     sr_rpc_t *shm_rpc;
     off_t shm_rpc_off;
+    uint32_t slot;
     int last_removed;
 
     SR_CHECK_ARG_APIRET(!session || SR_IS_EVENT_SESS(session) || !xpath || (!callback && !tree_callback) || !subscription,
@@ -4010,7 +4708,7 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
 
     conn = session->conn;
     /* only these options are relevant outside this function and will be stored */
-    sub_opts = opts & SR_SUBSCR_UNLOCKED;
+    sub_opts = opts & (SR_SUBSCR_UNLOCKED | SR_SUBSCR_CONCURRENT);
 
     module_name = sr_get_first_ns(xpath);
     if (!module_name) {
@@ -4044,10 +4742,11 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
         goto error;
     }
 
-    /* SHM LOCK (writing into subscriptions) */
-    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_WRITE, 1, __func__))) {
+    /* SHM LOCK (subscriptions are added into ext SHM under their own locks) */
+    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 1, __func__))) {
         goto error;
     }
+    main_shm = (sr_main_shm_t *)conn->main_shm.addr;
 
     if (!(opts & SR_SUBSCR_CTX_REUSE)) {
         /* create a new subscription */
@@ -4056,22 +4755,30 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
         }
     }
 
+    /* RPC SUBS WRITE LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__))) {
+        goto error_unlock_unsub;
+    }
+
     /* find RPC struct or add a new one */
-    shm_rpc = sr_shmmain_find_rpc((sr_main_shm_t *)conn->main_shm.addr, conn->ext_shm.addr, op_path, 0);
+    shm_rpc = sr_shmmain_find_rpc(main_shm, conn->ext_shm.addr, op_path, 0);
     if (!shm_rpc && (err_info = sr_shmmain_add_rpc(conn, op_path, &shm_rpc))) {
-        goto error_unlock_unsub;
+        goto error_rpc_unlock;
     }
     shm_rpc_off = ((char *)shm_rpc) - conn->ext_shm.addr;
 
     /* add RPC/action subscription into main SHM (which may be remapped) */
     if ((err_info = sr_shmmain_rpc_subscription_add(&conn->ext_shm, shm_rpc_off, xpath, priority, sub_opts,
-                (*subscription)->evpipe_num))) {
-        goto error_unlock_unsub;
+                (*subscription)->evpipe_num, &slot))) {
+        goto error_rpc_unlock;
     }
-    shm_rpc = (sr_rpc_t *)(conn->ext_shm.addr + shm_rpc_off);
+
+    /* RPC SUBS WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__);
 
     /* add subscription into structure and create separate specific SHM segment */
-    if ((err_info = sr_sub_rpc_add(session, op_path, xpath, callback, tree_callback, private_data, priority, *subscription))) {
+    if ((err_info = sr_sub_rpc_add(session, op_path, xpath, callback, tree_callback, private_data, priority, slot,
+            *subscription))) {
         goto error_unlock_unsub_unrpc;
     }
 
@@ -4082,29 +4789,49 @@ _sr_rpc_subscribe(sr_session_ctx_t *session, const char *xpath, sr_rpc_cb callba
     }
 
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
 
     free(module_name);
     free(op_path);
     return sr_api_ret(session, NULL);
 
 error_unlock_unsub_unrpc:
-    sr_shmmain_rpc_subscription_del(conn->ext_shm.addr, shm_rpc, xpath, priority, (*subscription)->evpipe_num, 0, &last_removed);
-    if (last_removed) {
-        sr_shmmain_del_rpc((sr_main_shm_t *)conn->main_shm.addr, conn->ext_shm.addr, NULL, shm_rpc->op_path);
+    /* RPC SUBS WRITE LOCK */
+    if ((tmp_err = sr_shmmain_sub_lock_remap(conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__))) {
+        sr_errinfo_merge(&err_info, tmp_err);
+    } else {
+        /* RPCs could have been added or removed in the meantime */
+        shm_rpc = sr_shmmain_find_rpc(main_shm, conn->ext_shm.addr, op_path, 0);
+        if (shm_rpc) {
+            sr_shmmain_rpc_subscription_del(&conn->ext_shm, shm_rpc, xpath, priority, (*subscription)->evpipe_num,
+                    0, NULL, &last_removed);
+            if (last_removed) {
+                sr_shmmain_del_rpc(main_shm, &conn->ext_shm, NULL, shm_rpc->op_path);
+            }
+        }
+
+        /* RPC SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__);
     }
 
-error_unlock_unsub:
     if (opts & SR_SUBSCR_CTX_REUSE) {
         sr_sub_rpc_del(op_path, xpath, callback, tree_callback, private_data, priority, *subscription);
-    } else {
+    }
+    goto error_unlock_unsub;
+
+error_rpc_unlock:
+    /* RPC SUBS WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &main_shm->rpc_lock, SR_LOCK_WRITE, __func__);
+
+error_unlock_unsub:
+    if (!(opts & SR_SUBSCR_CTX_REUSE)) {
         _sr_unsubscribe(*subscription);
         *subscription = NULL;
     }
 
 error_unlock:
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
 
 error:
     free(module_name);
@@ -4205,7 +4932,7 @@ sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t tim
     sr_mod_data_dep_t *shm_deps;
     uint16_t shm_dep_count;
     char *op_path = NULL, *str;
-    uint32_t event_id = 0;
+    uint32_t event_id = 0, slot;
 
     SR_CHECK_ARG_APIRET(!session || !input || !output, session, err_info);
     if (session->conn->ly_ctx != input->schema->module->ctx) {
@@ -4274,8 +5001,8 @@ sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t tim
     }
 
     /* load all input dependency modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, &session->sid, NULL, SR_OPER_CB_TIMEOUT, 0,
-            &cb_err_info)) || cb_err_info) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, &session->sid, NULL, 0, 0,
+            SR_OPER_CB_TIMEOUT, 0, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -4292,14 +5019,14 @@ sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t tim
     SR_MODINFO_INIT(mod_info, session->conn, SR_DS_OPERATIONAL, SR_DS_RUNNING);
 
     /* publish RPC in an event and wait for a reply from the last subscriber */
-    if ((err_info = sr_shmsub_rpc_notify(session->conn, op_path, input, session->sid, timeout_ms, &event_id, output,
-            &cb_err_info))) {
+    if ((err_info = sr_shmsub_rpc_notify(session->conn, op_path, input, session->sid, timeout_ms, &event_id, &slot,
+            output, &cb_err_info))) {
         goto cleanup_shm_unlock;
     }
 
     if (cb_err_info) {
         /* "rpc" event failed, publish "abort" event and finish */
-        err_info = sr_shmsub_rpc_notify_abort(session->conn, op_path, input, session->sid, event_id);
+        err_info = sr_shmsub_rpc_notify_abort(session->conn, op_path, input, session->sid, event_id, slot);
         goto cleanup_shm_unlock;
     }
 
@@ -4319,8 +5046,8 @@ sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t tim
     }
 
     /* load all output dependency modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, &session->sid, NULL, SR_OPER_CB_TIMEOUT, 0,
-            &cb_err_info)) || cb_err_info) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, &session->sid, NULL, 0, 0,
+            SR_OPER_CB_TIMEOUT, 0, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -4358,6 +5085,506 @@ cleanup_shm_unlock:
     return sr_api_ret(session, err_info);
 }
 
+
+/**
+ * @brief Free an asynchronous request.
+ *
+ * @param[in] request Request to free.
+ */
+static void
+sr_async_free(sr_async_t *request)
+{
+    struct lyd_node *node;
+
+    if (!request) {
+        return;
+    }
+
+    if (request->pipe[0] > -1) {
+        close(request->pipe[0]);
+    }
+    if (request->pipe[1] > -1) {
+        close(request->pipe[1]);
+    }
+    free(request->user);
+    lyd_free_withsiblings(request->input);
+    free(request->xpath);
+    if (request->data) {
+        /* action output is not a top-level node */
+        for (node = request->data; node->parent; node = node->parent) {}
+        lyd_free_withsiblings(node);
+    }
+    sr_errinfo_free(&request->err_info);
+    free(request);
+}
+
+/**
+ * @brief Create a new asynchronous request.
+ *
+ * @param[in] session Session the request is created on.
+ * @param[in] type Request type.
+ * @param[in] with_fd Whether the request should have a file descriptor to poll on.
+ * @param[out] request Created request.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_async_new(sr_session_ctx_t *session, sr_async_type_t type, int with_fd, sr_async_t **request)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_async_t *req;
+
+    req = calloc(1, sizeof *req);
+    SR_CHECK_MEM_RET(!req, err_info);
+    req->type = type;
+    req->session = session;
+    req->pipe[0] = -1;
+    req->pipe[1] = -1;
+
+    if (with_fd && (pipe(req->pipe) == -1)) {
+        SR_ERRINFO_SYSERRNO(&err_info, "pipe");
+        goto error;
+    }
+
+    /* the request is performed on a worker session, but with the same datastore and identity */
+    req->ds = session->ds;
+    req->nc_sid = session->sid.nc;
+    req->user = strdup(session->sid.user);
+    if (!req->user) {
+        SR_ERRINFO_MEM(&err_info);
+        goto error;
+    }
+
+    *request = req;
+    return NULL;
+
+error:
+    sr_async_free(req);
+    return err_info;
+}
+
+/**
+ * @brief Initialize the asynchronous request pool of a connection, no workers are started.
+ *
+ * @param[in] conn Connection to use.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_async_pool_init(sr_conn_ctx_t *conn)
+{
+    sr_error_info_t *err_info = NULL;
+    struct sr_async_pool_s *pool;
+    int ret;
+
+    pool = calloc(1, sizeof *pool);
+    SR_CHECK_MEM_RET(!pool, err_info);
+
+    if ((err_info = sr_mutex_init(&pool->lock, 0))) {
+        free(pool);
+        return err_info;
+    }
+    if ((ret = pthread_cond_init(&pool->cond, NULL))) {
+        sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Initializing pthread cond failed (%s).", strerror(ret));
+        pthread_mutex_destroy(&pool->lock);
+        free(pool);
+        return err_info;
+    }
+    pool->running = 1;
+
+    conn->async_pool = pool;
+    return NULL;
+}
+
+/**
+ * @brief Stop the asynchronous request pool of a connection. All the queued requests are performed,
+ * then all the workers are joined and their sessions stopped.
+ *
+ * @param[in] conn Connection to use.
+ */
+static void
+sr_async_pool_stop(sr_conn_ctx_t *conn)
+{
+    struct sr_async_pool_s *pool = conn->async_pool;
+    uint32_t i;
+
+    if (!pool) {
+        return;
+    }
+
+    /* POOL LOCK */
+    pthread_mutex_lock(&pool->lock);
+
+    /* no new requests are accepted from now on */
+    pool->running = 0;
+    pthread_cond_broadcast(&pool->cond);
+
+    /* POOL UNLOCK */
+    pthread_mutex_unlock(&pool->lock);
+
+    /* the workers exit once there are no queued requests */
+    for (i = 0; i < pool->worker_count; ++i) {
+        pthread_join(pool->workers[i].tid, NULL);
+        sr_session_stop(pool->workers[i].sess);
+    }
+    pool->worker_count = 0;
+}
+
+/**
+ * @brief Free the asynchronous request pool of a connection, it must be stopped.
+ *
+ * @param[in] conn Connection to use.
+ */
+static void
+sr_async_pool_free(sr_conn_ctx_t *conn)
+{
+    struct sr_async_pool_s *pool = conn->async_pool;
+
+    if (!pool) {
+        return;
+    }
+
+    assert(!pool->worker_count && !pool->first);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+    conn->async_pool = NULL;
+}
+
+/**
+ * @brief Asynchronous request pool worker thread, performs queued requests.
+ *
+ * @param[in] arg Pool worker.
+ * @return Always NULL.
+ */
+static void *
+sr_async_worker_thread(void *arg)
+{
+    struct sr_async_worker_s *worker = (struct sr_async_worker_s *)arg;
+    struct sr_async_pool_s *pool = worker->pool;
+    sr_session_ctx_t *sess = worker->sess;
+    sr_async_t *req;
+    char c = 0;
+
+    while (1) {
+        /* POOL LOCK */
+        pthread_mutex_lock(&pool->lock);
+
+        while (!pool->first && pool->running) {
+            ++pool->idle;
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            --pool->idle;
+        }
+
+        /* dequeue the first request */
+        req = pool->first;
+        if (req) {
+            pool->first = req->next;
+            if (!pool->first) {
+                pool->last = NULL;
+            }
+            --pool->queued;
+        }
+
+        /* POOL UNLOCK */
+        pthread_mutex_unlock(&pool->lock);
+
+        if (!req) {
+            /* the pool is being stopped and there are no requests left */
+            break;
+        }
+
+        /* use the datastore and identity of the request session */
+        sess->ds = req->ds;
+        sess->sid.nc = req->nc_sid;
+        free(sess->sid.user);
+        sess->sid.user = req->user;
+        req->user = NULL;
+
+        switch (req->type) {
+        case SR_ASYNC_RPC:
+            req->ret = sr_rpc_send_tree(sess, req->input, req->timeout_ms, &req->data);
+            break;
+        case SR_ASYNC_GET:
+            req->ret = sr_get_data(sess, req->xpath, req->max_depth, req->timeout_ms, req->opts, &req->data);
+            break;
+        }
+
+        if (req->cb) {
+            /* report the result and free the request, nobody is waiting for it */
+            req->cb(sess, req->ret, req->data, req->private_data);
+            sr_async_free(req);
+            continue;
+        }
+
+        /* take over the request error */
+        req->err_info = sess->err_info;
+        sess->err_info = NULL;
+
+        /* signal the request is finished, it must not be accessed anymore */
+        while ((write(req->pipe[1], &c, 1) == -1) && (errno == EINTR)) {}
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Queue an asynchronous request to be performed by the connection pool. A new worker is started
+ * if there are more queued requests than idle workers and the maximum worker count was not reached.
+ *
+ * @param[in] request Prepared request.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+sr_async_start(sr_async_t *request)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_conn_ctx_t *conn = request->session->conn;
+    struct sr_async_pool_s *pool = conn->async_pool;
+    struct sr_async_worker_s *worker;
+    sr_session_ctx_t *sess;
+    int ret;
+
+    /* POOL LOCK */
+    pthread_mutex_lock(&pool->lock);
+
+    if (!pool->running) {
+        sr_errinfo_new(&err_info, SR_ERR_OPERATION_FAILED, NULL, "Connection is being disconnected.");
+        goto cleanup_unlock;
+    }
+
+    /* enqueue the request */
+    request->next = NULL;
+    if (pool->last) {
+        pool->last->next = request;
+    } else {
+        pool->first = request;
+    }
+    pool->last = request;
+    ++pool->queued;
+
+    if ((pool->queued > pool->idle) && (pool->worker_count < SR_ASYNC_WORKER_COUNT)) {
+        /* start a new worker with its own session */
+        worker = &pool->workers[pool->worker_count];
+        if ((ret = sr_session_start(conn, SR_DS_RUNNING, &sess))) {
+            sr_errinfo_new(&err_info, ret, NULL, "Failed to start a session for an asynchronous request worker.");
+        } else {
+            worker->pool = pool;
+            worker->sess = sess;
+            if ((ret = pthread_create(&worker->tid, NULL, sr_async_worker_thread, worker))) {
+                sr_errinfo_new(&err_info, SR_ERR_SYS, NULL, "Creating a new thread failed (%s).", strerror(ret));
+                sr_session_stop(sess);
+            } else {
+                ++pool->worker_count;
+            }
+        }
+
+        if (err_info) {
+            if (pool->worker_count) {
+                /* the request will be performed by one of the existing workers */
+                sr_errinfo_free(&err_info);
+            } else {
+                /* there is no worker to perform it, it is the only queued request */
+                assert((pool->first == request) && (pool->queued == 1));
+                pool->first = NULL;
+                pool->last = NULL;
+                pool->queued = 0;
+                goto cleanup_unlock;
+            }
+        }
+    }
+
+    pthread_cond_signal(&pool->cond);
+
+cleanup_unlock:
+    /* POOL UNLOCK */
+    pthread_mutex_unlock(&pool->lock);
+    return err_info;
+}
+
+/**
+ * @brief Create and start an asynchronous RPC/action request.
+ *
+ * @param[in] session Session to use.
+ * @param[in] input Input data tree.
+ * @param[in] timeout_ms RPC/action callback timeout in milliseconds.
+ * @param[in] callback Optional completion callback.
+ * @param[in] private_data Completion callback private data.
+ * @param[out] request Optional started request, only if there is no \p callback.
+ * @return err_info, NULL on success.
+ */
+static sr_error_info_t *
+_sr_rpc_send_async(sr_session_ctx_t *session, const struct lyd_node *input, uint32_t timeout_ms,
+        sr_rpc_async_cb callback, void *private_data, sr_async_t **request)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_async_t *req = NULL;
+
+    if (session->conn->ly_ctx != input->schema->module->ctx) {
+        sr_errinfo_new(&err_info, SR_ERR_INVAL_ARG, NULL, "Data trees must be created using the session connection libyang context.");
+        return err_info;
+    }
+
+    if ((err_info = sr_async_new(session, SR_ASYNC_RPC, callback ? 0 : 1, &req))) {
+        return err_info;
+    }
+
+    /* the input may not be accessed by the caller while the request is performed, use a copy */
+    while (input->parent) {
+        input = input->parent;
+    }
+    req->input = lyd_dup(input, LYD_DUP_OPT_RECURSIVE);
+    if (!req->input) {
+        sr_errinfo_new_ly(&err_info, session->conn->ly_ctx);
+        goto error;
+    }
+    req->timeout_ms = timeout_ms;
+    req->cb = callback;
+    req->private_data = private_data;
+
+    if ((err_info = sr_async_start(req))) {
+        goto error;
+    }
+
+    if (request) {
+        *request = req;
+    }
+    return NULL;
+
+error:
+    sr_async_free(req);
+    return err_info;
+}
+
+API int
+sr_rpc_send_tree_async(sr_session_ctx_t *session, const struct lyd_node *input, uint32_t timeout_ms,
+        sr_async_t **request)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session || !input || !request, session, err_info);
+
+    *request = NULL;
+    err_info = _sr_rpc_send_async(session, input, timeout_ms, NULL, NULL, request);
+    return sr_api_ret(session, err_info);
+}
+
+API int
+sr_rpc_send_async(sr_session_ctx_t *session, const struct lyd_node *input, uint32_t timeout_ms,
+        sr_rpc_async_cb callback, void *private_data)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!session || !input || !callback, session, err_info);
+
+    err_info = _sr_rpc_send_async(session, input, timeout_ms, callback, private_data, NULL);
+    return sr_api_ret(session, err_info);
+}
+
+API int
+sr_get_data_async(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
+        const sr_get_oper_options_t opts, sr_async_t **request)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_async_t *req = NULL;
+
+    SR_CHECK_ARG_APIRET(!session || !xpath || !request || ((session->ds != SR_DS_OPERATIONAL) && opts), session,
+            err_info);
+
+    if ((err_info = sr_async_new(session, SR_ASYNC_GET, 1, &req))) {
+        goto cleanup;
+    }
+
+    req->xpath = strdup(xpath);
+    if (!req->xpath) {
+        SR_ERRINFO_MEM(&err_info);
+        goto cleanup;
+    }
+    req->max_depth = max_depth;
+    req->timeout_ms = timeout_ms;
+    req->opts = opts;
+
+    err_info = sr_async_start(req);
+
+cleanup:
+    if (err_info) {
+        sr_async_free(req);
+        req = NULL;
+    }
+    *request = req;
+    return sr_api_ret(session, err_info);
+}
+
+API int
+sr_async_get_fd(sr_async_t *request, int *fd)
+{
+    sr_error_info_t *err_info = NULL;
+
+    SR_CHECK_ARG_APIRET(!request || !fd, NULL, err_info);
+
+    *fd = request->pipe[0];
+    return sr_api_ret(NULL, NULL);
+}
+
+API int
+sr_async_is_done(sr_async_t *request)
+{
+    struct pollfd pfd;
+    int ret;
+
+    if (!request) {
+        return 0;
+    }
+
+    pfd.fd = request->pipe[0];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    do {
+        ret = poll(&pfd, 1, 0);
+    } while ((ret == -1) && (errno == EINTR));
+
+    return (ret > 0) && (pfd.revents & POLLIN);
+}
+
+API int
+sr_async_finish(sr_async_t *request, struct lyd_node **data)
+{
+    sr_error_info_t *err_info = NULL;
+    sr_session_ctx_t *session;
+    ssize_t ret;
+    char c;
+
+    if (data) {
+        *data = NULL;
+    }
+    SR_CHECK_ARG_APIRET(!request, NULL, err_info);
+
+    session = request->session;
+
+    /* wait for the request to finish */
+    do {
+        ret = read(request->pipe[0], &c, 1);
+    } while ((ret == -1) && (errno == EINTR));
+    if (ret != 1) {
+        SR_ERRINFO_SYSERRNO(&err_info, "read");
+        /* the worker may still be using the request, it cannot be freed */
+        return sr_api_ret(session, err_info);
+    }
+
+    /* take over the request error */
+    err_info = request->err_info;
+    request->err_info = NULL;
+    if (!err_info && request->ret) {
+        sr_errinfo_new(&err_info, request->ret, NULL, NULL);
+    }
+
+    if (data) {
+        *data = request->data;
+        request->data = NULL;
+    }
+    sr_async_free(request);
+
+    return sr_api_ret(session, err_info);
+}
+
 /**
  * @brief Subscribe to a notification.
  *
@@ -4378,7 +5605,7 @@ _sr_event_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const
         time_t stop_time, sr_event_notif_cb callback, sr_event_notif_tree_cb tree_callback, void *private_data,
         sr_subscr_options_t opts, sr_subscription_ctx_t **subscription)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_error_info_t *err_info = NULL, *tmp_err;
     struct ly_set *set;
     const struct lys_node *ctx_node;
     time_t cur_ts = time(NULL);
@@ -4443,8 +5670,8 @@ _sr_event_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const
     }
     ly_set_free(set);
 
-    /* SHM LOCK (writing into subscriptions) */
-    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_WRITE, 1, __func__))) {
+    /* SHM LOCK (subscriptions are added into ext SHM under their own locks) */
+    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 1, __func__))) {
         return sr_api_ret(session, err_info);
     }
 
@@ -4460,8 +5687,18 @@ _sr_event_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const
     SR_CHECK_INT_GOTO(!shm_mod, err_info, error_unlock_unsub);
 
     if (!start_time) {
+        /* MOD SUBS WRITE LOCK */
+        if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            goto error_unlock_unsub;
+        }
+
         /* add notification subscription into main SHM now if replay was not requested */
-        if ((err_info = sr_shmmod_notif_subscription_add(&conn->ext_shm, shm_mod, (*subscription)->evpipe_num))) {
+        err_info = sr_shmmod_notif_subscription_add(&conn->ext_shm, shm_mod, (*subscription)->evpipe_num);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+        if (err_info) {
             goto error_unlock_unsub;
         }
     }
@@ -4486,13 +5723,21 @@ _sr_event_notif_subscribe(sr_session_ctx_t *session, const char *mod_name, const
     }
 
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
 
     return sr_api_ret(session, NULL);
 
 error_unlock_unsub_unmod:
     if (!start_time) {
-        sr_shmmod_notif_subscription_del(conn->ext_shm.addr, shm_mod, (*subscription)->evpipe_num, NULL);
+        /* MOD SUBS WRITE LOCK */
+        if ((tmp_err = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+            sr_errinfo_merge(&err_info, tmp_err);
+        } else {
+            sr_shmmod_notif_subscription_del(&conn->ext_shm, shm_mod, (*subscription)->evpipe_num, NULL);
+
+            /* MOD SUBS WRITE UNLOCK */
+            sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+        }
     }
 
 error_unlock_unsub:
@@ -4505,7 +5750,7 @@ error_unlock_unsub:
 
 error_unlock:
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
 
     return sr_api_ret(session, err_info);
 }
@@ -4575,7 +5820,7 @@ sr_event_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif)
     sr_mod_t *shm_mod;
     time_t notif_ts;
     uint16_t shm_dep_count;
-    sr_mod_notif_sub_t *notif_subs;
+    sr_mod_notif_sub_t *notif_subs = NULL;
     uint32_t notif_sub_count;
     char *xpath = NULL;
 
@@ -4637,8 +5882,8 @@ sr_event_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif)
     }
 
     /* load all input dependency modules data */
-    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, &session->sid, NULL, SR_OPER_CB_TIMEOUT, 0,
-            &cb_err_info)) || cb_err_info) {
+    if ((err_info = sr_modinfo_data_load(&mod_info, MOD_INFO_TYPE_MASK, 1, &session->sid, NULL, 0, 0,
+            SR_OPER_CB_TIMEOUT, 0, &cb_err_info)) || cb_err_info) {
         goto cleanup_mods_unlock;
     }
 
@@ -4657,6 +5902,8 @@ sr_event_notif_send_tree(sr_session_ctx_t *session, struct lyd_node *notif)
     /* store the notification for a replay, we continue on failure */
     err_info = sr_replay_store(session, notif, notif_ts);
 
+    ATOMIC_INC_RELAXED(shm_mod->stats.notifs);
+
     /* check that there is a subscriber */
     if ((tmp_err_info = sr_notif_find_subscriber(session->conn, lyd_node_module(notif)->name, &notif_subs, &notif_sub_count))) {
         goto cleanup_shm_unlock;
@@ -4683,6 +5930,7 @@ cleanup_shm_unlock:
     sr_shmmain_unlock(session->conn, SR_LOCK_READ, 0, __func__);
 
     free(xpath);
+    free(notif_subs);
     sr_modinfo_free(&mod_info);
     if (tmp_err_info) {
         sr_errinfo_merge(&err_info, tmp_err_info);
@@ -4820,7 +6068,7 @@ API int
 sr_oper_get_items_subscribe(sr_session_ctx_t *session, const char *module_name, const char *path,
         sr_oper_get_items_cb callback, void *private_data, sr_subscr_options_t opts, sr_subscription_ctx_t **subscription)
 {
-    sr_error_info_t *err_info = NULL;
+    sr_error_info_t *err_info = NULL, *tmp_err;
     sr_conn_ctx_t *conn;
     const struct lys_module *ly_mod;
     sr_mod_oper_sub_type_t sub_type;
@@ -4855,8 +6103,8 @@ sr_oper_get_items_subscribe(sr_session_ctx_t *session, const char *module_name,
         return sr_api_ret(session, err_info);
     }
 
-    /* SHM LOCK (writing into subscriptions) */
-    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_WRITE, 1, __func__))) {
+    /* SHM LOCK (subscriptions are added into ext SHM under their own locks) */
+    if ((err_info = sr_shmmain_lock_remap(conn, SR_LOCK_READ, 1, __func__))) {
         return sr_api_ret(session, err_info);
     }
 
@@ -4871,9 +6119,19 @@ sr_oper_get_items_subscribe(sr_session_ctx_t *session, const char *module_name,
     shm_mod = sr_shmmain_find_module(&conn->main_shm, conn->ext_shm.addr, module_name, 0);
     SR_CHECK_INT_GOTO(!shm_mod, err_info, error_unlock_unsub);
 
+    /* MOD SUBS WRITE LOCK */
+    if ((err_info = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+        goto error_unlock_unsub;
+    }
+
     /* add oper subscription into main SHM */
-    if ((err_info = sr_shmmod_oper_subscription_add(&conn->ext_shm, shm_mod, path, sub_type, sub_opts,
-            (*subscription)->evpipe_num))) {
+    err_info = sr_shmmod_oper_subscription_add(&conn->ext_shm, shm_mod, path, sub_type, sub_opts,
+            (*subscription)->evpipe_num);
+
+    /* MOD SUBS WRITE UNLOCK */
+    sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+
+    if (err_info) {
         goto error_unlock_unsub;
     }
 
@@ -4892,7 +6150,15 @@ sr_oper_get_items_subscribe(sr_session_ctx_t *session, const char *module_name,
     goto cleanup_unlock;
 
 error_unlock_unsub_unmod:
-    sr_shmmod_oper_subscription_del(conn->ext_shm.addr, shm_mod, path, (*subscription)->evpipe_num, 0, NULL);
+    /* MOD SUBS WRITE LOCK */
+    if ((tmp_err = sr_shmmain_sub_lock_remap(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__))) {
+        sr_errinfo_merge(&err_info, tmp_err);
+    } else {
+        sr_shmmod_oper_subscription_del(&conn->ext_shm, shm_mod, path, (*subscription)->evpipe_num, 0, NULL);
+
+        /* MOD SUBS WRITE UNLOCK */
+        sr_shmmain_sub_unlock(conn, &shm_mod->sub_lock, SR_LOCK_WRITE, __func__);
+    }
 
 error_unlock_unsub:
     if (opts & SR_SUBSCR_CTX_REUSE) {
@@ -4904,7 +6170,7 @@ error_unlock_unsub:
 
 cleanup_unlock:
     /* SHM UNLOCK */
-    sr_shmmain_unlock(conn, SR_LOCK_WRITE, 1, __func__);
+    sr_shmmain_unlock(conn, SR_LOCK_READ, 1, __func__);
 
     return sr_api_ret(session, err_info);
 }
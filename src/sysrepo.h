@@ -151,6 +151,23 @@ typedef void (*sr_log_cb)(sr_log_level_t level, const char *message);
  */
 void sr_log_set_cb(sr_log_cb log_callback);
 
+/**
+ * @brief Enables / disables asynchronous logging.
+ *
+ * By default, messages are printed into all the outputs (stderr, syslog, callback) by the thread
+ * that generated them. With asynchronous logging enabled, messages are only stored into a lock-free
+ * ring buffer as binary records of their format and arguments and formatted and printed by a separate
+ * thread so that even verbose logging does not slow down the operations. Messages may be truncated
+ * and if the buffer is full, they are printed directly.
+ *
+ * Disabling asynchronous logging waits for all the threads currently storing a message and prints
+ * all the stored messages.
+ *
+ * @param[in] enable Non-zero to enable, zero to disable asynchronous logging.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_log_async(int enable);
+
 /** @} logging */
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -178,7 +195,8 @@ typedef struct sr_session_ctx_s sr_session_ctx_t;
 typedef enum sr_conn_flag_e {
     SR_CONN_DEFAULT = 0,            /**< No special behaviour. */
     SR_CONN_CACHE_RUNNING = 1,      /**< Always cache running datastore data which makes mainly repeated retrieval of data
-                                         much faster. Affects all sessions created on this connection. */
+                                         much faster. Affects all sessions created on this connection. The cache
+                                         is private to the connection, each connection parses the data it caches. */
     SR_CONN_NO_SCHED_CHANGES = 2,   /**< Do not parse internal modules data and apply any scheduled changes. Makes
                                          creating the connection faster but, obviously, scheduled changes are not applied. */
     SR_CONN_ERR_ON_SCHED_FAIL = 4,  /**< If applying any of the scheduled changes fails, do not create a connection
@@ -237,7 +255,8 @@ int sr_connect(const sr_conn_options_t opts, sr_conn_ctx_t **conn);
  * @brief Disconnect from the sysrepo datastore.
  *
  * Cleans up and frees connection context allocated by ::sr_connect. All sessions and subscriptions
- * started within the connection will be automatically stopped and cleaned up too.
+ * started within the connection will be automatically stopped and cleaned up too. All the pending
+ * [asynchronous requests](@ref async_api) are performed and their callbacks return before that.
  *
  * @note Connection and all its associated sessions and subscriptions can no longer be used even on error.
  *
@@ -285,6 +304,35 @@ typedef int (*sr_diff_check_cb)(sr_session_ctx_t *session, const struct lyd_node
  */
 void sr_set_diff_check_callback(sr_conn_ctx_t *conn, sr_diff_check_cb callback);
 
+/**
+ * @brief Set the maximum number of modules whose operational data subscribers are queried concurrently
+ * when operational data of several modules are retrieved. Only modules whose subscribers provide
+ * data independently of other modules are queried concurrently, subscribers of a single module
+ * are always queried in order, parents before nested data. Default is 1 (no concurrency).
+ *
+ * @param[in] conn Connection, whose all sessions will use this limit.
+ * @param[in] limit Maximum number of modules queried concurrently, must be at least 1.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_set_oper_parallel_limit(sr_conn_ctx_t *conn, uint32_t limit);
+
+/**
+ * @brief Create a pool of threads processing events of all the subscriptions of a connection created
+ * afterwards without ::SR_SUBSCR_NO_THREAD, instead of a thread for every subscription context.
+ * Events of every subscription context are processed in order by one thread at a time but
+ * different subscription contexts are handled concurrently, by any idle thread. So to prevent
+ * callbacks blocking each other, subscribe them in separate subscription contexts.
+ *
+ * Subscriptions created before calling this function keep their own threads. The pool is
+ * destroyed when the connection is disconnected. Unsubscribing from a callback of the same
+ * subscription context is not supported.
+ *
+ * @param[in] conn Connection to create the pool for.
+ * @param[in] thread_count Number of threads in the pool, must be at least 1.
+ * @return Error code (::SR_ERR_OK on success), ::SR_ERR_EXISTS if the pool was already created.
+ */
+int sr_set_handler_pool(sr_conn_ctx_t *conn, uint32_t thread_count);
+
 /**
  * @brief Start a new session.
  *
@@ -431,6 +479,17 @@ const char *sr_session_get_user(sr_session_ctx_t *session);
  */
 sr_conn_ctx_t *sr_session_get_connection(sr_session_ctx_t *session);
 
+/**
+ * @brief Get statistics of callbacks of all the subscriptions created on a session. Change, operational,
+ * RPC/action, and realtime notification callbacks are counted.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use.
+ * @param[out] cb_count Optional number of called callbacks.
+ * @param[out] cb_usec Optional total time spent in the callbacks in microseconds.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_session_get_cb_stats(sr_session_ctx_t *session, uint64_t *cb_count, uint64_t *cb_usec);
+
 /** @} connsess */
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -465,6 +524,21 @@ const char *sr_get_repo_path(void);
 int sr_install_module(sr_conn_ctx_t *conn, const char *schema_path, const char *search_dirs, const char **features,
         int feat_count);
 
+/**
+ * @brief Install new schemas (modules) into sysrepo in a batch. Deferred until there are no connections!
+ * All the modules are parsed in a single context and scheduled for installation at once, so it is considerably
+ * faster than installing them one by one. Modules that are already installed (in the same revision) are skipped,
+ * if any other of them fails to be installed, none of them is scheduled.
+ *
+ * @param[in] conn Connection to use.
+ * @param[in] schema_paths NULL-terminated array of paths to the new schemas. Can have either YANG or YIN extension/format.
+ * @param[in] search_dirs Optional search directories for import schemas, supports the format `<dir>[:<dir>]*`.
+ * @param[in] features Optional array of enabled features for every schema in @p schema_paths, each one
+ * a NULL-terminated array of feature names or NULL.
+ * @return Error code (::SR_ERR_OK on success, ::SR_ERR_EXISTS if all the modules are already installed).
+ */
+int sr_install_modules(sr_conn_ctx_t *conn, const char **schema_paths, const char *search_dirs, const char ***features);
+
 /**
  * @brief Set newly installed module startup and running data. It is necessary in case empty data are not valid
  * for the particular schema (module).
@@ -954,6 +1028,23 @@ int sr_move_item(sr_session_ctx_t *session, const char *path, const sr_move_posi
  */
 int sr_edit_batch(sr_session_ctx_t *session, const struct lyd_node *edit, const char *default_operation);
 
+/**
+ * @brief Provide serialized edit data to be applied. Same as ::sr_edit_batch() but the data are parsed
+ * directly into the session edit so no tree duplication is needed. Can be used with any format
+ * including binary ::LYD_LYB, which is the most efficient to parse.
+ * These changes are applied only after calling ::sr_apply_changes.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] data Edit data to parse. Set only if @p data_path is not set.
+ * @param[in] data_path Path to a file with edit data. Set only if @p data is not set.
+ * @param[in] format Format of the edit data.
+ * @param[in] default_operation Default operation for nodes without operation on themselves or any parent.
+ * Possible values are `merge`, `replace`, or `none` (see [NETCONF RFC](https://tools.ietf.org/html/rfc6241#page-39)).
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_edit_batch_data(sr_session_ctx_t *session, const char *data, const char *data_path, LYD_FORMAT format,
+        const char *default_operation);
+
 /**
  * @brief Perform the validation a datastore and any changes made in the current session, but do not
  * apply nor discard them.
@@ -1022,6 +1113,27 @@ int sr_discard_changes(sr_session_ctx_t *session);
 int sr_replace_config(sr_session_ctx_t *session, const char *module_name, struct lyd_node *src_config,
         uint32_t timeout_ms, int wait);
 
+/**
+ * @brief Replace a datastore with serialized data. Same as ::sr_replace_config() but the data are parsed
+ * by sysrepo so the application does not need to create any data tree. Can be used with any format
+ * including binary ::LYD_LYB, which is the most efficient to parse.
+ *
+ * Required WRITE access.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific - target datastore) to use.
+ * @param[in] module_name If specified, limits the replace operation only to this module.
+ * @param[in] data Source data to parse. Set only if @p data_path is not set.
+ * @param[in] data_path Path to a file with source data. Set only if @p data is not set.
+ * @param[in] format Format of the source data.
+ * @param[in] timeout_ms Configuration callback timeout in milliseconds. If 0, default is used.
+ * @param[in] wait Whether to wait until all callbacks on all events are finished (even ::SR_EV_DONE or ::SR_EV_ABORT).
+ * If not set, these events may not yet be processed after the function returns. Note that all ::SR_EV_CHANGE events
+ * are always waited for.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_replace_config_data(sr_session_ctx_t *session, const char *module_name, const char *data, const char *data_path,
+        LYD_FORMAT format, uint32_t timeout_ms, int wait);
+
 /**
  * @brief Replaces a conventional datastore with the contents of
  * another conventional datastore. If the module is specified, limits
@@ -1191,6 +1303,15 @@ typedef enum sr_subscr_flag_e {
      */
     SR_SUBSCR_OPER_MERGE = 128,
 
+    /**
+     * @brief The subscriber is able to handle several RPC/action requests at the same time. All the concurrent
+     * subscriptions of an RPC/action form a pool and every request is handled by exactly one of them so that
+     * several requests can be outstanding at once, each subscription context handles its requests in its own
+     * thread. Priorities of concurrent subscriptions are ignored and they cannot be combined with standard
+     * subscriptions of the same RPC/action. Accepted only for RPC/action subscriptions.
+     */
+    SR_SUBSCR_CONCURRENT = 256,
+
 } sr_subscr_flag_t;
 
 /**
@@ -1343,6 +1464,39 @@ int sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_nam
         sr_module_change_cb callback, void *private_data, uint32_t priority, sr_subscr_options_t opts,
         sr_subscription_ctx_t **subscription);
 
+/**
+ * @brief Structure describing one module change subscription of a batch, see ::sr_module_change_subscribe_batch.
+ */
+typedef struct sr_module_change_subscr_s {
+    const char *module_name;        /**< Name of the module of interest for change notifications. */
+    const char *xpath;              /**< Optional [XPath](@ref paths) further filtering the changes. */
+    sr_module_change_cb callback;   /**< Callback to be called when the change in the datastore occurs. */
+    void *private_data;             /**< Private context passed to the callback function, opaque to sysrepo. */
+    uint32_t priority;              /**< Order in which the callbacks (**within module**) will be called. */
+} sr_module_change_subscr_t;
+
+/**
+ * @brief Subscribe for changes made in several modules or with several XPaths at once. The result is the same
+ * as calling ::sr_module_change_subscribe for each of the subscriptions but sysrepo state is updated only once
+ * and, with ::SR_SUBSCR_ENABLED, the current running data are loaded only once for all the subscriptions.
+ *
+ * If any of the subscriptions fails, none of them are created. With ::SR_SUBSCR_ENABLED, if any callback fails
+ * the ::SR_EV_ENABLED event, the callbacks that already succeeded get an ::SR_EV_ABORT event with the reversed changes.
+ *
+ * Required WRITE access for all the modules. If ::SR_SUBSCR_PASSIVE is set, required READ access.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use.
+ * @param[in] subscrs Array of subscriptions to create.
+ * @param[in] subscr_count Count of @p subscrs.
+ * @param[in] opts Options overriding default behavior of all the subscriptions, it is supposed to be
+ * a bitwise OR-ed value of any ::sr_subscr_flag_t flags.
+ * @param[in,out] subscription Subscription context that is supposed to be released by ::sr_unsubscribe.
+ * @note An existing context may be passed in case that ::SR_SUBSCR_CTX_REUSE option is specified.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_module_change_subscribe_batch(sr_session_ctx_t *session, const sr_module_change_subscr_t *subscrs,
+        uint32_t subscr_count, sr_subscr_options_t opts, sr_subscription_ctx_t **subscription);
+
 /**
  * @brief Create an iterator for retrieving the changes (list of newly added / removed / modified nodes)
  * in module-change callbacks. It __cannot__ be used outside the callback.
@@ -1558,6 +1712,129 @@ int sr_rpc_send_tree(sr_session_ctx_t *session, struct lyd_node *input, uint32_t
 
 /** @} rpcsubs */
 
+////////////////////////////////////////////////////////////////////////////////
+// Asynchronous Requests API
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @defgroup async_api Asynchronous Requests API
+ * @{
+ *
+ * Requests are performed in the background while the caller continues its work. Every request provides
+ * a file descriptor that becomes readable once the request is finished so it can be polled for together
+ * with any other file descriptors, which allows a single thread to have many requests in flight.
+ * Finished requests must always be collected by ::sr_async_finish.
+ *
+ * The requests are performed by a pool of worker threads of the connection, each with its own session.
+ * Workers are started on demand up to a fixed maximum, any more requests wait queued until a worker
+ * is available. A worker performs one request at a time so RPCs/actions with blocking callbacks, which
+ * depend on other requests being performed concurrently, may not exceed the number of workers.
+ */
+
+/**
+ * @brief Sysrepo asynchronous request.
+ */
+typedef struct sr_async_s sr_async_t;
+
+/**
+ * @brief Send an RPC/action without waiting for the result, ::sr_rpc_send_tree is performed in the background.
+ *
+ * Required READ access.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use, must not be stopped before
+ * the request is finished.
+ * @param[in] input Input data tree, it is duplicated.
+ * @param[in] timeout_ms RPC/action callback timeout in milliseconds. If 0, default is used.
+ * @param[out] request Created request, use ::sr_async_finish to get the output data tree.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_rpc_send_tree_async(sr_session_ctx_t *session, const struct lyd_node *input, uint32_t timeout_ms,
+        sr_async_t **request);
+
+/**
+ * @brief Callback to be called when an RPC/action sent by ::sr_rpc_send_async is finished.
+ *
+ * @param[in] session Internal session the RPC/action was sent on, ::sr_get_error can be used on it. It belongs
+ * to the thread calling the callback and can be used for sending more requests, but it must not be stopped.
+ * The connection must not be disconnected from the callback.
+ * @param[in] err_code Error code of the RPC/action (::SR_ERR_OK on success).
+ * @param[in] output Output data tree, NULL on error. It is freed once the callback returns.
+ * @param[in] private_data Private context opaque to sysrepo, as passed to ::sr_rpc_send_async call.
+ */
+typedef void (*sr_rpc_async_cb)(sr_session_ctx_t *session, int err_code, const struct lyd_node *output,
+        void *private_data);
+
+/**
+ * @brief Send an RPC/action without waiting for the result, which is passed to a completion callback.
+ * Any number of RPCs/actions may be outstanding at once but only a limited number of them is sent in parallel
+ * by the connection workers, the rest is queued. If the RPC/action has ::SR_SUBSCR_CONCURRENT subscribers, the sent
+ * ones are handled in parallel.
+ *
+ * Required READ access.
+ *
+ * @param[in] session Session (not [DS](@ref sr_datastore_t)-specific) to use, must not be stopped before
+ * the callback is called.
+ * @param[in] input Input data tree, it is duplicated.
+ * @param[in] timeout_ms RPC/action callback timeout in milliseconds. If 0, default is used.
+ * @param[in] callback Callback called from another thread once the RPC/action is finished.
+ * @param[in] private_data Private context passed to the callback function, opaque to sysrepo.
+ * @return Error code (::SR_ERR_OK on success), the callback is not called on error.
+ */
+int sr_rpc_send_async(sr_session_ctx_t *session, const struct lyd_node *input, uint32_t timeout_ms,
+        sr_rpc_async_cb callback, void *private_data);
+
+/**
+ * @brief Retrieve a tree whose root nodes match the provided XPath without waiting for the result,
+ * ::sr_get_data is performed in the background.
+ *
+ * Required READ access, but if the access check fails, the module data are simply ignored without an error.
+ *
+ * @note Changes prepared in the session are not considered.
+ *
+ * @param[in] session Session ([DS](@ref sr_datastore_t)-specific) to use, must not be stopped before
+ * the request is finished.
+ * @param[in] xpath [XPath](@ref paths) selecting root nodes of subtrees to be retrieved.
+ * @param[in] max_depth Maximum depth of the selected subtrees. 0 is unlimited, 1 will not return any
+ * descendant nodes. If a list should be returned, its keys are always returned as well.
+ * @param[in] timeout_ms Operational callback timeout in milliseconds. If 0, default is used.
+ * @param[in] opts Options overriding default get behaviour.
+ * @param[out] request Created request, use ::sr_async_finish to get the retrieved data.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_get_data_async(sr_session_ctx_t *session, const char *xpath, uint32_t max_depth, uint32_t timeout_ms,
+        const sr_get_oper_options_t opts, sr_async_t **request);
+
+/**
+ * @brief Get the file descriptor of a request. It becomes readable (POLLIN) once the request is finished.
+ * Nothing should be read from it.
+ *
+ * @param[in] request Request to use.
+ * @param[out] fd File descriptor of the request.
+ * @return Error code (::SR_ERR_OK on success).
+ */
+int sr_async_get_fd(sr_async_t *request, int *fd);
+
+/**
+ * @brief Check whether a request is finished without blocking.
+ *
+ * @param[in] request Request to check.
+ * @return Non-zero if the request is finished, 0 if it is still being performed.
+ */
+int sr_async_is_done(sr_async_t *request);
+
+/**
+ * @brief Wait for a request to finish, if it is not already, and free it.
+ * Any error of the request is stored in the session it was created on.
+ *
+ * @param[in] request Request to finish, is freed.
+ * @param[out] data Optional result data tree (RPC/action output or retrieved data), should be freed
+ * by the caller. If not set, the data are freed.
+ * @return Error code of the request (::SR_ERR_OK on success).
+ */
+int sr_async_finish(sr_async_t *request, struct lyd_node **data);
+
+/** @} async_api */
+
 ////////////////////////////////////////////////////////////////////////////////
 // Notifications API
 ////////////////////////////////////////////////////////////////////////////////
@@ -1767,6 +2044,13 @@ int sr_oper_get_items_subscribe(sr_session_ctx_t *session, const char *module_na
  */
 #define SRP_CLEANUP_CB  "sr_plugin_cleanup_cb"
 
+/**
+ * @brief Sysrepo plugin dependencies variable name that may optionally exist in a plugin. It must be
+ * a NULL-terminated array of strings (`const char *sr_plugin_deps[]`) with the names of the plugins
+ * that must be initialized before this plugin. Plugin name is its file name without the ".so" suffix.
+ */
+#define SRP_DEPS        "sr_plugin_deps"
+
 /**
  * @brief Sysrepo plugin initialization callback.
  *
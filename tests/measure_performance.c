@@ -30,6 +30,7 @@
 #include <setjmp.h>
 #include <cmocka.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include <libyang/libyang.h>
 
 #include "tests/config.h"
@@ -46,6 +47,21 @@
 /**@brief constant for commit operation */
 #define OP_COUNT_COMMIT 1000
 
+/**@brief used with the huge data file */
+#define OP_COUNT_HUGE 20
+
+/**@brief constant for scheduling module installation */
+#define OP_COUNT_INSTALL 50
+
+/**@brief used with the boot datastore */
+#define OP_COUNT_BOOT 5
+
+/**@brief approximate size of the whole boot datastore (MB) */
+#define BOOT_DATASTORE_SIZE 500
+
+/**@brief length of every string value in the boot datastore */
+#define BOOT_VALUE_LEN 1024
+
 #define TEST_SCHEMA_SEARCH_DIR "/home/vasko/Documents/sysrepo/build/repository/yang/"
 #define TEST_DATA_PREFIX "/dev/shm/sr_"
 #define SR_RUNNING_FILE_EXT ".running"
@@ -606,6 +622,55 @@ perf_get_ietf_intefaces_tree_test(void **state, int op_num, int *items)
     *items = total_cnt;
 }
 
+static void
+perf_get_data_depth_test(void **state, int op_num, int *items, sr_datastore_t ds, uint32_t max_depth)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+
+    sr_session_ctx_t *session = NULL;
+    struct lyd_node *trees = NULL;
+    size_t count = 0;
+    int rc = 0;
+
+    /* start a session */
+    rc = sr_session_start(conn, ds, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* perform a depth-limited get-data request */
+    for (int i = 0; i<op_num; i++){
+        rc = sr_get_data(session, "/example-module:container/list", max_depth, 0, 0, &trees);
+        assert_int_equal(SR_ERR_OK, rc);
+        if (0 == i) {
+            count = get_nodes_cnt(trees);
+        }
+        lyd_free_withsiblings(trees);
+    }
+
+    /* stop the session */
+    rc = sr_session_stop(session);
+    assert_int_equal(rc, SR_ERR_OK);
+    *items = count;
+}
+
+static void
+perf_get_data_depth1_test(void **state, int op_num, int *items)
+{
+    perf_get_data_depth_test(state, op_num, items, SR_DS_RUNNING, 1);
+}
+
+static void
+perf_get_data_depth_all_test(void **state, int op_num, int *items)
+{
+    perf_get_data_depth_test(state, op_num, items, SR_DS_RUNNING, 0);
+}
+
+static void
+perf_get_data_depth1_oper_test(void **state, int op_num, int *items)
+{
+    perf_get_data_depth_test(state, op_num, items, SR_DS_OPERATIONAL, 1);
+}
+
 static void
 perf_set_delete_test(void **state, int op_num, int *items)
 {
@@ -726,6 +791,37 @@ perf_commit_test(void **state, int op_num, int *items)
     *items = 1;
 }
 
+static void
+perf_commit_other_module_test(void **state, int op_num, int *items)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    sr_session_ctx_t *session = NULL;
+    char buf[4];
+    int rc = 0;
+
+    /* start a session */
+    rc = sr_session_start(conn, SR_DS_RUNNING, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* perform edit of the large module without any actual change and a change of a small module, commit request */
+    for (int i = 0; i<op_num; i++){
+        rc = sr_set_item_str(session, "/example-module:container/list[key1='key1'][key2='key2']/leaf", "Leaf value",
+                NULL, SR_EDIT_DEFAULT);
+        assert_int_equal(rc, SR_ERR_OK);
+        snprintf(buf, sizeof buf, "%d", i % 256);
+        rc = sr_set_item_str(session, "/referenced-data:magic_number", buf, NULL, SR_EDIT_DEFAULT);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_apply_changes(session, 0, 0);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+
+    /* stop the session */
+    rc = sr_session_stop(session);
+    assert_int_equal(rc, SR_ERR_OK);
+    *items = 1;
+}
+
 static int
 test_rpc_cb(sr_session_ctx_t *session, const char *op_path, const sr_val_t *input, const size_t input_cnt,
         sr_event_t event, uint32_t request_id, sr_val_t **output, size_t *output_cnt, void *private_data)
@@ -815,6 +911,141 @@ perf_rpc_test(void **state, int op_num, int *items)
     *items = 1;
 }
 
+struct rpc_async_state {
+    struct lyd_node *input;
+    int to_send;
+    int in_flight;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+static void
+test_rpc_async_cb(sr_session_ctx_t *session, int err_code, const struct lyd_node *output, void *private_data)
+{
+    struct rpc_async_state *st = private_data;
+    int rc, resend = 0;
+
+    assert_int_equal(err_code, SR_ERR_OK);
+    assert_non_null(output);
+
+    pthread_mutex_lock(&st->lock);
+    if (st->to_send) {
+        --st->to_send;
+        resend = 1;
+    } else {
+        --st->in_flight;
+        pthread_cond_broadcast(&st->cond);
+    }
+    pthread_mutex_unlock(&st->lock);
+
+    if (resend) {
+        /* keep the pipeline full, use the session of this callback thread */
+        rc = sr_rpc_send_async(session, st->input, 0, test_rpc_async_cb, st);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+}
+
+static void
+perf_rpc_concurrent_test(void **state, int op_num, int *items, int callers)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    sr_session_ctx_t *session = NULL;
+    sr_subscription_ctx_t *subscription[32] = { NULL };
+    struct rpc_async_state st;
+    int i, rc = 0;
+
+    assert_true(callers <= 32);
+
+    /* start a session */
+    rc = sr_session_start(conn, SR_DS_RUNNING, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* subscribe a handler for every caller, each with its own thread */
+    for (i = 0; i < callers; ++i) {
+        rc = sr_rpc_subscribe(session, "/test-module:activate-software-image", test_rpc_cb, NULL, 0,
+                SR_SUBSCR_CONCURRENT, &subscription[i]);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+
+    /* subscribe to a default leaf so that it is present in operational */
+    rc = sr_module_change_subscribe(session, "test-module", "/test-module:top-level-default", test_dummy_cb, NULL, 0,
+            SR_SUBSCR_CTX_REUSE, &subscription[0]);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    st.input = lyd_new_path(NULL, sr_get_context(conn), "/test-module:activate-software-image/image-name",
+            "acmefw-2.3", 0, 0);
+    assert_non_null(st.input);
+    st.to_send = op_num - callers;
+    st.in_flight = callers;
+    pthread_mutex_init(&st.lock, NULL);
+    pthread_cond_init(&st.cond, NULL);
+
+    /* send the first RPCs, every completion sends another one */
+    for (i = 0; i < callers; ++i) {
+        rc = sr_rpc_send_async(session, st.input, 0, test_rpc_async_cb, &st);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+
+    /* wait for all the RPCs to finish */
+    pthread_mutex_lock(&st.lock);
+    while (st.in_flight) {
+        pthread_cond_wait(&st.cond, &st.lock);
+    }
+    pthread_mutex_unlock(&st.lock);
+
+    pthread_cond_destroy(&st.cond);
+    pthread_mutex_destroy(&st.lock);
+    lyd_free_withsiblings(st.input);
+
+    /* unsubscribe from RPCs */
+    for (i = 0; i < callers; ++i) {
+        rc = sr_unsubscribe(subscription[i]);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+
+    /* stop the session */
+    rc = sr_session_stop(session);
+    assert_int_equal(rc, SR_ERR_OK);
+    *items = 1;
+}
+
+static void
+perf_rpc_concurrent_1_test(void **state, int op_num, int *items)
+{
+    perf_rpc_concurrent_test(state, op_num, items, 1);
+}
+
+static void
+perf_rpc_concurrent_2_test(void **state, int op_num, int *items)
+{
+    perf_rpc_concurrent_test(state, op_num, items, 2);
+}
+
+static void
+perf_rpc_concurrent_4_test(void **state, int op_num, int *items)
+{
+    perf_rpc_concurrent_test(state, op_num, items, 4);
+}
+
+static void
+perf_rpc_concurrent_8_test(void **state, int op_num, int *items)
+{
+    perf_rpc_concurrent_test(state, op_num, items, 8);
+}
+
+static void
+perf_rpc_concurrent_16_test(void **state, int op_num, int *items)
+{
+    perf_rpc_concurrent_test(state, op_num, items, 16);
+}
+
+static void
+perf_rpc_concurrent_32_test(void **state, int op_num, int *items)
+{
+    perf_rpc_concurrent_test(state, op_num, items, 32);
+}
+
 static void
 test_event_notif_link_discovery_cb(sr_session_ctx_t *session, const sr_ev_notif_type_t notif_type, const char *path,
         const sr_val_t *values, const size_t values_cnt, time_t timestamp, void *private_data)
@@ -946,6 +1177,151 @@ perf_libyang_get_all_list(void **state, int op_num, int *items)
 
 }
 
+static const char *perf_install_schemas[] = {
+    TESTS_DIR "/files/simple.yang",
+    TESTS_DIR "/files/decimal.yang",
+    TESTS_DIR "/files/defaults.yang",
+    TESTS_DIR "/files/when1.yang",
+    TESTS_DIR "/files/list-case.yang",
+    TESTS_DIR "/files/mixed-config.yang",
+    TESTS_DIR "/files/t-types.yang",
+    TESTS_DIR "/files/act.yang",
+    NULL
+};
+
+static const char *perf_install_names[] = {
+    "simple", "decimal", "defaults", "when1", "list-case", "mixed-config", "t-types", "act", NULL
+};
+
+static void
+perf_install_unschedule(sr_conn_ctx_t *conn)
+{
+    int rc;
+
+    for (int j = 0; perf_install_names[j]; j++) {
+        rc = sr_remove_module(conn, perf_install_names[j]);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+}
+
+static void
+perf_install_modules_single_test(void **state, int op_num, int *items)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    int rc, j;
+
+    /* schedule installation of the modules one by one and unschedule them */
+    for (int i = 0; i < op_num; i++) {
+        for (j = 0; perf_install_schemas[j]; j++) {
+            rc = sr_install_module(conn, perf_install_schemas[j], TESTS_DIR "/files", NULL, 0);
+            assert_int_equal(rc, SR_ERR_OK);
+        }
+        perf_install_unschedule(conn);
+    }
+
+    for (j = 0; perf_install_schemas[j]; j++) {}
+    *items = j;
+}
+
+static void
+perf_install_modules_batch_test(void **state, int op_num, int *items)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    int rc, j;
+
+    /* schedule installation of all the modules at once and unschedule them */
+    for (int i = 0; i < op_num; i++) {
+        rc = sr_install_modules(conn, perf_install_schemas, TESTS_DIR "/files", NULL);
+        assert_int_equal(rc, SR_ERR_OK);
+        perf_install_unschedule(conn);
+    }
+
+    for (j = 0; perf_install_schemas[j]; j++) {}
+    *items = j;
+}
+
+static void
+perf_subscribe_churn_test(void **state, int op_num, int *items)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    sr_session_ctx_t *session = NULL;
+    sr_subscription_ctx_t *subscription = NULL, *churn_sub;
+    char xpath[128];
+    int rc;
+
+    /* start a session */
+    rc = sr_session_start(conn, SR_DS_RUNNING, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* keep one subscription of every kind for the whole test */
+    rc = sr_module_change_subscribe(session, "test-module", NULL, test_dummy_cb, NULL, 0, SR_SUBSCR_NO_THREAD,
+            &subscription);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_rpc_subscribe(session, "/test-module:activate-software-image", test_rpc_cb, NULL, 0,
+            SR_SUBSCR_NO_THREAD | SR_SUBSCR_CTX_REUSE, &subscription);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* subscribe and unsubscribe with xpaths of varying lengths */
+    for (int i = 0; i < op_num; i++) {
+        churn_sub = NULL;
+        snprintf(xpath, sizeof xpath, "/test-module:list[key='%0*d']", i % 32 + 1, i);
+
+        rc = sr_module_change_subscribe(session, "test-module", xpath, test_dummy_cb, NULL, 0, SR_SUBSCR_NO_THREAD,
+                &churn_sub);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_oper_get_items_subscribe(session, "ietf-interfaces", "/ietf-interfaces:interfaces-state/interface",
+                data_provide_cb, NULL, SR_SUBSCR_NO_THREAD | SR_SUBSCR_CTX_REUSE, &churn_sub);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_rpc_subscribe(session, "/test-module:activate-software-image", test_rpc_cb, NULL, 1,
+                SR_SUBSCR_NO_THREAD | SR_SUBSCR_CTX_REUSE, &churn_sub);
+        assert_int_equal(rc, SR_ERR_OK);
+
+        rc = sr_unsubscribe(churn_sub);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+
+    /* unsubscribe */
+    rc = sr_unsubscribe(subscription);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* stop the session */
+    rc = sr_session_stop(session);
+    assert_int_equal(rc, SR_ERR_OK);
+    *items = 3;
+}
+
+static void
+perf_boot_load_test(void **state, int op_num, int *items)
+{
+    sr_conn_ctx_t *conn = *state, *boot_conn;
+    assert_non_null(conn);
+    sr_session_ctx_t *session = NULL;
+    struct lyd_node *trees = NULL;
+    size_t count = 0;
+    int rc;
+
+    /* every new connection without a cache has to parse the whole datastore */
+    for (int i = 0; i < op_num; i++) {
+        rc = sr_connect(0, &boot_conn);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_session_start(boot_conn, SR_DS_RUNNING, &session);
+        assert_int_equal(rc, SR_ERR_OK);
+
+        rc = sr_get_data(session, "/*", 0, 0, 0, &trees);
+        assert_int_equal(rc, SR_ERR_OK);
+        if (0 == i) {
+            count = get_nodes_cnt(trees);
+        }
+        lyd_free_withsiblings(trees);
+
+        sr_disconnect(boot_conn);
+    }
+    *items = count;
+}
+
 void
 test_perf(test_t *ts, int test_count, const char *title, int selection)
 {
@@ -1059,6 +1435,56 @@ createDataTreeLargeIETFinterfacesModule(sr_session_ctx_t *sess, size_t if_count)
     assert_int_equal(SR_ERR_OK, sr_replace_config(sess, "ietf-interfaces", root, 0, 0));
 }
 
+static void
+createDataTreeBootDatastore(sr_session_ctx_t *sess, size_t size_mb)
+{
+    const struct ly_ctx *ctx = sr_get_context(sr_session_get_connection(sess));
+    const struct lys_module *ex_mod, *if_mod;
+    struct lyd_node *root, *node;
+    char value[BOOT_VALUE_LEN + 1], key[32];
+    size_t count;
+
+    ex_mod = ly_ctx_get_module(ctx, "example-module", NULL, 1);
+    assert_non_null(ex_mod);
+    if_mod = ly_ctx_get_module(ctx, "ietf-interfaces", NULL, 1);
+    assert_non_null(if_mod);
+
+    memset(value, 'v', BOOT_VALUE_LEN);
+    value[BOOT_VALUE_LEN] = '\0';
+
+    /* half of the data in every module */
+    count = (size_mb * 1024 * 1024) / 2 / BOOT_VALUE_LEN;
+
+    /* example-module lists with long values */
+    root = lyd_new(NULL, ex_mod, "container");
+    assert_non_null(root);
+    for (size_t i = 0; i < count; i++) {
+        node = lyd_new(root, NULL, "list");
+        assert_non_null(node);
+        snprintf(key, sizeof key, "k1%zu", i);
+        assert_non_null(lyd_new_leaf(node, NULL, "key1", key));
+        snprintf(key, sizeof key, "k2%zu", i);
+        assert_non_null(lyd_new_leaf(node, NULL, "key2", key));
+        assert_non_null(lyd_new_leaf(node, NULL, "leaf", value));
+    }
+    assert_int_equal(0, lyd_validate(&root, LYD_OPT_STRICT | LYD_OPT_CONFIG, NULL));
+    assert_int_equal(SR_ERR_OK, sr_replace_config(sess, "example-module", root, 0, 0));
+
+    /* ietf-interfaces interfaces with long descriptions */
+    root = lyd_new(NULL, if_mod, "interfaces");
+    assert_non_null(root);
+    for (size_t i = 0; i < count; i++) {
+        node = lyd_new(root, NULL, "interface");
+        assert_non_null(node);
+        snprintf(key, sizeof key, "eth%zu", i);
+        assert_non_null(lyd_new_leaf(node, NULL, "name", key));
+        assert_non_null(lyd_new_leaf(node, NULL, "type", "iana-if-type:ethernetCsmacd"));
+        assert_non_null(lyd_new_leaf(node, NULL, "description", value));
+    }
+    assert_int_equal(0, lyd_validate(&root, LYD_OPT_STRICT | LYD_OPT_CONFIG, NULL));
+    assert_int_equal(SR_ERR_OK, sr_replace_config(sess, "ietf-interfaces", root, 0, 0));
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1073,18 +1499,45 @@ main(int argc, char **argv)
         {perf_get_subtree_with_data_load_test, "Get subtree incl session start", OP_COUNT, sysrepo_setup, sysrepo_teardown},
         {perf_get_subtrees_test, "Get subtrees all lists", OP_COUNT, sysrepo_setup, sysrepo_teardown},
         {perf_get_ietf_intefaces_tree_test, "Get subtrees ietf-if config", OP_COUNT, sysrepo_setup, sysrepo_teardown},
+        {perf_get_data_depth1_test, "Get data all lists depth 1", OP_COUNT, sysrepo_setup, sysrepo_teardown},
+        {perf_get_data_depth_all_test, "Get data all lists full depth", OP_COUNT, sysrepo_setup, sysrepo_teardown},
+        {perf_get_data_depth1_oper_test, "Get oper data all lists depth 1", OP_COUNT, sysrepo_setup, sysrepo_teardown},
         {perf_set_delete_test, "Set & delete one list", OP_COUNT, sysrepo_setup, sysrepo_teardown},
         {perf_set_delete_100_test, "Set & delete 100 lists", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
         {perf_commit_test, "Commit one leaf change", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_commit_other_module_test, "Commit other module leaf change", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
         {perf_data_provide_test, "Operational data provide", OP_COUNT_COMMIT, data_provide_setup, data_provide_teardown},
         {perf_rpc_test, "RPC", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_rpc_concurrent_1_test, "RPC async 1 caller", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_rpc_concurrent_2_test, "RPC async 2 callers", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_rpc_concurrent_4_test, "RPC async 4 callers", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_rpc_concurrent_8_test, "RPC async 8 callers", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_rpc_concurrent_16_test, "RPC async 16 callers", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_rpc_concurrent_32_test, "RPC async 32 callers", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
         {perf_ev_notification_ephemeral_test, "Event notification - ephemeral", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
         {perf_ev_notification_store_test, "Event notification - store", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
+        {perf_install_modules_single_test, "Install modules one by one", OP_COUNT_INSTALL, sysrepo_setup, sysrepo_teardown},
+        {perf_install_modules_batch_test, "Install modules in a batch", OP_COUNT_INSTALL, sysrepo_setup, sysrepo_teardown},
+        {perf_subscribe_churn_test, "Subscribe & unsubscribe", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
         {perf_libyang_get_node, "Libyang get one node", OP_COUNT, libyang_setup, libyang_teardown},
         {perf_libyang_get_all_list, "Libyang get all list", OP_COUNT, libyang_setup, libyang_teardown},
     };
 
+    test_t huge_tests[] = {
+        {perf_get_data_depth1_test, "Get data all lists depth 1", OP_COUNT_HUGE, sysrepo_setup, sysrepo_teardown},
+        {perf_get_data_depth_all_test, "Get data all lists full depth", OP_COUNT_HUGE, sysrepo_setup, sysrepo_teardown},
+        {perf_get_data_depth1_oper_test, "Get oper data all lists depth 1", OP_COUNT_HUGE, sysrepo_setup, sysrepo_teardown},
+        {perf_commit_test, "Commit one leaf change", OP_COUNT_HUGE, sysrepo_setup, sysrepo_teardown},
+        {perf_commit_other_module_test, "Commit other module leaf change", OP_COUNT_HUGE, sysrepo_setup, sysrepo_teardown},
+    };
+
+    test_t boot_tests[] = {
+        {perf_boot_load_test, "Load whole datastore", OP_COUNT_BOOT, sysrepo_setup, sysrepo_teardown},
+    };
+
     size_t test_count = sizeof(tests)/sizeof(*tests);
+    size_t huge_test_count = sizeof(huge_tests)/sizeof(*huge_tests);
+    size_t boot_test_count = sizeof(boot_tests)/sizeof(*boot_tests);
     sr_conn_ctx_t *conn = NULL;
     sr_session_ctx_t *sess;
     int rc, ret = -1, selection = -1;
@@ -1144,7 +1597,7 @@ main(int argc, char **argv)
 
     /* decrease the number of performed operation on larger file */
     for (size_t i = 0; i < test_count; i++){
-        if (OP_COUNT_COMMIT != tests[i].op_count){
+        if ((OP_COUNT_COMMIT != tests[i].op_count) && (OP_COUNT_INSTALL != tests[i].op_count)) {
             tests[i].op_count = OP_COUNT_LOW;
         }
     }
@@ -1154,6 +1607,17 @@ main(int argc, char **argv)
     createDataTreeLargeIETFinterfacesModule(sess, 100);
     instance_cnt = 100;
     test_perf(tests, test_count, "Data file with 100 list instances", selection);
+
+    if (-1 == selection) {
+        /* 100k list instances, only depth-limited data retrieval and commit latency */
+        createDataTreeLargeExampleModule(sess, 100000);
+        instance_cnt = 100000;
+        test_perf(huge_tests, huge_test_count, "Data file with 100k list instances", selection);
+
+        /* boot-time load of a huge datastore split into several modules */
+        createDataTreeBootDatastore(sess, BOOT_DATASTORE_SIZE);
+        test_perf(boot_tests, boot_test_count, "Datastore of about 500 MB", selection);
+    }
     puts("\n\n");
     ret = 0;
 
@@ -22,6 +22,9 @@
 #define _GNU_SOURCE
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <stdlib.h>
@@ -34,6 +37,7 @@
 
 #include "tests/config.h"
 #include "sysrepo.h"
+#include "common.h"
 
 struct state {
     sr_conn_ctx_t *conn;
@@ -4989,6 +4993,521 @@ test_change_userord(void **state)
     pthread_join(tid[1], NULL);
 }
 
+/* TEST */
+static int
+module_change_batch_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    sr_change_oper_t op;
+    sr_change_iter_t *iter;
+    sr_val_t *old_val, *new_val;
+    int ret;
+
+    (void)request_id;
+
+    if (!strcmp(module_name, "ietf-interfaces")) {
+        assert_null(xpath);
+    } else {
+        assert_string_equal(module_name, "test");
+    }
+
+    if ((event == SR_EV_ENABLED) && xpath) {
+        /* the current data are presented as created */
+        assert_string_equal(xpath, "/test:l1[k='batch']");
+
+        ret = sr_get_changes_iter(session, "/test:l1[k='batch']/v", &iter);
+        assert_int_equal(ret, SR_ERR_OK);
+
+        ret = sr_get_change_next(session, iter, &op, &old_val, &new_val);
+        assert_int_equal(ret, SR_ERR_OK);
+        assert_int_equal(op, SR_OP_CREATED);
+        assert_null(old_val);
+        assert_non_null(new_val);
+        assert_int_equal(new_val->data.uint8_val, 10);
+        sr_free_val(new_val);
+
+        ret = sr_get_change_next(session, iter, &op, &old_val, &new_val);
+        assert_int_equal(ret, SR_ERR_NOT_FOUND);
+        sr_free_change_iter(iter);
+    }
+
+    ++st->cb_called;
+    return SR_ERR_OK;
+}
+
+static void
+test_change_batch(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    sr_module_change_subscr_t subscrs[] = {
+        {"test", "/test:l1[k='batch']", module_change_batch_cb, st, 0},
+        {"ietf-interfaces", NULL, module_change_batch_cb, st, 0},
+        {"test", NULL, module_change_batch_cb, st, 1},
+    };
+    int count, ret;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_set_item_str(sess, "/test:l1[k='batch']/v", "10", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe to all at once, "enabled" and "done" events for each */
+    ret = sr_module_change_subscribe_batch(sess, subscrs, 3, SR_SUBSCR_ENABLED, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(st->cb_called, 6);
+
+    /* change the data, "change" and "done" event for both "test" subscriptions */
+    ret = sr_set_item_str(sess, "/test:l1[k='batch']/v", "11", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    count = 0;
+    while ((st->cb_called < 10) && (count < 1500)) {
+        usleep(10000);
+        ++count;
+    }
+    assert_int_equal(st->cb_called, 10);
+
+    sr_unsubscribe(subscr);
+
+    /* "update" subscriptions with the same priority in one batch */
+    subscr = NULL;
+    subscrs[2].priority = 0;
+    ret = sr_module_change_subscribe_batch(sess, subscrs, 3, SR_SUBSCR_UPDATE, &subscr);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+    assert_null(subscr);
+
+    /* no subscriptions were left behind, nothing is called */
+    ret = sr_delete_item(sess, "/test:l1[k='batch']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(st->cb_called, 10);
+
+    sr_session_stop(sess);
+}
+
+/* TEST */
+static int
+module_change_batch_abort_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    sr_change_oper_t op;
+    sr_change_iter_t *iter;
+    sr_val_t *old_val, *new_val;
+    int ret;
+
+    (void)xpath;
+    (void)request_id;
+
+    if (!strcmp(module_name, "ietf-interfaces")) {
+        /* the second subscription refuses its data */
+        assert_int_equal(event, SR_EV_ENABLED);
+        ++st->cb_called2;
+        return SR_ERR_UNSUPPORTED;
+    }
+
+    assert_string_equal(module_name, "test");
+    switch (st->cb_called) {
+    case 0:
+        assert_int_equal(event, SR_EV_ENABLED);
+        break;
+    case 1:
+        /* the enabled data are reverted */
+        assert_int_equal(event, SR_EV_ABORT);
+
+        ret = sr_get_changes_iter(session, "/test:l1[k='batch-abort']/v", &iter);
+        assert_int_equal(ret, SR_ERR_OK);
+
+        ret = sr_get_change_next(session, iter, &op, &old_val, &new_val);
+        assert_int_equal(ret, SR_ERR_OK);
+        assert_int_equal(op, SR_OP_DELETED);
+        assert_non_null(old_val);
+        assert_null(new_val);
+        assert_int_equal(old_val->data.uint8_val, 20);
+        sr_free_val(old_val);
+
+        ret = sr_get_change_next(session, iter, &op, &old_val, &new_val);
+        assert_int_equal(ret, SR_ERR_NOT_FOUND);
+        sr_free_change_iter(iter);
+        break;
+    default:
+        fail();
+    }
+
+    ++st->cb_called;
+    return SR_ERR_OK;
+}
+
+static void
+test_change_batch_abort(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    sr_module_change_subscr_t subscrs[] = {
+        {"test", "/test:l1[k='batch-abort']", module_change_batch_abort_cb, st, 0},
+        {"ietf-interfaces", NULL, module_change_batch_abort_cb, st, 0},
+        {"test", NULL, module_change_batch_abort_cb, st, 1},
+    };
+    int ret;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_set_item_str(sess, "/test:l1[k='batch-abort']/v", "20", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* the first subscription gets "enabled" and "abort" events, the last one is not called at all */
+    ret = sr_module_change_subscribe_batch(sess, subscrs, 3, SR_SUBSCR_ENABLED, &subscr);
+    assert_int_equal(ret, SR_ERR_CALLBACK_FAILED);
+    assert_null(subscr);
+    assert_int_equal(st->cb_called, 2);
+    assert_int_equal(st->cb_called2, 1);
+
+    ret = sr_delete_item(sess, "/test:l1[k='batch-abort']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    sr_session_stop(sess);
+}
+
+/* TEST */
+static int
+module_change_enabled_fail_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+
+    (void)session;
+    (void)xpath;
+    (void)request_id;
+
+    assert_string_equal(module_name, "test");
+
+    ++st->cb_called;
+    if (event == SR_EV_ENABLED) {
+        return SR_ERR_UNSUPPORTED;
+    }
+    return SR_ERR_OK;
+}
+
+static void
+test_change_enabled_fail(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    int ret;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* the failed "enabled" event does not fail the subscription, no "done" event */
+    ret = sr_module_change_subscribe(sess, "test", NULL, module_change_enabled_fail_cb, st, 0, SR_SUBSCR_ENABLED,
+            &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(subscr);
+    assert_int_equal(st->cb_called, 1);
+
+    /* the subscription was created, "change" and "done" events */
+    ret = sr_set_item_str(sess, "/test:l1[k='enabled-fail']/v", "30", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 1);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(st->cb_called, 3);
+    ret = sr_delete_item(sess, "/test:l1[k='enabled-fail']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 1);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(st->cb_called, 5);
+
+    sr_unsubscribe(subscr);
+    sr_session_stop(sess);
+}
+
+/* TEST */
+static int
+module_change_churn_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    (void)session;
+    (void)module_name;
+    (void)xpath;
+    (void)event;
+    (void)request_id;
+    (void)private_data;
+
+    return SR_ERR_OK;
+}
+
+/* from src/common.c */
+static size_t
+test_ext_shm_size(void)
+{
+    const char *prefix;
+    char *path;
+    struct stat st;
+    int fd;
+
+    prefix = getenv(SR_SHM_PREFIX_ENV);
+    if (!prefix) {
+        prefix = SR_SHM_PREFIX_DEFAULT;
+    }
+    assert_int_not_equal(asprintf(&path, "/%s_ext", prefix), -1);
+
+    fd = shm_open(path, O_RDONLY, 0);
+    free(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(fstat(fd, &st), 0);
+    close(fd);
+
+    return st.st_size;
+}
+
+static void
+test_change_sub_churn(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr;
+    char xpath[64];
+    size_t warm_size = 0;
+    int ret, i, j;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    for (i = 0; i < 50; ++i) {
+        /* a different number of subscriptions so that their array grows and shrinks across size classes */
+        subscr = NULL;
+        for (j = 0; j < 10 + (i % 10) * 4; ++j) {
+            sprintf(xpath, "/test:l1[k='churn%d']", j);
+            ret = sr_module_change_subscribe(sess, "test", xpath, module_change_churn_cb, NULL, 0, SR_SUBSCR_CTX_REUSE,
+                    &subscr);
+            assert_int_equal(ret, SR_ERR_OK);
+        }
+
+        /* the subscriptions are removed one by one, their array is shrunk */
+        sr_unsubscribe(subscr);
+
+        if (i == 9) {
+            /* all the subscription counts were used */
+            warm_size = test_ext_shm_size();
+        }
+    }
+
+    /* the freed blocks were merged and reused, ext SHM did not grow */
+    assert_int_equal(test_ext_shm_size(), warm_size);
+
+    sr_session_stop(sess);
+}
+
+/* TEST */
+static int
+module_change_concurrent_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, sr_event_t event,
+        uint32_t request_id, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+
+    (void)session;
+    (void)module_name;
+    (void)xpath;
+    (void)event;
+    (void)request_id;
+
+    if (st) {
+        ++st->cb_called;
+    }
+    return SR_ERR_OK;
+}
+
+static void *
+read_concurrent_thread(void *arg)
+{
+    struct state *st = (struct state *)arg;
+    sr_session_ctx_t *sess;
+    struct lyd_node *data;
+    int ret, i;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth64']/type",
+            "iana-if-type:ethernetCsmacd", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* start reading and subscribing at once */
+    pthread_barrier_wait(&st->barrier);
+
+    /* only "test" subscriptions are being changed, reading "ietf-interfaces" is not blocked by them */
+    for (i = 0; i < 100; ++i) {
+        ret = sr_get_data(sess, "/ietf-interfaces:interfaces", 0, 0, 0, &data);
+        assert_int_equal(ret, SR_ERR_OK);
+        assert_non_null(data);
+        assert_string_equal(data->schema->name, "interfaces");
+        lyd_free_withsiblings(data);
+    }
+
+    /* wait for the subscriptions to be removed */
+    pthread_barrier_wait(&st->barrier);
+
+    ret = sr_delete_item(sess, "/ietf-interfaces:interfaces", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static void *
+subscribe_concurrent_thread(void *arg)
+{
+    struct state *st = (struct state *)arg;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr;
+    int ret, i;
+
+    /* a separate connection so that it does not share any locks with the reading thread */
+    ret = sr_connect(0, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* start reading and subscribing at once */
+    pthread_barrier_wait(&st->barrier);
+
+    for (i = 0; i < 100; ++i) {
+        ret = sr_module_change_subscribe(sess, "test", NULL, module_change_concurrent_cb, NULL, 0, 0, &subscr);
+        assert_int_equal(ret, SR_ERR_OK);
+        sr_unsubscribe(subscr);
+    }
+
+    /* signal that the subscriptions were removed */
+    pthread_barrier_wait(&st->barrier);
+
+    sr_disconnect(conn);
+    return NULL;
+}
+
+static void
+test_sub_concurrent(void **state)
+{
+    pthread_t tid[2];
+
+    pthread_create(&tid[0], NULL, read_concurrent_thread, *state);
+    pthread_create(&tid[1], NULL, subscribe_concurrent_thread, *state);
+
+    pthread_join(tid[0], NULL);
+    pthread_join(tid[1], NULL);
+}
+
+/* TEST */
+static void *
+apply_ext_grow_thread(void *arg)
+{
+    struct state *st = (struct state *)arg;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr;
+    int ret, i;
+
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_module_change_subscribe(sess, "ietf-interfaces", NULL, module_change_concurrent_cb, st, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* start applying changes and subscribing at once */
+    pthread_barrier_wait(&st->barrier);
+
+    /* both this thread and the subscription thread use ext SHM of the connection while it is being remapped */
+    for (i = 0; i < 20; ++i) {
+        if (i % 2) {
+            ret = sr_delete_item(sess, "/ietf-interfaces:interfaces/interface[name='eth64']", 0);
+        } else {
+            ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth64']/type",
+                    "iana-if-type:ethernetCsmacd", NULL, 0);
+        }
+        assert_int_equal(ret, SR_ERR_OK);
+        ret = sr_apply_changes(sess, 0, 1);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+
+    /* change and done events */
+    assert_int_equal(st->cb_called, 40);
+
+    /* wait for the other thread to finish */
+    pthread_barrier_wait(&st->barrier);
+
+    sr_unsubscribe(subscr);
+    sr_session_stop(sess);
+    return NULL;
+}
+
+static void *
+subscribe_ext_grow_thread(void *arg)
+{
+    struct state *st = (struct state *)arg;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr = NULL;
+    char xpath[64];
+    size_t size;
+    int ret, i;
+
+    /* another connection makes ext SHM grow, the mapping of the first connection is left behind */
+    ret = sr_connect(0, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    size = test_ext_shm_size();
+
+    /* start applying changes and subscribing at once */
+    pthread_barrier_wait(&st->barrier);
+
+    for (i = 0; i < 500; ++i) {
+        sprintf(xpath, "/test:l1[k='grow%d']", i);
+        ret = sr_module_change_subscribe(sess, "test", xpath, module_change_concurrent_cb, NULL, 0, SR_SUBSCR_CTX_REUSE,
+                &subscr);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+    assert_true(test_ext_shm_size() > size);
+
+    /* signal that we have finished subscribing */
+    pthread_barrier_wait(&st->barrier);
+
+    sr_unsubscribe(subscr);
+    sr_disconnect(conn);
+    return NULL;
+}
+
+static void
+test_sub_ext_grow(void **state)
+{
+    pthread_t tid[2];
+
+    pthread_create(&tid[0], NULL, apply_ext_grow_thread, *state);
+    pthread_create(&tid[1], NULL, subscribe_ext_grow_thread, *state);
+
+    pthread_join(tid[0], NULL);
+    pthread_join(tid[1], NULL);
+}
+
 /* MAIN */
 int
 main(void)
@@ -5008,6 +5527,12 @@ main(void)
         cmocka_unit_test_setup_teardown(test_change_timeout, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_change_order, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_change_userord, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_change_batch, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_change_batch_abort, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_change_enabled_fail, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_change_sub_churn, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_sub_concurrent, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_sub_ext_grow, setup_f, teardown_f),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
@@ -743,6 +743,70 @@ test_top_op(void **state)
     lyd_free_withsiblings(data);
 }
 
+static void
+test_data_lyb(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct ly_ctx *ly_ctx = (struct ly_ctx *)sr_get_context(st->conn);
+    struct lyd_node *data;
+    char *lyb, *str;
+    const char *str2;
+    int ret;
+
+    /* create an edit and print it in LYB */
+    str2 =
+    "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+        "<interface>"
+            "<name>eth66</name>"
+            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+        "</interface>"
+    "</interfaces>";
+    data = lyd_parse_mem(ly_ctx, str2, LYD_XML, LYD_OPT_EDIT | LYD_OPT_STRICT);
+    assert_non_null(data);
+    ret = lyd_print_mem(&lyb, data, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    lyd_free_withsiblings(data);
+
+    /* apply it as an edit */
+    ret = sr_edit_batch_data(st->sess, lyb, NULL, LYD_LYB, "merge");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_edit_batch_data(st->sess, lyb, NULL, LYD_LYB, "merge");
+    assert_int_equal(ret, SR_ERR_UNSUPPORTED);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* check datastore contents */
+    ret = sr_get_subtree(st->sess, "/ietf-interfaces:interfaces", 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_print_mem(&str, data, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_free_withsiblings(data);
+
+    assert_string_equal(str, str2);
+    free(str);
+
+    /* replace the whole module with the same LYB data */
+    ret = sr_delete_item(st->sess, "/ietf-interfaces:interfaces", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_replace_config_data(st->sess, "ietf-interfaces", lyb, NULL, LYD_LYB, 0, 0);
+    free(lyb);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* check datastore contents */
+    ret = sr_get_subtree(st->sess, "/ietf-interfaces:interfaces", 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_print_mem(&str, data, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_free_withsiblings(data);
+
+    assert_string_equal(str, str2);
+    free(str);
+
+    /* invalid data */
+    ret = sr_replace_config_data(st->sess, "ietf-interfaces", "<interfaces", NULL, LYD_XML, 0, 0);
+    assert_int_equal(ret, SR_ERR_LY);
+}
+
 static void
 test_union(void **state)
 {
@@ -1174,6 +1238,7 @@ main(void)
         cmocka_unit_test_teardown(test_isolate, clear_interfaces),
         cmocka_unit_test(test_purge),
         cmocka_unit_test(test_top_op),
+        cmocka_unit_test_teardown(test_data_lyb, clear_interfaces),
         cmocka_unit_test_teardown(test_union, clear_test),
         cmocka_unit_test(test_decimal64),
         cmocka_unit_test(test_mutiple_types),
@@ -154,6 +154,79 @@ test_cached_datastore(void **state)
     assert_int_equal(ret, SR_ERR_OK);
 }
 
+/* TEST */
+static void
+test_cached_update(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn2;
+    sr_session_ctx_t *sess2;
+    sr_val_t *values;
+    size_t count;
+    int ret;
+
+    /* cache current data */
+    ret = sr_get_items(st->sess, "/simple:ac1/acl1", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(count, 0);
+
+    ret = sr_connect(0, &conn2);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn2, SR_DS_RUNNING, &sess2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* change data in another connection, cached data are one version behind */
+    ret = sr_set_item_str(sess2, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess2, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_items(st->sess, "/simple:ac1/acl1", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(count, 1);
+    assert_string_equal(values[0].xpath, "/simple:ac1/acl1[acs1='a']");
+    sr_free_values(values, count);
+
+    /* change data twice, cached data are two versions behind */
+    ret = sr_set_item_str(sess2, "/simple:ac1/acl1[acs1='b']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess2, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_delete_item(sess2, "/simple:ac1/acl1[acs1='a']", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess2, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_items(st->sess, "/simple:ac1/acl1", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(count, 1);
+    assert_string_equal(values[0].xpath, "/simple:ac1/acl1[acs1='b']");
+    sr_free_values(values, count);
+
+    /* change data in the caching connection */
+    ret = sr_set_item_str(st->sess, "/simple:ac1/acl1[acs1='c']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_items(st->sess, "/simple:ac1/acl1", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(count, 2);
+    sr_free_values(values, count);
+
+    /* remove all data in another connection */
+    ret = sr_delete_item(sess2, "/simple:ac1", 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess2, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_items(st->sess, "/simple:ac1/acl1", 0, 0, &values, &count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(count, 0);
+
+    sr_disconnect(conn2);
+}
+
 /* TEST */
 static int
 enable_cached_get_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, sr_event_t event,
@@ -287,6 +360,7 @@ main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_cached_datastore, setup_cached_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_cached_update, setup_cached_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_enable_cached_get, setup_cached_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_no_read_access, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_no_read_access, setup_cached_f, teardown_f),
@@ -5,7 +5,7 @@
  *
  * @copyright
  * Copyright 2018 Deutsche Telekom AG.
- * Copyright 2018 - 2019 CESNET, z.s.p.o.
+ * Copyright 2018 - 2020 CESNET, z.s.p.o.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -29,6 +29,7 @@
 #include <ctype.h>
 #include <pwd.h>
 #include <grp.h>
+#include <sys/stat.h>
 
 #include <cmocka.h>
 #include <libyang/libyang.h>
@@ -463,6 +464,61 @@ test_inv_deps(void **state)
     );
 }
 
+static void
+test_install_modules(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const struct lys_module *ly_mod;
+    const char *schema_paths[] = {
+        TESTS_DIR "/files/test.yang",
+        TESTS_DIR "/files/features.yang",
+        TESTS_DIR "/files/simple.yang",
+        NULL
+    };
+    const char *feats[] = {"feat1", NULL}, *bad_feats[] = {"no-feat", NULL};
+    const char **features[] = {NULL, feats, NULL}, **bad_features[] = {NULL, bad_feats, NULL};
+    int ret;
+    uint32_t conn_count;
+
+    /* invalid feature, nothing is scheduled */
+    ret = sr_install_modules(st->conn, schema_paths, TESTS_DIR "/files", bad_features);
+    assert_int_equal(ret, SR_ERR_NOT_FOUND);
+
+    /* install all the modules at once */
+    ret = sr_install_modules(st->conn, schema_paths, TESTS_DIR "/files", features);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* all already scheduled */
+    ret = sr_install_modules(st->conn, schema_paths, TESTS_DIR "/files", NULL);
+    assert_int_equal(ret, SR_ERR_EXISTS);
+
+    /* apply scheduled changes */
+    sr_disconnect(st->conn);
+    st->conn = NULL;
+    ret = sr_connection_count(&conn_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(conn_count, 0);
+    ret = sr_connect(0, &st->conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* check the modules */
+    ly_mod = ly_ctx_get_module(sr_get_context(st->conn), "test", NULL, 1);
+    assert_non_null(ly_mod);
+    ly_mod = ly_ctx_get_module(sr_get_context(st->conn), "simple", NULL, 1);
+    assert_non_null(ly_mod);
+    ly_mod = ly_ctx_get_module(sr_get_context(st->conn), "features", NULL, 1);
+    assert_non_null(ly_mod);
+    assert_int_equal(lys_features_state(ly_mod, "feat1"), 1);
+
+    /* cleanup */
+    ret = sr_remove_module(st->conn, "features");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_remove_module(st->conn, "simple");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_remove_module(st->conn, "test");
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
 static void
 test_remove_module(void **state)
 {
@@ -1524,6 +1580,68 @@ test_feature_dependencies_across_modules(void **state)
     assert_int_equal(ret, SR_ERR_OK);
 }
 
+static void
+test_unaffected_data(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_session_ctx_t *sess;
+    struct stat st_before, st_after;
+    char path[1024];
+    int ret;
+    uint32_t conn_count;
+
+    /* install a module */
+    ret = sr_install_module(st->conn, TESTS_DIR "/files/simple.yang", TESTS_DIR "/files", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* apply scheduled changes */
+    sr_disconnect(st->conn);
+    st->conn = NULL;
+    ret = sr_connection_count(&conn_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(conn_count, 0);
+    ret = sr_connect(0, &st->conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* store some startup data */
+    ret = sr_session_start(st->conn, SR_DS_STARTUP, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/simple:ac1/acl1[acs1='a']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess);
+
+    sprintf(path, "%s/data/simple.startup", sr_get_repo_path());
+    ret = stat(path, &st_before);
+    assert_int_equal(ret, 0);
+
+    /* install an unrelated module */
+    ret = sr_install_module(st->conn, TESTS_DIR "/files/decimal.yang", TESTS_DIR "/files", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* apply scheduled changes */
+    sr_disconnect(st->conn);
+    st->conn = NULL;
+    ret = sr_connection_count(&conn_count);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(conn_count, 0);
+    ret = sr_connect(0, &st->conn);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* data file of the first module must not have been rewritten */
+    ret = stat(path, &st_after);
+    assert_int_equal(ret, 0);
+    assert_int_equal(st_before.st_mtim.tv_sec, st_after.st_mtim.tv_sec);
+    assert_int_equal(st_before.st_mtim.tv_nsec, st_after.st_mtim.tv_nsec);
+
+    /* cleanup */
+    ret = sr_remove_module(st->conn, "decimal");
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_remove_module(st->conn, "simple");
+    assert_int_equal(ret, SR_ERR_OK);
+}
+
 int
 main(void)
 {
@@ -1532,6 +1650,7 @@ main(void)
         cmocka_unit_test_setup_teardown(test_data_deps, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_op_deps, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_inv_deps, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_install_modules, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_remove_module, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_remove_dep_module, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_remove_imp_module, setup_f, teardown_f),
@@ -1545,6 +1664,7 @@ main(void)
         cmocka_unit_test_setup_teardown(test_get_module_access, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_get_module_info, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_feature_dependencies_across_modules, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_unaffected_data, setup_f, teardown_f),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
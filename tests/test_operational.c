@@ -312,6 +312,24 @@ dummy_rpc_cb(sr_session_ctx_t *session, const char *op_path, const sr_val_t *inp
     return SR_ERR_OK;
 }
 
+static void
+test_sr_mon_free_stats(struct lyd_node *data)
+{
+    struct ly_set *set;
+    uint32_t i;
+
+    set = lyd_find_path(data, "/sysrepo-monitoring:sysrepo-state/statistics | "
+            "/sysrepo-monitoring:sysrepo-state/module/statistics");
+    assert_non_null(set);
+
+    /* global statistics and statistics of every module */
+    assert_int_equal(set->number, 20);
+    for (i = 0; i < set->number; ++i) {
+        lyd_free(set->set.d[i]);
+    }
+    ly_set_free(set);
+}
+
 static void
 test_sr_mon(void **state)
 {
@@ -327,6 +345,9 @@ test_sr_mon(void **state)
     ret = sr_get_data(st->sess, "/sysrepo-monitoring:*", 0, 0, 0, &data);
     assert_int_equal(ret, SR_ERR_OK);
 
+    /* remove statistics, they are not deterministic */
+    test_sr_mon_free_stats(data);
+
     /* check their content */
     ret = lyd_print_mem(&str1, data, LYD_XML, 0);
     assert_int_equal(ret, 0);
@@ -451,6 +472,9 @@ test_sr_mon(void **state)
     ret = sr_get_data(st->sess, "/sysrepo-monitoring:*", 0, 0, 0, &data);
     assert_int_equal(ret, SR_ERR_OK);
 
+    /* remove statistics, they are not deterministic */
+    test_sr_mon_free_stats(data);
+
     /* check their content */
     ret = lyd_print_mem(&str1, data, LYD_XML, 0);
     assert_int_equal(ret, 0);
@@ -496,10 +520,12 @@ test_sr_mon(void **state)
                     "<xpath xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">/if:interfaces</xpath>"
                     "<priority>3</priority>"
                     "<pid>%ld</pid>"
+                    "<events>0</events>"
                 "</change-sub>"
                 "<operational-sub>"
                     "<xpath xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">/if:interfaces-state</xpath>"
                     "<pid>%ld</pid>"
+                    "<events>0</events>"
                 "</operational-sub>"
             "</subscriptions>"
         "</module>"
@@ -513,6 +539,7 @@ test_sr_mon(void **state)
                     "<datastore xmlns:ds=\"urn:ietf:params:xml:ns:yang:ietf-datastores\">ds:running</datastore>"
                     "<priority>0</priority>"
                     "<pid>%ld</pid>"
+                    "<events>0</events>"
                 "</change-sub>"
             "</subscriptions>"
         "</module>"
@@ -525,6 +552,7 @@ test_sr_mon(void **state)
                 "<operational-sub>"
                     "<xpath xmlns:a=\"urn:act\" xmlns:a2=\"urn:act2\">/a:basics/a:subbasics/a2:complex_number/a2:imaginary_part</xpath>"
                     "<pid>%ld</pid>"
+                    "<events>0</events>"
                 "</operational-sub>"
             "</subscriptions>"
         "</module>"
@@ -2227,6 +2255,76 @@ test_stored_config(void **state)
     sr_unsubscribe(subscr);
 }
 
+/* TEST */
+static void
+test_stored_config_pruned(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct lyd_node *data;
+    sr_subscription_ctx_t *subscr;
+    char *str1;
+    const char *str2;
+    int ret;
+
+    /* set some configuration data */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth1']/type",
+            "iana-if-type:ethernetCsmacd", NULL, SR_EDIT_STRICT);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth1']/description",
+            "config-description", NULL, SR_EDIT_STRICT);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe to all configuration data just to enable them */
+    ret = sr_module_change_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces", dummy_change_cb, NULL,
+            0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* switch to operational DS */
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* store a diff referencing the configuration data */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth1']/description",
+            "oper-description", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read other top-level data of the module, the configuration data may be pruned only after the diff is applied */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces-state", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    if (data) {
+        /* only the default container */
+        assert_string_equal(data->schema->name, "interfaces-state");
+        assert_int_equal(data->dflt, 1);
+        lyd_free_withsiblings(data);
+    }
+
+    /* read only the changed leaf */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces/interface[name='eth1']/description", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = lyd_print_mem(&str1, data, LYD_XML, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+
+    lyd_free_withsiblings(data);
+
+    str2 =
+    "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+        "<interface>"
+            "<name>eth1</name>"
+            "<description>oper-description</description>"
+        "</interface>"
+    "</interfaces>";
+
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    sr_unsubscribe(subscr);
+}
+
 /* TEST */
 static void
 test_stored_np_cont1(void **state)
@@ -2981,6 +3079,193 @@ test_merge_flag(void **state)
     sr_unsubscribe(subscr);
 }
 
+/* TEST */
+static int
+commit_oper_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, const char *request_xpath,
+        uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    sr_session_ctx_t *sess;
+    struct lyd_node *node;
+    int ret;
+
+    (void)session;
+    (void)module_name;
+    (void)xpath;
+    (void)request_xpath;
+    (void)request_id;
+
+    /* commit a change into the module whose data are being read, must not wait for the reader */
+    ret = sr_session_start(st->conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(sess, "/ietf-interfaces:interfaces/interface[name='eth2']/type",
+            "iana-if-type:ethernetCsmacd", NULL, SR_EDIT_STRICT);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_session_stop(sess);
+
+    node = lyd_new_path(NULL, sr_get_context(st->conn), "/ietf-interfaces:interfaces-state/interface[name='eth1']/type",
+            "iana-if-type:ethernetCsmacd", 0, 0);
+    assert_non_null(node);
+    *parent = node;
+
+    ++st->cb_called;
+    return SR_ERR_OK;
+}
+
+static void
+test_commit_in_cb(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct lyd_node *data;
+    sr_subscription_ctx_t *subscr, *subscr2;
+    char *str1;
+    const char *str2;
+    int ret;
+
+    /* set some configuration data */
+    ret = sr_set_item_str(st->sess, "/ietf-interfaces:interfaces/interface[name='eth1']/type",
+            "iana-if-type:ethernetCsmacd", NULL, SR_EDIT_STRICT);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe to all configuration data just to enable them */
+    ret = sr_module_change_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces", dummy_change_cb, NULL,
+            0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe as state data provider that changes the configuration (separate thread so that the change
+     * subscription can be handled) */
+    ret = sr_oper_get_items_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces-state", commit_oper_cb,
+            st, 0, &subscr2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read all data from operational, the configuration snapshot is taken before the callback */
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    st->cb_called = 0;
+    ret = sr_get_data(st->sess, "/ietf-interfaces:*", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(st->cb_called, 1);
+
+    ret = lyd_print_mem(&str1, data, LYD_XML, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    lyd_free_withsiblings(data);
+
+    str2 =
+    "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+        "<interface>"
+            "<name>eth1</name>"
+            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+        "</interface>"
+    "</interfaces>"
+    "<interfaces-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+        "<interface>"
+            "<name>eth1</name>"
+            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+        "</interface>"
+    "</interfaces-state>";
+
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    /* the committed change is visible in the next read */
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_int_equal(st->cb_called, 1);
+    assert_string_equal(data->child->next->child->schema->name, "name");
+    lyd_free_withsiblings(data);
+
+    sr_unsubscribe(subscr);
+    sr_unsubscribe(subscr2);
+}
+
+/* TEST */
+static int
+parallel_oper_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, const char *request_xpath,
+        uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    struct lyd_node *node;
+
+    (void)session;
+    (void)xpath;
+    (void)request_xpath;
+    (void)request_id;
+
+    /* both callbacks must be called at the same time */
+    pthread_barrier_wait(&st->barrier);
+
+    if (!strcmp(module_name, "ietf-interfaces")) {
+        node = lyd_new_path(NULL, sr_get_context(st->conn), "/ietf-interfaces:interfaces-state/interface[name='eth1']/type",
+                "iana-if-type:ethernetCsmacd", 0, 0);
+    } else {
+        assert_string_equal(module_name, "mixed-config");
+        node = lyd_new_path(NULL, sr_get_context(st->conn), "/mixed-config:test-state/ll", "val", 0, 0);
+    }
+    assert_non_null(node);
+    *parent = node;
+
+    return SR_ERR_OK;
+}
+
+static void
+test_parallel(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct lyd_node *data;
+    sr_subscription_ctx_t *subscr, *subscr2;
+    char *str1;
+    const char *str2;
+    int ret;
+
+    /* subscribe providers of 2 modules, each handled by its own thread */
+    ret = sr_oper_get_items_subscribe(st->sess, "ietf-interfaces", "/ietf-interfaces:interfaces-state",
+            parallel_oper_cb, st, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_oper_get_items_subscribe(st->sess, "mixed-config", "/mixed-config:test-state", parallel_oper_cb, st, 0,
+            &subscr2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* allow querying both providers at once */
+    ret = sr_set_oper_parallel_limit(st->conn, 2);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* read the data of both modules */
+    ret = sr_session_switch_ds(st->sess, SR_DS_OPERATIONAL);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data(st->sess, "/ietf-interfaces:interfaces-state | /mixed-config:test-state", 0, 0, 0, &data);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = lyd_print_mem(&str1, data, LYD_XML, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    lyd_free_withsiblings(data);
+
+    str2 =
+    "<interfaces-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+        "<interface>"
+            "<name>eth1</name>"
+            "<type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+        "</interface>"
+    "</interfaces-state>"
+    "<test-state xmlns=\"urn:sysrepo:mixed-config\">"
+        "<ll>val</ll>"
+    "</test-state>";
+
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    ret = sr_set_oper_parallel_limit(st->conn, 1);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    sr_unsubscribe(subscr);
+    sr_unsubscribe(subscr2);
+}
+
 int
 main(void)
 {
@@ -3003,6 +3288,7 @@ main(void)
         cmocka_unit_test_teardown(test_stored_state, clear_up),
         cmocka_unit_test_teardown(test_stored_state_list, clear_up),
         cmocka_unit_test_teardown(test_stored_config, clear_up),
+        cmocka_unit_test_teardown(test_stored_config_pruned, clear_up),
         cmocka_unit_test_teardown(test_stored_np_cont1, clear_up),
         cmocka_unit_test_teardown(test_stored_np_cont2, clear_up),
         cmocka_unit_test_teardown(test_stored_diff_merge_leaf, clear_up),
@@ -3011,6 +3297,8 @@ main(void)
         cmocka_unit_test(test_default_when),
         cmocka_unit_test(test_nested_default),
         cmocka_unit_test_teardown(test_merge_flag, clear_up),
+        cmocka_unit_test_teardown(test_commit_in_cb, clear_up),
+        cmocka_unit_test_teardown(test_parallel, clear_up),
     };
 
     setenv("CMOCKA_TEST_ABORT", "1", 1);
@@ -22,6 +22,7 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -338,12 +339,190 @@ test_rpc_crash2(int rp, int wp)
     return 0;
 }
 
+/* TEST */
+static int
+test_conn_crash1(int rp, int wp)
+{
+    sr_conn_ctx_t *conn, *conn2;
+    sr_session_ctx_t *sess;
+    struct lyd_node *rpc, *output;
+    int ret, i;
+
+    /* the first connection of the process creates the watch of closed connections */
+    ret = sr_connect(0, &conn);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    /* wait for the other process to subscribe */
+    barrier(rp, wp);
+
+    /* let the other process terminate */
+    barrier(rp, wp);
+
+    rpc = lyd_new_path(NULL, sr_get_context(conn), "/ops:rpc3/l4", "value", 0, 0);
+    sr_assert_true(rpc);
+
+    for (i = 0; i < 100; ++i) {
+        /* another connection shares the watch, its connect reads the close event and recovers only the terminated
+         * process, all the connections were checked only when the watch was created */
+        ret = sr_connect(0, &conn2);
+        sr_assert_int_equal(ret, SR_ERR_OK);
+        sr_disconnect(conn2);
+
+        /* the subscription of the terminated process was removed */
+        output = NULL;
+        ret = sr_rpc_send_tree(sess, rpc, 100, &output);
+        lyd_free_withsiblings(output);
+        if (ret == SR_ERR_UNSUPPORTED) {
+            break;
+        }
+
+        /* the process may still be exiting */
+        usleep(10000);
+    }
+    sr_assert_int_equal(ret, SR_ERR_UNSUPPORTED);
+
+    lyd_free(rpc);
+    sr_disconnect(conn);
+    return 0;
+}
+
+static int
+test_conn_crash2(int rp, int wp)
+{
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *sub;
+    int ret;
+
+    ret = sr_connect(0, &conn);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    /* do not create thread to avoid leaks */
+    ret = sr_rpc_subscribe(sess, "/ops:rpc3", rpc_sub_cb, NULL, 0, SR_SUBSCR_NO_THREAD, &sub);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    /* wait for the other process */
+    barrier(rp, wp);
+    barrier(rp, wp);
+
+    /* terminate without disconnecting, the connection file is closed */
+    exit(0);
+}
+
+/* TEST */
+static int
+oper_sub_cb(sr_session_ctx_t *session, const char *module_name, const char *xpath, const char *request_xpath,
+        uint32_t request_id, struct lyd_node **parent, void *private_data)
+{
+    (void)session;
+    (void)module_name;
+    (void)xpath;
+    (void)request_xpath;
+    (void)request_id;
+    (void)parent;
+    (void)private_data;
+
+    return SR_ERR_OK;
+}
+
+static int
+test_sub_crash1(int rp, int wp)
+{
+    sr_conn_ctx_t *conn, *conn2;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *sub;
+    uint32_t conn_count;
+    int ret, i;
+
+    ret = sr_connect(0, &conn);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_start(conn, SR_DS_OPERATIONAL, &sess);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    /* the events are never processed so the other process keeps waiting for the data */
+    ret = sr_oper_get_items_subscribe(sess, "ops-ref", "/ops-ref:l1", oper_sub_cb, NULL, SR_SUBSCR_NO_THREAD, &sub);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    /* wait for the other process */
+    barrier(rp, wp);
+
+    for (i = 0; i < 100; ++i) {
+        /* once the other process terminates while holding main SHM and ops-ref subscriptions READ locks,
+         * connect removes the main SHM lock and recovers the terminated connection */
+        ret = sr_connect(0, &conn2);
+        sr_assert_int_equal(ret, SR_ERR_OK);
+        sr_disconnect(conn2);
+
+        ret = sr_connection_count(&conn_count);
+        sr_assert_int_equal(ret, SR_ERR_OK);
+        if (conn_count == 1) {
+            break;
+        }
+
+        /* the process may not have terminated yet */
+        usleep(100000);
+    }
+    sr_assert_int_equal(conn_count, 1);
+
+    /* ops-ref subscriptions can be WRITE locked again */
+    ret = sr_oper_get_items_subscribe(sess, "ops-ref", "/ops-ref:l2", oper_sub_cb, NULL, SR_SUBSCR_CTX_REUSE, &sub);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    sr_unsubscribe(sub);
+    sr_disconnect(conn);
+    return 0;
+}
+
+static void
+sub_crash_alarm(int signum)
+{
+    (void)signum;
+
+    /* terminate without disconnecting and unlocking anything */
+    _exit(0);
+}
+
+static int
+test_sub_crash2(int rp, int wp)
+{
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    struct lyd_node *data;
+    int ret;
+
+    ret = sr_connect(0, &conn);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_session_start(conn, SR_DS_OPERATIONAL, &sess);
+    sr_assert_int_equal(ret, SR_ERR_OK);
+
+    /* wait for the other process to subscribe */
+    barrier(rp, wp);
+
+    /* crash while waiting for the operational data */
+    signal(SIGALRM, sub_crash_alarm);
+    alarm(1);
+    sr_get_data(sess, "/ops-ref:l1", 0, 5000, 0, &data);
+
+    /* unreachable */
+    return 1;
+}
+
 int
 main(void)
 {
     struct test tests[] = {
         {"rpc sub", test_rpc_sub, test_rpc_sub, setup, teardown},
         {"rpc crash", test_rpc_crash1, test_rpc_crash2, setup, teardown},
+        {"conn crash", test_conn_crash1, test_conn_crash2, setup, teardown},
+        {"sub crash", test_sub_crash1, test_sub_crash2, setup, teardown},
     };
 
     sr_log_set_cb(test_log_cb);
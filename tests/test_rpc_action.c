@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <setjmp.h>
 #include <string.h>
@@ -522,6 +523,134 @@ test_action(void **state)
     sr_unsubscribe(subscr);
 }
 
+static void
+test_action_async(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr;
+    const sr_error_info_t *err_info = NULL;
+    sr_async_t *req[3];
+    struct pollfd pfd[3];
+    struct lyd_node *node, *input_op, *output_op, *data;
+    char *str1;
+    const char *str2;
+    int ret, i, done;
+
+    /* subscribe */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:cont/list1/cont2/act1", rpc_action_cb, NULL, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:cont/list1/act2", rpc_action_cb, NULL, 0, SR_SUBSCR_CTX_REUSE, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* set some data needed for validation and executing the actions */
+    ret = sr_set_item_str(st->sess, "/ops:cont/list1[k='key']", NULL, NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_item_str(st->sess, "/ops:cont/l12", "l12-val", NULL, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_apply_changes(st->sess, 0, 0);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe to the data so they are actually present in operational */
+    ret = sr_module_change_subscribe(st->sess, "ops", NULL, module_change_dummy_cb, NULL, 0, SR_SUBSCR_CTX_REUSE, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* send both actions and read the data without waiting */
+    input_op = lyd_new_path(NULL, sr_get_context(st->conn), "/ops:cont/list1[k='key']/cont2/act1", NULL, 0, LYD_PATH_OPT_NOPARENTRET);
+    assert_non_null(input_op);
+    node = lyd_new_path(input_op, NULL, "l6", "val", 0, 0);
+    assert_non_null(node);
+    node = lyd_new_path(input_op, NULL, "l7", "val", 0, 0);
+    assert_non_null(node);
+    ret = sr_rpc_send_tree_async(st->sess, input_op, 0, &req[0]);
+    for (; input_op->parent; input_op = input_op->parent);
+    lyd_free_withsiblings(input_op);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    input_op = lyd_new_path(NULL, sr_get_context(st->conn), "/ops:cont/list1[k='key']/act2", NULL, 0, LYD_PATH_OPT_NOPARENTRET);
+    assert_non_null(input_op);
+    node = lyd_new_path(input_op, NULL, "l10", "e3", 0, 0);
+    assert_non_null(node);
+    ret = sr_rpc_send_tree_async(st->sess, input_op, 0, &req[1]);
+    for (; input_op->parent; input_op = input_op->parent);
+    lyd_free_withsiblings(input_op);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_get_data_async(st->sess, "/ops:cont/l12", 0, 0, 0, &req[2]);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* wait for all the requests */
+    for (i = 0; i < 3; ++i) {
+        ret = sr_async_get_fd(req[i], &pfd[i].fd);
+        assert_int_equal(ret, SR_ERR_OK);
+        pfd[i].events = POLLIN;
+    }
+    do {
+        ret = poll(pfd, 3, 5000);
+        assert_int_not_equal(ret, -1);
+        assert_int_not_equal(ret, 0);
+
+        done = 0;
+        for (i = 0; i < 3; ++i) {
+            if (pfd[i].revents & POLLIN) {
+                assert_true(sr_async_is_done(req[i]));
+                ++done;
+            }
+        }
+    } while (done < 3);
+
+    /* check output data trees */
+    ret = sr_async_finish(req[0], &output_op);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(output_op);
+    ret = lyd_print_mem(&str1, output_op, LYD_XML, LYP_WITHSIBLINGS);
+    for (; output_op->parent; output_op = output_op->parent);
+    lyd_free_withsiblings(output_op);
+    assert_int_equal(ret, 0);
+    str2 = "<act1 xmlns=\"urn:ops\"><l9>l12-val</l9></act1>";
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    ret = sr_async_finish(req[1], &output_op);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(output_op);
+    ret = lyd_print_mem(&str1, output_op, LYD_XML, LYP_WITHSIBLINGS);
+    for (; output_op->parent; output_op = output_op->parent);
+    lyd_free_withsiblings(output_op);
+    assert_int_equal(ret, 0);
+    str2 = "<act2 xmlns=\"urn:ops\"><l11>-65536</l11></act2>";
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    ret = sr_async_finish(req[2], &data);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(data);
+    ret = lyd_print_mem(&str1, data, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_free_withsiblings(data);
+    assert_int_equal(ret, 0);
+    str2 = "<cont xmlns=\"urn:ops\"><l12>l12-val</l12></cont>";
+    assert_string_equal(str1, str2);
+    free(str1);
+
+    /* errors are stored in the session the request was created on */
+    input_op = lyd_new_path(NULL, sr_get_context(st->conn), "/ops:cont/list1[k='none']/act2", NULL, 0, LYD_PATH_OPT_NOPARENTRET);
+    assert_non_null(input_op);
+    node = lyd_new_path(input_op, NULL, "l10", "e3", 0, 0);
+    assert_non_null(node);
+    ret = sr_rpc_send_tree_async(st->sess, input_op, 0, &req[0]);
+    for (; input_op->parent; input_op = input_op->parent);
+    lyd_free_withsiblings(input_op);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_async_finish(req[0], &output_op);
+    assert_int_equal(ret, SR_ERR_VALIDATION_FAILED);
+    assert_null(output_op);
+    ret = sr_get_error(st->sess, &err_info);
+    assert_int_equal(ret, SR_ERR_OK);
+    assert_non_null(err_info);
+    assert_int_equal(err_info->err_code, SR_ERR_VALIDATION_FAILED);
+
+    sr_unsubscribe(subscr);
+}
+
 /* TEST */
 static int
 rpc_action_pred_cb(sr_session_ctx_t *session, const char *op_path, const struct lyd_node *input, sr_event_t event,
@@ -1400,6 +1529,219 @@ test_rpc_shelve(void **state)
     pthread_join(tid[1], NULL);
 }
 
+static int
+rpc_concurrent_cb(sr_session_ctx_t *session, const char *op_path, const struct lyd_node *input, sr_event_t event,
+        uint32_t request_id, struct lyd_node *output, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    struct lyd_node *node;
+
+    (void)session;
+    (void)op_path;
+    (void)input;
+    (void)event;
+    (void)request_id;
+
+    /* both the callbacks must be running at the same time */
+    pthread_barrier_wait(&st->barrier);
+
+    /* create output data */
+    node = lyd_new_path(output, NULL, "l5", "256", 0, LYD_PATH_OPT_OUTPUT);
+    assert_non_null(node);
+
+    return SR_ERR_OK;
+}
+
+struct async_done {
+    int count;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+static void
+rpc_async_done_cb(sr_session_ctx_t *session, int err_code, const struct lyd_node *output, void *private_data)
+{
+    struct async_done *done = private_data;
+
+    (void)session;
+
+    assert_int_equal(err_code, SR_ERR_OK);
+    assert_non_null(output);
+    assert_string_equal(output->schema->name, "rpc3");
+    assert_non_null(output->child);
+    assert_string_equal(output->child->schema->name, "l5");
+
+    pthread_mutex_lock(&done->lock);
+    ++done->count;
+    pthread_cond_signal(&done->cond);
+    pthread_mutex_unlock(&done->lock);
+}
+
+static void
+test_rpc_concurrent(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_subscription_ctx_t *subscr[3];
+    struct async_done done = {0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    struct lyd_node *input_op;
+    int ret;
+
+    /* subscribe twice, each subscription handles RPCs in its own thread */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc3", rpc_concurrent_cb, st, 0, SR_SUBSCR_CONCURRENT, &subscr[0]);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc3", rpc_concurrent_cb, st, 0, SR_SUBSCR_CONCURRENT, &subscr[1]);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* standard subscription cannot be added */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc3", rpc_concurrent_cb, st, 0, 0, &subscr[2]);
+    assert_int_equal(ret, SR_ERR_INVAL_ARG);
+
+    /* send the RPC twice without waiting, both the callbacks block until the other one is called */
+    input_op = lyd_new_path(NULL, sr_get_context(st->conn), "/ops:rpc3/l4", "vall", 0, 0);
+    assert_non_null(input_op);
+    ret = sr_rpc_send_async(st->sess, input_op, 0, rpc_async_done_cb, &done);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_rpc_send_async(st->sess, input_op, 0, rpc_async_done_cb, &done);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_free_withsiblings(input_op);
+
+    /* wait for both the replies */
+    pthread_mutex_lock(&done.lock);
+    while (done.count < 2) {
+        pthread_cond_wait(&done.cond, &done.lock);
+    }
+    pthread_mutex_unlock(&done.lock);
+
+    sr_unsubscribe(subscr[0]);
+    sr_unsubscribe(subscr[1]);
+
+    /* standard subscription can be added again */
+    ret = sr_rpc_subscribe_tree(st->sess, "/ops:rpc3", rpc_concurrent_cb, st, 0, 0, &subscr[2]);
+    assert_int_equal(ret, SR_ERR_OK);
+    sr_unsubscribe(subscr[2]);
+}
+
+static void
+test_rpc_async_disconnect(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr;
+    struct async_done done = {0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    struct lyd_node *input_op;
+    int ret, i;
+
+    ret = sr_rpc_subscribe(st->sess, "/ops:rpc3", rpc_rpc_cb, NULL, 0, 0, &subscr);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    ret = sr_connect(0, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* send several RPCs on the new connection */
+    input_op = lyd_new_path(NULL, sr_get_context(conn), "/ops:rpc3/l4", "vall", 0, 0);
+    assert_non_null(input_op);
+    for (i = 0; i < 4; ++i) {
+        ret = sr_rpc_send_async(sess, input_op, 0, rpc_async_done_cb, &done);
+        assert_int_equal(ret, SR_ERR_OK);
+    }
+    lyd_free_withsiblings(input_op);
+
+    /* wait for the first reply */
+    pthread_mutex_lock(&done.lock);
+    while (done.count < 1) {
+        pthread_cond_wait(&done.cond, &done.lock);
+    }
+    pthread_mutex_unlock(&done.lock);
+
+    /* disconnect right away, all the callbacks must be called and finished before it returns */
+    sr_disconnect(conn);
+
+    pthread_mutex_lock(&done.lock);
+    assert_int_equal(done.count, 4);
+    pthread_mutex_unlock(&done.lock);
+
+    sr_unsubscribe(subscr);
+}
+
+static int
+rpc_pool_cb(sr_session_ctx_t *session, const char *op_path, const struct lyd_node *input, sr_event_t event,
+        uint32_t request_id, struct lyd_node *output, void *private_data)
+{
+    struct state *st = (struct state *)private_data;
+    struct lyd_node *node;
+
+    (void)session;
+    (void)input;
+    (void)event;
+    (void)request_id;
+
+    /* both the callbacks must be running at the same time */
+    pthread_barrier_wait(&st->barrier);
+
+    if (!strcmp(op_path, "/ops:rpc3")) {
+        /* create output data */
+        node = lyd_new_path(output, NULL, "l5", "256", 0, LYD_PATH_OPT_OUTPUT);
+        assert_non_null(node);
+    }
+
+    return SR_ERR_OK;
+}
+
+static void
+test_handler_pool(void **state)
+{
+    struct state *st = (struct state *)*state;
+    sr_conn_ctx_t *conn;
+    sr_session_ctx_t *sess;
+    sr_subscription_ctx_t *subscr[2];
+    struct async_done done = {0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    struct lyd_node *input_op, *output_op;
+    int ret;
+
+    ret = sr_connect(0, &conn);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_handler_pool(conn, 2);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_set_handler_pool(conn, 2);
+    assert_int_equal(ret, SR_ERR_EXISTS);
+    ret = sr_session_start(conn, SR_DS_RUNNING, &sess);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* subscribe in separate subscription contexts handled by the pool */
+    ret = sr_rpc_subscribe_tree(sess, "/ops:rpc1", rpc_pool_cb, st, 0, 0, &subscr[0]);
+    assert_int_equal(ret, SR_ERR_OK);
+    ret = sr_rpc_subscribe_tree(sess, "/ops:rpc3", rpc_pool_cb, st, 0, 0, &subscr[1]);
+    assert_int_equal(ret, SR_ERR_OK);
+
+    /* send both RPCs, the callbacks block until the other one is called */
+    input_op = lyd_new_path(NULL, sr_get_context(st->conn), "/ops:rpc3/l4", "vall", 0, 0);
+    assert_non_null(input_op);
+    ret = sr_rpc_send_async(st->sess, input_op, 0, rpc_async_done_cb, &done);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_free_withsiblings(input_op);
+
+    input_op = lyd_new_path(NULL, sr_get_context(st->conn), "/ops:rpc1", NULL, 0, 0);
+    assert_non_null(input_op);
+    ret = sr_rpc_send_tree(st->sess, input_op, 0, &output_op);
+    assert_int_equal(ret, SR_ERR_OK);
+    lyd_free_withsiblings(input_op);
+    lyd_free_withsiblings(output_op);
+
+    /* wait for the other reply */
+    pthread_mutex_lock(&done.lock);
+    while (done.count < 1) {
+        pthread_cond_wait(&done.cond, &done.lock);
+    }
+    pthread_mutex_unlock(&done.lock);
+
+    sr_unsubscribe(subscr[0]);
+    sr_unsubscribe(subscr[1]);
+    sr_disconnect(conn);
+}
+
 static void
 test_input_parameters(void **state)
 {
@@ -1559,6 +1901,7 @@ main(void)
         cmocka_unit_test(test_fail),
         cmocka_unit_test_teardown(test_rpc, clear_ops),
         cmocka_unit_test_teardown(test_action, clear_ops),
+        cmocka_unit_test_teardown(test_action_async, clear_ops),
         cmocka_unit_test_teardown(test_action_pred, clear_ops),
         cmocka_unit_test_teardown(test_multi, clear_ops),
         cmocka_unit_test(test_multi_fail),
@@ -1566,6 +1909,9 @@ main(void)
         cmocka_unit_test(test_action_deps),
         cmocka_unit_test_teardown(test_action_change_config, clear_ops),
         cmocka_unit_test(test_rpc_shelve),
+        cmocka_unit_test(test_rpc_concurrent),
+        cmocka_unit_test(test_rpc_async_disconnect),
+        cmocka_unit_test(test_handler_pool),
         cmocka_unit_test(test_input_parameters),
         cmocka_unit_test(test_rpc_action_with_no_thread),
     };